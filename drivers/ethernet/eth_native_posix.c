@@ -48,9 +48,30 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #define ETH_HDR_LEN sizeof(struct net_eth_hdr)
 #endif
 
+#define ETH_FRAME_MAX_LEN (_ETH_MTU + ETH_HDR_LEN)
+
+/* Number of net_buf fragments a full sized frame is spread over */
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+#define ETH_FRAME_FRAGS ((ETH_FRAME_MAX_LEN + CONFIG_NET_BUF_DATA_SIZE - 1) / \
+			 CONFIG_NET_BUF_DATA_SIZE)
+#else
+#define ETH_FRAME_FRAGS 1
+#endif
+
+/* TX packets are usually built from a header fragment plus payload
+ * fragments so leave some slack. Anything more fragmented than this is
+ * linearized into ctx->send before it is written.
+ */
+#define ETH_TX_IOV_MAX (ETH_FRAME_FRAGS + 4)
+
+#if defined(CONFIG_ETH_NATIVE_POSIX_RX_BATCH)
+#define ETH_RX_BUDGET CONFIG_ETH_NATIVE_POSIX_RX_BUDGET
+#else
+#define ETH_RX_BUDGET 1
+#endif
+
 struct eth_context {
-	u8_t recv[_ETH_MTU + ETH_HDR_LEN];
-	u8_t send[_ETH_MTU + ETH_HDR_LEN];
+	u8_t send[ETH_FRAME_MAX_LEN];
 	u8_t mac_addr[6];
 	struct net_linkaddr ll_addr;
 	struct net_if *iface;
@@ -183,23 +204,57 @@ static int eth_send(struct device *dev, struct net_pkt *pkt)
 {
 	struct eth_context *ctx = dev->driver_data;
 	int count = net_pkt_get_len(pkt);
+	struct iovec iov[ETH_TX_IOV_MAX];
+	struct net_buf *buf;
+	int iovcnt = 0;
 	int ret;
 
-	ret = net_pkt_read_new(pkt, ctx->send, count);
-	if (ret) {
-		return ret;
-	}
-
 	update_gptp(net_pkt_iface(pkt), pkt, true);
 
 	LOG_DBG("Send pkt %p len %d", pkt, count);
 
-	ret = eth_write_data(ctx->dev_fd, ctx->send, count);
+	/* Hand the fragments to the host as they are, the frame is
+	 * only copied if it is too fragmented for the iovec array.
+	 */
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		if (!buf->len) {
+			continue;
+		}
+
+		if (iovcnt == ETH_TX_IOV_MAX) {
+			iovcnt = -1;
+			break;
+		}
+
+		iov[iovcnt].iov_base = buf->data;
+		iov[iovcnt].iov_len = buf->len;
+		iovcnt++;
+	}
+
+	if (iovcnt < 0) {
+		ret = net_pkt_read_new(pkt, ctx->send, count);
+		if (ret) {
+			return ret;
+		}
+
+		ret = eth_write_data(ctx->dev_fd, ctx->send, count);
+	} else {
+		ret = eth_write_data_vec(ctx->dev_fd, iov, iovcnt);
+	}
+
 	if (ret < 0) {
 		LOG_DBG("Cannot send pkt %p (%d)", pkt, ret);
+		return ret;
 	}
 
-	return ret < 0 ? ret : 0;
+	/* Whatever the host answers will be waiting for us, no need to
+	 * sleep through the rest of the idle poll interval.
+	 */
+	if (IS_ENABLED(CONFIG_ETH_NATIVE_POSIX_RX_BATCH)) {
+		k_wakeup(&rx_thread_data);
+	}
+
+	return 0;
 }
 
 static int eth_init(struct device *dev)
@@ -238,25 +293,47 @@ static inline struct net_if *get_iface(struct eth_context *ctx,
 static int read_data(struct eth_context *ctx, int fd)
 {
 	u16_t vlan_tag = NET_VLAN_TAG_UNSPEC;
+	struct iovec iov[ETH_FRAME_FRAGS];
 	struct net_if *iface;
 	struct net_pkt *pkt;
+	struct net_buf *buf;
+	int iovcnt = 0;
+	size_t len;
 	int count;
 
-	count = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
-	if (count <= 0) {
-		return 0;
-	}
-
-	pkt = net_pkt_rx_alloc_with_buffer(ctx->iface, count,
+	/* The frame length is not known before reading it, so reserve
+	 * room for a full sized frame and let the host scatter the frame
+	 * directly into the fragments.
+	 */
+	pkt = net_pkt_rx_alloc_with_buffer(ctx->iface, ETH_FRAME_MAX_LEN,
 					   AF_UNSPEC, 0, NET_BUF_TIMEOUT);
 	if (!pkt) {
 		return -ENOMEM;
 	}
 
-	if (net_pkt_write_new(pkt, ctx->recv, count)) {
-		return -ENOBUFS;
+	for (buf = pkt->buffer; buf && iovcnt < ETH_FRAME_FRAGS;
+	     buf = buf->frags) {
+		iov[iovcnt].iov_base = buf->data;
+		iov[iovcnt].iov_len = net_buf_tailroom(buf);
+		iovcnt++;
+	}
+
+	count = eth_read_data_vec(fd, iov, iovcnt);
+	if (count <= 0) {
+		net_pkt_unref(pkt);
+		return -EAGAIN;
 	}
 
+	for (buf = pkt->buffer, len = count; buf && len; buf = buf->frags) {
+		size_t frag_len = MIN(len, net_buf_tailroom(buf));
+
+		net_buf_add(buf, frag_len);
+		len -= frag_len;
+	}
+
+	net_pkt_trim_buffer(pkt);
+	net_pkt_cursor_init(pkt);
+
 #if defined(CONFIG_NET_VLAN)
 	{
 		struct net_eth_hdr *hdr = NET_ETH_HDR(pkt);
@@ -293,23 +370,56 @@ static int read_data(struct eth_context *ctx, int fd)
 	return 0;
 }
 
-static void eth_rx(struct eth_context *ctx)
+static int eth_rx_batch(struct eth_context *ctx)
 {
+	int count = 0;
 	int ret;
 
+	while (count < ETH_RX_BUDGET) {
+		ret = eth_wait_data(ctx->dev_fd);
+		if (ret == -EAGAIN) {
+			break;
+		}
+
+		if (ret < 0) {
+			eth_stats_update_errors_rx(ctx->iface);
+			break;
+		}
+
+		if (read_data(ctx, ctx->dev_fd) < 0) {
+			break;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+static void eth_rx(struct eth_context *ctx)
+{
+	int count;
+
 	LOG_DBG("Starting ZETH RX thread");
 
 	while (1) {
+		count = 0;
+
 		if (net_if_is_up(ctx->iface)) {
-			ret = eth_wait_data(ctx->dev_fd);
-			if (!ret) {
-				read_data(ctx, ctx->dev_fd);
-			} else {
-				eth_stats_update_errors_rx(ctx->iface);
-			}
+			count = eth_rx_batch(ctx);
+		}
+
+		/* If the budget ran out there are most likely more frames
+		 * pending, so only let the stack process the batch before
+		 * polling the device again.
+		 */
+		if (IS_ENABLED(CONFIG_ETH_NATIVE_POSIX_RX_BATCH) &&
+		    count == ETH_RX_BUDGET) {
+			k_yield();
+			continue;
 		}
 
-		k_sleep(K_MSEC(50));
+		k_sleep(K_MSEC(CONFIG_ETH_NATIVE_POSIX_RX_TIMEOUT));
 	}
 }
 
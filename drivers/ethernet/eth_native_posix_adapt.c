@@ -23,6 +23,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <time.h>
 #include "posix_trace.h"
@@ -175,6 +176,20 @@ ssize_t eth_write_data(int fd, void *buf, size_t buf_len)
 	return write(fd, buf, buf_len);
 }
 
+/* The TAP device delivers exactly one frame per read() and takes one
+ * frame per write(), so the vectored variants let the driver scatter a
+ * frame straight into, or gather it straight out of, net_buf fragments.
+ */
+ssize_t eth_read_data_vec(int fd, const struct iovec *iov, int iovcnt)
+{
+	return readv(fd, iov, iovcnt);
+}
+
+ssize_t eth_write_data_vec(int fd, const struct iovec *iov, int iovcnt)
+{
+	return writev(fd, iov, iovcnt);
+}
+
 #if defined(CONFIG_NET_GPTP)
 int eth_clock_gettime(struct net_ptp_time *time)
 {
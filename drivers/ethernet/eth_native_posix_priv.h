@@ -25,6 +25,11 @@
 #define ETH_NATIVE_POSIX_STARTUP_SCRIPT_USER ""
 #endif
 
+/* Both the host and the Zephyr side define struct iovec with the same
+ * layout, so only a forward declaration is needed here.
+ */
+struct iovec;
+
 int eth_iface_create(const char *if_name, bool tun_only);
 int eth_iface_remove(int fd);
 int eth_setup_host(const char *if_name);
@@ -32,6 +37,8 @@ int eth_start_script(const char *if_name);
 int eth_wait_data(int fd);
 ssize_t eth_read_data(int fd, void *buf, size_t buf_len);
 ssize_t eth_write_data(int fd, void *buf, size_t buf_len);
+ssize_t eth_read_data_vec(int fd, const struct iovec *iov, int iovcnt);
+ssize_t eth_write_data_vec(int fd, const struct iovec *iov, int iovcnt);
 int eth_if_up(const char *if_name);
 int eth_if_down(const char *if_name);
 
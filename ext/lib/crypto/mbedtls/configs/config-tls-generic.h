@@ -60,6 +60,15 @@
 
 #endif
 
+#if defined(CONFIG_MBEDTLS_SSL_SESSION_TICKETS)
+#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_TICKET_C
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE)
+#define MBEDTLS_SSL_CACHE_C
+#endif
+
 #if defined(CONFIG_MBEDTLS_DTLS)
 #define MBEDTLS_SSL_PROTO_DTLS
 #define MBEDTLS_SSL_DTLS_ANTI_REPLAY
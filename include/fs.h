@@ -27,6 +27,7 @@ typedef long long int off_t;
 #endif
 
 #include <misc/dlist.h>
+#include <misc/slist.h>
 #include <fs/fs_interface.h>
 
 #ifdef __cplusplus
@@ -110,6 +111,49 @@ struct fs_statvfs {
 	unsigned long f_bfree;
 };
 
+/**
+ * @brief Buffer of a vectored read or write
+ *
+ * @param iov_base Pointer to the data buffer
+ * @param iov_len Size of the buffer in bytes
+ */
+struct fs_iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+
+/**
+ * @brief Operation of an asynchronous request
+ */
+enum fs_async_op {
+	FS_ASYNC_READ = 0,
+	FS_ASYNC_WRITE
+};
+
+/**
+ * @brief Asynchronous read or write request
+ *
+ * The request, its buffers and the signal must stay valid until the
+ * signal is raised.
+ *
+ * @param node Entry of the queue of pending requests, used by the core
+ * @param zfp Pointer to the file object
+ * @param op Read or write
+ * @param iov Buffers to read into or write from, in order
+ * @param iovcnt Number of buffers
+ * @param signal Signal raised with the result when the request is done
+ * @param result Number of bytes read or written, or -ERRNO code on error
+ */
+struct fs_async_req {
+	sys_snode_t node;
+	struct fs_file_t *zfp;
+	enum fs_async_op op;
+	const struct fs_iovec *iov;
+	int iovcnt;
+	struct k_poll_signal *signal;
+	ssize_t result;
+};
+
 /**
  * @brief File System interface structure
  *
@@ -267,6 +311,59 @@ ssize_t fs_read(struct fs_file_t *zfp, void *ptr, size_t size);
  */
 ssize_t fs_write(struct fs_file_t *zfp, const void *ptr, size_t size);
 
+/**
+ * @brief File vectored read
+ *
+ * Reads into the buffers in order, as fs_read() would for each.
+ *
+ * @param zfp Pointer to the file object
+ * @param iov Buffers to read into
+ * @param iovcnt Number of buffers
+ *
+ * @return Number of bytes read, less than the size of the buffers when the
+ * end of the file is reached. Returns -ERRNO code if the first read fails,
+ * the number of bytes already read if a later one does.
+ */
+ssize_t fs_readv(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		 int iovcnt);
+
+/**
+ * @brief File vectored write
+ *
+ * Writes the buffers in order, as fs_write() would for each.
+ *
+ * @param zfp Pointer to the file object
+ * @param iov Buffers to write
+ * @param iovcnt Number of buffers
+ *
+ * @return Number of bytes written, less than the size of the buffers when
+ * the disk got full. Returns -ERRNO code if the first write fails, the
+ * number of bytes already written if a later one does.
+ */
+ssize_t fs_writev(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		  int iovcnt);
+
+/**
+ * @brief Submit an asynchronous read or write
+ *
+ * Queues the request to the file system I/O thread, which does it with
+ * fs_readv() or fs_writev() and raises req->signal with the result.
+ * Requests are done in the order they are submitted. Writes queued back
+ * to back to the same file may be merged into a single write to the
+ * file system, each still gets its own result.
+ *
+ * The file must not be closed, nor read, written or moved with the
+ * synchronous calls, while it has requests pending.
+ *
+ * Available with CONFIG_FILE_SYSTEM_ASYNC.
+ *
+ * @param req Request, see struct fs_async_req
+ *
+ * @retval 0 Success, the request is queued
+ * @retval -ERRNO errno code if error
+ */
+int fs_async_submit(struct fs_async_req *req);
+
 /**
  * @brief File seek
  *
@@ -447,9 +447,19 @@ struct _thread_base {
 	/* True for the per-CPU idle threads */
 	u8_t is_idle;
 
-	/* CPU index on which thread was last run */
+	/* CPU index on which thread was last run (or, with
+	 * CONFIG_SCHED_CPU_RUNQ, whose ready queue it is waiting in)
+	 */
 	u8_t cpu;
 
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	/* True while in the ready queue of CPU cpu.  Kept out of
+	 * thread_state as it is only written under that queue's lock,
+	 * not under sched_spinlock.
+	 */
+	u8_t queued;
+#endif
+
 	/* Recursive count of irq_lock() calls */
 	u8_t global_lock_count;
 
@@ -3972,9 +3982,34 @@ static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_POOL_CACHE
+/* Per-level (and per-CPU) cache of recently freed blocks, threaded
+ * through the free blocks themselves.  Cached blocks stay marked as
+ * allocated in the underlying buddy allocator.
+ */
+struct k_mem_pool_mag {
+	struct k_spinlock lock;
+	void *head;
+	u16_t count;
+	u32_t hits;
+	u32_t misses;
+};
+
+#define Z_MEM_POOL_MAGS_DEFINE(name, minsz, maxsz)			\
+	struct k_mem_pool_mag						\
+	_mpool_mags_##name[Z_MPOOL_LVLS(maxsz, minsz) * CONFIG_MP_NUM_CPUS];
+#define Z_MEM_POOL_MAGS_INIT(name) .mags = _mpool_mags_##name,
+#else
+#define Z_MEM_POOL_MAGS_DEFINE(name, minsz, maxsz)
+#define Z_MEM_POOL_MAGS_INIT(name)
+#endif
+
 struct k_mem_pool {
 	struct sys_mem_pool_base base;
 	_wait_q_t wait_q;
+#ifdef CONFIG_MEM_POOL_CACHE
+	struct k_mem_pool_mag *mags;
+#endif
 };
 
 /**
@@ -4010,6 +4045,7 @@ struct k_mem_pool {
 	char __aligned(align) _mpool_buf_##name[_ALIGN4(maxsz * nmax)	\
 				  + _MPOOL_BITS_SIZE(maxsz, minsz, nmax)]; \
 	struct sys_mem_pool_lvl _mpool_lvls_##name[Z_MPOOL_LVLS(maxsz, minsz)]; \
+	Z_MEM_POOL_MAGS_DEFINE(name, minsz, maxsz)			\
 	struct k_mem_pool name __in_section(_k_mem_pool, static, name) = { \
 		.base = {						\
 			.buf = _mpool_buf_##name,			\
@@ -4018,7 +4054,8 @@ struct k_mem_pool {
 			.n_levels = Z_MPOOL_LVLS(maxsz, minsz),		\
 			.levels = _mpool_lvls_##name,			\
 			.flags = SYS_MEM_POOL_KERNEL			\
-		} \
+		},							\
+		Z_MEM_POOL_MAGS_INIT(name)				\
 	}
 
 /**
@@ -4080,6 +4117,46 @@ extern void k_mem_pool_free(struct k_mem_block *block);
  */
 extern void k_mem_pool_free_id(struct k_mem_block_id *id);
 
+#if defined(CONFIG_MEM_POOL_CACHE) || defined(__DOXYGEN__)
+/**
+ * @brief Memory pool block cache statistics.
+ */
+struct k_mem_pool_cache_stats {
+	/** Allocations served from the cache */
+	u32_t hits;
+	/** Allocations that fell through to the buddy allocator */
+	u32_t misses;
+	/** Blocks currently held in the cache */
+	u32_t cached;
+};
+
+/**
+ * @brief Get memory pool block cache statistics.
+ *
+ * Sums the counters of all levels and CPUs of the pool's cache.
+ *
+ * @param pool Address of the memory pool.
+ * @param stats Filled with the statistics.
+ *
+ * @return N/A
+ */
+extern void k_mem_pool_cache_stats_get(struct k_mem_pool *pool,
+				       struct k_mem_pool_cache_stats *stats);
+
+/**
+ * @brief Return all cached blocks of a memory pool to the pool.
+ *
+ * Cached blocks cannot be recombined into larger ones, so this is done
+ * automatically when an allocation would otherwise fail, but may also
+ * be called explicitly, e.g. ahead of a large allocation.
+ *
+ * @param pool Address of the memory pool.
+ *
+ * @return N/A
+ */
+extern void k_mem_pool_cache_flush(struct k_mem_pool *pool);
+#endif
+
 /**
  * @}
  */
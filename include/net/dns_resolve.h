@@ -208,6 +208,28 @@ struct dns_resolve_context {
 
 		/** DNS id of this query */
 		u16_t id;
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+		/** Copy of the query name the answer is cached for, empty
+		 * if the name is too long to be cached.
+		 */
+		char name[CONFIG_DNS_RESOLVER_CACHE_MAX_NAME_LEN + 1];
+
+		/** Addresses received so far, cached when the query is done */
+		u8_t addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS]
+			 [sizeof(struct in6_addr)];
+
+		/** Lowest TTL of the records received so far */
+		u32_t ttl;
+
+		/** Number of addresses received so far */
+		u8_t addr_count;
+
+		/** Index of the query this one waits the answer of, -1 if
+		 * this query was sent to the servers.
+		 */
+		s8_t leader;
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
 
 	/** Is this context in use */
@@ -286,7 +308,8 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx,
  * @param type What kind of data the caller wants to get.
  * @param dns_id DNS id is returned to the caller. This is needed if one
  * wishes to cancel the query. This can be set to NULL if there is no need
- * to cancel the query.
+ * to cancel the query. It is set to 0 when the answer came from the cache
+ * and the callback has already been called, as no query is pending then.
  * @param cb Callback to call after the resolving has finished or timeout
  * has happened.
  * @param user_data The user data.
@@ -333,7 +356,8 @@ struct dns_resolve_context *dns_resolve_get_default(void);
  * @param type What kind of data the caller wants to get.
  * @param dns_id DNS id is returned to the caller. This is needed if one
  * wishes to cancel the query. This can be set to NULL if there is no need
- * to cancel the query.
+ * to cancel the query. It is set to 0 when the answer came from the cache
+ * and the callback has already been called, as no query is pending then.
  * @param cb Callback to call after the resolving has finished or timeout
  * has happened.
  * @param user_data The user data.
@@ -374,6 +398,85 @@ static inline int dns_cancel_addr_info(u16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * DNS cache statistics.
+ */
+struct dns_resolve_cache_stats {
+	/** Queries answered from the cache */
+	u32_t hits;
+
+	/** Hits that were negative answers */
+	u32_t negative_hits;
+
+	/** Queries not found in the cache */
+	u32_t misses;
+
+	/** Queries that waited for an identical query in flight */
+	u32_t coalesced;
+};
+
+/**
+ * @typedef dns_resolve_cache_cb_t
+ * @brief Callback used while iterating over the DNS cache.
+ *
+ * @param name Cached name.
+ * @param type Query type of the cached answer.
+ * @param status DNS_EAI_ALLDONE for an answer with addresses,
+ * DNS_EAI_NODATA for a negative answer.
+ * @param addr_count Number of cached addresses.
+ * @param ttl Seconds left before the answer expires.
+ * @param user_data A valid pointer to user data or NULL
+ */
+typedef void (*dns_resolve_cache_cb_t)(const char *name,
+				       enum dns_query_type type,
+				       enum dns_resolve_status status,
+				       int addr_count, u32_t ttl,
+				       void *user_data);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @brief Remove all the answers from the DNS cache.
+ *
+ * @details The cache is shared by all the DNS contexts. Answers are kept
+ * for as long as their TTL allows, negative answers as specified in
+ * RFC 2308.
+ */
+void dns_resolve_cache_flush(void);
+
+/**
+ * @brief Go through all the valid answers of the DNS cache.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ *
+ * @return Number of answers in the cache.
+ */
+int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data);
+
+/**
+ * @brief Get the DNS cache statistics.
+ *
+ * @param stats Statistics are copied here.
+ */
+void dns_resolve_cache_get_stats(struct dns_resolve_cache_stats *stats);
+#else
+static inline void dns_resolve_cache_flush(void)
+{
+}
+
+static inline int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb,
+					    void *user_data)
+{
+	return 0;
+}
+
+static inline void
+dns_resolve_cache_get_stats(struct dns_resolve_cache_stats *stats)
+{
+	(void)memset(stats, 0, sizeof(*stats));
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 /**
  * @}
  */
@@ -118,6 +118,11 @@ enum ethernet_hw_caps {
 
 	/** Link Layer Discovery Protocol supported */
 	ETHERNET_LLDP			= BIT(13),
+
+	/** TCP segmentation offloading supported, the driver accepts TCP
+	 * packets larger than the MTU and splits them itself.
+	 */
+	ETHERNET_HW_TCP_SEGMENTATION	= BIT(14),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -401,6 +401,17 @@ struct mqtt_transport {
 	};
 };
 
+/** @brief QoS 1 or QoS 2 message published and not acknowledged yet. */
+struct mqtt_inflight {
+	/** Message, referencing the topic and payload of the application. */
+	struct mqtt_publish_param param;
+
+	/** Internal. Acknowledgment expected for the message, 0 if the entry
+	 *  is free.
+	 */
+	u8_t ack_type;
+};
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -419,6 +430,18 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	u32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_INFLIGHT_WINDOW) && (CONFIG_MQTT_INFLIGHT_WINDOW > 0)
+	/** Internal. Messages waiting for an acknowledgment. They are kept
+	 *  across reconnections.
+	 */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_WINDOW];
+
+	/** Internal. Last message id given to a message published with
+	 *  message id 0.
+	 */
+	u16_t last_message_id;
+#endif
 };
 
 /**
@@ -526,11 +549,42 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note The fixed and variable headers are sent along with the payload in a
+ *       single transport write, the payload is not copied.
+ *
+ * @note With :option:`CONFIG_MQTT_INFLIGHT_WINDOW`, QoS 1 and QoS 2 messages
+ *       are kept until acknowledged, so their topic and payload shall stay
+ *       valid until @ref MQTT_EVT_PUBACK or @ref MQTT_EVT_PUBCOMP. A message
+ *       id 0 is replaced with a free one, see mqtt_publish_and_get_id().
+ *       -EBUSY is returned when the window is full, and -EALREADY when the
+ *       message id is already in flight.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to publish messages on topics, returning their message id.
+ *
+ * @details Same as mqtt_publish(), with the message id of the message
+ *          returned so that the acknowledgments can be matched. With
+ *          :option:`CONFIG_MQTT_INFLIGHT_WINDOW`, this is the id given to
+ *          a QoS 1 or QoS 2 message published with message id 0.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] param Parameters to be used for the publish message.
+ *                  Shall not be NULL.
+ * @param[out] message_id Message id of the message, set once the message
+ *                        is encoded. May be NULL.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_publish_and_get_id(struct mqtt_client *client,
+			    const struct mqtt_publish_param *param,
+			    u16_t *message_id);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
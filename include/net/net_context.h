@@ -270,6 +270,22 @@ struct net_context {
 	/** TLS context information */
 	struct tls_context *tls;
 #endif /* CONFIG_NET_SOCKETS_SOCKOPT_TLS */
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** Registration of the socket in an epoll instance */
+	struct {
+		/** Node in the instance's list of registered sockets */
+		sys_dnode_t node;
+		/** Node in the instance's list of ready sockets */
+		sys_dnode_t ready_node;
+		/** Owning epoll instance, NULL when not registered */
+		void *ep;
+		/** Events of interest */
+		u32_t events;
+		/** User data reported with the events */
+		u64_t data;
+	} epoll;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -901,6 +917,32 @@ int net_context_sendto_new(struct net_context *context,
 			   void *token,
 			   void *user_data);
 
+/**
+ * @brief Send data gathered from several buffers to a peer.
+ *
+ * @details Works like net_context_sendto_new(), but the data is taken
+ * from the scatter-gather array of @a msghdr and written into a single
+ * network packet. If @a msghdr has no destination address, the one set
+ * by net_context_connect() is used, as with net_context_send_new().
+ * This is similar as BSD sendmsg() function.
+ *
+ * @param context The network context to use.
+ * @param msghdr Data buffers and optional destination address.
+ * @param cb Caller-supplied callback function.
+ * @param timeout Timeout for the connection. Possible values
+ * are K_FOREVER, K_NO_WAIT, >0.
+ * @param token Caller specified value that is passed as is to callback.
+ * @param user_data Caller-supplied user data.
+ *
+ * @return numbers of bytes sent on success, a negative errno otherwise
+ */
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *token,
+			void *user_data);
+
 /**
  * @brief Receive network data from a peer specified by context.
  *
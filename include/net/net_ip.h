@@ -262,6 +262,23 @@ struct sockaddr {
 	char data[NET_SOCKADDR_MAX_SIZE - sizeof(sa_family_t)];
 };
 
+/** Scatter-gather buffer descriptor, as used by sendmsg() and recvmsg(). */
+struct iovec {
+	void  *iov_base; /**< Start of the buffer */
+	size_t iov_len;  /**< Length of the buffer */
+};
+
+/** Message header for sendmsg() and recvmsg(). */
+struct msghdr {
+	void         *msg_name;       /**< Optional peer address */
+	socklen_t     msg_namelen;    /**< Size of the peer address */
+	struct iovec *msg_iov;        /**< Scatter-gather array */
+	size_t        msg_iovlen;     /**< Number of elements in msg_iov */
+	void         *msg_control;    /**< Ancillary data, unsupported */
+	size_t        msg_controllen; /**< Ancillary data length */
+	int           msg_flags;      /**< Flags on received message */
+};
+
 /** @cond INTERNAL_HIDDEN */
 
 struct sockaddr_ptr {
@@ -206,6 +206,19 @@ struct net_pkt {
 	u8_t ipv6_next_hdr;	/* What is the very first next header */
 #endif /* CONFIG_NET_IPV6 */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	u16_t ipv4_fragment_offset;	/* Fragment offset of this packet */
+	u8_t ipv4_reassembled : 1;	/* Reassembled locally, the packet has
+					 * no link layer header.
+					 */
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+	u16_t gso_size;	/* If set, the TCP payload is split at L2 into
+			 * segments of at most this size.
+			 */
+#endif /* CONFIG_NET_TCP_GSO */
+
 #if defined(CONFIG_IEEE802154)
 	u8_t ieee802154_rssi; /* Received Signal Strength Indication */
 	u8_t ieee802154_lqi;  /* Link Quality Indicator */
@@ -589,6 +602,83 @@ static inline void net_pkt_set_ipv6_fragment_id(struct net_pkt *pkt,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline u16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_offset;
+}
+
+static inline void net_pkt_set_ipv4_fragment_offset(struct net_pkt *pkt,
+						    u16_t offset)
+{
+	pkt->ipv4_fragment_offset = offset;
+}
+
+static inline bool net_pkt_ipv4_reassembled(struct net_pkt *pkt)
+{
+	return pkt->ipv4_reassembled;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool reassembled)
+{
+	pkt->ipv4_reassembled = reassembled;
+}
+#else /* CONFIG_NET_IPV4_FRAGMENT */
+static inline u16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_offset(struct net_pkt *pkt,
+						    u16_t offset)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(offset);
+}
+
+static inline bool net_pkt_ipv4_reassembled(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool reassembled)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(reassembled);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+static inline u16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	return pkt->gso_size;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt, u16_t size)
+{
+	pkt->gso_size = size;
+}
+#else /* CONFIG_NET_TCP_GSO */
+static inline u16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt, u16_t size)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(size);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 #if NET_TC_COUNT > 1
 static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 {
@@ -178,6 +178,46 @@ struct net_stats_udp {
 	net_stats_t chkerr;
 };
 
+/**
+ * @brief Connection lookup statistics
+ */
+struct net_stats_conn {
+	/** Number of packets matched to a fully specified connection. */
+	net_stats_t hit;
+
+	/** Number of packets matched to a wildcard (listening) connection. */
+	net_stats_t wildcard;
+
+	/** Number of packets for which no connection was found. */
+	net_stats_t miss;
+
+	/** Total number of connection entries examined by lookups. */
+	net_stats_t chain;
+
+	/** Largest number of entries examined by a single lookup. */
+	net_stats_t chain_max;
+};
+
+/**
+ * @brief IPv4 fragmentation and reassembly statistics
+ */
+struct net_stats_ipv4_frag {
+	/** Number of received IPv4 fragments. */
+	net_stats_t recv;
+
+	/** Number of IPv4 fragments sent. */
+	net_stats_t sent;
+
+	/** Number of received IPv4 fragments that were dropped. */
+	net_stats_t drop;
+
+	/** Number of IPv4 packets successfully reassembled. */
+	net_stats_t reassembled;
+
+	/** Number of reassemblies that timed out or were evicted. */
+	net_stats_t timeout;
+};
+
 /**
  * @brief IPv6 neighbor discovery statistics
  */
@@ -244,6 +284,11 @@ struct net_stats {
 	struct net_stats_ip ipv4;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	/** IPv4 fragmentation statistics */
+	struct net_stats_ipv4_frag ipv4_frag;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 	/** ICMP statistics */
 	struct net_stats_icmp icmp;
@@ -259,6 +304,11 @@ struct net_stats {
 	struct net_stats_udp udp;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+	/** Connection lookup statistics */
+	struct net_stats_conn conn;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_IPV6_ND)
 	/** IPv6 neighbor discovery statistics */
 	struct net_stats_ipv6_nd ipv6_nd;
@@ -329,6 +379,18 @@ struct net_stats_eth_hw_timestamp {
 	net_stats_t tx_hwtstamp_skipped;
 };
 
+/**
+ * @brief Ethernet ARP cache statistics
+ */
+struct net_stats_eth_arp {
+	/** Outgoing packets whose destination was found in the cache */
+	net_stats_t hit;
+	/** Outgoing packets that needed an ARP request */
+	net_stats_t miss;
+	/** Packets dropped because too many were waiting for a reply */
+	net_stats_t pending_dropped;
+};
+
 #ifdef CONFIG_NET_STATISTICS_ETHERNET_VENDOR
 /**
  * @brief Ethernet vendor specific statistics
@@ -352,6 +414,7 @@ struct net_stats_eth {
 	struct net_stats_eth_flow flow_control;
 	struct net_stats_eth_csum csum;
 	struct net_stats_eth_hw_timestamp hw_timestamp;
+	struct net_stats_eth_arp arp;
 	net_stats_t collisions;
 	net_stats_t tx_dropped;
 	net_stats_t tx_timeout_count;
@@ -384,6 +447,8 @@ enum net_request_stats_cmd {
 	NET_REQUEST_STATS_CMD_GET_UDP,
 	NET_REQUEST_STATS_CMD_GET_TCP,
 	NET_REQUEST_STATS_CMD_GET_ETHERNET,
+	NET_REQUEST_STATS_CMD_GET_CONN,
+	NET_REQUEST_STATS_CMD_GET_IPV4_FRAG,
 };
 
 #define NET_REQUEST_STATS_GET_ALL				\
@@ -455,6 +520,20 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP);
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_ETHERNET);
 #endif /* CONFIG_NET_STATISTICS_ETHERNET */
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+#define NET_REQUEST_STATS_GET_CONN				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_CONN)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_CONN);
+#endif /* CONFIG_NET_STATISTICS_CONN */
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+#define NET_REQUEST_STATS_GET_IPV4_FRAG				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_IPV4_FRAG)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV4_FRAG);
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
 
 /**
@@ -56,8 +56,32 @@ typedef struct zsock_fd_set {
 #define ZSOCK_POLLNVAL 0x20
 
 #define ZSOCK_MSG_PEEK 0x02
+#define ZSOCK_MSG_TRUNC 0x20
 #define ZSOCK_MSG_DONTWAIT 0x40
 
+/* Values are compatible with Linux */
+#define ZSOCK_EPOLLIN ZSOCK_POLLIN
+#define ZSOCK_EPOLLOUT ZSOCK_POLLOUT
+#define ZSOCK_EPOLLERR ZSOCK_POLLERR
+#define ZSOCK_EPOLLHUP ZSOCK_POLLHUP
+#define ZSOCK_EPOLLET (1U << 31)
+
+#define ZSOCK_EPOLL_CTL_ADD 1
+#define ZSOCK_EPOLL_CTL_DEL 2
+#define ZSOCK_EPOLL_CTL_MOD 3
+
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	u32_t u32;
+	u64_t u64;
+} zsock_epoll_data_t;
+
+struct zsock_epoll_event {
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
  * respectively". Some software uses numeric values.
@@ -117,6 +141,21 @@ typedef struct zsock_fd_set {
  *    - 1 - server
  */
 #define TLS_DTLS_ROLE 6
+/** Socket option to enable or disable TLS session resumption. It accepts and
+ *  returns an integer:
+ *    - 0 - disabled
+ *    - 1 - enabled
+ *
+ *  When enabled, a TLS client offers the session of its last connection to
+ *  the same hostname, and a TLS server lets its clients resume their
+ *  sessions. Enabled by default if CONFIG_NET_SOCKETS_TLS_SESSION_CACHE is
+ *  set.
+ */
+#define TLS_SESSION_CACHE 7
+
+/* Valid values for TLS_SESSION_CACHE option */
+#define TLS_SESSION_CACHE_DISABLED 0
+#define TLS_SESSION_CACHE_ENABLED 1
 
 /** @} */
 
@@ -170,10 +209,183 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+/** Message vector entry for zsock_sendmmsg() and zsock_recvmmsg() */
+struct zsock_mmsghdr {
+	struct msghdr msg_hdr;	/**< Message to send or receive into */
+	unsigned int msg_len;	/**< Number of bytes sent or received */
+};
+
+/**
+ * @brief Send a message gathered from several buffers
+ *
+ * Sends the buffers of @a msg->msg_iov as a single datagram or as
+ * contiguous stream data, to @a msg->msg_name if set or else to the
+ * connected peer. Ancillary data is not supported. From user mode, at
+ * most CONFIG_NET_SOCKETS_MSG_IOV_MAX buffers can be passed.
+ *
+ * @param sock Socket descriptor
+ * @param msg Message to send
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ *
+ * @return Number of bytes sent, or -1 with errno set.
+ */
+__syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
+				int flags);
+
+/**
+ * @brief Receive a message scattered into several buffers
+ *
+ * Receives one datagram, or the stream data available, into the buffers
+ * of @a msg->msg_iov. For datagram sockets the source address is stored
+ * in @a msg->msg_name if set, and ZSOCK_MSG_TRUNC is set in
+ * @a msg->msg_flags if the datagram did not fit. Ancillary data is not
+ * supported.
+ *
+ * @param sock Socket descriptor
+ * @param msg Message to receive into
+ * @param flags ZSOCK_MSG_DONTWAIT, ZSOCK_MSG_PEEK or 0
+ *
+ * @return Number of bytes received, or -1 with errno set.
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Send several messages with one call
+ *
+ * Equivalent to calling zsock_sendmsg() for each entry of @a msgvec,
+ * storing the number of bytes sent in its msg_len, but the socket is only
+ * looked up once, and from user mode only one system call is made.
+ *
+ * @param sock Socket descriptor
+ * @param msgvec Messages to send
+ * @param vlen Number of entries in @a msgvec
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ *
+ * @return Number of messages sent, which is less than @a vlen if sending
+ *	   a message failed, or -1 with errno set if none could be sent.
+ */
+__syscall int zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive several messages with one call
+ *
+ * Receives up to @a vlen messages as zsock_recvmsg() would. Only the first
+ * message is waited for according to @a flags; the call then returns as
+ * soon as no further message is queued.
+ *
+ * @param sock Socket descriptor
+ * @param msgvec Messages to receive into
+ * @param vlen Number of entries in @a msgvec
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ *
+ * @return Number of messages received, or -1 with errno set if none was.
+ */
+__syscall int zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Received data lent to the application by zsock_recv_zc()
+ *
+ * The data starts at @a data inside fragment @a frag and continues in the
+ * following fragments of the chain, from their beginning. It stays valid
+ * until it is handed back with zsock_recv_zc_release().
+ */
+struct zsock_zc_buf {
+	/** First fragment holding received data */
+	struct net_buf *frag;
+	/** Start of the received data within @a frag */
+	u8_t *data;
+	/** Total length of the received data */
+	size_t len;
+	/** Packet owning the fragments, for internal use */
+	struct net_pkt *pkt;
+};
+
+/**
+ * @brief Receive data without copying it
+ *
+ * Takes the next received datagram, or the rest of the next received TCP
+ * segment, off socket @a sock and lends its network buffers to the caller,
+ * so the data can be parsed in place. For stream sockets, the receive
+ * window is only reopened when the data is released. The lent buffers
+ * come from the network stack's RX pool, so they should be released
+ * promptly.
+ *
+ * This function is only available to kernel threads, and only for
+ * sockets that do not transform the received data (e.g. not TLS).
+ * ZSOCK_MSG_PEEK is not supported.
+ *
+ * @param sock Socket descriptor
+ * @param zc Filled with the lent data on success
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ * @param src_addr Source address of the data, or NULL
+ * @param addrlen Length of @a src_addr buffer, updated with actual length
+ *
+ * @return Number of bytes lent, 0 at end of stream, or -1 with errno set.
+ */
+ssize_t zsock_recv_zc(int sock, struct zsock_zc_buf *zc, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen);
+
+/**
+ * @brief Give back data lent by zsock_recv_zc()
+ *
+ * @param sock Socket descriptor the data was received on
+ * @param zc Lent data, cleared on return
+ */
+void zsock_recv_zc_release(int sock, struct zsock_zc_buf *zc);
+
 __syscall int zsock_fcntl(int sock, int cmd, int flags);
 
 __syscall int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
 
+/**
+ * @brief Create an epoll instance
+ *
+ * An epoll instance keeps a set of sockets and the events of interest on
+ * each across calls to zsock_epoll_wait(). Sockets are queued on the
+ * instance as they become ready, so waiting costs do not grow with the
+ * number of registered sockets, unlike zsock_poll().
+ *
+ * A socket can be registered with at most one epoll instance. Only plain
+ * (non-TLS) sockets are supported.
+ *
+ * @param flags Must be 0
+ *
+ * @return File descriptor of the instance, or -1 with errno set.
+ */
+__syscall int zsock_epoll_create1(int flags);
+
+/**
+ * @brief Add, modify or remove a socket of an epoll instance
+ *
+ * @param epfd Epoll instance
+ * @param op ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_MOD or ZSOCK_EPOLL_CTL_DEL
+ * @param fd Socket
+ * @param event Events of interest, ZSOCK_EPOLLIN and/or ZSOCK_EPOLLOUT,
+ *	  optionally with ZSOCK_EPOLLET for edge-triggered reporting, and the
+ *	  data to report them with. Ignored for ZSOCK_EPOLL_CTL_DEL.
+ *
+ * @return 0 on success, or -1 with errno set.
+ */
+__syscall int zsock_epoll_ctl(int epfd, int op, int fd,
+			      struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for events on the sockets of an epoll instance
+ *
+ * @param epfd Epoll instance
+ * @param events Filled with the ready sockets' events and data
+ * @param maxevents Size of @a events
+ * @param timeout Timeout in milliseconds, 0 to return immediately or -1 to
+ *	  wait forever
+ *
+ * @return Number of entries filled in @a events, 0 on timeout, or -1 with
+ *	   errno set.
+ */
+__syscall int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			       int maxevents, int timeout);
+
 /* select() API is inefficient, and implemented as inefficient wrapper on
  * top of poll(). Avoid select(), use poll directly().
  */
@@ -297,11 +509,55 @@ static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline ssize_t sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	return zsock_sendmsg(sock, msg, flags);
+}
+
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+#define mmsghdr zsock_mmsghdr
+
+static inline int sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
+static inline int recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
 }
 
+#define epoll_event zsock_epoll_event
+#define epoll_data_t zsock_epoll_data_t
+
+static inline int epoll_create1(int flags)
+{
+	return zsock_epoll_create1(flags);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
 static inline int select(int nfds, zsock_fd_set *readfds,
 			 zsock_fd_set *writefds, zsock_fd_set *exceptfds,
 			 struct timeval *timeout)
@@ -410,7 +666,18 @@ static inline int inet_pton(sa_family_t family, const char *src, void *dst)
 #define POLLHUP ZSOCK_POLLHUP
 #define POLLNVAL ZSOCK_POLLNVAL
 
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
 #define MSG_PEEK ZSOCK_MSG_PEEK
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
 
 #define SHUT_RD ZSOCK_SHUT_RD
@@ -29,6 +29,20 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief Non-volatile Storage lookup cache entry
+ *
+ * @param ate_addr Address of the latest allocation table entry of the id,
+ * 0xFFFFFFFE if the id has none, 0xFFFFFFFF if the entry is free
+ * @param id Id of the entry
+ * @param stamp Last use of the entry, to find the least recently used one
+ */
+struct nvs_lookup_entry {
+	u32_t ate_addr;
+	u16_t id;
+	u16_t stamp;
+};
+
 /**
  * @brief Non-volatile Storage File system structure
  *
@@ -42,6 +56,17 @@ extern "C" {
  * @param write_block_size Alignment size
  * @param nvs_lock Mutex
  * @param flash_device Flash Device
+ * @param lookup_cache Addresses of the latest allocation table entries, with
+ * CONFIG_NVS_LOOKUP_CACHE
+ * @param lookup_stamp Counter of the lookup cache uses
+ * @param lookup_complete The lookup cache has all the ids with an allocation
+ * table entry
+ * @param gc_addr Next allocation table entry to collect, with
+ * CONFIG_NVS_GC_INCREMENTAL
+ * @param gc_stop_addr Last allocation table entry to collect
+ * @param gc_reserve Room taken at most by the entries left to collect
+ * @param gc_work Work item running the garbage collection steps, with
+ * CONFIG_NVS_GC_BACKGROUND
  */
 struct nvs_fs {
 	off_t offset;		/* filesystem offset in flash */
@@ -56,6 +81,19 @@ struct nvs_fs {
 
 	struct k_mutex nvs_lock;
 	struct device *flash_device;
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	struct nvs_lookup_entry lookup_cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+	u16_t lookup_stamp;
+	bool lookup_complete;
+#endif
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	u32_t gc_addr;
+	u32_t gc_stop_addr;
+	u32_t gc_reserve;
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	struct k_work gc_work;
+#endif
+#endif
 };
 
 /**
@@ -155,6 +193,21 @@ ssize_t nvs_read(struct nvs_fs *fs, u16_t id, void *data, size_t len);
 ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 		  u16_t cnt);
 
+/**
+ * @brief nvs_gc_step
+ *
+ * Run a step of the incremental garbage collection, collecting
+ * CONFIG_NVS_GC_STEP_ATES allocation table entries of the oldest sector.
+ * Available with CONFIG_NVS_GC_INCREMENTAL. Writes only collect garbage
+ * themselves when the steps did not keep up with them.
+ *
+ * @param fs Pointer to file system
+ * @retval 0 No garbage left to collect
+ * @retval 1 More steps are needed
+ * @retval -ERRNO errno code if error
+ */
+int nvs_gc_step(struct nvs_fs *fs);
+
 /**
  * @brief nvs_calc_free_space
  *
@@ -23,6 +23,11 @@ extern "C" {
 
 /**
  * @brief A structure to represent a ring buffer
+ *
+ * The head index is only written by the consumer and the tail index only
+ * by the producer, and both are published with release/acquire ordering.
+ * A single producer and a single consumer, e.g. an interrupt handler and a
+ * thread, can therefore use a ring buffer concurrently without locking.
  */
 struct ring_buf {
 	u32_t head;	 /**< Index in buf for the head element */
@@ -37,6 +42,12 @@ struct ring_buf {
 		struct ring_buf_misc_byte_mode {
 			u32_t tmp_tail;
 			u32_t tmp_head;
+#ifdef CONFIG_RING_BUFFER_MP
+			atomic_t mp_state; /**< Reservation state of
+					     * concurrent producers, see
+					     * ring_buf_mp_put().
+					     */
+#endif
 		} byte_mode;
 	} misc;
 	u32_t size;   /**< Size of buf in 32-bit chunks */
@@ -184,6 +195,34 @@ static inline int z_ring_buf_custom_space_get(u32_t size, u32_t head,
 	return (size - tail) + head - 1;
 }
 
+/** @brief Read an index published by the other side of a ring buffer.
+ *
+ * @note Function for internal use.
+ *
+ * The load has acquire semantics, so data written before the index was
+ * published with z_ring_buf_idx_set() is visible once the new index is.
+ *
+ * @param idx Address of the head or tail index.
+ *
+ * @return Index value.
+ */
+static inline u32_t z_ring_buf_idx_get(const u32_t *idx)
+{
+	return __atomic_load_n(idx, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Publish a new head or tail index of a ring buffer.
+ *
+ * @note Function for internal use.
+ *
+ * @param idx Address of the head or tail index.
+ * @param val New index value.
+ */
+static inline void z_ring_buf_idx_set(u32_t *idx, u32_t val)
+{
+	__atomic_store_n(idx, val, __ATOMIC_RELEASE);
+}
+
 /**
  * @brief Determine if a ring buffer is empty.
  *
@@ -193,7 +232,8 @@ static inline int z_ring_buf_custom_space_get(u32_t size, u32_t head,
  */
 static inline int ring_buf_is_empty(struct ring_buf *buf)
 {
-	return (buf->head == buf->tail);
+	return (z_ring_buf_idx_get(&buf->head) ==
+		z_ring_buf_idx_get(&buf->tail));
 }
 /** @deprecated Renamed to ring_buf_is_empty. */
 __deprecated static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
@@ -210,7 +250,9 @@ __deprecated static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
  */
 static inline int ring_buf_space_get(struct ring_buf *buf)
 {
-	return z_ring_buf_custom_space_get(buf->size, buf->head, buf->tail);
+	return z_ring_buf_custom_space_get(buf->size,
+					   z_ring_buf_idx_get(&buf->head),
+					   z_ring_buf_idx_get(&buf->tail));
 }
 
 /** @deprecated Renamed to ring_buf_space_get. */
@@ -355,6 +397,34 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size);
  */
 u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size);
 
+#if defined(CONFIG_RING_BUFFER_MP) || defined(__DOXYGEN__)
+/**
+ * @brief Write (copy) data to a ring buffer shared by several producers.
+ *
+ * This routine writes data to a ring buffer @a buf without any locking.
+ * Any number of threads and interrupt handlers may call it concurrently on
+ * the same ring buffer, and a producer preempted in the middle of a write
+ * never blocks the others. The data is written either completely or not
+ * at all, so records written by different producers are never interleaved.
+ *
+ * Data becomes visible to the consumer once every write that started
+ * before it has completed.
+ *
+ * @warning
+ * All writes to a ring buffer used with this routine must go through it;
+ * it cannot be mixed with @ref ring_buf_put or the claim API. The ring
+ * buffer size must be smaller than 2^24 bytes.
+ *
+ * @param buf Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @return @a size if the data was written, or 0 if there was not enough
+ *	   free space.
+ */
+u32_t ring_buf_mp_put(struct ring_buf *buf, const u8_t *data, u32_t size);
+#endif
+
 /**
  * @brief Get address of a valid data in a ring buffer.
  *
@@ -43,19 +43,27 @@ struct _priq_rb {
 void z_priq_rb_add(struct _priq_rb *pq, struct k_thread *thread);
 void z_priq_rb_remove(struct _priq_rb *pq, struct k_thread *thread);
 struct k_thread *z_priq_rb_best(struct _priq_rb *pq);
+bool z_priq_rb_lessthan(struct rbnode *a, struct rbnode *b);
 
 /* Traditional/textbook "multi-queue" structure.  Separate lists for a
  * small number (max 32 here) of fixed priorities.  This corresponds
  * to the original Zephyr scheduler.  RAM requirements are
- * comparatively high, but performance is very fast.  Won't work with
- * features like deadline scheduling which need large priority spaces
- * to represet their requirements.
+ * comparatively high, but performance is very fast.  With deadline
+ * scheduling enabled, each priority level instead gets a small
+ * balanced tree ordered by deadline, so finding the best priority is
+ * still a single bit scan and only threads sharing a priority pay an
+ * O(logN) cost to be sorted among each other.
  */
 struct _priq_mq {
+#ifdef CONFIG_SCHED_DEADLINE
+	struct _priq_rb queues[32];
+#else
 	sys_dlist_t queues[32];
+#endif
 	unsigned int bitmask; /* bit 1<<i set if queues[i] is non-empty */
 };
 
+void z_priq_mq_init_level(struct _priq_mq *pq, int level);
 void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
 void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread);
 struct k_thread *z_priq_mq_best(struct _priq_mq *pq);
@@ -117,7 +117,11 @@ static inline bool z_is_thread_state_set(struct k_thread *thread, u32_t state)
 
 static inline bool z_is_thread_queued(struct k_thread *thread)
 {
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	return thread->base.queued != 0U;
+#else
 	return z_is_thread_state_set(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline void z_mark_thread_as_suspended(struct k_thread *thread)
@@ -158,12 +162,20 @@ static inline void z_reset_thread_states(struct k_thread *thread,
 
 static inline void z_mark_thread_as_queued(struct k_thread *thread)
 {
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	thread->base.queued = 1U;
+#else
 	z_set_thread_states(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline void z_mark_thread_as_not_queued(struct k_thread *thread)
 {
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	thread->base.queued = 0U;
+#else
 	z_reset_thread_states(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline bool z_is_under_prio_ceiling(int prio)
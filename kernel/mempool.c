@@ -48,6 +48,169 @@ int init_static_pools(struct device *unused)
 
 SYS_INIT(init_static_pools, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
+#ifdef CONFIG_MEM_POOL_CACHE
+/* Block size at a level, computed the same way as the allocator does */
+static size_t level_size(struct k_mem_pool *p, int level)
+{
+	size_t sz = _ALIGN4(p->base.max_sz);
+
+	for (int i = 1; i <= level; i++) {
+		sz = _ALIGN4(sz / 4);
+	}
+
+	return sz;
+}
+
+/* The level the allocator would satisfy a request from, or -1 */
+static int alloc_level(struct k_mem_pool *p, size_t size)
+{
+	size_t sz = _ALIGN4(p->base.max_sz);
+	int level = -1;
+
+	for (int i = 0; i < p->base.n_levels && sz >= size; i++) {
+		level = i;
+		sz = _ALIGN4(sz / 4);
+	}
+
+	return level;
+}
+
+static struct k_mem_pool_mag *get_mag(struct k_mem_pool *p, int level,
+				      int cpu)
+{
+	return &p->mags[level * CONFIG_MP_NUM_CPUS + cpu];
+}
+
+/* Pops a cached block of the given level for the current CPU, or
+ * returns NULL and counts a miss.  The thread may migrate between
+ * choosing the magazine and locking it, which only costs locality:
+ * the magazine lock is what makes this correct.
+ */
+static void *cache_get(struct k_mem_pool *p, int level)
+{
+	struct k_mem_pool_mag *mag = get_mag(p, level, _current_cpu->id);
+	k_spinlock_key_t key = k_spin_lock(&mag->lock);
+	void *block = mag->head;
+
+	if (block != NULL) {
+		mag->head = *(void **)block;
+		mag->count--;
+		mag->hits++;
+	} else {
+		mag->misses++;
+	}
+	k_spin_unlock(&mag->lock, key);
+
+	return block;
+}
+
+/* Returns true if the block was taken into the cache */
+static bool cache_put(struct k_mem_pool *p, int level, void *block)
+{
+	struct k_mem_pool_mag *mag = get_mag(p, level, _current_cpu->id);
+	k_spinlock_key_t key;
+	bool ret = false;
+
+	key = k_spin_lock(&mag->lock);
+	if (mag->count < CONFIG_MEM_POOL_CACHE_DEPTH) {
+		*(void **)block = mag->head;
+		mag->head = block;
+		mag->count++;
+		ret = true;
+	}
+	k_spin_unlock(&mag->lock, key);
+
+	return ret;
+}
+
+void k_mem_pool_cache_flush(struct k_mem_pool *p)
+{
+	for (int level = 0; level < p->base.n_levels; level++) {
+		size_t lsz = level_size(p, level);
+
+		for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+			struct k_mem_pool_mag *mag = get_mag(p, level, cpu);
+			k_spinlock_key_t key = k_spin_lock(&mag->lock);
+			void *block = mag->head;
+
+			mag->head = NULL;
+			mag->count = 0U;
+			k_spin_unlock(&mag->lock, key);
+
+			while (block != NULL) {
+				void *next = *(void **)block;
+				u32_t bn = ((u8_t *)block -
+					    (u8_t *)p->base.buf) / lsz;
+
+				z_sys_mem_pool_block_free(&p->base, level, bn);
+				block = next;
+			}
+		}
+	}
+}
+
+void k_mem_pool_cache_stats_get(struct k_mem_pool *p,
+				struct k_mem_pool_cache_stats *stats)
+{
+	*stats = (struct k_mem_pool_cache_stats) {};
+
+	for (int i = 0; i < p->base.n_levels * CONFIG_MP_NUM_CPUS; i++) {
+		stats->hits += p->mags[i].hits;
+		stats->misses += p->mags[i].misses;
+		stats->cached += p->mags[i].count;
+	}
+}
+#endif /* CONFIG_MEM_POOL_CACHE */
+
+static int pool_block_alloc(struct k_mem_pool *p, size_t size,
+			    u32_t *level_p, u32_t *block_p, void **data_p)
+{
+	int ret;
+
+#ifdef CONFIG_MEM_POOL_CACHE
+	int level = alloc_level(p, size);
+
+	if (level >= 0) {
+		void *block = cache_get(p, level);
+
+		if (block != NULL) {
+			*level_p = level;
+			*block_p = ((u8_t *)block - (u8_t *)p->base.buf) /
+				level_size(p, level);
+			*data_p = block;
+			return 0;
+		}
+	}
+#endif
+
+	/* There is a "managed race" in alloc that can fail (albeit in
+	 * a well-defined way, see comments there) with -EAGAIN when
+	 * simultaneous allocations happen.  Retry exactly once before
+	 * sleeping to resolve it.  If we're so contended that it fails
+	 * twice, then we clearly want to block.
+	 */
+	for (int i = 0; i < 2; i++) {
+		ret = z_sys_mem_pool_block_alloc(&p->base, size, level_p,
+						block_p, data_p);
+		if (ret != -EAGAIN) {
+			break;
+		}
+	}
+
+#ifdef CONFIG_MEM_POOL_CACHE
+	/* Blocks sitting in the cache can't be split or recombined,
+	 * give them all back and try once more before failing
+	 */
+	if (ret == -ENOMEM || ret == -EAGAIN) {
+		k_mem_pool_cache_flush(p);
+		ret = z_sys_mem_pool_block_alloc(&p->base, size, level_p,
+						block_p, data_p);
+	}
+#endif
+
+	return ret;
+}
+
 int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
 		     size_t size, s32_t timeout)
 {
@@ -63,21 +226,8 @@ int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
 	while (true) {
 		u32_t level_num, block_num;
 
-		/* There is a "managed race" in alloc that can fail
-		 * (albeit in a well-defined way, see comments there)
-		 * with -EAGAIN when simultaneous allocations happen.
-		 * Retry exactly once before sleeping to resolve it.
-		 * If we're so contended that it fails twice, then we
-		 * clearly want to block.
-		 */
-		for (int i = 0; i < 2; i++) {
-			ret = z_sys_mem_pool_block_alloc(&p->base, size,
-							&level_num, &block_num,
-							&block->data);
-			if (ret != -EAGAIN) {
-				break;
-			}
-		}
+		ret = pool_block_alloc(p, size, &level_num, &block_num,
+				       &block->data);
 
 		if (ret == -EAGAIN) {
 			ret = -ENOMEM;
@@ -111,7 +261,17 @@ void k_mem_pool_free_id(struct k_mem_block_id *id)
 	int need_sched = 0;
 	struct k_mem_pool *p = get_pool(id->pool);
 
+#ifdef CONFIG_MEM_POOL_CACHE
+	/* Waiters still need waking for a cached block, their retry
+	 * will find it (or flush the cache)
+	 */
+	if (!cache_put(p, id->level, (u8_t *)p->base.buf +
+		       id->block * level_size(p, id->level))) {
+		z_sys_mem_pool_block_free(&p->base, id->level, id->block);
+	}
+#else
 	z_sys_mem_pool_block_free(&p->base, id->level, id->block);
+#endif
 
 	/* Wake up anyone blocked on this pool and let them repeat
 	 * their allocation attempts
@@ -52,6 +52,21 @@ static struct k_spinlock sched_spinlock;
 			!__i.key;					\
 			k_spin_unlock(lck, __key), __i.key = 1)
 
+#ifdef CONFIG_SCHED_CPU_RUNQ
+/* One ready queue per CPU, each with its own lock.  A CPU picks its
+ * next thread in next_up() holding only its own queue lock; everything
+ * else takes these nested inside sched_spinlock.  No code ever holds
+ * two of them at once.  A queued thread's base.cpu field names the
+ * queue it is in, and base.queued (not thread_state, which is written
+ * under sched_spinlock) says whether it is in it; both are only
+ * written under that queue's lock.
+ */
+static struct {
+	struct k_spinlock lock;
+	struct _ready_q q;
+} cpu_runq[CONFIG_MP_NUM_CPUS];
+#endif
+
 static inline int is_preempt(struct k_thread *thread)
 {
 #ifdef CONFIG_PREEMPT_ENABLED
@@ -176,6 +191,216 @@ static ALWAYS_INLINE struct k_thread *_priq_dumb_mask_best(sys_dlist_t *pq)
 }
 #endif
 
+#ifdef CONFIG_SCHED_CPU_RUNQ
+static inline bool cpu_allowed(struct k_thread *thread, int cpu)
+{
+#ifdef CONFIG_SCHED_CPU_MASK
+	return (thread->base.cpu_mask & BIT(cpu)) != 0;
+#else
+	return true;
+#endif
+}
+
+static inline bool cpu_is_idle(int cpu)
+{
+	struct k_thread *cur = _kernel.cpus[cpu].current;
+
+	return cur != NULL && is_idle(cur);
+}
+
+/* Picks the ready queue for a thread being made runnable.  _current
+ * always goes back to the local queue.  Otherwise prefer the CPU the
+ * thread last ran on (its cache is likely still warm), unless that CPU
+ * is busy and another allowed one is idle.  Reading the other CPUs'
+ * current thread is racy, but this is only a placement heuristic:
+ * idle CPUs steal whatever they don't get handed.
+ */
+static int runq_target_cpu(struct k_thread *thread)
+{
+	int cpu = thread->base.cpu;
+
+	if (thread == _current) {
+		return _current_cpu->id;
+	}
+
+	if (cpu_allowed(thread, cpu) && cpu_is_idle(cpu)) {
+		return cpu;
+	}
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (cpu_allowed(thread, i) && cpu_is_idle(i)) {
+			return i;
+		}
+	}
+
+	if (cpu_allowed(thread, cpu)) {
+		return cpu;
+	}
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (cpu_allowed(thread, i)) {
+			return i;
+		}
+	}
+
+	return cpu;
+}
+#endif
+
+/* Adds a thread to the ready queue and marks it queued.  Under
+ * CONFIG_SCHED_CPU_RUNQ the queued flag is only ever changed while
+ * holding the lock of the queue in question, as the owning CPU pops
+ * threads out of it without taking sched_spinlock.
+ */
+static ALWAYS_INLINE void runq_add(struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	int cpu = runq_target_cpu(thread);
+
+	LOCKED(&cpu_runq[cpu].lock) {
+		_priq_run_add(&cpu_runq[cpu].q.runq, thread);
+		thread->base.cpu = cpu;
+		z_mark_thread_as_queued(thread);
+	}
+#else
+	_priq_run_add(&_kernel.ready_q.runq, thread);
+	z_mark_thread_as_queued(thread);
+#endif
+}
+
+/* Takes a thread out of the ready queue, returns false if it was not
+ * in it (only possible under CONFIG_SCHED_CPU_RUNQ, see below).
+ */
+static ALWAYS_INLINE bool runq_remove(struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	bool moved, removed = false;
+
+	/* A CPU may steal the thread and requeue it on its own queue
+	 * holding only the queue locks, so base.cpu can change until
+	 * the lock of the queue it names is held.  Retry until it
+	 * still names the same queue under that lock; the owning CPU
+	 * may also have dequeued it to run since the caller looked.
+	 */
+	do {
+		int cpu = thread->base.cpu;
+
+		moved = false;
+		LOCKED(&cpu_runq[cpu].lock) {
+			if (thread->base.cpu != cpu) {
+				moved = true;
+			} else if (z_is_thread_queued(thread)) {
+				_priq_run_remove(&cpu_runq[cpu].q.runq, thread);
+				z_mark_thread_as_not_queued(thread);
+				removed = true;
+			}
+		}
+	} while (moved);
+
+	return removed;
+#else
+	_priq_run_remove(&_kernel.ready_q.runq, thread);
+	z_mark_thread_as_not_queued(thread);
+
+	return true;
+#endif
+}
+
+#ifdef CONFIG_SCHED_CPU_RUNQ
+/* Called by a CPU that has nothing to run: takes the best thread this
+ * CPU is allowed to run out of the first non-empty remote queue,
+ * starting with the next CPU up so stealing spreads out.
+ */
+static struct k_thread *steal_thread(void)
+{
+	for (int i = 1; i < CONFIG_MP_NUM_CPUS; i++) {
+		int cpu = (_current_cpu->id + i) % CONFIG_MP_NUM_CPUS;
+		struct k_thread *th = NULL;
+
+		LOCKED(&cpu_runq[cpu].lock) {
+			th = _priq_run_best(&cpu_runq[cpu].q.runq);
+			if (th != NULL) {
+				_priq_run_remove(&cpu_runq[cpu].q.runq, th);
+				z_mark_thread_as_not_queued(th);
+			}
+		}
+
+		if (th != NULL) {
+			return th;
+		}
+	}
+
+	return NULL;
+}
+
+/* The lock to hold around next_up() */
+#define NEXT_UP_LOCK (&cpu_runq[_current_cpu->id].lock)
+
+/* Per-CPU variant of the SMP next_up() below, called with only the
+ * local queue lock held instead of sched_spinlock.  Note that _current
+ * is always queued (if at all) on the local queue, so a CPU only
+ * needs to look elsewhere when _current can't run and the local queue
+ * is empty.  The local lock is dropped while stealing so that two
+ * idle CPUs stealing from each other can't deadlock.
+ *
+ * This only writes base.queued and base.cpu, never thread_state.  It
+ * does read thread_state to decide whether _current goes back into
+ * the queue, which another CPU may be changing: see
+ * z_remove_thread_from_ready_q() for why that is safe.
+ */
+static struct k_thread *next_up(void)
+{
+	struct _ready_q *rq = &cpu_runq[_current_cpu->id].q;
+	int queued = z_is_thread_queued(_current);
+	int active = !z_is_thread_prevented_from_running(_current);
+	struct k_thread *th = _priq_run_best(&rq->runq);
+
+	if (th == NULL && !active) {
+		k_spin_release(NEXT_UP_LOCK);
+		th = steal_thread();
+		(void)k_spin_lock(NEXT_UP_LOCK);
+
+		/* Something may have landed locally meanwhile, it
+		 * will be picked up at the next reschedule
+		 */
+	}
+
+	if (th == NULL) {
+		th = _current_cpu->idle_thread;
+	}
+
+	if (active) {
+		if (!queued &&
+		    !z_is_t1_higher_prio_than_t2(th, _current)) {
+			th = _current;
+		}
+
+		if (!should_preempt(th, _current_cpu->swap_ok)) {
+			th = _current;
+		}
+	}
+
+	/* Put _current back into the local queue */
+	if (th != _current && active && !is_idle(_current) && !queued) {
+		_priq_run_add(&rq->runq, _current);
+		_current->base.cpu = _current_cpu->id;
+		z_mark_thread_as_queued(_current);
+	}
+
+	/* Take the new _current out of the queue (a stolen thread
+	 * has been already)
+	 */
+	if (z_is_thread_queued(th)) {
+		_priq_run_remove(&rq->runq, th);
+	}
+	z_mark_thread_as_not_queued(th);
+	th->base.cpu = _current_cpu->id;
+
+	return th;
+}
+#else
+#define NEXT_UP_LOCK (&sched_spinlock)
+
 static ALWAYS_INLINE struct k_thread *next_up(void)
 {
 #ifndef CONFIG_SMP
@@ -234,6 +459,7 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	return th;
 #endif
 }
+#endif /* CONFIG_SCHED_CPU_RUNQ */
 
 #ifdef CONFIG_TIMESLICING
 
@@ -331,8 +557,7 @@ static void update_cache(int preempt_ok)
 void z_add_thread_to_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
+		runq_add(thread);
 		update_cache(0);
 	}
 }
@@ -340,28 +565,41 @@ void z_add_thread_to_ready_q(struct k_thread *thread)
 void z_move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
-		_priq_run_remove(&_kernel.ready_q.runq, thread);
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
+		runq_remove(thread);
+		runq_add(thread);
 		update_cache(thread == _current);
 	}
 }
 
+/* Under CONFIG_SCHED_CPU_RUNQ, the CPU running a thread may put it
+ * back into its ready queue in next_up() holding only that queue's
+ * lock, if thread_state does not prevent it from running.  So callers
+ * stopping a thread set the state bit that prevents it from running
+ * first, then call this: either next_up() sees the bit under the queue
+ * lock, or it queued the thread before and this takes it out again.
+ * For the same reason the queued flag is only checked under the queue
+ * lock, in runq_remove().
+ */
 void z_remove_thread_from_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
+#ifdef CONFIG_SCHED_CPU_RUNQ
+		if (runq_remove(thread)) {
+			update_cache(thread == _current);
+		}
+#else
 		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-			z_mark_thread_as_not_queued(thread);
+			runq_remove(thread);
 			update_cache(thread == _current);
 		}
+#endif
 	}
 }
 
 static void pend(struct k_thread *thread, _wait_q_t *wait_q, s32_t timeout)
 {
-	z_remove_thread_from_ready_q(thread);
 	z_mark_thread_as_pending(thread);
+	z_remove_thread_from_ready_q(thread);
 
 	if (wait_q != NULL) {
 		thread->base.pended_on = wait_q;
@@ -479,9 +717,9 @@ void z_thread_priority_set(struct k_thread *thread, int prio)
 		need_sched = z_is_thread_ready(thread);
 
 		if (need_sched) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+			runq_remove(thread);
 			thread->base.prio = prio;
-			_priq_run_add(&_kernel.ready_q.runq, thread);
+			runq_add(thread);
 			update_cache(1);
 		} else {
 			thread->base.prio = prio;
@@ -554,7 +792,7 @@ struct k_thread *z_get_next_ready_thread(void)
 {
 	struct k_thread *ret = 0;
 
-	LOCKED(&sched_spinlock) {
+	LOCKED(NEXT_UP_LOCK) {
 		ret = next_up();
 	}
 
@@ -568,7 +806,7 @@ void *z_get_next_switch_handle(void *interrupted)
 	_current->switch_handle = interrupted;
 
 #ifdef CONFIG_SMP
-	LOCKED(&sched_spinlock) {
+	LOCKED(NEXT_UP_LOCK) {
 		struct k_thread *th = next_up();
 
 		if (_current != th) {
@@ -715,11 +953,28 @@ struct k_thread *z_priq_rb_best(struct _priq_rb *pq)
 # endif
 #endif
 
+void z_priq_mq_init_level(struct _priq_mq *pq, int level)
+{
+#ifdef CONFIG_SCHED_DEADLINE
+	pq->queues[level] = (struct _priq_rb) {
+		.tree = {
+			.lessthan_fn = z_priq_rb_lessthan,
+		}
+	};
+#else
+	sys_dlist_init(&pq->queues[level]);
+#endif
+}
+
 ALWAYS_INLINE void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread)
 {
 	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
 
+#ifdef CONFIG_SCHED_DEADLINE
+	z_priq_rb_add(&pq->queues[priority_bit], thread);
+#else
 	sys_dlist_append(&pq->queues[priority_bit], &thread->base.qnode_dlist);
+#endif
 	pq->bitmask |= (1 << priority_bit);
 }
 
@@ -733,10 +988,17 @@ ALWAYS_INLINE void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread
 #endif
 	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
 
+#ifdef CONFIG_SCHED_DEADLINE
+	z_priq_rb_remove(&pq->queues[priority_bit], thread);
+	if (pq->queues[priority_bit].tree.root == NULL) {
+		pq->bitmask &= ~(1 << priority_bit);
+	}
+#else
 	sys_dlist_remove(&thread->base.qnode_dlist);
 	if (sys_dlist_is_empty(&pq->queues[priority_bit])) {
 		pq->bitmask &= ~(1 << priority_bit);
 	}
+#endif
 }
 
 struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
@@ -745,6 +1007,9 @@ struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
 		return NULL;
 	}
 
+#ifdef CONFIG_SCHED_DEADLINE
+	return z_priq_rb_best(&pq->queues[__builtin_ctz(pq->bitmask)]);
+#else
 	struct k_thread *t = NULL;
 	sys_dlist_t *l = &pq->queues[__builtin_ctz(pq->bitmask)];
 	sys_dnode_t *n = sys_dlist_peek_head(l);
@@ -753,6 +1018,7 @@ struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
 		t = CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
 	}
 	return t;
+#endif
 }
 
 int z_unpend_all(_wait_q_t *wait_q)
@@ -769,14 +1035,14 @@ int z_unpend_all(_wait_q_t *wait_q)
 	return need_sched;
 }
 
-void z_sched_init(void)
+static void init_ready_q(struct _ready_q *rq)
 {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+	sys_dlist_init(&rq->runq);
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
+	rq->runq = (struct _priq_rb) {
 		.tree = {
 			.lessthan_fn = z_priq_rb_lessthan,
 		}
@@ -784,9 +1050,20 @@ void z_sched_init(void)
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
+	for (int i = 0; i < ARRAY_SIZE(rq->runq.queues); i++) {
+		z_priq_mq_init_level(&rq->runq, i);
+	}
+#endif
+}
+
+void z_sched_init(void)
+{
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		init_ready_q(&cpu_runq[i].q);
 	}
+#else
+	init_ready_q(&_kernel.ready_q);
 #endif
 
 #ifdef CONFIG_TIMESLICING
@@ -843,9 +1120,8 @@ void z_impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 
 	LOCKED(&sched_spinlock) {
 		th->base.prio_deadline = k_cycle_get_32() + deadline;
-		if (z_is_thread_queued(th)) {
-			_priq_run_remove(&_kernel.ready_q.runq, th);
-			_priq_run_add(&_kernel.ready_q.runq, th);
+		if (z_is_thread_queued(th) && runq_remove(th)) {
+			runq_add(th);
 		}
 	}
 }
@@ -872,8 +1148,8 @@ void z_impl_k_yield(void)
 
 	if (!is_idle(_current)) {
 		LOCKED(&sched_spinlock) {
-			_priq_run_remove(&_kernel.ready_q.runq, _current);
-			_priq_run_add(&_kernel.ready_q.runq, _current);
+			runq_remove(_current);
+			runq_add(_current);
 			update_cache(1);
 		}
 	}
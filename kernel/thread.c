@@ -530,11 +530,14 @@ Z_SYSCALL_HANDLER(k_thread_create,
 
 void z_thread_single_suspend(struct k_thread *thread)
 {
-	if (z_is_thread_ready(thread)) {
-		z_remove_thread_from_ready_q(thread);
-	}
+	bool ready = z_is_thread_ready(thread);
 
+	/* Suspended first, see z_remove_thread_from_ready_q() */
 	z_mark_thread_as_suspended(thread);
+
+	if (ready) {
+		z_remove_thread_from_ready_q(thread);
+	}
 }
 
 void z_impl_k_thread_suspend(struct k_thread *thread)
@@ -582,7 +585,12 @@ void z_thread_single_abort(struct k_thread *thread)
 		thread->fn_abort();
 	}
 
-	if (z_is_thread_ready(thread)) {
+	bool ready = z_is_thread_ready(thread);
+
+	/* Dead first, see z_remove_thread_from_ready_q() */
+	thread->base.thread_state |= _THREAD_DEAD;
+
+	if (ready) {
 		z_remove_thread_from_ready_q(thread);
 	} else {
 		if (z_is_thread_pending(thread)) {
@@ -593,8 +601,6 @@ void z_thread_single_abort(struct k_thread *thread)
 		}
 	}
 
-	thread->base.thread_state |= _THREAD_DEAD;
-
 	sys_trace_thread_abort(thread);
 
 #ifdef CONFIG_USERSPACE
@@ -684,6 +690,10 @@ void z_init_thread_base(struct _thread_base *thread_base, int priority,
 
 	thread_base->sched_locked = 0;
 
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	thread_base->queued = 0U;
+#endif
+
 	/* swap_data does not need to be initialized */
 
 	z_init_thread_timeout(thread_base);
@@ -17,8 +17,6 @@
 
 static u64_t curr_tick;
 
-static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
-
 static struct k_spinlock timeout_lock;
 
 static bool can_wait_forever;
@@ -30,6 +28,190 @@ static int announce_remaining;
 int z_clock_hw_cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
 #endif
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+
+/* Hierarchical timing wheel.  Level N has WHEEL_SLOTS slots, each
+ * covering WHEEL_SLOTS^N ticks.  A timeout lives at the level of the
+ * highest bit group in which its absolute expiry differs from
+ * curr_tick, in the slot indexed by that group of expiry bits.  That
+ * slot's start tick is therefore always in the future, and when
+ * curr_tick reaches it the slot contents are reinserted ("cascaded")
+ * at a lower level.  Timeouts differing from curr_tick above the
+ * top level (which only happens when the carry from a nearby expiry
+ * crosses a WHEEL_SPAN boundary) sit on an overflow list that is
+ * cascaded at that boundary.  The dticks field of a pending timeout
+ * holds the low 32 bits of its absolute expiry tick.
+ *
+ * Slot bits in the per-level bitmask may be left set after a
+ * cancellation empties the slot, they get cleaned up lazily by
+ * wheel_next().
+ */
+#define WHEEL_BITS CONFIG_TIMEOUT_WHEEL_SLOT_BITS
+#define WHEEL_SLOTS BIT(WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/* Enough levels to span the 32 bit range of a timeout */
+#define WHEEL_LEVELS ((32 + WHEEL_BITS - 1) / WHEEL_BITS)
+#define WHEEL_SPAN_BITS (WHEEL_LEVELS * WHEEL_BITS)
+
+static struct {
+	u32_t bitmask;
+	sys_dlist_t slots[WHEEL_SLOTS];
+} wheel[WHEEL_LEVELS];
+
+static sys_dlist_t wheel_overflow = SYS_DLIST_STATIC_INIT(&wheel_overflow);
+
+/* Timeouts due at curr_tick, waiting for their callbacks */
+static sys_dlist_t wheel_expired = SYS_DLIST_STATIC_INIT(&wheel_expired);
+
+static u64_t expiry(struct _timeout *t)
+{
+	return curr_tick + (u32_t)((u32_t)t->dticks - (u32_t)curr_tick);
+}
+
+static void wheel_insert(struct _timeout *t)
+{
+	u64_t when = expiry(t);
+	u64_t diff = when ^ curr_tick;
+	int lvl, slot;
+
+	if (diff == 0U) {
+		sys_dlist_append(&wheel_expired, &t->node);
+		return;
+	}
+
+	lvl = (63 - __builtin_clzll(diff)) / WHEEL_BITS;
+	if (lvl >= WHEEL_LEVELS) {
+		sys_dlist_append(&wheel_overflow, &t->node);
+		return;
+	}
+
+	slot = (when >> (lvl * WHEEL_BITS)) & WHEEL_MASK;
+
+	/* A clear bit means the slot head was never used or was
+	 * drained, either way it's safe to (re)initialize it here
+	 */
+	if ((wheel[lvl].bitmask & BIT(slot)) == 0U) {
+		sys_dlist_init(&wheel[lvl].slots[slot]);
+		wheel[lvl].bitmask |= BIT(slot);
+	}
+	sys_dlist_append(&wheel[lvl].slots[slot], &t->node);
+}
+
+/* Computes the start tick of the earliest non-empty slot, which is a
+ * lower bound on (and at level zero equal to) the next expiry.
+ * Everything at level N expires before anything at level N+1, so
+ * only the lowest occupied level needs to be examined.
+ */
+static bool wheel_next(u64_t *tick)
+{
+	for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		u32_t *mask = &wheel[lvl].bitmask;
+
+		while (*mask != 0U) {
+			int slot = __builtin_ctz(*mask);
+			int shift = lvl * WHEEL_BITS;
+
+			if (!sys_dlist_is_empty(&wheel[lvl].slots[slot])) {
+				*tick = ((curr_tick >> (shift + WHEEL_BITS))
+					 << (shift + WHEEL_BITS))
+					| ((u64_t)slot << shift);
+				return true;
+			}
+			*mask &= ~BIT(slot);
+		}
+	}
+
+	if (!sys_dlist_is_empty(&wheel_overflow)) {
+		*tick = ((curr_tick >> WHEEL_SPAN_BITS) + 1) << WHEEL_SPAN_BITS;
+		return true;
+	}
+
+	return false;
+}
+
+/* Cascades every slot that starts at curr_tick, from the top level
+ * down, leaving the timeouts due now on wheel_expired
+ */
+static void wheel_advance(void)
+{
+	sys_dnode_t *n;
+
+	/* Nothing on the overflow list can overflow again once
+	 * curr_tick has reached the boundary, its expiry is less than
+	 * one WHEEL_SPAN away.
+	 */
+	if ((curr_tick & (((u64_t)1 << WHEEL_SPAN_BITS) - 1)) == 0U) {
+		while ((n = sys_dlist_get(&wheel_overflow)) != NULL) {
+			wheel_insert(CONTAINER_OF(n, struct _timeout, node));
+		}
+	}
+
+	for (int lvl = WHEEL_LEVELS - 1; lvl >= 0; lvl--) {
+		int slot = (curr_tick >> (lvl * WHEEL_BITS)) & WHEEL_MASK;
+
+		if ((wheel[lvl].bitmask & BIT(slot)) == 0U) {
+			continue;
+		}
+
+		wheel[lvl].bitmask &= ~BIT(slot);
+		while ((n = sys_dlist_get(&wheel[lvl].slots[slot])) != NULL) {
+			wheel_insert(CONTAINER_OF(n, struct _timeout, node));
+		}
+	}
+}
+
+static void insert_timeout(struct _timeout *to, s32_t dticks)
+{
+	to->dticks = (s32_t)(u32_t)(curr_tick + dticks);
+	wheel_insert(to);
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	sys_dlist_remove(&t->node);
+}
+
+static bool first_dticks(s32_t *dticks)
+{
+	u64_t next;
+
+	if (!wheel_next(&next)) {
+		return false;
+	}
+
+	*dticks = MIN(next - curr_tick, INT_MAX);
+	return true;
+}
+
+static s32_t timeout_dticks(struct _timeout *t)
+{
+	return expiry(t) - curr_tick;
+}
+
+static struct _timeout *pop_expired(void)
+{
+	u64_t next;
+
+	while (sys_dlist_is_empty(&wheel_expired)) {
+		if (!wheel_next(&next) ||
+		    next - curr_tick > announce_remaining) {
+			return NULL;
+		}
+
+		announce_remaining -= next - curr_tick;
+		curr_tick = next;
+		wheel_advance();
+	}
+
+	return CONTAINER_OF(sys_dlist_get(&wheel_expired),
+			    struct _timeout, node);
+}
+
+#else /* !CONFIG_TIMEOUT_WHEEL */
+
+static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -44,6 +226,27 @@ static struct _timeout *next(struct _timeout *t)
 	return n == NULL ? NULL : CONTAINER_OF(n, struct _timeout, node);
 }
 
+static void insert_timeout(struct _timeout *to, s32_t dticks)
+{
+	struct _timeout *t;
+
+	to->dticks = dticks;
+	for (t = first(); t != NULL; t = next(t)) {
+		__ASSERT(t->dticks >= 0, "");
+
+		if (t->dticks > to->dticks) {
+			t->dticks -= to->dticks;
+			sys_dlist_insert(&t->node, &to->node);
+			break;
+		}
+		to->dticks -= t->dticks;
+	}
+
+	if (t == NULL) {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+}
+
 static void remove_timeout(struct _timeout *t)
 {
 	if (next(t) != NULL) {
@@ -53,6 +256,50 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
+static bool first_dticks(s32_t *dticks)
+{
+	struct _timeout *to = first();
+
+	if (to == NULL) {
+		return false;
+	}
+
+	*dticks = to->dticks;
+	return true;
+}
+
+static s32_t timeout_dticks(struct _timeout *timeout)
+{
+	s32_t ticks = 0;
+
+	for (struct _timeout *t = first(); t != NULL; t = next(t)) {
+		ticks += t->dticks;
+		if (timeout == t) {
+			break;
+		}
+	}
+
+	return ticks;
+}
+
+static struct _timeout *pop_expired(void)
+{
+	struct _timeout *t = first();
+
+	if (t == NULL || t->dticks > announce_remaining) {
+		return NULL;
+	}
+
+	curr_tick += t->dticks;
+	announce_remaining -= t->dticks;
+	t->dticks = 0;
+	remove_timeout(t);
+
+	return t;
+}
+
+#endif /* CONFIG_TIMEOUT_WHEEL */
+
 static s32_t elapsed(void)
 {
 	return announce_remaining == 0 ? z_clock_elapsed() : 0;
@@ -61,8 +308,8 @@ static s32_t elapsed(void)
 static s32_t next_timeout(void)
 {
 	int maxw = can_wait_forever ? K_FOREVER : INT_MAX;
-	struct _timeout *to = first();
-	s32_t ret = to == NULL ? maxw : MAX(0, to->dticks - elapsed());
+	s32_t dticks;
+	s32_t ret = first_dticks(&dticks) ? MAX(0, dticks - elapsed()) : maxw;
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -79,25 +326,12 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks)
 	ticks = MAX(1, ticks);
 
 	LOCKED(&timeout_lock) {
-		struct _timeout *t;
-
-		to->dticks = ticks + elapsed();
-		for (t = first(); t != NULL; t = next(t)) {
-			__ASSERT(t->dticks >= 0, "");
-
-			if (t->dticks > to->dticks) {
-				t->dticks -= to->dticks;
-				sys_dlist_insert(&t->node, &to->node);
-				break;
-			}
-			to->dticks -= t->dticks;
-		}
+		s32_t prev, curr;
+		bool had_first = first_dticks(&prev);
 
-		if (t == NULL) {
-			sys_dlist_append(&timeout_list, &to->node);
-		}
+		insert_timeout(to, ticks + elapsed());
 
-		if (to == first()) {
+		if (first_dticks(&curr) && (!had_first || curr < prev)) {
 			z_clock_set_timeout(next_timeout(), false);
 		}
 	}
@@ -126,12 +360,7 @@ s32_t z_timeout_remaining(struct _timeout *timeout)
 	}
 
 	LOCKED(&timeout_lock) {
-		for (struct _timeout *t = first(); t != NULL; t = next(t)) {
-			ticks += t->dticks;
-			if (timeout == t) {
-				break;
-			}
-		}
+		ticks = timeout_dticks(timeout);
 	}
 
 	return ticks - elapsed();
@@ -174,25 +403,21 @@ void z_clock_announce(s32_t ticks)
 
 	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
 
-	announce_remaining = ticks;
+	struct _timeout *t;
 
-	while (first() != NULL && first()->dticks <= announce_remaining) {
-		struct _timeout *t = first();
-		int dt = t->dticks;
-
-		curr_tick += dt;
-		announce_remaining -= dt;
-		t->dticks = 0;
-		remove_timeout(t);
+	announce_remaining = ticks;
 
+	while ((t = pop_expired()) != NULL) {
 		k_spin_unlock(&timeout_lock, key);
 		t->fn(t);
 		key = k_spin_lock(&timeout_lock);
 	}
 
+#ifndef CONFIG_TIMEOUT_WHEEL
 	if (first() != NULL) {
 		first()->dticks -= announce_remaining;
 	}
+#endif
 
 	curr_tick += announce_remaining;
 	announce_remaining = 0;
@@ -39,13 +39,15 @@ int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
 				index = (i + buf->tail + 1) & buf->mask;
 				buf->buf.buf32[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) & buf->mask;
+			z_ring_buf_idx_set(&buf->tail,
+					   (buf->tail + size32 + 1) & buf->mask);
 		} else {
 			for (i = 0U; i < size32; ++i) {
 				index = (i + buf->tail + 1) % buf->size;
 				buf->buf.buf32[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) % buf->size;
+			z_ring_buf_idx_set(&buf->tail,
+					   (buf->tail + size32 + 1) % buf->size);
 		}
 		rc = 0U;
 	} else {
@@ -82,13 +84,15 @@ int ring_buf_item_get(struct ring_buf *buf, u16_t *type, u8_t *value,
 			index = (i + buf->head + 1) & buf->mask;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) & buf->mask;
+		z_ring_buf_idx_set(&buf->head,
+				   (buf->head + header->length + 1) & buf->mask);
 	} else {
 		for (i = 0U; i < header->length; ++i) {
 			index = (i + buf->head + 1) % buf->size;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) % buf->size;
+		z_ring_buf_idx_set(&buf->head,
+				   (buf->head + header->length + 1) % buf->size);
 	}
 
 	return 0;
@@ -110,7 +114,8 @@ u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 {
 	u32_t space, trail_size, allocated;
 
-	space = z_ring_buf_custom_space_get(buf->size, buf->head,
+	space = z_ring_buf_custom_space_get(buf->size,
+					    z_ring_buf_idx_get(&buf->head),
 					    buf->misc.byte_mode.tmp_tail);
 
 	/* Limit requested size to available size. */
@@ -133,8 +138,8 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->tail = wrap(buf->tail + size, buf->size);
-	buf->misc.byte_mode.tmp_tail = buf->tail;
+	buf->misc.byte_mode.tmp_tail = wrap(buf->tail + size, buf->size);
+	z_ring_buf_idx_set(&buf->tail, buf->misc.byte_mode.tmp_tail);
 
 	return 0;
 }
@@ -158,6 +163,95 @@ u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size)
 	return total_size;
 }
 
+#ifdef CONFIG_RING_BUFFER_MP
+/*
+ * Producers sharing a ring buffer coordinate through a single atomic word:
+ * the low bits hold the reservation index (the end of the last reserved
+ * region), the high bits count producers still copying into their region,
+ * and one bit marks the producer currently publishing the tail. The tail
+ * may only be moved up to the reservation index when no copy is in
+ * flight, and only the publisher writes it, so it never moves backwards.
+ */
+#define MP_POS_MASK (BIT(24) - 1)
+#define MP_PUBLISH BIT(24)
+#define MP_BUSY_ONE BIT(25)
+#define MP_BUSY_MASK (~(MP_POS_MASK | MP_PUBLISH))
+
+static void mp_publish(struct ring_buf *buf, u32_t state)
+{
+	atomic_t *mp = &buf->misc.byte_mode.mp_state;
+	u32_t pos, old, new;
+
+	do {
+		pos = state & MP_POS_MASK;
+		z_ring_buf_idx_set(&buf->tail, pos);
+
+		/* Writes that completed while we were publishing did not
+		 * publish themselves, so keep going until none are left.
+		 */
+		do {
+			old = atomic_get(mp);
+			new = old & ~MP_PUBLISH;
+			if (((old & MP_BUSY_MASK) == 0U) &&
+			    ((old & MP_POS_MASK) != pos)) {
+				new = old;
+			}
+		} while ((new != old) && !atomic_cas(mp, old, new));
+
+		state = new;
+	} while ((state & MP_PUBLISH) != 0U);
+}
+
+u32_t ring_buf_mp_put(struct ring_buf *buf, const u8_t *data, u32_t size)
+{
+	atomic_t *mp = &buf->misc.byte_mode.mp_state;
+	u32_t old, new, start, trail;
+
+	__ASSERT(buf->size <= MP_POS_MASK, "Ring buffer too large");
+
+	if (size == 0U) {
+		return 0;
+	}
+
+	/* Reserve [start, start + size) and register as in flight. */
+	do {
+		old = atomic_get(mp);
+		start = old & MP_POS_MASK;
+		if (z_ring_buf_custom_space_get(buf->size,
+						z_ring_buf_idx_get(&buf->head),
+						start) < size) {
+			return 0;
+		}
+
+		new = ((old & ~MP_POS_MASK) + MP_BUSY_ONE) |
+		      wrap(start + size, buf->size);
+	} while (!atomic_cas(mp, old, new));
+
+	trail = buf->size - start;
+	memcpy(&buf->buf.buf8[start], data, MIN(size, trail));
+	if (size > trail) {
+		memcpy(buf->buf.buf8, data + trail, size - trail);
+	}
+
+	/* The last producer to finish publishes everything reserved so
+	 * far, unless another one is already publishing.
+	 */
+	do {
+		old = atomic_get(mp);
+		new = old - MP_BUSY_ONE;
+		if ((new & (MP_BUSY_MASK | MP_PUBLISH)) == 0U) {
+			new |= MP_PUBLISH;
+		}
+	} while (!atomic_cas(mp, old, new));
+
+	if (((new & MP_BUSY_MASK) == 0U) && ((old & MP_PUBLISH) == 0U)) {
+		mp_publish(buf, new);
+	}
+
+	return size;
+}
+#endif /* CONFIG_RING_BUFFER_MP */
+
 u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 {
 	u32_t space, granted_size, trail_size;
@@ -165,7 +259,7 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 	space = (buf->size - 1) -
 		z_ring_buf_custom_space_get(buf->size,
 					    buf->misc.byte_mode.tmp_head,
-					    buf->tail);
+					    z_ring_buf_idx_get(&buf->tail));
 	trail_size = buf->size - buf->misc.byte_mode.tmp_head;
 
 	/* Limit requested size to available size. */
@@ -189,8 +283,8 @@ int ring_buf_get_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->head = wrap(buf->head + size, buf->size);
-	buf->misc.byte_mode.tmp_head = buf->head;
+	buf->misc.byte_mode.tmp_head = wrap(buf->head + size, buf->size);
+	z_ring_buf_idx_set(&buf->head, buf->misc.byte_mode.tmp_head);
 
 	return 0;
 }
@@ -18,9 +18,25 @@
 
 static struct device *flash_dev;
 
+#ifdef CONFIG_DISK_FLASH_WRITE_BACK
+/* an erase block held in RAM, written to flash on sync or eviction */
+struct block_cache {
+	off_t addr;	/* erase block address, -1 if the slot is free */
+	u32_t used;	/* cache_clock at the last access */
+	bool dirty;
+	u8_t data[CONFIG_DISK_ERASE_BLOCK_SIZE];
+};
+
+static struct block_cache cache[CONFIG_DISK_FLASH_CACHE_BLOCKS];
+static u32_t cache_clock;
+
+/* end of the last read, a read starting there is sequential */
+static off_t next_read_addr = -1;
+#else
 /* flash read-copy-erase-write operation */
 static u8_t read_copy_buf[CONFIG_DISK_ERASE_BLOCK_SIZE];
 static u8_t *fs_buff = read_copy_buf;
+#endif
 
 /* calculate number of blocks required for a given size */
 #define GET_NUM_BLOCK(total_size, block_size) \
@@ -61,19 +77,21 @@ static int disk_flash_access_init(struct disk_info *disk)
 		return -ENODEV;
 	}
 
+#ifdef CONFIG_DISK_FLASH_WRITE_BACK
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		cache[i].addr = -1;
+	}
+#endif
+
 	return 0;
 }
 
-static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
-				u32_t start_sector, u32_t sector_count)
+/* read in chunks of at most CONFIG_DISK_FLASH_MAX_RW_SIZE */
+static int flash_read_chunks(off_t fl_addr, u8_t *buff, u32_t remaining)
 {
-	off_t fl_addr;
-	u32_t remaining;
 	u32_t len;
 	u32_t num_read;
 
-	fl_addr = lba_to_address(start_sector);
-	remaining = (sector_count * SECTOR_SIZE);
 	len = CONFIG_DISK_FLASH_MAX_RW_SIZE;
 
 	num_read = GET_NUM_BLOCK(remaining, CONFIG_DISK_FLASH_MAX_RW_SIZE);
@@ -95,6 +113,217 @@ static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
 	return 0;
 }
 
+/* erase one block and write it with the data of a full block */
+static int write_flash_block(off_t fl_addr, const u8_t *src)
+{
+	u32_t num_write;
+
+	/* disable write-protection first before erase */
+	flash_write_protection_set(flash_dev, false);
+	if (flash_erase(flash_dev, fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE)
+			!= 0) {
+		return -EIO;
+	}
+
+	/* write data to flash */
+	num_write = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
+				  CONFIG_DISK_FLASH_MAX_RW_SIZE);
+
+	for (u32_t i = 0; i < num_write; i++) {
+		/* flash_write reenabled write-protection so disable it again */
+		flash_write_protection_set(flash_dev, false);
+
+		if (flash_write(flash_dev, fl_addr, src,
+				CONFIG_DISK_FLASH_MAX_RW_SIZE) != 0) {
+			return -EIO;
+		}
+
+		fl_addr += CONFIG_DISK_FLASH_MAX_RW_SIZE;
+		src += CONFIG_DISK_FLASH_MAX_RW_SIZE;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_DISK_FLASH_WRITE_BACK
+
+static struct block_cache *cache_find(off_t blk_addr)
+{
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].addr == blk_addr) {
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* a free slot, else the least recently used one, clean ones only if
+ * clean_only is set.
+ */
+static struct block_cache *cache_victim(bool clean_only)
+{
+	struct block_cache *victim = NULL;
+
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].addr == -1) {
+			return &cache[i];
+		}
+
+		if (clean_only && cache[i].dirty) {
+			continue;
+		}
+
+		if (!victim || (s32_t)(cache[i].used - victim->used) < 0) {
+			victim = &cache[i];
+		}
+	}
+
+	return victim;
+}
+
+static int cache_flush_block(struct block_cache *blk)
+{
+	if (!blk->dirty) {
+		return 0;
+	}
+
+	if (write_flash_block(blk->addr, blk->data) != 0) {
+		return -EIO;
+	}
+
+	blk->dirty = false;
+
+	return 0;
+}
+
+static int cache_flush(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache_flush_block(&cache[i]) != 0) {
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/* Reads go to the cached blocks first, as they may not be written yet.
+ * A sequential read of a part of a block reads the whole block ahead,
+ * into a slot that holds no write.
+ */
+static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
+				u32_t start_sector, u32_t sector_count)
+{
+	struct block_cache *blk;
+	off_t fl_addr;
+	off_t blk_addr;
+	u32_t remaining;
+	u32_t offset;
+	u32_t size;
+	bool sequential;
+
+	fl_addr = lba_to_address(start_sector);
+	remaining = (sector_count * SECTOR_SIZE);
+
+	sequential = (fl_addr == next_read_addr);
+	next_read_addr = fl_addr + remaining;
+
+	while (remaining) {
+		blk_addr = ROUND_DOWN(fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE);
+		offset = fl_addr - blk_addr;
+		size = MIN(remaining, CONFIG_DISK_ERASE_BLOCK_SIZE - offset);
+
+		blk = cache_find(blk_addr);
+		if (!blk && sequential &&
+		    size < CONFIG_DISK_ERASE_BLOCK_SIZE) {
+			blk = cache_victim(true);
+			if (blk) {
+				blk->addr = -1;
+				if (flash_read_chunks(blk_addr, blk->data,
+					CONFIG_DISK_ERASE_BLOCK_SIZE) != 0) {
+					return -EIO;
+				}
+
+				blk->addr = blk_addr;
+			}
+		}
+
+		if (blk) {
+			memcpy(buff, blk->data + offset, size);
+			blk->used = ++cache_clock;
+		} else if (flash_read_chunks(fl_addr, buff, size) != 0) {
+			return -EIO;
+		}
+
+		fl_addr += size;
+		remaining -= size;
+		buff += size;
+	}
+
+	return 0;
+}
+
+/* Writes are gathered in the cached blocks, so that the sectors of one
+ * erase block cost a single erase.  A block is only read from flash when
+ * it is not all overwritten.
+ */
+static int disk_flash_access_write(struct disk_info *disk, const u8_t *buff,
+				 u32_t start_sector, u32_t sector_count)
+{
+	struct block_cache *blk;
+	off_t fl_addr;
+	off_t blk_addr;
+	u32_t remaining;
+	u32_t offset;
+	u32_t size;
+
+	fl_addr = lba_to_address(start_sector);
+	remaining = (sector_count * SECTOR_SIZE);
+
+	while (remaining) {
+		blk_addr = ROUND_DOWN(fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE);
+		offset = fl_addr - blk_addr;
+		size = MIN(remaining, CONFIG_DISK_ERASE_BLOCK_SIZE - offset);
+
+		blk = cache_find(blk_addr);
+		if (!blk) {
+			blk = cache_victim(false);
+			if (cache_flush_block(blk) != 0) {
+				return -EIO;
+			}
+
+			blk->addr = -1;
+			if (size < CONFIG_DISK_ERASE_BLOCK_SIZE &&
+			    flash_read_chunks(blk_addr, blk->data,
+					      CONFIG_DISK_ERASE_BLOCK_SIZE) != 0) {
+				return -EIO;
+			}
+
+			blk->addr = blk_addr;
+		}
+
+		memcpy(blk->data + offset, buff, size);
+		blk->dirty = true;
+		blk->used = ++cache_clock;
+
+		fl_addr += size;
+		remaining -= size;
+		buff += size;
+	}
+
+	return 0;
+}
+
+#else
+
+static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
+				u32_t start_sector, u32_t sector_count)
+{
+	return flash_read_chunks(lba_to_address(start_sector), buff,
+				 sector_count * SECTOR_SIZE);
+}
+
 /* This performs read-copy into an output buffer */
 static int read_copy_flash_block(off_t start_addr, u32_t size,
 				 const void *src_buff,
@@ -141,7 +370,6 @@ static int update_flash_block(off_t start_addr, u32_t size, const void *buff)
 {
 	off_t fl_addr;
 	u8_t *src = (u8_t *)buff;
-	u32_t num_write;
 
 	/* if size is a partial block, perform read-copy with user data */
 	if (size < CONFIG_DISK_ERASE_BLOCK_SIZE) {
@@ -159,31 +387,7 @@ static int update_flash_block(off_t start_addr, u32_t size, const void *buff)
 	/* always align starting address for flash write operation */
 	fl_addr = ROUND_DOWN(start_addr, CONFIG_DISK_FLASH_ERASE_ALIGNMENT);
 
-	/* disable write-protection first before erase */
-	flash_write_protection_set(flash_dev, false);
-	if (flash_erase(flash_dev, fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE)
-			!= 0) {
-		return -EIO;
-	}
-
-	/* write data to flash */
-	num_write = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
-				  CONFIG_DISK_FLASH_MAX_RW_SIZE);
-
-	for (u32_t i = 0; i < num_write; i++) {
-		/* flash_write reenabled write-protection so disable it again */
-		flash_write_protection_set(flash_dev, false);
-
-		if (flash_write(flash_dev, fl_addr, src,
-				CONFIG_DISK_FLASH_MAX_RW_SIZE) != 0) {
-			return -EIO;
-		}
-
-		fl_addr += CONFIG_DISK_FLASH_MAX_RW_SIZE;
-		src += CONFIG_DISK_FLASH_MAX_RW_SIZE;
-	}
-
-	return 0;
+	return write_flash_block(fl_addr, src);
 }
 
 static int disk_flash_access_write(struct disk_info *disk, const u8_t *buff,
@@ -255,11 +459,17 @@ static int disk_flash_access_write(struct disk_info *disk, const u8_t *buff,
 	return 0;
 }
 
+#endif /* CONFIG_DISK_FLASH_WRITE_BACK */
+
 static int disk_flash_access_ioctl(struct disk_info *disk, u8_t cmd, void *buff)
 {
 	switch (cmd) {
 	case DISK_IOCTL_CTRL_SYNC:
+#ifdef CONFIG_DISK_FLASH_WRITE_BACK
+		return cache_flush();
+#else
 		return 0;
+#endif
 	case DISK_IOCTL_GET_SECTOR_COUNT:
 		*(u32_t *)buff = CONFIG_DISK_VOLUME_SIZE / SECTOR_SIZE;
 		return 0;
@@ -150,6 +150,52 @@ ssize_t fs_write(struct fs_file_t *zfp, const void *ptr, size_t size)
 	return rc;
 }
 
+ssize_t fs_readv(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		 int iovcnt)
+{
+	ssize_t total = 0;
+	ssize_t rc;
+
+	for (int i = 0; i < iovcnt; i++) {
+		rc = fs_read(zfp, iov[i].iov_base, iov[i].iov_len);
+		if (rc < 0) {
+			return total ? total : rc;
+		}
+
+		total += rc;
+
+		/* end of file */
+		if (rc < iov[i].iov_len) {
+			break;
+		}
+	}
+
+	return total;
+}
+
+ssize_t fs_writev(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		  int iovcnt)
+{
+	ssize_t total = 0;
+	ssize_t rc;
+
+	for (int i = 0; i < iovcnt; i++) {
+		rc = fs_write(zfp, iov[i].iov_base, iov[i].iov_len);
+		if (rc < 0) {
+			return total ? total : rc;
+		}
+
+		total += rc;
+
+		/* disk full */
+		if (rc < iov[i].iov_len) {
+			break;
+		}
+	}
+
+	return total;
+}
+
 int fs_seek(struct fs_file_t *zfp, off_t offset, int whence)
 {
 	int rc = -EINVAL;
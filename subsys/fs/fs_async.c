@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2019 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/types.h>
+#include <errno.h>
+#include <init.h>
+#include <kernel.h>
+#include <fs.h>
+
+/* requests waiting for the I/O thread */
+static K_FIFO_DEFINE(fs_async_fifo);
+
+static K_THREAD_STACK_DEFINE(fs_async_stack, CONFIG_FS_ASYNC_STACK_SIZE);
+static struct k_thread fs_async_thread_data;
+
+#if CONFIG_FS_ASYNC_MERGE_SIZE > 0
+/* data of the writes merged into one */
+static u8_t merge_buf[CONFIG_FS_ASYNC_MERGE_SIZE];
+#endif
+
+static size_t iov_size(const struct fs_iovec *iov, int iovcnt)
+{
+	size_t size = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+		size += iov[i].iov_len;
+	}
+
+	return size;
+}
+
+static void fs_async_complete(struct fs_async_req *req, ssize_t result)
+{
+	req->result = result;
+	k_poll_signal_raise(req->signal, result);
+}
+
+#if CONFIG_FS_ASYNC_MERGE_SIZE > 0
+static size_t merge_copy(size_t offset, const struct fs_async_req *req)
+{
+	for (int i = 0; i < req->iovcnt; i++) {
+		memcpy(merge_buf + offset, req->iov[i].iov_base,
+		       req->iov[i].iov_len);
+		offset += req->iov[i].iov_len;
+	}
+
+	return offset;
+}
+
+/*
+ * Gathers the writes to the same file queued behind req, as long as their
+ * data fits in merge_buf, and writes them with a single fs_write(). Each
+ * request gets the part of the result that covers its data, in order.
+ *
+ * Returns false, doing nothing, if the data of req alone does not fit.
+ */
+static bool fs_async_write_merged(struct fs_async_req *req)
+{
+	struct fs_async_req *next;
+	sys_snode_t *node;
+	sys_slist_t batch;
+	size_t size, left;
+	ssize_t rc;
+
+	size = iov_size(req->iov, req->iovcnt);
+	if (size > sizeof(merge_buf)) {
+		return false;
+	}
+
+	sys_slist_init(&batch);
+	sys_slist_append(&batch, &req->node);
+	size = merge_copy(0, req);
+
+	/* only this thread takes requests out of the FIFO */
+	while ((next = k_fifo_peek_head(&fs_async_fifo)) != NULL) {
+		if (next->op != FS_ASYNC_WRITE || next->zfp != req->zfp ||
+		    size + iov_size(next->iov, next->iovcnt) >
+		    sizeof(merge_buf)) {
+			break;
+		}
+
+		(void)k_fifo_get(&fs_async_fifo, K_NO_WAIT);
+		sys_slist_append(&batch, &next->node);
+		size = merge_copy(size, next);
+	}
+
+	rc = fs_write(req->zfp, merge_buf, size);
+	left = rc < 0 ? 0 : rc;
+
+	while ((node = sys_slist_get(&batch)) != NULL) {
+		next = CONTAINER_OF(node, struct fs_async_req, node);
+
+		if (rc < 0) {
+			fs_async_complete(next, rc);
+			continue;
+		}
+
+		size = MIN(left, iov_size(next->iov, next->iovcnt));
+		left -= size;
+		fs_async_complete(next, size);
+	}
+
+	return true;
+}
+#endif
+
+static void fs_async_thread(void)
+{
+	struct fs_async_req *req;
+	ssize_t rc;
+
+	while (1) {
+		req = k_fifo_get(&fs_async_fifo, K_FOREVER);
+
+		if (req->op == FS_ASYNC_READ) {
+			rc = fs_readv(req->zfp, req->iov, req->iovcnt);
+		} else {
+#if CONFIG_FS_ASYNC_MERGE_SIZE > 0
+			if (fs_async_write_merged(req)) {
+				continue;
+			}
+#endif
+			rc = fs_writev(req->zfp, req->iov, req->iovcnt);
+		}
+
+		fs_async_complete(req, rc);
+	}
+}
+
+int fs_async_submit(struct fs_async_req *req)
+{
+	if ((req == NULL) || (req->zfp == NULL) || (req->signal == NULL) ||
+	    (req->iovcnt < 0) || (req->iovcnt && req->iov == NULL) ||
+	    (req->op != FS_ASYNC_READ && req->op != FS_ASYNC_WRITE)) {
+		return -EINVAL;
+	}
+
+	k_fifo_put(&fs_async_fifo, req);
+
+	return 0;
+}
+
+static int fs_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_thread_create(&fs_async_thread_data, fs_async_stack,
+			K_THREAD_STACK_SIZEOF(fs_async_stack),
+			(k_thread_entry_t)fs_async_thread, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(CONFIG_FS_ASYNC_THREAD_PRIO), 0, 0);
+	k_thread_name_set(&fs_async_thread_data, "fs_async");
+
+	return 0;
+}
+
+SYS_INIT(fs_async_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -287,6 +287,164 @@ static int _nvs_ate_cmp_const(const struct nvs_ate *entry, u8_t value)
 	return 0;
 }
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* lookup cache routines, to be called with fs->nvs_lock held */
+#define NVS_LOOKUP_CACHE_SETS \
+	(CONFIG_NVS_LOOKUP_CACHE_SIZE / NVS_LOOKUP_CACHE_WAYS)
+
+static void _nvs_lookup_cache_clear(struct nvs_fs *fs)
+{
+	(void)memset(fs->lookup_cache, 0xff, sizeof(fs->lookup_cache));
+	fs->lookup_stamp = 0U;
+	fs->lookup_complete = false;
+}
+
+/* first entry of the set id is mapped to */
+static struct nvs_lookup_entry *_nvs_lookup_cache_set(struct nvs_fs *fs,
+						      u16_t id)
+{
+	return &fs->lookup_cache[(id % NVS_LOOKUP_CACHE_SETS) *
+				 NVS_LOOKUP_CACHE_WAYS];
+}
+
+/* returns the entry of id, NULL if id is not cached */
+static struct nvs_lookup_entry *_nvs_lookup_cache_find(struct nvs_fs *fs,
+						       u16_t id)
+{
+	struct nvs_lookup_entry *entry = _nvs_lookup_cache_set(fs, id);
+
+	for (int i = 0; i < NVS_LOOKUP_CACHE_WAYS; i++, entry++) {
+		if ((entry->ate_addr != NVS_LOOKUP_CACHE_NO_ADDR) &&
+		    (entry->id == id)) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/* store the address of the latest ate of id. If use is set the entry is
+ * marked as recently used and the least recently used entry of the set is
+ * replaced when the set is full, otherwise only a free entry is taken.
+ */
+static void _nvs_lookup_cache_update(struct nvs_fs *fs, u16_t id,
+				     u32_t ate_addr, bool use)
+{
+	struct nvs_lookup_entry *entry, *victim = NULL;
+	u16_t age, victim_age = 0U;
+
+	entry = _nvs_lookup_cache_find(fs, id);
+	if (entry) {
+		entry->ate_addr = ate_addr;
+		if (use) {
+			entry->stamp = ++fs->lookup_stamp;
+		}
+		return;
+	}
+
+	/* a complete cache already tells the id has no ate */
+	if (fs->lookup_complete && (ate_addr == NVS_LOOKUP_CACHE_NO_ATE)) {
+		return;
+	}
+
+	entry = _nvs_lookup_cache_set(fs, id);
+	for (int i = 0; i < NVS_LOOKUP_CACHE_WAYS; i++, entry++) {
+		if ((entry->ate_addr == NVS_LOOKUP_CACHE_NO_ADDR) ||
+		    (fs->lookup_complete &&
+		     (entry->ate_addr == NVS_LOOKUP_CACHE_NO_ATE))) {
+			victim = entry;
+			break;
+		}
+		age = fs->lookup_stamp - entry->stamp;
+		if (use && (!victim || (age > victim_age))) {
+			victim = entry;
+			victim_age = age;
+		}
+	}
+
+	/* an id with an ate is left out */
+	if (!victim || ((victim->ate_addr != NVS_LOOKUP_CACHE_NO_ADDR) &&
+			(victim->ate_addr != NVS_LOOKUP_CACHE_NO_ATE))) {
+		fs->lookup_complete = false;
+	}
+
+	if (!victim) {
+		return;
+	}
+
+	victim->ate_addr = ate_addr;
+	victim->id = id;
+	victim->stamp = ++fs->lookup_stamp;
+}
+
+/* update the entries pointing into the sector at addr before it is erased.
+ * The latest ate's left in the sector were not copied by the garbage
+ * collection, these ids have no ate once the oldest sector is erased.
+ */
+static void _nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t addr)
+{
+	struct nvs_lookup_entry *entry = fs->lookup_cache;
+
+	addr &= ADDR_SECT_MASK;
+	for (int i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++, entry++) {
+		if ((entry->ate_addr != NVS_LOOKUP_CACHE_NO_ADDR) &&
+		    ((entry->ate_addr & ADDR_SECT_MASK) == addr)) {
+			entry->ate_addr = NVS_LOOKUP_CACHE_NO_ATE;
+		}
+	}
+}
+
+/* read the latest ate of id from the address in the lookup cache. When
+ * the cache is complete the ids that are not cached have no ate.
+ * returns 0 if found, 1 if id is not cached, -ENOENT if id has no ate,
+ * errcode if error
+ */
+static int _nvs_lookup_cache_ate_rd(struct nvs_fs *fs, u16_t id, u32_t *addr,
+				    struct nvs_ate *ate, bool use)
+{
+	int rc;
+	struct nvs_lookup_entry *entry;
+
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+
+	entry = _nvs_lookup_cache_find(fs, id);
+	if (!entry) {
+		rc = fs->lookup_complete ? -ENOENT : 1;
+		goto end;
+	}
+
+	if (entry->ate_addr == NVS_LOOKUP_CACHE_NO_ATE) {
+		if (use) {
+			entry->stamp = ++fs->lookup_stamp;
+		}
+		rc = -ENOENT;
+		goto end;
+	}
+
+	*addr = entry->ate_addr;
+	rc = _nvs_flash_rd(fs, *addr, ate, sizeof(struct nvs_ate));
+	if (rc) {
+		goto end;
+	}
+
+	if ((ate->id != id) || _nvs_ate_crc8_check(ate)) {
+		/* should not happen, fall back to walking the ate's */
+		LOG_WRN("Invalid lookup cache entry for id %d", id);
+		entry->ate_addr = NVS_LOOKUP_CACHE_NO_ADDR;
+		fs->lookup_complete = false;
+		rc = 1;
+		goto end;
+	}
+
+	if (use) {
+		entry->stamp = ++fs->lookup_stamp;
+	}
+
+end:
+	k_mutex_unlock(&fs->nvs_lock);
+	return rc;
+}
+#endif /* CONFIG_NVS_LOOKUP_CACHE */
+
 /* store an entry in flash */
 static int _nvs_flash_wrt_entry(struct nvs_fs *fs, u16_t id, const void *data,
 				size_t len)
@@ -294,6 +452,7 @@ static int _nvs_flash_wrt_entry(struct nvs_fs *fs, u16_t id, const void *data,
 	int rc;
 	struct nvs_ate entry;
 	size_t ate_size;
+	u32_t ate_addr;
 
 	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
 
@@ -308,11 +467,18 @@ static int _nvs_flash_wrt_entry(struct nvs_fs *fs, u16_t id, const void *data,
 	if (rc) {
 		return rc;
 	}
+	ate_addr = fs->ate_wra;
 	rc = _nvs_flash_ate_wrt(fs, &entry);
 	if (rc) {
 		return rc;
 	}
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	_nvs_lookup_cache_update(fs, id, ate_addr, true);
+#else
+	ARG_UNUSED(ate_addr);
+#endif
+
 	return 0;
 }
 /* end of flash routines */
@@ -390,6 +556,111 @@ static int _nvs_prev_ate(struct nvs_fs *fs, u32_t *addr, struct nvs_ate *ate)
 	return 0;
 }
 
+/* With CONFIG_NVS_GC_BACKGROUND the system work queue may erase a sector
+ * at any time, so the reads walking the ate's hold the lock meanwhile.
+ * nvs_lock is recursive, the functions it protects may take it again.
+ */
+static inline void _nvs_walk_lock(struct nvs_fs *fs)
+{
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+#endif
+}
+
+static inline void _nvs_walk_unlock(struct nvs_fs *fs)
+{
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	k_mutex_unlock(&fs->nvs_lock);
+#endif
+}
+
+/* find the latest valid ate of id, through the lookup cache if enabled.
+ * addr is set to the address of the ate. use is passed on to the cache,
+ * the garbage collection clears it so as not to evict the ids in use.
+ * returns 0 if found, 1 if not found, errcode if error
+ */
+static int _nvs_latest_ate(struct nvs_fs *fs, u16_t id, u32_t *addr,
+			   struct nvs_ate *ate, bool use)
+{
+	int rc;
+	u32_t wlk_addr, ate_wra;
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	rc = _nvs_lookup_cache_ate_rd(fs, id, addr, ate, use);
+	if (rc == -ENOENT) {
+		return 1;
+	}
+	if (rc <= 0) {
+		return rc;
+	}
+#endif
+
+	ate_wra = fs->ate_wra;
+	wlk_addr = ate_wra;
+
+	while (1) {
+		*addr = wlk_addr;
+		rc = _nvs_prev_ate(fs, &wlk_addr, ate);
+		if (rc) {
+			return rc;
+		}
+		if ((ate->id == id) && (!_nvs_ate_crc8_check(ate))) {
+			rc = 0;
+			break;
+		}
+		if (wlk_addr == ate_wra) {
+			rc = 1;
+			break;
+		}
+	}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+	/* don't cache the ate if something was written in the meantime */
+	if (fs->ate_wra == ate_wra) {
+		_nvs_lookup_cache_update(fs, id, rc ? NVS_LOOKUP_CACHE_NO_ATE :
+					 *addr, use);
+	}
+	k_mutex_unlock(&fs->nvs_lock);
+#endif
+
+	return rc;
+}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* fill the lookup cache with the latest ate's, walking from the newest
+ * to the oldest ate. Ids that do not fit are left out.
+ */
+static int _nvs_lookup_cache_build(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_ate wlk_ate;
+	u32_t wlk_addr, rd_addr;
+
+	_nvs_lookup_cache_clear(fs);
+	fs->lookup_complete = true;
+
+	wlk_addr = fs->ate_wra;
+
+	while (1) {
+		rd_addr = wlk_addr;
+		rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
+		if (rc) {
+			return rc;
+		}
+		if (!_nvs_ate_crc8_check(&wlk_ate) &&
+		    !_nvs_lookup_cache_find(fs, wlk_ate.id)) {
+			_nvs_lookup_cache_update(fs, wlk_ate.id, rd_addr,
+						 false);
+		}
+		if (wlk_addr == fs->ate_wra) {
+			break;
+		}
+	}
+	return 0;
+}
+#endif /* CONFIG_NVS_LOOKUP_CACHE */
+
 static void _nvs_sector_advance(struct nvs_fs *fs, u32_t *addr)
 {
 	*addr += (1 << ADDR_SECT_SHIFT);
@@ -428,6 +699,88 @@ static int _nvs_sector_close(struct nvs_fs *fs)
 }
 
 
+/* garbage collection of one ate: the ate read from gc_addr needs to be
+ * copied to the write sector if it is the latest entry of its id, unless it
+ * is a deleted item.
+ * returns 1 if a copy is needed, 0 if not, errcode if error
+ */
+static int _nvs_gc_ate_needed(struct nvs_fs *fs, u32_t gc_addr,
+			      const struct nvs_ate *gc_ate)
+{
+	int rc;
+	struct nvs_ate wlk_ate;
+	u32_t wlk_addr;
+
+	/* an invalid ate is never the latest entry of its id */
+	if (_nvs_ate_crc8_check(gc_ate)) {
+		return 0;
+	}
+
+	/* answered by the lookup cache when the id is cached or the cache
+	 * is complete, otherwise by walking the ate's.
+	 */
+	rc = _nvs_latest_ate(fs, gc_ate->id, &wlk_addr, &wlk_ate, false);
+	if (rc < 0) {
+		return rc;
+	}
+
+	/* if the latest ate of the id is the one at gc_addr copy is
+	 * needed unless it is a deleted item.
+	 */
+	if (!rc && (wlk_addr == gc_addr) && gc_ate->len) {
+		return 1;
+	}
+	return 0;
+}
+
+/* copy the entry of the ate read from gc_addr to the write sector */
+static int _nvs_gc_ate_move(struct nvs_fs *fs, u32_t gc_addr,
+			    struct nvs_ate *gc_ate)
+{
+	int rc;
+	u32_t data_addr, ate_addr;
+
+	LOG_DBG("Moving %d, len %d", gc_ate->id, gc_ate->len);
+
+	data_addr = (gc_addr & ADDR_SECT_MASK);
+	data_addr += gc_ate->offset;
+
+	gc_ate->offset = (u16_t)(fs->data_wra & ADDR_OFFS_MASK);
+	_nvs_ate_crc8_update(gc_ate);
+
+	rc = _nvs_flash_block_move(fs, data_addr, gc_ate->len);
+	if (rc) {
+		return rc;
+	}
+
+	ate_addr = fs->ate_wra;
+	rc = _nvs_flash_ate_wrt(fs, gc_ate);
+	if (rc) {
+		return rc;
+	}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* moved data should not push out the recently used ids. */
+	_nvs_lookup_cache_update(fs, gc_ate->id, ate_addr, false);
+#else
+	ARG_UNUSED(ate_addr);
+#endif
+
+	return 0;
+}
+
+/* erase a sector once all its entries have been collected */
+static int _nvs_gc_sector_erase(struct nvs_fs *fs, u32_t sec_addr)
+{
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* the remaining entries in the sector are deleted items */
+	_nvs_lookup_cache_invalidate(fs, sec_addr);
+#endif
+
+	return _nvs_flash_erase_sector(fs, sec_addr);
+}
+
+#ifndef CONFIG_NVS_GC_INCREMENTAL
 /* garbage collection: the address ate_wra has been updated to the new sector
  * that has just been started. The data to gc is in the sector after this new
  * sector.
@@ -435,9 +788,8 @@ static int _nvs_sector_close(struct nvs_fs *fs)
 static int _nvs_gc(struct nvs_fs *fs)
 {
 	int rc;
-	struct nvs_ate close_ate, gc_ate, wlk_ate;
-	u32_t sec_addr, gc_addr, gc_prev_addr, wlk_addr, wlk_prev_addr,
-	      data_addr, stop_addr;
+	struct nvs_ate close_ate, gc_ate;
+	u32_t sec_addr, gc_addr, gc_prev_addr, stop_addr;
 	size_t ate_size;
 
 	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
@@ -473,59 +825,297 @@ static int _nvs_gc(struct nvs_fs *fs)
 		if (rc) {
 			return rc;
 		}
-		wlk_addr = fs->ate_wra;
-		while (1) {
-			wlk_prev_addr = wlk_addr;
-			rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
+
+		rc = _nvs_gc_ate_needed(fs, gc_prev_addr, &gc_ate);
+		if (rc < 0) {
+			return rc;
+		}
+		if (rc) {
+			/* copy needed */
+			rc = _nvs_gc_ate_move(fs, gc_prev_addr, &gc_ate);
 			if (rc) {
 				return rc;
 			}
-			/* if ate with same id is reached we might need to copy.
-			 * only consider valid wlk_ate's. Something wrong might
-			 * have been written that has the same ate but is
-			 * invalid, don't consider these as a match.
-			 */
-			if ((wlk_ate.id == gc_ate.id) &&
-			    (!_nvs_ate_crc8_check(&wlk_ate))) {
-				break;
-			}
 		}
-		/* if walk has reached the same address as gc_addr copy is
-		 * needed unless it is a deleted item.
-		 */
-		if ((wlk_prev_addr == gc_prev_addr) && gc_ate.len) {
-			/* copy needed */
-			LOG_DBG("Moving %d, len %d", gc_ate.id, gc_ate.len);
 
-			data_addr = (gc_prev_addr & ADDR_SECT_MASK);
-			data_addr += gc_ate.offset;
+		/* stop gc at end of the sector */
+		if (gc_prev_addr == stop_addr) {
+			break;
+		}
+	}
+
+	rc = _nvs_gc_sector_erase(fs, sec_addr);
+	if (rc) {
+		return rc;
+	}
+	return 0;
+}
+#endif /* !CONFIG_NVS_GC_INCREMENTAL */
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+/* incremental garbage collection: instead of collecting the sector after
+ * the write sector as soon as a sector is closed, NVS_GC_EMPTY_SECTORS empty
+ * sectors are kept after the write sector and the oldest sector is collected
+ * a few ate's at a time by nvs_gc_step(). Only when the sector being
+ * collected directly follows the write sector do writes have to keep room
+ * for the entries left to collect, and collect them if there is not enough
+ * room.
+ */
+
+/* flash size taken by an entry: its ate and its data */
+static size_t _nvs_entry_size(struct nvs_fs *fs, const struct nvs_ate *ate)
+{
+	size_t ate_size;
+
+	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
+	if (_nvs_ate_crc8_check(ate)) {
+		/* the data size of an invalid ate is unknown */
+		return ate_size;
+	}
+
+	return ate_size + _nvs_al_size(fs, ate->len);
+}
+
+/* start collecting the closed sector at sec_addr */
+static int _nvs_gc_start(struct nvs_fs *fs, u32_t sec_addr)
+{
+	int rc;
+	struct nvs_ate close_ate, last_ate;
+	u32_t close_addr;
+	size_t ate_size;
+
+	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	close_addr = sec_addr + fs->sector_size - ate_size;
+	rc = _nvs_flash_ate_rd(fs, close_addr, &close_ate);
+	if (rc) {
+		return rc;
+	}
+
+	fs->gc_stop_addr = close_addr - ate_size;
+	fs->gc_addr = sec_addr + close_ate.offset;
+
+	/* the entries to collect take at most the ate's up to the sector
+	 * close and the data up to the end of the data of the last ate.
+	 */
+	fs->gc_reserve = fs->sector_size - ate_size - close_ate.offset;
+
+	rc = _nvs_flash_ate_rd(fs, fs->gc_addr, &last_ate);
+	if (rc) {
+		return rc;
+	}
+	if (!_nvs_ate_crc8_check(&last_ate)) {
+		fs->gc_reserve += last_ate.offset;
+		fs->gc_reserve += _nvs_al_size(fs, last_ate.len);
+	} else {
+		fs->gc_reserve += close_ate.offset;
+	}
+
+	LOG_DBG("Collecting sector %d, reserve %d", sec_addr >> ADDR_SECT_SHIFT,
+		fs->gc_reserve);
+
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	/* at startup, the work is submitted once nvs is ready */
+	if (fs->ready) {
+		k_work_submit(&fs->gc_work);
+	}
+#endif
+
+	return 0;
+}
+
+/* start collecting the oldest sector when less than NVS_GC_EMPTY_SECTORS
+ * sectors after the write sector are empty.
+ */
+static int _nvs_gc_schedule(struct nvs_fs *fs)
+{
+	int rc;
+	u32_t addr, wrt_sec;
+	size_t ate_size;
+
+	if (fs->gc_addr != NVS_GC_IDLE) {
+		return 0;
+	}
+
+	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	wrt_sec = fs->ate_wra & ADDR_SECT_MASK;
+	addr = wrt_sec;
+
+	for (int i = 0; i < NVS_GC_EMPTY_SECTORS; i++) {
+		_nvs_sector_advance(fs, &addr);
+		if (addr == wrt_sec) {
+			/* no closed sector */
+			return 0;
+		}
+
+		rc = _nvs_flash_cmp_const(fs, addr + fs->sector_size - ate_size,
+					  0xff, sizeof(struct nvs_ate));
+		if (rc < 0) {
+			return rc;
+		}
+		if (rc) {
+			/* closed sector, the oldest one */
+			return _nvs_gc_start(fs, addr);
+		}
+	}
+
+	return 0;
+}
+
+/* is the sector being collected the one after the write sector ? */
+static bool _nvs_gc_adjacent(struct nvs_fs *fs)
+{
+	u32_t addr;
+
+	if (fs->gc_addr == NVS_GC_IDLE) {
+		return false;
+	}
+
+	addr = fs->ate_wra & ADDR_SECT_MASK;
+	_nvs_sector_advance(fs, &addr);
+
+	return addr == (fs->gc_stop_addr & ADDR_SECT_MASK);
+}
+
+/* collect the next ate of the sector being collected, the sector is erased
+ * after its last ate.
+ */
+static int _nvs_gc_next(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_ate gc_ate;
+	u32_t gc_addr, gc_prev_addr, sec_addr;
+	size_t entry_size;
+
+	gc_addr = fs->gc_addr;
+	gc_prev_addr = gc_addr;
+	rc = _nvs_prev_ate(fs, &gc_addr, &gc_ate);
+	if (rc) {
+		return rc;
+	}
+
+	entry_size = _nvs_entry_size(fs, &gc_ate);
+
+	rc = _nvs_gc_ate_needed(fs, gc_prev_addr, &gc_ate);
+	if (rc < 0) {
+		return rc;
+	}
 
-			gc_ate.offset = (u16_t)(fs->data_wra & ADDR_OFFS_MASK);
-			_nvs_ate_crc8_update(&gc_ate);
+	if (rc) {
+		/* copy needed */
+		if (fs->ate_wra - fs->data_wra < entry_size) {
+			if (_nvs_gc_adjacent(fs)) {
+				/* should not happen, the room was kept by
+				 * writes.
+				 */
+				LOG_ERR("No room to collect the entries");
+				return -ENOSPC;
+			}
 
-			rc = _nvs_flash_block_move(fs, data_addr, gc_ate.len);
+			/* continue in the empty sector after the write
+			 * sector
+			 */
+			rc = _nvs_sector_close(fs);
 			if (rc) {
 				return rc;
 			}
+		}
+
+		rc = _nvs_gc_ate_move(fs, gc_prev_addr, &gc_ate);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	fs->gc_reserve -= MIN(fs->gc_reserve, entry_size);
+
+	if (gc_prev_addr != fs->gc_stop_addr) {
+		fs->gc_addr = gc_addr;
+		return 0;
+	}
+
+	/* all the entries of the sector are collected */
+	sec_addr = fs->gc_stop_addr & ADDR_SECT_MASK;
+	fs->gc_addr = NVS_GC_IDLE;
+	fs->gc_reserve = 0U;
+
+	rc = _nvs_gc_sector_erase(fs, sec_addr);
+	if (rc) {
+		return rc;
+	}
+
+	return _nvs_gc_schedule(fs);
+}
+
+/* make room for an entry of size bytes in the write sector, closing the
+ * write sector or collecting entries as needed.
+ */
+static int _nvs_gc_make_room(struct nvs_fs *fs, size_t size)
+{
+	int rc, close_count;
+	size_t sector_freespace;
+
+	close_count = 0;
+	while (1) {
+		sector_freespace = fs->ate_wra - fs->data_wra;
+
+		if (_nvs_gc_adjacent(fs)) {
+			/* keep room for the entries left to collect */
+			if (sector_freespace >= size + fs->gc_reserve) {
+				return 0;
+			}
 
-			rc = _nvs_flash_ate_wrt(fs, &gc_ate);
+			rc = _nvs_gc_next(fs);
 			if (rc) {
 				return rc;
 			}
+			continue;
 		}
 
-		/* stop gc at end of the sector */
-		if (gc_prev_addr == stop_addr) {
-			break;
+		if (sector_freespace >= size) {
+			return 0;
+		}
+
+		if (close_count == fs->sector_count) {
+			/* closed all sectors, no extra space will be created
+			 * by extra gc.
+			 */
+			return -ENOSPC;
+		}
+
+		rc = _nvs_sector_close(fs);
+		if (rc) {
+			return rc;
+		}
+		close_count++;
+
+		rc = _nvs_gc_schedule(fs);
+		if (rc) {
+			return rc;
 		}
 	}
+}
+
+#ifdef CONFIG_NVS_GC_BACKGROUND
+static void _nvs_gc_work_handler(struct k_work *work)
+{
+	struct nvs_fs *fs = CONTAINER_OF(work, struct nvs_fs, gc_work);
+	int rc;
+
+	rc = nvs_gc_step(fs);
+	if (rc < 0) {
+		LOG_ERR("Garbage collection failed (%d)", rc);
+		return;
+	}
 
-	rc = _nvs_flash_erase_sector(fs, sec_addr);
 	if (rc) {
-		return rc;
+		/* let the other work items run between the steps */
+		k_work_submit(&fs->gc_work);
 	}
-	return 0;
 }
+#endif /* CONFIG_NVS_GC_BACKGROUND */
+#endif /* CONFIG_NVS_GC_INCREMENTAL */
 
 static int _nvs_startup(struct nvs_fs *fs)
 {
@@ -541,6 +1131,10 @@ static int _nvs_startup(struct nvs_fs *fs)
 
 	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	_nvs_lookup_cache_clear(fs);
+#endif
+
 	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
 	/* step through the sectors to find the last sector */
 	for (u16_t i = 0; i < fs->sector_count; i++) {
@@ -609,6 +1203,43 @@ static int _nvs_startup(struct nvs_fs *fs)
 		fs->data_wra += fs->write_block_size;
 	}
 
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	/* the write sector also holds new entries, it cannot be erased to
+	 * restart an interrupted gc. The gc of the oldest sector is started
+	 * again instead, the entries that were already copied are not the
+	 * latest ones any more and are skipped. Make sure the sectors that
+	 * should be empty are fully erased, in case an erase was interrupted.
+	 */
+	fs->gc_addr = NVS_GC_IDLE;
+	fs->gc_reserve = 0U;
+
+	addr = fs->ate_wra & ADDR_SECT_MASK;
+	for (int i = 0; i < NVS_GC_EMPTY_SECTORS; i++) {
+		_nvs_sector_advance(fs, &addr);
+		if ((addr >> ADDR_SECT_SHIFT) ==
+		    (fs->ate_wra >> ADDR_SECT_SHIFT)) {
+			break;
+		}
+		rc = _nvs_flash_cmp_const(fs, addr + fs->sector_size - ate_size,
+					  0xff, sizeof(struct nvs_ate));
+		if (rc < 0) {
+			goto end;
+		}
+		if (rc) {
+			/* closed sector */
+			break;
+		}
+		rc = _nvs_flash_erase_sector(fs, addr);
+		if (rc) {
+			goto end;
+		}
+	}
+
+	rc = _nvs_gc_schedule(fs);
+	if (rc) {
+		goto end;
+	}
+#else
 	/* if the sector after the write sector is not empty gc was interrupted
 	 * we need to restart gc, first erase the sector before restarting gc
 	 * otherwise the data may not fit into the sector.
@@ -633,6 +1264,11 @@ static int _nvs_startup(struct nvs_fs *fs)
 			goto end;
 		}
 	}
+#endif /* CONFIG_NVS_GC_INCREMENTAL */
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	rc = _nvs_lookup_cache_build(fs);
+#endif
 
 end:
 	k_mutex_unlock(&fs->nvs_lock);
@@ -649,6 +1285,17 @@ int nvs_clear(struct nvs_fs *fs)
 		return -EACCES;
 	}
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+	_nvs_lookup_cache_clear(fs);
+	k_mutex_unlock(&fs->nvs_lock);
+#endif
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	fs->gc_addr = NVS_GC_IDLE;
+	fs->gc_reserve = 0U;
+#endif
+
 	for (u16_t i = 0; i < fs->sector_count; i++) {
 		addr = i << ADDR_SECT_SHIFT;
 		rc = _nvs_flash_erase_sector(fs, addr);
@@ -667,6 +1314,10 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name)
 
 	k_mutex_init(&fs->nvs_lock);
 
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	k_work_init(&fs->gc_work, _nvs_gc_work_handler);
+#endif
+
 	fs->flash_device = device_get_binding(dev_name);
 	if (!fs->flash_device) {
 		LOG_ERR("No valid flash device found");
@@ -706,6 +1357,12 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name)
 	/* nvs is ready for use */
 	fs->ready = true;
 
+#ifdef CONFIG_NVS_GC_BACKGROUND
+	if (fs->gc_addr != NVS_GC_IDLE) {
+		k_work_submit(&fs->gc_work);
+	}
+#endif
+
 	LOG_INF("%d Sectors of %d bytes", fs->sector_count, fs->sector_size);
 	LOG_INF("alloc wra: %d, %x",
 		(fs->ate_wra >> ADDR_SECT_SHIFT),
@@ -719,11 +1376,14 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name)
 
 ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 {
-	int rc, gc_count;
+	int rc;
 	size_t ate_size, data_size;
 	struct nvs_ate wlk_ate;
-	u32_t wlk_addr, rd_addr;
+	u32_t rd_addr;
+#ifndef CONFIG_NVS_GC_INCREMENTAL
+	int gc_count;
 	u16_t sector_freespace;
+#endif
 
 	if (!fs->ready) {
 		LOG_ERR("NVS not initialized");
@@ -742,25 +1402,15 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		return -EINVAL;
 	}
 
-	/* find latest entry with same id */
-	wlk_addr = fs->ate_wra;
-	rd_addr = wlk_addr;
+	_nvs_walk_lock(fs);
 
-	while (1) {
-		rd_addr = wlk_addr;
-		rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
-		if (rc) {
-			return rc;
-		}
-		if ((wlk_ate.id == id) && (!_nvs_ate_crc8_check(&wlk_ate))) {
-			break;
-		}
-		if (wlk_addr == fs->ate_wra) {
-			break;
-		}
+	/* find latest entry with same id */
+	rc = _nvs_latest_ate(fs, id, &rd_addr, &wlk_ate, true);
+	if (rc < 0) {
+		goto unlock;
 	}
 
-	if (wlk_addr != fs->ate_wra) {
+	if (!rc) {
 		/* previous entry found */
 		rd_addr &= ADDR_SECT_MASK;
 		rd_addr += wlk_ate.offset;
@@ -768,19 +1418,33 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		if (len == 0) {
 			/* do not try to compare with empty data */
 			if (wlk_ate.len == 0) {
-				return 0;
+				rc = 0;
+				goto unlock;
 			}
 		} else {
 			/* compare the data and if equal return 0 */
 			rc = _nvs_flash_block_cmp(fs, rd_addr, data, len);
 			if (rc <= 0) {
-				return rc;
+				goto unlock;
 			}
 		}
 	}
 
+	_nvs_walk_unlock(fs);
+
 	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
 
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	rc = _nvs_gc_make_room(fs, data_size + ate_size);
+	if (rc) {
+		goto end;
+	}
+
+	rc = _nvs_flash_wrt_entry(fs, id, data, len);
+	if (rc) {
+		goto end;
+	}
+#else
 	gc_count = 0;
 	while (1) {
 		if (gc_count == fs->sector_count) {
@@ -814,10 +1478,15 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		}
 		gc_count++;
 	}
+#endif /* CONFIG_NVS_GC_INCREMENTAL */
 	rc = len;
 end:
 	k_mutex_unlock(&fs->nvs_lock);
 	return rc;
+
+unlock:
+	_nvs_walk_unlock(fs);
+	return rc;
 }
 
 int nvs_delete(struct nvs_fs *fs, u16_t id)
@@ -825,6 +1494,36 @@ int nvs_delete(struct nvs_fs *fs, u16_t id)
 	return nvs_write(fs, id, NULL, 0);
 }
 
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+int nvs_gc_step(struct nvs_fs *fs)
+{
+	int rc = 0;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+
+	for (int i = 0; i < CONFIG_NVS_GC_STEP_ATES; i++) {
+		if (fs->gc_addr == NVS_GC_IDLE) {
+			break;
+		}
+
+		rc = _nvs_gc_next(fs);
+		if (rc) {
+			goto end;
+		}
+	}
+
+	rc = (fs->gc_addr != NVS_GC_IDLE);
+end:
+	k_mutex_unlock(&fs->nvs_lock);
+	return rc;
+}
+#endif /* CONFIG_NVS_GC_INCREMENTAL */
+
 ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 		      u16_t cnt)
 {
@@ -845,6 +1544,21 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 		return -EINVAL;
 	}
 
+	_nvs_walk_lock(fs);
+
+	if (cnt == 0) {
+		/* latest entry, from the lookup cache if enabled */
+		rc = _nvs_latest_ate(fs, id, &rd_addr, &wlk_ate, true);
+		if (rc < 0) {
+			goto err;
+		}
+		if (rc || (wlk_ate.len == 0)) {
+			rc = -ENOENT;
+			goto err;
+		}
+		goto rd;
+	}
+
 	cnt_his = 0U;
 
 	wlk_addr = fs->ate_wra;
@@ -866,9 +1580,11 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 
 	if (((wlk_addr == fs->ate_wra) && (wlk_ate.id != id)) ||
 	    (wlk_ate.len == 0) || (cnt_his < cnt)) {
-		return -ENOENT;
+		rc = -ENOENT;
+		goto err;
 	}
 
+rd:
 	rd_addr &= ADDR_SECT_MASK;
 	rd_addr += wlk_ate.offset;
 	rc = _nvs_flash_rd(fs, rd_addr, data, MIN(len, wlk_ate.len));
@@ -876,9 +1592,10 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 		goto err;
 	}
 
-	return wlk_ate.len;
+	rc = wlk_ate.len;
 
 err:
+	_nvs_walk_unlock(fs);
 	return rc;
 }
 
@@ -910,12 +1627,21 @@ ssize_t nvs_calc_free_space(struct nvs_fs *fs)
 		free_space += (fs->sector_size - ate_size);
 	}
 
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	/* one more sector is kept empty */
+	if (fs->sector_count > NVS_GC_EMPTY_SECTORS) {
+		free_space -= (fs->sector_size - ate_size);
+	}
+#endif
+
+	_nvs_walk_lock(fs);
+
 	step_addr = fs->ate_wra;
 
 	while (1) {
 		rc = _nvs_prev_ate(fs, &step_addr, &step_ate);
 		if (rc) {
-			return rc;
+			goto end;
 		}
 
 		wlk_addr = fs->ate_wra;
@@ -923,7 +1649,7 @@ ssize_t nvs_calc_free_space(struct nvs_fs *fs)
 		while (1) {
 			rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
 			if (rc) {
-				return rc;
+				goto end;
 			}
 			if ((wlk_ate.id == step_ate.id) ||
 			    (wlk_addr == fs->ate_wra)) {
@@ -943,5 +1669,9 @@ ssize_t nvs_calc_free_space(struct nvs_fs *fs)
 		}
 
 	}
-	return free_space;
+
+	rc = free_space;
+end:
+	_nvs_walk_unlock(fs);
+	return rc;
 }
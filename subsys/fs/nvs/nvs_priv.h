@@ -28,6 +28,22 @@ extern "C" {
 
 #define NVS_BLOCK_SIZE 32
 
+/*
+ * Lookup cache, the ids are mapped to sets of NVS_LOOKUP_CACHE_WAYS entries.
+ * Unused entries have NVS_LOOKUP_CACHE_NO_ADDR, entries of ids known to have
+ * no allocation table entry have NVS_LOOKUP_CACHE_NO_ATE.
+ */
+#define NVS_LOOKUP_CACHE_WAYS 4
+#define NVS_LOOKUP_CACHE_NO_ADDR 0xFFFFFFFF
+#define NVS_LOOKUP_CACHE_NO_ATE 0xFFFFFFFE
+
+/*
+ * Incremental garbage collection, number of empty sectors kept after the
+ * write sector and gc_addr value when no sector is being collected
+ */
+#define NVS_GC_EMPTY_SECTORS 2
+#define NVS_GC_IDLE 0xFFFFFFFF
+
 /* Allocation Table Entry */
 struct nvs_ate {
 	u16_t id;	/* data id */
@@ -47,285 +47,104 @@ LOG_MODULE_REGISTER(net_conn, CONFIG_NET_CONN_LOG_LEVEL);
 
 static struct net_conn conns[CONFIG_NET_MAX_CONN];
 
-#if defined(CONFIG_NET_CONN_CACHE)
-
-/* Cache the connection so that we do not have to go
- * through the full list of connections when receiving
- * a network packet. The cache contains an index to
- * corresponding entry in conns array.
+/* Incoming packets are demultiplexed through two hash tables instead of
+ * walking all of conns[]:
  *
- * Hash value is constructed like this:
+ * - conn_exact holds fully specified connections (remote address, remote
+ *   port and local port set, e.g. TCP connections and connected UDP
+ *   sockets), hashed by protocol, remote address and both ports.
+ * - conn_wildcard holds connections with only a local port, e.g. bound
+ *   UDP sockets and TCP listeners, hashed by protocol and local port.
  *
- *   bit      description
- *   0  - 3   bits from remote port
- *   4  - 7   bits from local port
- *   8  - 18  bits from remote address
- *   19 - 29  bits from local address
- *   30       family
- *   31       protocol
+ * The remaining handlers (no local port, packet and CAN sockets) are kept
+ * in conn_any and are checked linearly, as before.
  */
-struct conn_hash {
-	u32_t value;
-	s32_t idx;
-};
-
-struct conn_hash_neg {
-	u32_t value;
-};
-
-/** Connection cache */
-static struct conn_hash conn_cache[CONFIG_NET_MAX_CONN];
-
-/** Negative cache, we definitely do not have a connection
- * to these hosts.
+BUILD_ASSERT_MSG((CONFIG_NET_CONN_HASH_SIZE &
+		  (CONFIG_NET_CONN_HASH_SIZE - 1)) == 0,
+		 "CONFIG_NET_CONN_HASH_SIZE must be a power of two");
+BUILD_ASSERT_MSG((CONFIG_NET_CONN_WILDCARD_HASH_SIZE &
+		  (CONFIG_NET_CONN_WILDCARD_HASH_SIZE - 1)) == 0,
+		 "CONFIG_NET_CONN_WILDCARD_HASH_SIZE must be a power of two");
+
+static sys_slist_t conn_exact[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_wildcard[CONFIG_NET_CONN_WILDCARD_HASH_SIZE];
+static sys_slist_t conn_any;
+
+/* Protects conns[] and the lookup lists. Handlers are called without it
+ * so that they can register and unregister connections.
  */
-static struct conn_hash_neg conn_cache_neg[CONFIG_NET_MAX_CONN];
+static K_MUTEX_DEFINE(conn_lock);
 
-#define TAKE_BIT(val, bit, max, used)				\
-	(((val & BIT(bit)) >> bit) << (max - used))
-
-static inline u8_t ports_to_hash(u16_t remote_port,
-				    u16_t local_port)
-{
-	/* Note that we do not convert port value to network byte order */
-	return (remote_port & BIT(0)) |
-		((remote_port & BIT(4)) >> 3) |
-		((remote_port & BIT(8)) >> 6) |
-		((remote_port & BIT(15)) >> 12) |
-		(((local_port & BIT(0)) |
-		  ((local_port & BIT(4)) >> 3) |
-		  ((local_port & BIT(8)) >> 6) |
-		  ((local_port & BIT(15)) >> 12)) << 4);
-}
+#define NET_RANK_EXACT (NET_RANK_REMOTE_SPEC_ADDR | NET_RANK_REMOTE_PORT | \
+			NET_RANK_LOCAL_PORT)
 
-static inline u16_t ipv6_to_hash(struct in6_addr *addr)
+static u32_t addr_to_hash(sa_family_t family, const void *addr)
 {
-	/* There is 11 bits available for IPv6 address */
-	/* Use more bits from the lower part of address space */
-	return
-		/* Take 3 bits from higher values */
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[0]), 31, 11, 1) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[0]), 15, 11, 2) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[0]), 7, 11, 3) |
-
-		/* Take 2 bits from higher middle values */
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[1]), 31, 11, 4) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[1]), 15, 11, 5) |
-
-		/* Take 2 bits from lower middle values */
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[2]), 31, 11, 6) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[2]), 15, 11, 7) |
-
-		/* Take 4 bits from lower values */
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[3]), 31, 11, 8) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[3]), 15, 11, 9) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[3]), 7, 11, 10) |
-		TAKE_BIT(UNALIGNED_GET(&addr->s6_addr32[3]), 0, 11, 11);
-}
-
-static inline u16_t ipv4_to_hash(struct in_addr *addr)
-{
-	/* There is 11 bits available for IPv4 address */
-	/* Use more bits from the lower part of address space */
-	return
-		TAKE_BIT(addr->s_addr, 31, 11, 1) |
-		TAKE_BIT(addr->s_addr, 27, 11, 2) |
-		TAKE_BIT(addr->s_addr, 21, 11, 3) |
-		TAKE_BIT(addr->s_addr, 17, 11, 4) |
-		TAKE_BIT(addr->s_addr, 14, 11, 5) |
-		TAKE_BIT(addr->s_addr, 11, 11, 6) |
-		TAKE_BIT(addr->s_addr, 8, 11, 7) |
-		TAKE_BIT(addr->s_addr, 5, 11, 8) |
-		TAKE_BIT(addr->s_addr, 3, 11, 9) |
-		TAKE_BIT(addr->s_addr, 2, 11, 10) |
-		TAKE_BIT(addr->s_addr, 0, 11, 11);
-}
-
-/* Return either the first free position in the cache (idx < 0) or
- * the existing cached position (idx >= 0)
- */
-static s32_t check_hash(enum net_ip_protocol proto,
-			  sa_family_t family,
-			  void *remote_addr,
-			  void *local_addr,
-			  u16_t remote_port,
-			  u16_t local_port,
-			  u32_t *cache_value)
-{
-	int i, free_pos = -1;
-	u32_t value = 0U;
-
-	value = ports_to_hash(remote_port, local_port);
-
-#if defined(CONFIG_NET_UDP)
-	if (proto == IPPROTO_UDP) {
-		value |= BIT(31);
-	}
-#endif
-
-#if defined(CONFIG_NET_TCP)
-	if (proto == IPPROTO_TCP) {
-		value &= ~BIT(31);
-	}
-#endif
-
-#if defined(CONFIG_NET_IPV6)
-	if (family == AF_INET6) {
-		value |= BIT(30);
-		value |= ipv6_to_hash((struct in6_addr *)remote_addr) << 8;
-		value |= ipv6_to_hash((struct in6_addr *)local_addr) << 19;
-	}
-#endif
+	if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
+		const struct in6_addr *addr6 = addr;
 
-#if defined(CONFIG_NET_IPV4)
-	if (family == AF_INET) {
-		value &= ~BIT(30);
-		value |= ipv4_to_hash((struct in_addr *)remote_addr) << 8;
-		value |= ipv4_to_hash((struct in_addr *)local_addr) << 19;
+		return UNALIGNED_GET(&addr6->s6_addr32[0]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[1]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[2]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[3]);
 	}
-#endif
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (conn_cache[i].value == value) {
-			return i;
-		}
-
-		if (conn_cache[i].idx < 0 && free_pos < 0) {
-			free_pos = i;
-		}
-	}
+	if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		const struct in_addr *addr4 = addr;
 
-	if (free_pos >= 0) {
-		conn_cache[free_pos].value = value;
-		return free_pos;
+		return UNALIGNED_GET(&addr4->s_addr);
 	}
 
-	*cache_value = value;
-
-	return -ENOENT;
+	return 0;
 }
 
-static inline s32_t get_conn(struct net_pkt *pkt,
-			     union net_ip_header *ip_hdr,
-			     enum net_ip_protocol proto,
-			     u16_t src_port,
-			     u16_t dst_port,
-			     u32_t *cache_value)
+/* Ports are in network byte order, as found in the packet */
+static inline sys_slist_t *exact_bucket(u16_t proto, sa_family_t family,
+					const void *remote_addr,
+					u16_t remote_port, u16_t local_port)
 {
-	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
-		return check_hash(proto, net_pkt_family(pkt),
-				  &ip_hdr->ipv4->src, &ip_hdr->ipv4->dst,
-				  src_port, dst_port, cache_value);
-	}
+	u32_t hash;
 
-	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
-		return check_hash(proto, net_pkt_family(pkt),
-				  &ip_hdr->ipv6->src, &ip_hdr->ipv6->dst,
-				  src_port, dst_port, cache_value);
-	}
+	hash = net_hash_mix(proto, addr_to_hash(family, remote_addr));
+	hash = net_hash_mix(hash, ((u32_t)remote_port << 16) | local_port);
 
-	return -1;
+	return &conn_exact[hash & (CONFIG_NET_CONN_HASH_SIZE - 1)];
 }
 
-static inline void cache_add_neg(u32_t cache_value)
+static inline sys_slist_t *wildcard_bucket(u16_t proto, u16_t local_port)
 {
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN && cache_value > 0; i++) {
-		if (conn_cache_neg[i].value) {
-			continue;
-		}
-
-		NET_DBG("Add to neg cache value 0x%x", cache_value);
+	u32_t hash = net_hash_mix(proto, local_port);
 
-		conn_cache_neg[i].value = cache_value;
-		break;
-	}
+	return &conn_wildcard[hash &
+			      (CONFIG_NET_CONN_WILDCARD_HASH_SIZE - 1)];
 }
 
-static inline bool cache_check_neg(u32_t cache_value)
+/* Return the lookup list a registered connection belongs to */
+static sys_slist_t *conn_list(struct net_conn *conn)
 {
-	int i;
+	if ((conn->rank & NET_RANK_EXACT) == NET_RANK_EXACT) {
+		sa_family_t family = conn->remote_addr.sa_family;
+		const void *addr;
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN && cache_value > 0; i++) {
-		if (conn_cache_neg[i].value == cache_value) {
-			NET_DBG("Cache neg [%d] value 0x%x found",
-				i, cache_value);
-			return true;
+		if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
+			addr = &net_sin6(&conn->remote_addr)->sin6_addr;
+		} else {
+			addr = &net_sin(&conn->remote_addr)->sin_addr;
 		}
-	}
 
-	return false;
-}
-
-static void cache_clear(void)
-{
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		conn_cache[i].idx = -1;
-		conn_cache_neg[i].value = 0U;
+		return exact_bucket(conn->proto, family, addr,
+				    net_sin(&conn->remote_addr)->sin_port,
+				    net_sin(&conn->local_addr)->sin_port);
 	}
-}
 
-static inline enum net_verdict cache_check(struct net_pkt *pkt,
-					   union net_ip_header *ip_hdr,
-					   union net_proto_header *proto_hdr,
-					   enum net_ip_protocol proto,
-					   u16_t src_port,
-					   u16_t dst_port,
-					   u32_t *cache_value,
-					   s32_t *pos)
-{
-	*pos = get_conn(pkt, ip_hdr, proto, src_port, dst_port, cache_value);
-	if (*pos >= 0) {
-		if (conn_cache[*pos].idx >= 0) {
-			/* Connection is in the cache */
-			struct net_conn *conn = &conns[conn_cache[*pos].idx];
-
-			NET_DBG("Cache %s listener for pkt %p src port %u "
-				"dst port %u family %d cache[%d] 0x%x",
-				net_proto2str(net_pkt_family(pkt), proto), pkt,
-				src_port, dst_port,
-				net_pkt_family(pkt), *pos,
-				conn_cache[*pos].value);
-
-			return conn->cb(conn, pkt,
-					ip_hdr, proto_hdr, conn->user_data);
-		}
-	} else if (*cache_value > 0) {
-		if (cache_check_neg(*cache_value)) {
-			NET_DBG("Drop by cache");
-			return NET_DROP;
-		}
+	if (conn->rank & NET_RANK_LOCAL_PORT) {
+		return wildcard_bucket(conn->proto,
+				       net_sin(&conn->local_addr)->sin_port);
 	}
 
-	return NET_CONTINUE;
+	return &conn_any;
 }
 
-static inline void cache_remove(struct net_conn *conn)
-{
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (conn_cache[i].idx < 0 ||
-		    conn_cache[i].idx >= CONFIG_NET_MAX_CONN) {
-			continue;
-		}
-
-		if (&conns[conn_cache[i].idx] == conn) {
-			conn_cache[i].idx = -1;
-			break;
-		}
-	}
-}
-#else
-#define cache_clear(...)
-#define cache_add_neg(...)
-#define cache_check(...) NET_CONTINUE
-#define cache_remove(...)
-#endif /* CONFIG_NET_CONN_CACHE */
-
 int net_conn_unregister(struct net_conn_handle *handle)
 {
 	struct net_conn *conn = (struct net_conn *)handle;
@@ -334,17 +153,22 @@ int net_conn_unregister(struct net_conn_handle *handle)
 		return -EINVAL;
 	}
 
+	k_mutex_lock(&conn_lock, K_FOREVER);
+
 	if (!(conn->flags & NET_CONN_IN_USE)) {
+		k_mutex_unlock(&conn_lock);
 		return -ENOENT;
 	}
 
-	cache_remove(conn);
+	sys_slist_find_and_remove(conn_list(conn), &conn->node);
 
 	NET_DBG("[%zu] connection handler %p removed",
 		conn - conns, conn);
 
 	(void)memset(conn, 0, sizeof(*conn));
 
+	k_mutex_unlock(&conn_lock);
+
 	return 0;
 }
 
@@ -357,7 +181,10 @@ int net_conn_change_callback(struct net_conn_handle *handle,
 		return -EINVAL;
 	}
 
+	k_mutex_lock(&conn_lock, K_FOREVER);
+
 	if (!(conn->flags & NET_CONN_IN_USE)) {
+		k_mutex_unlock(&conn_lock);
 		return -ENOENT;
 	}
 
@@ -367,6 +194,8 @@ int net_conn_change_callback(struct net_conn_handle *handle,
 	conn->cb = cb;
 	conn->user_data = user_data;
 
+	k_mutex_unlock(&conn_lock);
+
 	return 0;
 }
 
@@ -535,14 +364,14 @@ static int find_conn_handler(u16_t proto, u8_t family,
 	return -ENOENT;
 }
 
-int net_conn_register(u16_t proto, u8_t family,
-		      const struct sockaddr *remote_addr,
-		      const struct sockaddr *local_addr,
-		      u16_t remote_port,
-		      u16_t local_port,
-		      net_conn_cb_t cb,
-		      void *user_data,
-		      struct net_conn_handle **handle)
+static int register_conn(u16_t proto, u8_t family,
+			 const struct sockaddr *remote_addr,
+			 const struct sockaddr *local_addr,
+			 u16_t remote_port,
+			 u16_t local_port,
+			 net_conn_cb_t cb,
+			 void *user_data,
+			 struct net_conn_handle **handle)
 {
 	int i;
 	u8_t rank = 0U;
@@ -659,8 +488,7 @@ int net_conn_register(u16_t proto, u8_t family,
 		conns[i].proto = proto;
 		conns[i].family = family;
 
-		/* Cache needs to be cleared if new entries are added. */
-		cache_clear();
+		sys_slist_append(conn_list(&conns[i]), &conns[i].node);
 
 		if (CONFIG_NET_CONN_LOG_LEVEL >= LOG_LEVEL_DBG) {
 			char dst[NET_IPV6_ADDR_LEN];
@@ -690,6 +518,25 @@ int net_conn_register(u16_t proto, u8_t family,
 	return -ENOENT;
 }
 
+int net_conn_register(u16_t proto, u8_t family,
+		      const struct sockaddr *remote_addr,
+		      const struct sockaddr *local_addr,
+		      u16_t remote_port,
+		      u16_t local_port,
+		      net_conn_cb_t cb,
+		      void *user_data,
+		      struct net_conn_handle **handle)
+{
+	int ret;
+
+	k_mutex_lock(&conn_lock, K_FOREVER);
+	ret = register_conn(proto, family, remote_addr, local_addr,
+			    remote_port, local_port, cb, user_data, handle);
+	k_mutex_unlock(&conn_lock);
+
+	return ret;
+}
+
 static bool check_addr(struct net_pkt *pkt,
 		       union net_ip_header *ip_hdr,
 		       struct sockaddr *addr,
@@ -797,21 +644,158 @@ static bool is_invalid_packet(struct net_pkt *pkt,
 	return true;
 }
 
+static bool conn_matches(struct net_conn *conn, struct net_pkt *pkt,
+			 union net_ip_header *ip_hdr, u8_t proto,
+			 u16_t src_port, u16_t dst_port)
+{
+	if (conn->proto != proto) {
+		return false;
+	}
+
+	if (conn->family != AF_UNSPEC &&
+	    conn->family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (!IS_ENABLED(CONFIG_NET_UDP) && !IS_ENABLED(CONFIG_NET_TCP)) {
+		return true;
+	}
+
+	if (net_sin(&conn->remote_addr)->sin_port &&
+	    net_sin(&conn->remote_addr)->sin_port != src_port) {
+		return false;
+	}
+
+	if (net_sin(&conn->local_addr)->sin_port &&
+	    net_sin(&conn->local_addr)->sin_port != dst_port) {
+		return false;
+	}
+
+	if ((conn->flags & NET_CONN_REMOTE_ADDR_SET) &&
+	    !check_addr(pkt, ip_hdr, &conn->remote_addr, true)) {
+		return false;
+	}
+
+	if ((conn->flags & NET_CONN_LOCAL_ADDR_SET) &&
+	    !check_addr(pkt, ip_hdr, &conn->local_addr, false)) {
+		return false;
+	}
+
+	return true;
+}
+
+/* Pick the most specific of the matching handlers in a lookup list.
+ * Returns the number of list entries examined.
+ */
+static int match_list(sys_slist_t *list, struct net_pkt *pkt,
+		      union net_ip_header *ip_hdr, u8_t proto,
+		      u16_t src_port, u16_t dst_port,
+		      struct net_conn **best_match)
+{
+	struct net_conn *conn;
+	int len = 0;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
+		len++;
+
+		if (!conn_matches(conn, pkt, ip_hdr, proto, src_port,
+				  dst_port)) {
+			continue;
+		}
+
+		if (!IS_ENABLED(CONFIG_NET_UDP) &&
+		    !IS_ENABLED(CONFIG_NET_TCP)) {
+			*best_match = conn;
+			continue;
+		}
+
+		/* If we have an existing best_match, and that one
+		 * specifies a remote port, then we've matched to a
+		 * LISTENING connection that should not override.
+		 */
+		if (*best_match &&
+		    net_sin(&(*best_match)->remote_addr)->sin_port) {
+			continue;
+		}
+
+		if (!*best_match || (*best_match)->rank < conn->rank) {
+			*best_match = conn;
+		}
+	}
+
+	return len;
+}
+
+static struct net_conn *find_best_match(struct net_pkt *pkt,
+					union net_ip_header *ip_hdr,
+					u8_t proto, u16_t src_port,
+					u16_t dst_port)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+	struct net_conn *best_match = NULL;
+	int len = 0;
+
+	ARG_UNUSED(iface);
+
+	if ((IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) ||
+	    (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP)) {
+		sa_family_t family = net_pkt_family(pkt);
+		void *src = NULL;
+
+		if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
+			src = &ip_hdr->ipv6->src;
+		} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+			src = &ip_hdr->ipv4->src;
+		}
+
+		/* A fully specified connection ranks above any wildcard
+		 * one, so an exact match ends the lookup.
+		 */
+		if (src) {
+			len += match_list(exact_bucket(proto, family, src,
+						       src_port, dst_port),
+					  pkt, ip_hdr, proto, src_port,
+					  dst_port, &best_match);
+			if (best_match) {
+				net_stats_update_conn_hit(iface);
+				net_stats_update_conn_chain(iface, len);
+				return best_match;
+			}
+		}
+
+		len += match_list(wildcard_bucket(proto, dst_port), pkt,
+				  ip_hdr, proto, src_port, dst_port,
+				  &best_match);
+	}
+
+	len += match_list(&conn_any, pkt, ip_hdr, proto, src_port, dst_port,
+			  &best_match);
+
+	if ((IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) ||
+	    (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP)) {
+		if (best_match) {
+			net_stats_update_conn_wildcard(iface);
+		} else {
+			net_stats_update_conn_miss(iface);
+		}
+
+		net_stats_update_conn_chain(iface, len);
+	}
+
+	return best_match;
+}
+
 enum net_verdict net_conn_input(struct net_pkt *pkt,
 				union net_ip_header *ip_hdr,
 				u8_t proto,
 				union net_proto_header *proto_hdr)
 {
 	struct net_if *pkt_iface = net_pkt_iface(pkt);
-	int i, best_match = -1;
-	s16_t best_rank = -1;
+	struct net_conn *best_match;
+	net_conn_cb_t cb;
+	void *user_data;
 	u16_t src_port;
 	u16_t dst_port;
-#if defined(CONFIG_NET_CONN_CACHE)
-	enum net_verdict verdict;
-	u32_t cache_value = 0U;
-	s32_t pos;
-#endif
 
 	if (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) {
 		src_port = proto_hdr->udp->src_port;
@@ -842,113 +826,29 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		return NET_DROP;
 	}
 
-	/* TODO : Make core part of networing subsystem less depedant on
-	 * UDP, TCP, IPv4 or IPv6. So that we can add new features with
-	 * less dependency.
-	 */
-#if defined(CONFIG_NET_CONN_CACHE) && \
-	(defined(CONFIG_NET_UDP) || defined(CONFIG_NET_TCP))
-	verdict = cache_check(pkt, ip_hdr, proto_hdr, proto, src_port, dst_port,
-			      &cache_value, &pos);
-	if (verdict != NET_CONTINUE) {
-		return verdict;
-	}
-#endif
-
 	NET_DBG("Check %s listener for pkt %p src port %u dst port %u"
 		" family %d", net_proto2str(net_pkt_family(pkt), proto), pkt,
 		ntohs(src_port), ntohs(dst_port), net_pkt_family(pkt));
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (!(conns[i].flags & NET_CONN_IN_USE)) {
-			continue;
-		}
+	k_mutex_lock(&conn_lock, K_FOREVER);
 
-		if (conns[i].proto != proto) {
-			continue;
-		}
-
-		if (conns[i].family != AF_UNSPEC &&
-		    conns[i].family != net_pkt_family(pkt)) {
-			continue;
-		}
+	best_match = find_best_match(pkt, ip_hdr, proto, src_port, dst_port);
+	if (best_match) {
+		/* The handler may unregister itself, so do not use
+		 * best_match after releasing the lock.
+		 */
+		cb = best_match->cb;
+		user_data = best_match->user_data;
 
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
-			if (net_sin(&conns[i].remote_addr)->sin_port) {
-				if (net_sin(&conns[i].remote_addr)->sin_port !=
-				    src_port) {
-					continue;
-				}
-			}
-
-			if (net_sin(&conns[i].local_addr)->sin_port) {
-				if (net_sin(&conns[i].local_addr)->sin_port !=
-				    dst_port) {
-					continue;
-				}
-			}
-
-			if (conns[i].flags & NET_CONN_REMOTE_ADDR_SET) {
-				if (!check_addr(pkt, ip_hdr,
-						&conns[i].remote_addr,
-						true)) {
-					continue;
-				}
-			}
-
-			if (conns[i].flags & NET_CONN_LOCAL_ADDR_SET) {
-				if (!check_addr(pkt, ip_hdr,
-						&conns[i].local_addr,
-						false)) {
-					continue;
-				}
-			}
+		NET_DBG("[%zu] match found cb %p ud %p rank 0x%02x",
+			best_match - conns, cb, user_data, best_match->rank);
+	}
 
-			/* If we have an existing best_match, and that one
-			 * specifies a remote port, then we've matched to a
-			 * LISTENING connection that should not override.
-			 */
-			if (best_match >= 0 &&
-			    net_sin(&conns[best_match].remote_addr)->sin_port) {
-				continue;
-			}
+	k_mutex_unlock(&conn_lock);
 
-			if (best_rank < conns[i].rank) {
-				best_rank = conns[i].rank;
-				best_match = i;
-			}
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET)) {
-			best_rank = 0;
-			best_match = i;
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
-			best_rank = 0;
-			best_match = i;
-		}
-	}
-
-	if (best_match >= 0) {
-#if defined(CONFIG_NET_CONN_CACHE)
-		NET_DBG("[%d] match found cb %p ud %p rank 0x%02x cache 0x%x",
-			best_match,
-			conns[best_match].cb,
-			conns[best_match].user_data,
-			conns[best_match].rank,
-			pos < 0 ? 0 : conn_cache[pos].value);
-
-		if (pos >= 0) {
-			conn_cache[pos].idx = best_match;
-		}
-#else
-		NET_DBG("[%d] match found cb %p ud %p rank 0x%02x",
-			best_match,
-			conns[best_match].cb,
-			conns[best_match].user_data,
-			conns[best_match].rank);
-#endif /* CONFIG_NET_CONN_CACHE */
-
-		if (conns[best_match].cb(&conns[best_match], pkt, ip_hdr,
-			proto_hdr, conns[best_match].user_data) == NET_DROP) {
+	if (best_match) {
+		if (cb(best_match, pkt, ip_hdr, proto_hdr,
+		       user_data) == NET_DROP) {
 			goto drop;
 		}
 
@@ -959,8 +859,6 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 
 	NET_DBG("No match found.");
 
-	cache_add_neg(cache_value);
-
 	/* If the destination address is multicast address,
 	 * we will not send an ICMP error as that makes no sense.
 	 */
@@ -993,6 +891,8 @@ void net_conn_foreach(net_conn_foreach_cb_t cb, void *user_data)
 {
 	int i;
 
+	k_mutex_lock(&conn_lock, K_FOREVER);
+
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
 		if (!(conns[i].flags & NET_CONN_IN_USE)) {
 			continue;
@@ -1000,17 +900,21 @@ void net_conn_foreach(net_conn_foreach_cb_t cb, void *user_data)
 
 		cb(&conns[i], user_data);
 	}
+
+	k_mutex_unlock(&conn_lock);
 }
 
 void net_conn_init(void)
 {
-#if defined(CONFIG_NET_CONN_CACHE)
-	do {
-		int i;
+	int i;
 
-		for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-			conn_cache[i].idx = -1;
-		}
-	} while (0);
-#endif /* CONFIG_NET_CONN_CACHE */
+	for (i = 0; i < ARRAY_SIZE(conn_exact); i++) {
+		sys_slist_init(&conn_exact[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(conn_wildcard); i++) {
+		sys_slist_init(&conn_wildcard[i]);
+	}
+
+	sys_slist_init(&conn_any);
 }
@@ -219,6 +219,18 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	net_pkt_set_family(pkt, PF_INET);
 
+	if (net_ipv4_is_fragment(hdr)) {
+		/* Fragments are held until the whole datagram is present,
+		 * which is then passed to net_ipv4_input() again.
+		 */
+		verdict = net_ipv4_handle_fragment_hdr(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	net_pkt_acknowledge_data(pkt, &ipv4_access);
 
 	switch (hdr->proto) {
@@ -247,6 +259,11 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	ip.ipv4 = hdr;
 
+	if (hdr->proto == IPPROTO_TCP &&
+	    net_tcp_gro_receive(pkt, &ip, &proto_hdr) == NET_OK) {
+		return NET_OK;
+	}
+
 	verdict = net_conn_input(pkt, &ip, hdr->proto, &proto_hdr);
 	if (verdict != NET_DROP) {
 		return verdict;
@@ -22,6 +22,11 @@
 
 #include "ipv4.h"
 
+/* Flags and fragment offset field of the IPv4 header, in host order */
+#define NET_IPV4_DF  0x4000 /* Don't fragment */
+#define NET_IPV4_MF  0x2000 /* More fragments */
+#define NET_IPV4_FRAG_OFFSET_MASK 0x1fff
+
 /**
  * @brief Create IPv4 packet in provided net_pkt.
  *
@@ -66,4 +71,142 @@ int net_ipv4_create_new(struct net_pkt *pkt,
  */
 int net_ipv4_finalize(struct net_pkt *pkt, u8_t next_header_proto);
 
+/**
+ * @brief Get the flags and fragment offset field of an IPv4 header.
+ *
+ * @param hdr IPv4 header
+ *
+ * @return The field in host byte order.
+ */
+static inline u16_t net_ipv4_get_frag_field(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->offset[0] << 8) | hdr->offset[1];
+}
+
+/**
+ * @brief Check if an IPv4 packet is a fragment of a larger packet.
+ *
+ * @param hdr IPv4 header
+ *
+ * @return True if more fragments follow or the fragment offset is not 0.
+ */
+static inline bool net_ipv4_is_fragment(struct net_ipv4_hdr *hdr)
+{
+	return (net_ipv4_get_frag_field(hdr) &
+		(NET_IPV4_MF | NET_IPV4_FRAG_OFFSET_MASK)) != 0;
+}
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+#define NET_IPV4_FRAGMENTS_MAX_PKT CONFIG_NET_IPV4_FRAGMENT_MAX_PKT
+#else
+#define NET_IPV4_FRAGMENTS_MAX_PKT 1
+#endif
+
+/** Store pending IPv4 fragment information that is needed for reassembly. */
+struct net_ipv4_reassembly {
+	/** IPv4 source address of the fragment */
+	struct in_addr src;
+
+	/** IPv4 destination address of the fragment */
+	struct in_addr dst;
+
+	/** Timeout for cancelling the reassembly. */
+	struct k_delayed_work timer;
+
+	/**
+	 * Pending fragments, sorted by fragment offset. The slot is in use
+	 * if the first entry is set.
+	 */
+	struct net_pkt *pkt[NET_IPV4_FRAGMENTS_MAX_PKT];
+
+	/** Length of the reassembled payload, 0 until the last fragment
+	 * has been received.
+	 */
+	u16_t total_len;
+
+	/** IPv4 fragment identification */
+	u16_t id;
+
+	/** Upper layer protocol of the fragmented packet */
+	u8_t protocol;
+};
+
+/**
+ * @typedef net_ipv4_frag_cb_t
+ * @brief Callback used while iterating over pending IPv4 fragments.
+ *
+ * @param reass IPv4 fragment reassembly struct
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_ipv4_frag_cb_t)(struct net_ipv4_reassembly *reass,
+				   void *user_data);
+
+/**
+ * @brief Go through all the currently pending IPv4 fragments.
+ *
+ * @param cb Callback to call for each pending IPv4 fragment.
+ * @param user_data User specified data or NULL.
+ */
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data);
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+/**
+ * @brief Handles IPv4 fragmented packets.
+ *
+ * The fragment is stored until all the fragments of the packet have been
+ * received. The reassembled packet is then fed back to the IP stack.
+ *
+ * @param pkt Network packet containing the fragment
+ * @param hdr The IPv4 header of the fragment
+ *
+ * @return Return verdict about the packet
+ */
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr);
+
+/**
+ * @brief Split an IPv4 packet that does not fit the interface MTU
+ * into fragments and send them.
+ *
+ * @param iface Network interface the packet is sent to
+ * @param pkt Network packet to fragment, it is not released
+ * @param pkt_len Length of the packet
+ *
+ * @return 0 on success, negative errno otherwise.
+ */
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 u16_t pkt_len);
+
+/**
+ * @brief Fragment the IPv4 packet if it is larger than the interface MTU.
+ *
+ * @param pkt Network packet
+ *
+ * @return NET_OK if the packet can be sent as is, NET_CONTINUE if it was
+ * fragmented and its fragments sent instead, NET_DROP on error.
+ */
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt);
+
+void net_ipv4_frag_init(void);
+#else
+static inline
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+
+static inline enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return NET_OK;
+}
+
+#define net_ipv4_frag_init(...)
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #endif /* __IPV4_H */
@@ -0,0 +1,612 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <misc/byteorder.h>
+#include <random/rand32.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include "net_private.h"
+#include "ipv4.h"
+#include "net_stats.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+/* Timeout for the allocation of an outgoing fragment. */
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+/* Protects the reassembly slots which are accessed both from the RX path
+ * and from the reassembly timeout handler.
+ */
+static K_MUTEX_DEFINE(reassembly_lock);
+
+static atomic_t fragment_id;
+
+static inline u16_t frag_payload_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt);
+}
+
+static inline u16_t frag_end(struct net_pkt *pkt)
+{
+	return net_pkt_ipv4_fragment_offset(pkt) + frag_payload_len(pkt);
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	int i, len;
+
+	for (i = 0, len = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			len += net_pkt_get_len(reass->pkt[i]);
+		}
+	}
+
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms len %d", str, reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		k_delayed_work_remaining_get(&reass->timer), len);
+}
+
+static void reassembly_cancel(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] IPv4 reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reass->total_len = 0U;
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_ipv4_reassembly *reass =
+		CONTAINER_OF(work, struct net_ipv4_reassembly, timer);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	/* The slot might have been completed, or re-armed for a new
+	 * datagram, while we were waiting for the lock.
+	 */
+	if (reass->pkt[0] && !k_delayed_work_remaining_get(&reass->timer)) {
+		reassembly_info("Reassembly cancelled", reass);
+
+		net_stats_update_ipv4_frag_timeout(
+					net_pkt_iface(reass->pkt[0]));
+
+		reassembly_cancel(reass);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+static struct net_ipv4_reassembly *reassembly_get(u16_t id,
+						  struct in_addr *src,
+						  struct in_addr *dst,
+						  u8_t protocol)
+{
+	struct net_ipv4_reassembly *avail = NULL;
+	struct net_ipv4_reassembly *oldest = NULL;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		struct net_ipv4_reassembly *reass = &reassembly[i];
+
+		if (!reass->pkt[0]) {
+			if (!avail) {
+				avail = reass;
+			}
+
+			continue;
+		}
+
+		if (reass->id == id && reass->protocol == protocol &&
+		    net_ipv4_addr_cmp(src, &reass->src) &&
+		    net_ipv4_addr_cmp(dst, &reass->dst)) {
+			return reass;
+		}
+
+		if (!oldest || k_delayed_work_remaining_get(&reass->timer) <
+			       k_delayed_work_remaining_get(&oldest->timer)) {
+			oldest = reass;
+		}
+	}
+
+	if (!avail) {
+		/* All slots are busy, give up on the datagram that is the
+		 * closest to its timeout instead of dropping the new one.
+		 */
+		reassembly_info("Reassembly evicted", oldest);
+
+		net_stats_update_ipv4_frag_timeout(
+					net_pkt_iface(oldest->pkt[0]));
+
+		reassembly_cancel(oldest);
+		avail = oldest;
+	}
+
+	net_ipaddr_copy(&avail->src, src);
+	net_ipaddr_copy(&avail->dst, dst);
+	avail->id = id;
+	avail->protocol = protocol;
+	avail->total_len = 0U;
+
+	k_delayed_work_submit(&avail->timer, IPV4_REASSEMBLY_TIMEOUT);
+
+	return avail;
+}
+
+/* Store the fragment so that the list stays sorted by fragment offset. */
+static int fragment_insert(struct net_ipv4_reassembly *reass,
+			   struct net_pkt *pkt)
+{
+	u16_t offset = net_pkt_ipv4_fragment_offset(pkt);
+	int i;
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT && reass->pkt[i]; i++) {
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[i]) >= offset) {
+			break;
+		}
+	}
+
+	if (i < NET_IPV4_FRAGMENTS_MAX_PKT && reass->pkt[i] &&
+	    net_pkt_ipv4_fragment_offset(reass->pkt[i]) == offset &&
+	    frag_payload_len(reass->pkt[i]) == frag_payload_len(pkt)) {
+		return -EEXIST;
+	}
+
+	/* Overlapping fragments are not accepted, see RFC 1858 */
+	if ((i > 0 && frag_end(reass->pkt[i - 1]) > offset) ||
+	    (i < NET_IPV4_FRAGMENTS_MAX_PKT && reass->pkt[i] &&
+	     net_pkt_ipv4_fragment_offset(reass->pkt[i]) < frag_end(pkt))) {
+		return -EINVAL;
+	}
+
+	if (reass->pkt[NET_IPV4_FRAGMENTS_MAX_PKT - 1]) {
+		return -ENOMEM;
+	}
+
+	memmove(&reass->pkt[i + 1], &reass->pkt[i],
+		(NET_IPV4_FRAGMENTS_MAX_PKT - 1 - i) * sizeof(reass->pkt[0]));
+	reass->pkt[i] = pkt;
+
+	return 0;
+}
+
+static struct net_pkt *fragment_last(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	for (i = NET_IPV4_FRAGMENTS_MAX_PKT - 1; i > 0; i--) {
+		if (reass->pkt[i]) {
+			break;
+		}
+	}
+
+	return reass->pkt[i];
+}
+
+static bool fragments_complete(struct net_ipv4_reassembly *reass)
+{
+	u16_t next = 0U;
+	int i;
+
+	if (!reass->total_len) {
+		return false;
+	}
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT && reass->pkt[i]; i++) {
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[i]) != next) {
+			return false;
+		}
+
+		next = frag_end(reass->pkt[i]);
+	}
+
+	return next == reass->total_len;
+}
+
+static struct net_pkt *reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	struct net_buf *last;
+	int i;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	NET_ASSERT(reass->pkt[0]);
+
+	pkt = reass->pkt[0];
+	last = net_buf_frag_last(pkt->buffer);
+
+	/* The IPv4 header of the 1st fragment is kept, the payload of the
+	 * following fragments is appended to it without copying.
+	 */
+	for (i = 1; i < NET_IPV4_FRAGMENTS_MAX_PKT && reass->pkt[i]; i++) {
+		struct net_pkt *frag = reass->pkt[i];
+
+		net_pkt_cursor_init(frag);
+
+		if (net_pkt_pull(frag, net_pkt_ip_hdr_len(frag))) {
+			NET_ERR("Failed to pull headers");
+			reassembly_cancel(reass);
+			return NULL;
+		}
+
+		last->frags = frag->buffer;
+		last = net_buf_frag_last(frag->buffer);
+
+		frag->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(frag);
+	}
+
+	reass->pkt[0] = NULL;
+	reass->total_len = 0U;
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt, &ipv4_access);
+	if (!hdr) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->offset[0] = 0U;
+	hdr->offset[1] = 0U;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	net_pkt_set_ipv4_fragment_offset(pkt, 0);
+	net_pkt_set_ipv4_reassembled(pkt, true);
+
+	net_pkt_cursor_init(pkt);
+
+	net_stats_update_ipv4_frag_reassembled(net_pkt_iface(pkt));
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt, net_pkt_get_len(pkt));
+
+	return pkt;
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass;
+	u16_t frag = net_ipv4_get_frag_field(hdr);
+	bool more = frag & NET_IPV4_MF;
+	u8_t hdr_len = (hdr->vhl & 0x0f) * 4U;
+	u16_t offset, len;
+	int ret;
+
+	net_stats_update_ipv4_frag_recv(net_pkt_iface(pkt));
+
+	if (hdr_len < NET_IPV4H_LEN || net_pkt_get_len(pkt) <= hdr_len) {
+		goto drop;
+	}
+
+	offset = (frag & NET_IPV4_FRAG_OFFSET_MASK) * 8U;
+	len = net_pkt_get_len(pkt) - hdr_len;
+
+	/* All the fragments but the last one carry a multiple of 8 bytes,
+	 * and the reassembled packet must still fit the total length field.
+	 */
+	if ((more && (len % 8)) || (u32_t)offset + len + hdr_len > 0xffff) {
+		NET_DBG("Invalid fragment offset %u len %u", offset, len);
+		goto drop;
+	}
+
+	net_pkt_set_ip_hdr_len(pkt, hdr_len);
+	net_pkt_set_ipv4_fragment_offset(pkt, offset);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	reass = reassembly_get((hdr->id[0] << 8) | hdr->id[1],
+			       &hdr->src, &hdr->dst, hdr->proto);
+
+	ret = fragment_insert(reass, pkt);
+	if (ret == -EEXIST) {
+		NET_DBG("Duplicate fragment offset %u", offset);
+		k_mutex_unlock(&reassembly_lock);
+		goto drop;
+	} else if (ret < 0) {
+		reassembly_info(ret == -ENOMEM ? "Too many fragments" :
+				"Overlapping fragment", reass);
+		reassembly_cancel(reass);
+		k_mutex_unlock(&reassembly_lock);
+		goto drop;
+	}
+
+	if (!more) {
+		if (reass->total_len && reass->total_len != offset + len) {
+			goto cancel;
+		}
+
+		reass->total_len = offset + len;
+	}
+
+	if (reass->total_len &&
+	    frag_end(fragment_last(reass)) > reass->total_len) {
+		goto cancel;
+	}
+
+	if (!fragments_complete(reass)) {
+		reassembly_info("Reassembly pending", reass);
+		k_mutex_unlock(&reassembly_lock);
+		return NET_OK;
+	}
+
+	pkt = reassemble_packet(reass);
+
+	k_mutex_unlock(&reassembly_lock);
+
+	if (pkt && net_recv_data(net_pkt_iface(pkt), pkt) < 0) {
+		net_pkt_unref(pkt);
+	}
+
+	return NET_OK;
+
+cancel:
+	/* The fragment is already stored, so it is released together with
+	 * the rest of the datagram.
+	 */
+	reassembly_info("Inconsistent fragment length", reass);
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+	reassembly_cancel(reass);
+	k_mutex_unlock(&reassembly_lock);
+
+	return NET_OK;
+
+drop:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+
+	return NET_DROP;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, u8_t hdr_len,
+			      u16_t fit_len, u16_t frag_offset, u16_t id,
+			      bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	int ret = -ENOBUFS;
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *frag_pkt;
+	u16_t frag;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     hdr_len + fit_len,
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	/* Each fragment starts with a copy of the original header followed
+	 * by its part of the payload.
+	 */
+	if (net_pkt_copy(frag_pkt, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(frag_pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(frag_pkt,
+							  &ipv4_access);
+	if (!hdr) {
+		goto fail;
+	}
+
+	frag = (frag_offset / 8U) | (final ? 0 : NET_IPV4_MF);
+
+	hdr->len = htons(hdr_len + fit_len);
+	hdr->id[0] = id >> 8;
+	hdr->id[1] = id;
+	hdr->offset[0] = frag >> 8;
+	hdr->offset[1] = frag;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, hdr_len);
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	net_pkt_cursor_init(frag_pkt);
+
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_stats_update_ipv4_frag_sent(net_pkt_iface(pkt));
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 u16_t pkt_len)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	u16_t frag_offset;
+	u16_t length;
+	u16_t mtu;
+	u8_t hdr_len;
+	u16_t id;
+	int fit_len;
+	int ret;
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt, &ipv4_access);
+	if (!hdr) {
+		return -ENOBUFS;
+	}
+
+	if (net_ipv4_get_frag_field(hdr) & NET_IPV4_DF) {
+		NET_DBG("DF set, cannot fragment %u bytes", pkt_len);
+		return -EMSGSIZE;
+	}
+
+	hdr_len = (hdr->vhl & 0x0f) * 4U;
+
+	mtu = net_if_get_mtu(iface);
+	if (!mtu) {
+		mtu = NET_IPV4_MTU;
+	}
+
+	/* The payload of every fragment but the last one must be a
+	 * multiple of 8 bytes.
+	 */
+	fit_len = (mtu - hdr_len) & ~7;
+	if (fit_len <= 0 || pkt_len <= hdr_len) {
+		NET_DBG("No room for IPv4 payload MTU %d hdr_len %d",
+			mtu, hdr_len);
+		return -EINVAL;
+	}
+
+	id = (u16_t)atomic_inc(&fragment_id);
+
+	frag_offset = 0U;
+	length = pkt_len - hdr_len;
+
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, hdr_len, fit_len, frag_offset,
+					 id, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+	size_t pkt_len = net_pkt_get_len(pkt);
+	u16_t mtu = net_if_get_mtu(iface);
+	int ret;
+
+	/* Oversized TCP segments are split by L2 instead */
+	if (!mtu || pkt_len <= mtu || net_pkt_gso_size(pkt)) {
+		return NET_OK;
+	}
+
+	ret = net_ipv4_send_fragmented_pkt(iface, pkt, pkt_len);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			return NET_OK;
+		}
+
+		return NET_DROP;
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet sending. */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments will be sent separately to network.
+	 */
+	return NET_CONTINUE;
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!reassembly[i].pkt[0]) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+void net_ipv4_frag_init(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		k_delayed_work_init(&reassembly[i].timer, reassembly_timeout);
+	}
+
+	atomic_set(&fragment_id, sys_rand32_get());
+}
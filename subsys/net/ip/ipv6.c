@@ -584,6 +584,11 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 	ip.ipv6 = hdr;
 
+	if (nexthdr == IPPROTO_TCP &&
+	    net_tcp_gro_receive(pkt, &ip, &proto_hdr) == NET_OK) {
+		return NET_OK;
+	}
+
 	verdict = net_conn_input(pkt, &ip, nexthdr, &proto_hdr);
 	if (verdict != NET_DROP) {
 		return verdict;
@@ -660,9 +660,10 @@ enum net_verdict net_ipv6_prepare_for_send(struct net_pkt *pkt)
 
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 	/* If we have already fragmented the packet, the fragment id will
-	 * contain a proper value and we can skip other checks.
+	 * contain a proper value and we can skip other checks. Oversized
+	 * TCP segments are split by L2 instead.
 	 */
-	if (net_pkt_ipv6_fragment_id(pkt) == 0) {
+	if (net_pkt_ipv6_fragment_id(pkt) == 0 && !net_pkt_gso_size(pkt)) {
 		size_t pkt_len = net_pkt_get_len(pkt);
 
 		if (pkt_len > NET_IPV6_MTU) {
@@ -1493,10 +1493,36 @@ static int get_context_timepstamp(struct net_context *context,
 #endif
 }
 
+static int context_write_data(struct net_pkt *pkt, const void *buf,
+			      size_t buf_len, const struct msghdr *msghdr)
+{
+	size_t i, len;
+	int ret;
+
+	if (!msghdr) {
+		return net_pkt_write_new(pkt, buf, buf_len);
+	}
+
+	/* buf_len may have been cut down to what fits in the packet */
+	for (i = 0; i < msghdr->msg_iovlen && buf_len; i++) {
+		len = MIN(msghdr->msg_iov[i].iov_len, buf_len);
+
+		ret = net_pkt_write_new(pkt, msghdr->msg_iov[i].iov_base, len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		buf_len -= len;
+	}
+
+	return 0;
+}
+
 static int context_setup_udp_packet(struct net_context *context,
 				    struct net_pkt *pkt,
 				    const void *buf,
 				    size_t len,
+				    const struct msghdr *msghdr,
 				    const struct sockaddr *dst_addr,
 				    socklen_t addrlen)
 {
@@ -1538,7 +1564,7 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = net_pkt_write_new(pkt, buf, len);
+	ret = context_write_data(pkt, buf, len, msghdr);
 	if (ret) {
 		return ret;
 	}
@@ -1567,6 +1593,7 @@ static void context_finalize_packet(struct net_context *context,
 static int context_sendto_new(struct net_context *context,
 			      const void *buf,
 			      size_t len,
+			      const struct msghdr *msghdr,
 			      const struct sockaddr *dst_addr,
 			      socklen_t addrlen,
 			      net_context_send_cb_t cb,
@@ -1703,7 +1730,7 @@ static int context_sendto_new(struct net_context *context,
 
 	if (IS_ENABLED(CONFIG_NET_UDP) &&
 	    net_context_get_ip_proto(context) == IPPROTO_UDP) {
-		ret = context_setup_udp_packet(context, pkt, buf, len,
+		ret = context_setup_udp_packet(context, pkt, buf, len, msghdr,
 					       dst_addr, addrlen);
 		if (ret < 0) {
 			goto fail;
@@ -1714,7 +1741,7 @@ static int context_sendto_new(struct net_context *context,
 		ret = net_send_data(pkt);
 	} else if (IS_ENABLED(CONFIG_NET_TCP) &&
 		   net_context_get_ip_proto(context) == IPPROTO_TCP) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1728,7 +1755,7 @@ static int context_sendto_new(struct net_context *context,
 		ret = net_tcp_send_data(context, cb, token, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1739,7 +1766,7 @@ static int context_sendto_new(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN &&
 		   net_context_get_ip_proto(context) == CAN_RAW) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1764,43 +1791,53 @@ fail:
 	return ret;
 }
 
-int net_context_send_new(struct net_context *context,
-			 const void *buf,
-			 size_t len,
-			 net_context_send_cb_t cb,
-			 s32_t timeout,
-			 void *token,
-			 void *user_data)
+/* Destination address length of a connected context */
+static int context_remote_addrlen(struct net_context *context,
+				  socklen_t *addrlen)
 {
-	socklen_t addrlen;
-	int ret = 0;
-
-	k_mutex_lock(&context->lock, K_FOREVER);
-
 	if (!(context->flags & NET_CONTEXT_REMOTE_ADDR_SET) ||
 	    !net_sin(&context->remote)->sin_port) {
-		ret = -EDESTADDRREQ;
-		goto unlock;
+		return -EDESTADDRREQ;
 	}
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_context_get_family(context) == AF_INET) {
-		addrlen = sizeof(struct sockaddr_in);
+		*addrlen = sizeof(struct sockaddr_in);
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_context_get_family(context) == AF_INET6) {
-		addrlen = sizeof(struct sockaddr_in6);
+		*addrlen = sizeof(struct sockaddr_in6);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = -EOPNOTSUPP;
-		goto unlock;
+		return -EOPNOTSUPP;
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN) {
-		addrlen = sizeof(struct sockaddr_can);
+		*addrlen = sizeof(struct sockaddr_can);
 	} else {
-		addrlen = 0;
+		*addrlen = 0;
 	}
 
-	ret = context_sendto_new(context, buf, len, &context->remote,
+	return 0;
+}
+
+int net_context_send_new(struct net_context *context,
+			 const void *buf,
+			 size_t len,
+			 net_context_send_cb_t cb,
+			 s32_t timeout,
+			 void *token,
+			 void *user_data)
+{
+	socklen_t addrlen;
+	int ret = 0;
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	ret = context_remote_addrlen(context, &addrlen);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	ret = context_sendto_new(context, buf, len, NULL, &context->remote,
 				 addrlen, cb, timeout, token, user_data);
 unlock:
 	k_mutex_unlock(&context->lock);
@@ -1823,7 +1860,7 @@ int net_context_sendto_new(struct net_context *context,
 
 	k_mutex_lock(&context->lock, K_FOREVER);
 
-	ret = context_sendto_new(context, buf, len, dst_addr, addrlen,
+	ret = context_sendto_new(context, buf, len, NULL, dst_addr, addrlen,
 				 cb, timeout, token, user_data);
 
 	k_mutex_unlock(&context->lock);
@@ -1831,6 +1868,41 @@ int net_context_sendto_new(struct net_context *context,
 	return ret;
 }
 
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *token,
+			void *user_data)
+{
+	const struct sockaddr *dst_addr = msghdr->msg_name;
+	socklen_t addrlen = msghdr->msg_namelen;
+	size_t i, len = 0;
+	int ret = 0;
+
+	for (i = 0; i < msghdr->msg_iovlen; i++) {
+		len += msghdr->msg_iov[i].iov_len;
+	}
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (!dst_addr) {
+		ret = context_remote_addrlen(context, &addrlen);
+		if (ret < 0) {
+			goto unlock;
+		}
+
+		dst_addr = &context->remote;
+	}
+
+	ret = context_sendto_new(context, NULL, len, msghdr, dst_addr, addrlen,
+				 cb, timeout, token, user_data);
+unlock:
+	k_mutex_unlock(&context->lock);
+
+	return ret;
+}
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
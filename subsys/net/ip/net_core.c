@@ -39,6 +39,7 @@ LOG_MODULE_REGISTER(net_core, CONFIG_NET_CORE_LOG_LEVEL);
 #include "ipv6.h"
 
 #include "icmpv4.h"
+#include "ipv4.h"
 
 #if defined(CONFIG_NET_DHCPV4)
 #include "dhcpv4.h"
@@ -91,6 +92,13 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Same as above for a reassembled IPv4 packet. */
+	if (net_pkt_ipv4_reassembled(pkt)) {
+		locally_routed = true;
+	}
+#endif
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
@@ -361,6 +369,11 @@ static void process_rx_packet(struct k_work *work)
 	pkt = CONTAINER_OF(work, struct net_pkt, work);
 
 	net_rx(net_pkt_iface(pkt), pkt);
+
+	/* Pass up the TCP segments held for coalescing once the burst
+	 * is over.
+	 */
+	net_tcp_gro_flush_if_idle();
 }
 
 static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
@@ -422,6 +435,7 @@ static inline void l3_init(void)
 	net_icmpv4_init();
 	net_icmpv6_init();
 	net_ipv6_init();
+	net_ipv4_frag_init();
 
 	net_ipv4_autoconf_init();
 
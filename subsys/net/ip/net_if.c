@@ -20,6 +20,7 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 
 #include "net_private.h"
 #include "ipv6.h"
+#include "ipv4.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -290,6 +291,13 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4)
+	/* Split the packet if it does not fit the MTU of the interface. */
+	if (net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+#endif
+
 done:
 	/*   NET_OK in which case packet has checked successfully. In this case
 	 *   the net_context callback is called after successful delivery in
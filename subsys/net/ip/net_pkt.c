@@ -1747,6 +1747,15 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 		}
 	}
 
+#if defined(CONFIG_NET_TCP_GSO)
+	/* TCP segments bigger than the MTU are split by Ethernet L2 */
+	if (proto == IPPROTO_TCP && family != AF_UNSPEC &&
+	    net_pkt_iface(pkt) &&
+	    net_if_l2(net_pkt_iface(pkt)) == &NET_L2_GET_NAME(ETHERNET)) {
+		max_len = MAX(max_len, CONFIG_NET_TCP_GSO_MAX_SIZE);
+	}
+#endif /* CONFIG_NET_TCP_GSO */
+
 	max_len -= existing;
 
 	return MIN(size, max_len);
@@ -2442,6 +2451,7 @@ struct net_pkt *net_pkt_clone(struct net_pkt *pkt, s32_t timeout)
 	net_pkt_set_timestamp(clone_pkt, net_pkt_timestamp(pkt));
 	net_pkt_set_priority(clone_pkt, net_pkt_priority(pkt));
 	net_pkt_set_orig_iface(clone_pkt, net_pkt_orig_iface(pkt));
+	net_pkt_set_gso_size(clone_pkt, net_pkt_gso_size(pkt));
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
 		net_pkt_set_ipv4_ttl(clone_pkt, net_pkt_ipv4_ttl(pkt));
@@ -2510,7 +2520,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 	net_pkt_cursor_backup(pkt, &backup);
 
 	while (length) {
-		u8_t left, rem;
+		size_t left, rem;
 
 		pkt_cursor_advance(pkt, false);
 
@@ -2527,7 +2537,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 		c_op->buf->len -= rem;
 		left -= rem;
 		if (left) {
-			memmove(c_op->pos, c_op->pos+rem, rem);
+			memmove(c_op->pos, c_op->pos+rem, left);
 		}
 
 		/* For now, empty buffer are not freed, and there is no
@@ -49,8 +49,27 @@ extern void net_tc_tx_init(void);
 extern void net_tc_rx_init(void);
 extern void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt);
 extern void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt);
+extern int net_tc_rx_current(void);
+extern bool net_tc_rx_queue_is_empty(u8_t queue);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
+#if defined(CONFIG_NET_RX_FLOW_QUEUES)
+#define NET_RX_FLOW_QUEUES CONFIG_NET_RX_FLOW_QUEUES
+#else
+#define NET_RX_FLOW_QUEUES 1
+#endif
+
+/* Total number of RX queues, each traffic class has NET_RX_FLOW_QUEUES */
+#define NET_RX_QUEUE_COUNT (NET_TC_RX_COUNT * NET_RX_FLOW_QUEUES)
+
+static inline u32_t net_hash_mix(u32_t hash, u32_t value)
+{
+	/* Multiplicative (Fibonacci) hashing step */
+	hash = (hash ^ value) * 0x9e3779b1;
+
+	return hash ^ (hash >> 16);
+}
+
 char *net_sprint_addr(sa_family_t af, const void *addr);
 
 #define net_sprint_ipv4_addr(_addr) net_sprint_addr(AF_INET, _addr)
@@ -87,6 +106,11 @@ extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
 
+/* Add the Internet checksum of a flat buffer to sum. The data is taken
+ * as starting at an even offset of the checksummed stream.
+ */
+extern u16_t net_calc_chksum_buf(u16_t sum, const u8_t *data, size_t len);
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
@@ -33,6 +33,7 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #endif
 
 #include "ipv6.h"
+#include "ipv4.h"
 
 #if defined(CONFIG_NET_ARP)
 #include "ethernet/arp.h"
@@ -581,6 +582,39 @@ static void iface_per_route_cb(struct net_if *iface, void *user_data)
 }
 #endif /* CONFIG_NET_ROUTE */
 
+#if defined(CONFIG_NET_ROUTE_IPV4)
+static void route_ipv4_cb(struct net_route_entry_ipv4 *entry,
+			  void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	struct net_if *iface = data->user_data;
+
+	if (entry->iface != iface) {
+		return;
+	}
+
+	PR("IPv4 prefix : %s/%d\t", net_sprint_ipv4_addr(&entry->addr),
+	   entry->prefix_len);
+	PR("via : %s\n", net_sprint_ipv4_addr(&entry->nexthop));
+}
+
+static void iface_per_route_ipv4_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	const char *extra;
+
+	PR("\nIPv4 routes for interface %p (%s)\n", iface,
+	   iface2str(iface, &extra));
+	PR("=======================================%s\n", extra);
+
+	data->user_data = iface;
+
+	net_route_ipv4_foreach(route_ipv4_cb, data);
+}
+#endif /* CONFIG_NET_ROUTE_IPV4 */
+
 #if defined(CONFIG_NET_ROUTE_MCAST)
 static void route_mcast_cb(struct net_route_entry_mcast *entry,
 			   void *user_data)
@@ -658,6 +692,12 @@ static void print_eth_stats(struct net_if *iface, struct net_stats_eth *data,
 	PR("Mcast received   : %u\n", data->multicast.rx);
 	PR("Mcast sent       : %u\n", data->multicast.tx);
 
+#if defined(CONFIG_NET_ARP)
+	PR("ARP cache hits   : %u\n", data->arp.hit);
+	PR("ARP cache misses : %u\n", data->arp.miss);
+	PR("ARP queue drops  : %u\n", data->arp.pending_dropped);
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ETHERNET_VENDOR)
 	if (data->vendor) {
 		PR("Vendor specific statistics for Ethernet "
@@ -719,6 +759,16 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv4.forwarded));
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	PR("IPv4 frag recv %d\tsent\t%d\tdrop\t%d\n",
+	   GET_STAT(iface, ipv4_frag.recv),
+	   GET_STAT(iface, ipv4_frag.sent),
+	   GET_STAT(iface, ipv4_frag.drop));
+	PR("IPv4 reasm ok  %d\ttimeout\t%d\n",
+	   GET_STAT(iface, ipv4_frag.reassembled),
+	   GET_STAT(iface, ipv4_frag.timeout));
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 	PR("IP vhlerr      %d\thblener\t%d\tlblener\t%d\n",
 	   GET_STAT(iface, ip_errors.vhlerr),
 	   GET_STAT(iface, ip_errors.hblenerr),
@@ -768,6 +818,16 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, tcp.connrst));
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+	PR("Conn hit       %d\twildcard\t%d\tmiss\t%d\n",
+	   GET_STAT(iface, conn.hit),
+	   GET_STAT(iface, conn.wildcard),
+	   GET_STAT(iface, conn.miss));
+	PR("Conn chain     %d\tmax\t%d\n",
+	   GET_STAT(iface, conn.chain),
+	   GET_STAT(iface, conn.chain_max));
+#endif
+
 	PR("Bytes received %u\n", GET_STAT(iface, bytes.received));
 	PR("Bytes sent     %u\n", GET_STAT(iface, bytes.sent));
 	PR("Processing err %d\n", GET_STAT(iface, processing_error));
@@ -1070,6 +1130,40 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static void ipv4_frag_cb(struct net_ipv4_reassembly *reass,
+			 void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	char src[ADDR_LEN];
+	int i;
+
+	if (!*count) {
+		PR("\nIPv4 reassembly Id     Remain "
+		   "Src             \tDst\n");
+	}
+
+	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv4_addr(&reass->src));
+
+	PR("%p      0x%04x  %5d %16s\t%16s\n",
+	   reass, reass->id,
+	   k_delayed_work_remaining_get(&reass->timer),
+	   src, net_sprint_ipv4_addr(&reass->dst));
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			PR("[%d] pkt %p offset %u len %zd\n", i, reass->pkt[i],
+			   net_pkt_ipv4_fragment_offset(reass->pkt[i]),
+			   net_pkt_get_len(reass->pkt[i]));
+		}
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
 		      struct net_buf *buf,
@@ -1290,6 +1384,12 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 	/* Do not print anything if no fragments are pending atm */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+
+	net_ipv4_frag_foreach(ipv4_frag_cb, &user_data);
+#endif
+
 	return 0;
 }
 
@@ -1337,6 +1437,11 @@ static void dns_result_cb(enum dns_resolve_status status,
 		return;
 	}
 
+	if (status == DNS_EAI_NODATA) {
+		PR_WARNING("dns: No address found for the name.\n");
+		return;
+	}
+
 	PR_WARNING("dns: Unhandled status %d received\n", status);
 }
 
@@ -1434,6 +1539,70 @@ static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(const char *name, enum dns_query_type type,
+			 enum dns_resolve_status status, int addr_count,
+			 u32_t ttl, void *user_data)
+{
+	const struct shell *shell = user_data;
+
+	if (status == DNS_EAI_ALLDONE) {
+		PR("\t%s %s: %d address(es), expires in %u s\n",
+		   type == DNS_QUERY_TYPE_A ? "IPv4" : "IPv6", name,
+		   addr_count, ttl);
+	} else {
+		PR("\t%s %s: no address, expires in %u s\n",
+		   type == DNS_QUERY_TYPE_A ? "IPv4" : "IPv6", name, ttl);
+	}
+}
+#endif
+
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct dns_resolve_cache_stats stats;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_resolve_cache_get_stats(&stats);
+
+	PR("DNS cache hits %u (negative %u), misses %u, coalesced %u\n",
+	   stats.hits, stats.negative_hits, stats.misses, stats.coalesced);
+
+	PR("Cached answers:\n");
+
+	if (!dns_resolve_cache_foreach(dns_cache_cb, (void *)shell)) {
+		PR("\tNone\n");
+	}
+#else
+	PR_INFO("DNS cache not supported. Set CONFIG_DNS_RESOLVER_CACHE to "
+		"enable it.\n");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_flush(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_resolve_cache_flush();
+	PR("DNS cache flushed.\n");
+#else
+	PR_INFO("DNS cache not supported. Set CONFIG_DNS_RESOLVER_CACHE to "
+		"enable it.\n");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 			     char *argv[])
 {
@@ -2838,20 +3007,26 @@ wait_reply:
 
 static int cmd_net_route(const struct shell *shell, size_t argc, char *argv[])
 {
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST) || \
+	defined(CONFIG_NET_ROUTE_IPV4)
 	struct net_shell_user_data user_data;
 #endif
 
 	ARG_UNUSED(argc);
 	ARG_UNUSED(argv);
 
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST) || \
+	defined(CONFIG_NET_ROUTE_IPV4)
 	user_data.shell = shell;
 #endif
 
+#if defined(CONFIG_NET_ROUTE_IPV4)
+	net_if_foreach(iface_per_route_ipv4_cb, &user_data);
+#endif
+
 #if defined(CONFIG_NET_ROUTE)
 	net_if_foreach(iface_per_route_cb, &user_data);
-#else
+#elif !defined(CONFIG_NET_ROUTE_IPV4)
 	PR_INFO("Network route support not enabled. "
 		"Set CONFIG_NET_ROUTE to enable it.\n");
 #endif
@@ -3560,8 +3735,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_arp,
 );
 
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, NULL, "Show the DNS cache and its statistics.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
+	SHELL_CMD(flush, NULL, "Remove all answers from the DNS cache.",
+		  cmd_net_dns_flush),
 	SHELL_CMD(query, NULL,
 		  "'net dns <hostname> [A or AAAA]' queries IPv4 address "
 		  "(default) or IPv6 address for a host name.",
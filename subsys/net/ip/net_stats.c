@@ -106,6 +106,16 @@ static inline void stats(struct net_if *iface)
 			 GET_STAT(iface, ipv4.forwarded));
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+		NET_INFO("IPv4 frag recv %d\tsent\t%d\tdrop\t%d",
+			 GET_STAT(iface, ipv4_frag.recv),
+			 GET_STAT(iface, ipv4_frag.sent),
+			 GET_STAT(iface, ipv4_frag.drop));
+		NET_INFO("IPv4 reasm ok  %d\ttimeout\t%d",
+			 GET_STAT(iface, ipv4_frag.reassembled),
+			 GET_STAT(iface, ipv4_frag.timeout));
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 		NET_INFO("IP vhlerr      %d\thblener\t%d\tlblener\t%d",
 			 GET_STAT(iface, ip_errors.vhlerr),
 			 GET_STAT(iface, ip_errors.hblenerr),
@@ -153,6 +163,16 @@ static inline void stats(struct net_if *iface)
 			 GET_STAT(iface, tcp.connrst));
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+		NET_INFO("Conn hit       %d\twildcard\t%d\tmiss\t%d",
+			 GET_STAT(iface, conn.hit),
+			 GET_STAT(iface, conn.wildcard),
+			 GET_STAT(iface, conn.miss));
+		NET_INFO("Conn chain     %d\tmax\t%d",
+			 GET_STAT(iface, conn.chain),
+			 GET_STAT(iface, conn.chain_max));
+#endif
+
 		NET_INFO("Bytes received %u", GET_STAT(iface, bytes.received));
 		NET_INFO("Bytes sent     %u", GET_STAT(iface, bytes.sent));
 		NET_INFO("Processing err %d",
@@ -254,6 +274,12 @@ static int net_stats_get(u32_t mgmt_request, struct net_if *iface,
 		src = GET_STAT_ADDR(iface, ipv4);
 		break;
 #endif
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	case NET_REQUEST_STATS_CMD_GET_IPV4_FRAG:
+		len_chk = sizeof(struct net_stats_ipv4_frag);
+		src = GET_STAT_ADDR(iface, ipv4_frag);
+		break;
+#endif
 #if defined(CONFIG_NET_STATISTICS_IPV6)
 	case NET_REQUEST_STATS_CMD_GET_IPV6:
 		len_chk = sizeof(struct net_stats_ip);
@@ -283,6 +309,12 @@ static int net_stats_get(u32_t mgmt_request, struct net_if *iface,
 		len_chk = sizeof(struct net_stats_tcp);
 		src = GET_STAT_ADDR(iface, tcp);
 		break;
+#endif
+#if defined(CONFIG_NET_STATISTICS_CONN)
+	case NET_REQUEST_STATS_CMD_GET_CONN:
+		len_chk = sizeof(struct net_stats_conn);
+		src = GET_STAT_ADDR(iface, conn);
+		break;
 #endif
 	}
 
@@ -312,6 +344,11 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV4,
 				  net_stats_get);
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV4_FRAG,
+				  net_stats_get);
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_IPV6)
 NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV6,
 				  net_stats_get);
@@ -337,4 +374,9 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP,
 				  net_stats_get);
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_CONN,
+				  net_stats_get);
+#endif
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
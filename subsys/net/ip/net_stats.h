@@ -134,6 +134,42 @@ static inline void net_stats_update_ipv4_recv(struct net_if *iface)
 #define net_stats_update_ipv4_recv(iface)
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+/* IPv4 fragmentation stats */
+
+static inline void net_stats_update_ipv4_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.recv++);
+}
+
+static inline void net_stats_update_ipv4_frag_sent(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.sent++);
+}
+
+static inline void net_stats_update_ipv4_frag_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.drop++);
+}
+
+static inline void net_stats_update_ipv4_frag_reassembled(
+							struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv4_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.timeout++);
+}
+#else
+#define net_stats_update_ipv4_frag_recv(iface)
+#define net_stats_update_ipv4_frag_sent(iface)
+#define net_stats_update_ipv4_frag_drop(iface)
+#define net_stats_update_ipv4_frag_reassembled(iface)
+#define net_stats_update_ipv4_frag_timeout(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 /* Common ICMPv4/ICMPv6 stats */
 static inline void net_stats_update_icmp_sent(struct net_if *iface)
@@ -267,6 +303,45 @@ static inline void net_stats_update_tcp_seg_rexmit(struct net_if *iface)
 #define net_stats_update_tcp_seg_rexmit(iface)
 #endif /* CONFIG_NET_STATISTICS_TCP */
 
+#if defined(CONFIG_NET_STATISTICS_CONN)
+/* Connection lookup stats */
+static inline void net_stats_update_conn_hit(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.conn.hit++);
+}
+
+static inline void net_stats_update_conn_wildcard(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.conn.wildcard++);
+}
+
+static inline void net_stats_update_conn_miss(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.conn.miss++);
+}
+
+static inline void net_stats_update_conn_chain(struct net_if *iface,
+					       u32_t len)
+{
+	UPDATE_STAT(iface, stats.conn.chain += len);
+
+	if (len > net_stats.conn.chain_max) {
+		net_stats.conn.chain_max = len;
+	}
+
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+	if (len > iface->stats.conn.chain_max) {
+		iface->stats.conn.chain_max = len;
+	}
+#endif
+}
+#else
+#define net_stats_update_conn_hit(iface)
+#define net_stats_update_conn_wildcard(iface)
+#define net_stats_update_conn_miss(iface)
+#define net_stats_update_conn_chain(iface, len)
+#endif /* CONFIG_NET_STATISTICS_CONN */
+
 static inline void net_stats_update_per_proto_recv(struct net_if *iface,
 						   enum net_ip_protocol proto)
 {
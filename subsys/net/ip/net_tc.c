@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/ethernet.h>
 
 #include "net_private.h"
 #include "net_stats.h"
@@ -28,19 +29,171 @@ NET_STACK_ARRAY_DEFINE(TX, tx_stack,
 NET_STACK_ARRAY_DEFINE(RX, rx_stack,
 		       CONFIG_NET_RX_STACK_SIZE,
 		       CONFIG_NET_RX_STACK_SIZE,
-		       NET_TC_RX_COUNT);
+		       NET_RX_QUEUE_COUNT);
 
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
-static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
+
+/* The flow queues of traffic class tc are at
+ * [tc * NET_RX_FLOW_QUEUES, (tc + 1) * NET_RX_FLOW_QUEUES[
+ */
+static struct net_traffic_class rx_classes[NET_RX_QUEUE_COUNT];
 
 void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
 {
 	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
 }
 
+#if NET_RX_FLOW_QUEUES > 1
+static u32_t rx_flow_hash_ipv4(struct net_pkt *pkt, u32_t hash)
+{
+	struct net_ipv4_hdr hdr;
+	u32_t ports;
+
+	if (net_pkt_read_new(pkt, &hdr, sizeof(hdr)) ||
+	    (hdr.vhl & 0xf0) != 0x40) {
+		return hash;
+	}
+
+	hash = net_hash_mix(hash, hdr.proto);
+	hash = net_hash_mix(hash, UNALIGNED_GET(&hdr.src.s_addr));
+	hash = net_hash_mix(hash, UNALIGNED_GET(&hdr.dst.s_addr));
+
+	/* Only the first fragment has the ports, so all the fragments of a
+	 * datagram are steered by address.
+	 */
+	if ((hdr.offset[0] & 0x3f) || hdr.offset[1] ||
+	    (hdr.proto != IPPROTO_TCP && hdr.proto != IPPROTO_UDP)) {
+		return hash;
+	}
+
+	if (net_pkt_skip(pkt, (hdr.vhl & 0x0f) * 4 - sizeof(hdr)) ||
+	    net_pkt_read_be32_new(pkt, &ports)) {
+		return hash;
+	}
+
+	return net_hash_mix(hash, ports);
+}
+
+static u32_t rx_flow_hash_ipv6(struct net_pkt *pkt, u32_t hash)
+{
+	struct net_ipv6_hdr hdr;
+	u32_t ports;
+	int i;
+
+	if (net_pkt_read_new(pkt, &hdr, sizeof(hdr)) ||
+	    (hdr.vtc & 0xf0) != 0x60) {
+		return hash;
+	}
+
+	hash = net_hash_mix(hash, hdr.nexthdr);
+
+	for (i = 0; i < 4; i++) {
+		hash = net_hash_mix(hash, UNALIGNED_GET(&hdr.src.s6_addr32[i]));
+		hash = net_hash_mix(hash, UNALIGNED_GET(&hdr.dst.s6_addr32[i]));
+	}
+
+	/* Extension headers are not followed, such flows are steered by
+	 * address only.
+	 */
+	if ((hdr.nexthdr != IPPROTO_TCP && hdr.nexthdr != IPPROTO_UDP) ||
+	    net_pkt_read_be32_new(pkt, &ports)) {
+		return hash;
+	}
+
+	return net_hash_mix(hash, ports);
+}
+
+/* Hash the flow of a packet that has not been parsed by L2 yet. Only the
+ * link layers that are known to carry plain IP are looked into, other
+ * packets are steered per interface.
+ */
+static u32_t rx_flow_hash(struct net_pkt *pkt)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+	u32_t hash = net_hash_mix(0, net_if_get_by_iface(iface));
+	struct net_pkt_cursor backup;
+	u16_t ptype = 0U;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		if (net_pkt_skip(pkt, 2 * sizeof(struct net_eth_addr)) ||
+		    net_pkt_read_be16_new(pkt, &ptype)) {
+			goto out;
+		}
+
+		if (ptype == NET_ETH_PTYPE_VLAN &&
+		    (net_pkt_skip(pkt, sizeof(u16_t)) ||
+		     net_pkt_read_be16_new(pkt, &ptype))) {
+			goto out;
+		}
+	} else
+#endif
+#if defined(CONFIG_NET_L2_DUMMY)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(DUMMY)) {
+		u8_t version;
+
+		if (!pkt->buffer || !pkt->buffer->len) {
+			goto out;
+		}
+
+		version = pkt->buffer->data[0] & 0xf0;
+		ptype = version == 0x40 ? NET_ETH_PTYPE_IP :
+			version == 0x60 ? NET_ETH_PTYPE_IPV6 : 0U;
+	} else
+#endif
+	{
+		goto out;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && ptype == NET_ETH_PTYPE_IP) {
+		hash = rx_flow_hash_ipv4(pkt, hash);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   ptype == NET_ETH_PTYPE_IPV6) {
+		hash = rx_flow_hash_ipv6(pkt, hash);
+	}
+
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return hash;
+}
+#endif /* NET_RX_FLOW_QUEUES > 1 */
+
 void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
 {
-	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
+	u8_t queue = tc * NET_RX_FLOW_QUEUES;
+
+#if NET_RX_FLOW_QUEUES > 1
+	queue += rx_flow_hash(pkt) % NET_RX_FLOW_QUEUES;
+
+	NET_DBG("pkt %p TC %d queue %d", pkt, tc, queue);
+#endif
+
+	k_work_submit_to_queue(&rx_classes[queue].work_q, net_pkt_work(pkt));
+}
+
+/* Returns the RX queue handled by the current thread, or -1 if it is not
+ * an RX queue thread.
+ */
+int net_tc_rx_current(void)
+{
+	int i;
+
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
+		if (k_current_get() == &rx_classes[i].work_q.thread) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool net_tc_rx_queue_is_empty(u8_t queue)
+{
+	return k_queue_is_empty(&rx_classes[queue].work_q.queue);
 }
 
 int net_tx_priority2tc(enum net_priority prio)
@@ -218,6 +371,25 @@ static void net_tc_rx_stats_priority_setup(struct net_if *iface,
 }
 #endif
 
+#if NET_RX_FLOW_QUEUES > 1 && defined(CONFIG_SCHED_CPU_MASK)
+/* Spread the flow queues of a traffic class over the CPUs. The CPU mask
+ * can only be changed while the thread cannot run.
+ */
+static void rx_queue_pin(struct k_thread *thread, int cpu)
+{
+	k_thread_suspend(thread);
+
+	if (k_thread_cpu_mask_clear(thread) ||
+	    k_thread_cpu_mask_enable(thread, cpu)) {
+		NET_WARN("Cannot pin RX queue thread %p to CPU %d",
+			 thread, cpu);
+		k_thread_cpu_mask_enable_all(thread);
+	}
+
+	k_thread_resume(thread);
+}
+#endif
+
 /* Create workqueue for each traffic class we are using. All the network
  * traffic goes through these classes. There needs to be at least one traffic
  * class in the system.
@@ -271,10 +443,11 @@ void net_tc_rx_init(void)
 	net_if_foreach(net_tc_rx_stats_priority_setup, NULL);
 #endif
 
-	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
 		u8_t thread_priority;
 
-		thread_priority = rx_tc2thread(i);
+		/* All the flow queues of a traffic class share its priority */
+		thread_priority = rx_tc2thread(i / NET_RX_FLOW_QUEUES);
 		rx_classes[i].tc = thread_priority;
 
 #if defined(CONFIG_NET_SHELL)
@@ -297,5 +470,10 @@ void net_tc_rx_init(void)
 			       K_THREAD_STACK_SIZEOF(rx_stack[i]),
 			       K_PRIO_COOP(thread_priority));
 		k_thread_name_set(&rx_classes[i].work_q.thread, "rx_workq");
+
+#if NET_RX_FLOW_QUEUES > 1 && defined(CONFIG_SCHED_CPU_MASK)
+		rx_queue_pin(&rx_classes[i].work_q.thread,
+			     (i % NET_RX_FLOW_QUEUES) % CONFIG_MP_NUM_CPUS);
+#endif
 	}
 }
@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include <limits.h>
 #include <zephyr/types.h>
 #include <misc/slist.h>
+#include <misc/dlist.h>
 
 #include <net/net_pkt.h>
 #include <net/net_core.h>
@@ -28,6 +29,7 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include "icmpv6.h"
 #include "nbr.h"
 #include "route.h"
+#include "route_lpm.h"
 
 #if !defined(NET_ROUTE_EXTRA_DATA_SIZE)
 #define NET_ROUTE_EXTRA_DATA_SIZE 0
@@ -36,7 +38,10 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/* Routes indexed by prefix for the lookups */
+static struct net_route_lpm routes_lpm = NET_ROUTE_LPM_INIT(128);
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -252,37 +257,19 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
 struct net_route_entry *net_route_lookup(struct net_if *iface,
 					 struct in6_addr *dst)
 {
-	struct net_route_entry *route, *found = NULL;
-	u8_t longest_match = 0U;
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (!nbr->ref) {
-			continue;
-		}
-
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
-		route = net_route_data(nbr);
+	struct net_route_lpm_entry *entry;
+	struct net_route_entry *found = NULL;
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix((u8_t *)dst,
-				       (u8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
-		}
+	entry = net_route_lpm_lookup(&routes_lpm, dst->s6_addr, iface);
+	if (entry) {
+		found = CONTAINER_OF(entry, struct net_route_entry, lpm);
 	}
 
 	if (found) {
@@ -352,9 +339,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -399,8 +384,17 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 
 	route = net_route_data(nbr);
 	route->iface = iface;
+	route->lpm.iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	if (net_route_lpm_add(&routes_lpm, addr->s6_addr, prefix_len,
+			      &route->lpm) < 0) {
+		NET_ERR("Route prefix cannot be stored!");
+		net_nbr_unref(tmp);
+		nbr_free(nbr);
+		return NULL;
+	}
+
+	sys_dlist_prepend(&routes, &route->node);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -453,13 +447,18 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+	}
 
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	net_route_lpm_del(&routes_lpm, route->addr.s6_addr, route->prefix_len,
+			  &route->lpm);
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
@@ -15,10 +15,12 @@
 
 #include <kernel.h>
 #include <misc/slist.h>
+#include <misc/dlist.h>
 
 #include <net/net_ip.h>
 
 #include "nbr.h"
+#include "route_lpm.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,7 +48,10 @@ struct net_route_entry {
 	 * we can remove it if we run out of available routes.
 	 * The oldest one is the last entry in the list.
 	 */
-	sys_snode_t node;
+	sys_dnode_t node;
+
+	/** Entry in the prefix tree used for the lookups. */
+	struct net_route_lpm_entry lpm;
 
 	/** List of neighbors that the routes go through. */
 	sys_slist_t nexthop;
@@ -257,6 +262,82 @@ void net_route_init(void);
 #define net_route_init(...)
 #endif /* CONFIG_NET_ROUTE */
 
+/**
+ * @brief IPv4 route entry.
+ */
+struct net_route_entry_ipv4 {
+	/** Entry in the prefix tree used for the lookups. */
+	struct net_route_lpm_entry lpm;
+
+	/** Network interface for the route. */
+	struct net_if *iface;
+
+	/** IPv4 address/prefix of the route. */
+	struct in_addr addr;
+
+	/** IPv4 address of the router to send the packets to. */
+	struct in_addr nexthop;
+
+	/** IPv4 address/prefix length. */
+	u8_t prefix_len;
+
+	/** Is this entry in use or not */
+	bool is_used;
+};
+
+/**
+ * @brief Add an IPv4 route to routing table.
+ *
+ * If there is already a route to the same prefix on the interface, its
+ * nexthop is updated.
+ *
+ * @param iface Network interface that this route is tied to.
+ * @param addr IPv4 address.
+ * @param prefix_len Length of the IPv4 address/prefix.
+ * @param nexthop IPv4 address of the router on the same link.
+ *
+ * @return Return created route entry, NULL if could not be created.
+ */
+struct net_route_entry_ipv4 *net_route_ipv4_add(struct net_if *iface,
+						struct in_addr *addr,
+						u8_t prefix_len,
+						struct in_addr *nexthop);
+
+/**
+ * @brief Delete an IPv4 route from routing table.
+ *
+ * @param route Existing route entry.
+ *
+ * @return 0 if ok, <0 if error
+ */
+int net_route_ipv4_del(struct net_route_entry_ipv4 *route);
+
+/**
+ * @brief Lookup IPv4 route with the longest prefix matching a destination.
+ *
+ * @param iface Network interface. If NULL, then check against all interfaces.
+ * @param dst Destination IPv4 address.
+ *
+ * @return Return route entry related to a given destination address, NULL
+ * if not found.
+ */
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst);
+
+typedef void (*net_route_ipv4_cb_t)(struct net_route_entry_ipv4 *entry,
+				    void *user_data);
+
+/**
+ * @brief Go through all the IPv4 routing entries and call callback
+ * for each entry that is in use.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ *
+ * @return Total number of IPv4 routing entries found.
+ */
+int net_route_ipv4_foreach(net_route_ipv4_cb_t cb, void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
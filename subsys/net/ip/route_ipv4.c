@@ -0,0 +1,157 @@
+/** @file
+ * @brief IPv4 route handling.
+ *
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_route_ipv4, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+#include <zephyr/types.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+
+#include "net_private.h"
+#include "route.h"
+#include "route_lpm.h"
+
+static struct net_route_entry_ipv4 routes[CONFIG_NET_MAX_IPV4_ROUTES];
+
+static struct net_route_lpm routes_lpm = NET_ROUTE_LPM_INIT(32);
+
+static struct net_route_entry_ipv4 *route_find(struct net_if *iface,
+					       struct in_addr *addr,
+					       u8_t prefix_len)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_MAX_IPV4_ROUTES; i++) {
+		struct net_route_entry_ipv4 *route = &routes[i];
+
+		if (route->is_used && route->iface == iface &&
+		    route->prefix_len == prefix_len &&
+		    net_ipv4_addr_cmp(&route->addr, addr)) {
+			return route;
+		}
+	}
+
+	return NULL;
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_add(struct net_if *iface,
+						struct in_addr *addr,
+						u8_t prefix_len,
+						struct in_addr *nexthop)
+{
+	struct net_route_entry_ipv4 *route;
+	int i;
+
+	NET_ASSERT(iface);
+	NET_ASSERT(addr);
+	NET_ASSERT(nexthop);
+
+	if (prefix_len > 32) {
+		NET_DBG("Invalid prefix length %d", prefix_len);
+		return NULL;
+	}
+
+	route = route_find(iface, addr, prefix_len);
+	if (route) {
+		net_ipaddr_copy(&route->nexthop, nexthop);
+
+		NET_DBG("Updated route to %s/%d via %s (iface %p)",
+			log_strdup(net_sprint_ipv4_addr(addr)), prefix_len,
+			log_strdup(net_sprint_ipv4_addr(nexthop)), iface);
+
+		return route;
+	}
+
+	for (i = 0; i < CONFIG_NET_MAX_IPV4_ROUTES; i++) {
+		route = &routes[i];
+
+		if (route->is_used) {
+			continue;
+		}
+
+		net_ipaddr_copy(&route->addr, addr);
+		net_ipaddr_copy(&route->nexthop, nexthop);
+		route->prefix_len = prefix_len;
+		route->iface = iface;
+		route->lpm.iface = iface;
+
+		if (net_route_lpm_add(&routes_lpm, route->addr.s4_addr,
+				      prefix_len, &route->lpm) < 0) {
+			NET_ERR("Route prefix cannot be stored!");
+			return NULL;
+		}
+
+		route->is_used = true;
+
+		NET_DBG("Added route to %s/%d via %s (iface %p)",
+			log_strdup(net_sprint_ipv4_addr(addr)), prefix_len,
+			log_strdup(net_sprint_ipv4_addr(nexthop)), iface);
+
+		return route;
+	}
+
+	NET_DBG("No free IPv4 route entries");
+
+	return NULL;
+}
+
+int net_route_ipv4_del(struct net_route_entry_ipv4 *route)
+{
+	if (!route || !route->is_used) {
+		return -EINVAL;
+	}
+
+	NET_DBG("Deleted route to %s/%d (iface %p)",
+		log_strdup(net_sprint_ipv4_addr(&route->addr)),
+		route->prefix_len, route->iface);
+
+	net_route_lpm_del(&routes_lpm, route->addr.s4_addr, route->prefix_len,
+			  &route->lpm);
+
+	route->is_used = false;
+
+	return 0;
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst)
+{
+	struct net_route_lpm_entry *entry;
+
+	entry = net_route_lpm_lookup(&routes_lpm, dst->s4_addr, iface);
+	if (!entry) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(entry, struct net_route_entry_ipv4, lpm);
+}
+
+int net_route_ipv4_foreach(net_route_ipv4_cb_t cb, void *user_data)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < CONFIG_NET_MAX_IPV4_ROUTES; i++) {
+		if (!routes[i].is_used) {
+			continue;
+		}
+
+		cb(&routes[i], user_data);
+
+		ret++;
+	}
+
+	return ret;
+}
@@ -0,0 +1,330 @@
+/** @file
+ * @brief Longest prefix match route table.
+ *
+ * The routes of both address families are kept in path compressed binary
+ * trees (one per family). A node holds a prefix and the routes using it,
+ * or is only joining two branches whose prefixes differ after its own
+ * prefix. A lookup follows the bits of the destination address from the
+ * root, so it visits at most one node per address bit whatever the
+ * number of routes is.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/types.h>
+#include <misc/slist.h>
+#include <misc/byteorder.h>
+
+#include "net_private.h"
+#include "route_lpm.h"
+
+#if defined(CONFIG_NET_ROUTE)
+#define LPM_IPV6_ROUTES CONFIG_NET_MAX_ROUTES
+#else
+#define LPM_IPV6_ROUTES 0
+#endif
+
+#if defined(CONFIG_NET_ROUTE_IPV4)
+#define LPM_IPV4_ROUTES CONFIG_NET_MAX_IPV4_ROUTES
+#else
+#define LPM_IPV4_ROUTES 0
+#endif
+
+/* A tree with N prefixes has at most N - 1 nodes joining two branches */
+#define LPM_NODE_COUNT (2 * (LPM_IPV6_ROUTES + LPM_IPV4_ROUTES))
+
+struct net_route_lpm_node {
+	/** Branches for the bit following the prefix */
+	struct net_route_lpm_node *child[2];
+
+	/** Entries using this prefix, empty for a joining node */
+	sys_slist_t entries;
+
+	/** Prefix, the bits after prefix_len are zero */
+	u8_t prefix[sizeof(struct in6_addr)];
+
+	/** Prefix length in bits */
+	u8_t prefix_len;
+
+	/** Is this node in use or not */
+	bool is_used;
+};
+
+static struct net_route_lpm_node lpm_nodes[LPM_NODE_COUNT];
+
+static inline int addr_bit(const u8_t *addr, u8_t bit)
+{
+	return (addr[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/* Number of leading bits, up to max_len, that are the same in both */
+static u8_t common_len(const u8_t *a, const u8_t *b, u8_t max_len)
+{
+	u8_t len = 0U;
+	u8_t diff;
+
+	while (len < max_len) {
+		diff = a[len / 8] ^ b[len / 8];
+		if (!diff) {
+			len += 8U;
+			continue;
+		}
+
+		while (!(diff & 0x80)) {
+			diff <<= 1;
+			len++;
+		}
+
+		break;
+	}
+
+	return MIN(len, max_len);
+}
+
+static struct net_route_lpm_node *node_alloc(const u8_t *prefix,
+					     u8_t prefix_len)
+{
+	struct net_route_lpm_node *node;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(lpm_nodes); i++) {
+		node = &lpm_nodes[i];
+
+		if (node->is_used) {
+			continue;
+		}
+
+		(void)memset(node, 0, sizeof(*node));
+
+		memcpy(node->prefix, prefix, (prefix_len + 7) / 8);
+		if (prefix_len % 8) {
+			node->prefix[prefix_len / 8] &=
+				0xff << (8 - (prefix_len % 8));
+		}
+
+		node->prefix_len = prefix_len;
+		node->is_used = true;
+
+		return node;
+	}
+
+	return NULL;
+}
+
+static inline void node_free(struct net_route_lpm_node *node)
+{
+	node->is_used = false;
+}
+
+static inline struct net_route_lpm_node *
+node_single_child(struct net_route_lpm_node *node)
+{
+	return node->child[0] ? node->child[0] : node->child[1];
+}
+
+static inline bool node_is_removable(struct net_route_lpm_node *node)
+{
+	return sys_slist_is_empty(&node->entries) &&
+		!(node->child[0] && node->child[1]);
+}
+
+static void cache_flush(struct net_route_lpm *lpm)
+{
+	unsigned int key = irq_lock();
+
+	(void)memset(lpm->cache, 0, sizeof(lpm->cache));
+	lpm->generation++;
+
+	irq_unlock(key);
+}
+
+static struct net_route_lpm_cache *cache_get(struct net_route_lpm *lpm,
+					     const u8_t *addr,
+					     struct net_if *iface)
+{
+	u32_t hash = POINTER_TO_UINT(iface);
+	int i;
+
+	for (i = 0; i < lpm->addr_len / 8; i += sizeof(u32_t)) {
+		hash = net_hash_mix(hash, sys_get_be32(&addr[i]));
+	}
+
+	return &lpm->cache[hash % NET_ROUTE_LPM_CACHE_SIZE];
+}
+
+int net_route_lpm_add(struct net_route_lpm *lpm, const u8_t *prefix,
+		      u8_t prefix_len, struct net_route_lpm_entry *entry)
+{
+	struct net_route_lpm_node **link = &lpm->root;
+	struct net_route_lpm_node *node, *new, *branch;
+	u8_t len = 0U;
+
+	if (prefix_len > lpm->addr_len) {
+		return -EINVAL;
+	}
+
+	while (*link) {
+		node = *link;
+
+		len = common_len(node->prefix, prefix,
+				 MIN(node->prefix_len, prefix_len));
+		if (len < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == prefix_len) {
+			sys_slist_append(&node->entries, &entry->node);
+			goto out;
+		}
+
+		link = &node->child[addr_bit(prefix, node->prefix_len)];
+	}
+
+	new = node_alloc(prefix, prefix_len);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	sys_slist_append(&new->entries, &entry->node);
+
+	node = *link;
+	if (node) {
+		/* The prefix of the node and the new one differ after
+		 * len bits.
+		 */
+		if (len == prefix_len) {
+			new->child[addr_bit(node->prefix, len)] = node;
+		} else {
+			branch = node_alloc(prefix, len);
+			if (!branch) {
+				node_free(new);
+				return -ENOMEM;
+			}
+
+			branch->child[addr_bit(node->prefix, len)] = node;
+			branch->child[addr_bit(prefix, len)] = new;
+			new = branch;
+		}
+	}
+
+	*link = new;
+
+out:
+	cache_flush(lpm);
+
+	return 0;
+}
+
+int net_route_lpm_del(struct net_route_lpm *lpm, const u8_t *prefix,
+		      u8_t prefix_len, struct net_route_lpm_entry *entry)
+{
+	struct net_route_lpm_node **link = &lpm->root;
+	struct net_route_lpm_node **parent_link = NULL;
+	struct net_route_lpm_node *node, *parent;
+
+	while ((node = *link) && node->prefix_len < prefix_len) {
+		parent_link = link;
+		link = &node->child[addr_bit(prefix, node->prefix_len)];
+	}
+
+	if (!node || node->prefix_len != prefix_len ||
+	    common_len(node->prefix, prefix, prefix_len) != prefix_len) {
+		return -ENOENT;
+	}
+
+	if (!sys_slist_find_and_remove(&node->entries, &entry->node)) {
+		return -ENOENT;
+	}
+
+	cache_flush(lpm);
+
+	if (!node_is_removable(node)) {
+		return 0;
+	}
+
+	*link = node_single_child(node);
+	node_free(node);
+
+	/* The parent might now be joining a single branch */
+	if (parent_link) {
+		parent = *parent_link;
+
+		if (node_is_removable(parent)) {
+			*parent_link = node_single_child(parent);
+			node_free(parent);
+		}
+	}
+
+	return 0;
+}
+
+struct net_route_lpm_entry *net_route_lpm_lookup(struct net_route_lpm *lpm,
+						 const u8_t *addr,
+						 struct net_if *iface)
+{
+	struct net_route_lpm_entry *entry, *found = NULL;
+	struct net_route_lpm_node *node;
+	struct net_route_lpm_cache *cache;
+	u8_t addr_size = lpm->addr_len / 8;
+	unsigned int key;
+	u32_t generation;
+
+	cache = cache_get(lpm, addr, iface);
+
+	key = irq_lock();
+
+	generation = lpm->generation;
+
+	if (cache->is_used && cache->iface == iface &&
+	    !memcmp(cache->addr, addr, addr_size)) {
+		found = cache->entry;
+		irq_unlock(key);
+
+		return found;
+	}
+
+	irq_unlock(key);
+
+	node = lpm->root;
+
+	while (node) {
+		if (common_len(node->prefix, addr,
+			       node->prefix_len) < node->prefix_len) {
+			break;
+		}
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&node->entries, entry, node) {
+			if (!iface || entry->iface == iface) {
+				found = entry;
+				break;
+			}
+		}
+
+		if (node->prefix_len == lpm->addr_len) {
+			break;
+		}
+
+		node = node->child[addr_bit(addr, node->prefix_len)];
+	}
+
+	key = irq_lock();
+
+	/* Do not cache a result the table was changed under */
+	if (generation == lpm->generation) {
+		memcpy(cache->addr, addr, addr_size);
+		cache->iface = iface;
+		cache->entry = found;
+		cache->is_used = true;
+	}
+
+	irq_unlock(key);
+
+	return found;
+}
@@ -0,0 +1,139 @@
+/** @file
+ * @brief Longest prefix match route table
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __ROUTE_LPM_H
+#define __ROUTE_LPM_H
+
+#include <kernel.h>
+#include <misc/slist.h>
+
+#include <net/net_ip.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Route entry as stored in a prefix tree. This is embedded in the
+ * address family specific route entry.
+ */
+struct net_route_lpm_entry {
+	/** Other entries with the same prefix but a different interface */
+	sys_snode_t node;
+
+	/** Network interface of the route. */
+	struct net_if *iface;
+};
+
+#if defined(CONFIG_NET_ROUTE_CACHE_SIZE)
+#define NET_ROUTE_LPM_CACHE_SIZE CONFIG_NET_ROUTE_CACHE_SIZE
+#else
+#define NET_ROUTE_LPM_CACHE_SIZE 1
+#endif
+
+struct net_route_lpm_node;
+
+/**
+ * @brief Cached result of a lookup to a given destination.
+ */
+struct net_route_lpm_cache {
+	/** Interface the lookup was limited to, NULL if none */
+	struct net_if *iface;
+
+	/** Longest matching entry, NULL if there was no route */
+	struct net_route_lpm_entry *entry;
+
+	/** Destination address */
+	u8_t addr[sizeof(struct in6_addr)];
+
+	/** Is this cache entry valid */
+	bool is_used;
+};
+
+/**
+ * @brief Longest prefix match table for one address family.
+ *
+ * The prefixes are stored in a path compressed binary tree so the cost
+ * of a lookup only depends on the length of the address, not on the
+ * number of routes.
+ */
+struct net_route_lpm {
+	/** Root of the prefix tree */
+	struct net_route_lpm_node *root;
+
+	/** Per destination cache of the latest lookups */
+	struct net_route_lpm_cache cache[NET_ROUTE_LPM_CACHE_SIZE];
+
+	/** Incremented each time the table is changed */
+	u32_t generation;
+
+	/** Length of the addresses in bits */
+	u8_t addr_len;
+};
+
+/**
+ * @brief Statically initialize an empty table.
+ *
+ * @param _addr_len Length of the addresses in bits, 32 for IPv4 and 128
+ * for IPv6.
+ */
+#define NET_ROUTE_LPM_INIT(_addr_len) { .addr_len = (_addr_len) }
+
+/**
+ * @brief Add a route entry to a table.
+ *
+ * Several entries can have the same prefix as long as their network
+ * interface differs.
+ *
+ * @param lpm Route table.
+ * @param prefix Address or prefix of the route, in network byte order.
+ * @param prefix_len Length of the prefix in bits.
+ * @param entry Entry to add.
+ *
+ * @return 0 if ok, -ENOMEM if the tree has no free nodes, -EINVAL if the
+ * prefix length is invalid.
+ */
+int net_route_lpm_add(struct net_route_lpm *lpm, const u8_t *prefix,
+		      u8_t prefix_len, struct net_route_lpm_entry *entry);
+
+/**
+ * @brief Remove a route entry from a table.
+ *
+ * @param lpm Route table.
+ * @param prefix Address or prefix the entry was added with.
+ * @param prefix_len Length of the prefix in bits.
+ * @param entry Entry to remove.
+ *
+ * @return 0 if ok, -ENOENT if the entry was not found.
+ */
+int net_route_lpm_del(struct net_route_lpm *lpm, const u8_t *prefix,
+		      u8_t prefix_len, struct net_route_lpm_entry *entry);
+
+/**
+ * @brief Find the entry with the longest prefix matching an address.
+ *
+ * @param lpm Route table.
+ * @param addr Destination address, in network byte order.
+ * @param iface Network interface. If NULL, then check against all
+ * interfaces.
+ *
+ * @return Matching entry, NULL if there is no route to the address.
+ */
+struct net_route_lpm_entry *net_route_lpm_lookup(struct net_route_lpm *lpm,
+						 const u8_t *addr,
+						 struct net_if *iface);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROUTE_LPM_H */
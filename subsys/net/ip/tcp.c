@@ -51,7 +51,9 @@ static struct tcp_backlog_entry {
 	u32_t send_ack;
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
+	u32_t ts_recent;
 	u16_t send_mss;
+	u8_t opt_flags;
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
@@ -167,6 +169,247 @@ static inline u32_t retry_timeout(const struct net_tcp *tcp)
 				CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
 }
 
+/* Smallest shift that fits the configured receive window in 16 bits */
+static inline u8_t tcp_wscale_shift(void)
+{
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+	u8_t shift = 0U;
+
+	while (shift < NET_TCP_MAX_WSCALE &&
+	       (CONFIG_NET_TCP_RECV_WINDOW_SIZE >> shift) > UINT16_MAX) {
+		shift++;
+	}
+
+	return shift;
+#else
+	return 0U;
+#endif
+}
+
+#if defined(CONFIG_NET_TCP_TIMESTAMPS)
+static inline u32_t tcp_ts_recent(const struct net_tcp *tcp)
+{
+	return tcp->ts_recent;
+}
+
+static inline void tcp_set_ts_recent(struct net_tcp *tcp, u32_t tsval)
+{
+	tcp->ts_recent = tsval;
+}
+#else
+#define tcp_ts_recent(...) 0U
+#define tcp_set_ts_recent(...)
+#endif /* CONFIG_NET_TCP_TIMESTAMPS */
+
+/* Write a timestamps option at options, return its length */
+static u8_t tcp_put_ts_opt(const struct net_tcp *tcp, u8_t *options)
+{
+	options[0] = NET_TCP_TIMESTAMP_OPT;
+	options[1] = NET_TCP_TIMESTAMP_SIZE;
+	sys_put_be32(k_uptime_get_32(), options + 2);
+	sys_put_be32(tcp_ts_recent(tcp), options + 6);
+
+	return NET_TCP_TIMESTAMP_SIZE;
+}
+
+/* Adopt the options the peer sent on its SYN or SYN-ACK. An option
+ * is only used if both sides offered it.
+ */
+static void tcp_apply_syn_opts(struct net_tcp *tcp,
+			       const struct net_tcp_options *opts)
+{
+	tcp->flags &= ~NET_TCP_SYN_OPT_FLAGS;
+	tcp->rcv_wscale = 0U;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+	    (opts->found & NET_TCP_OPT_HAS_WSCALE)) {
+		tcp->flags |= NET_TCP_WSCALE_OK;
+		tcp->rcv_wscale = tcp_wscale_shift();
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+	    (opts->found & NET_TCP_OPT_HAS_SACK_PERM)) {
+		tcp->flags |= NET_TCP_SACK_OK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS) &&
+	    (opts->found & NET_TCP_OPT_HAS_TS)) {
+		tcp->flags |= NET_TCP_TS_OK;
+		tcp_set_ts_recent(tcp, opts->tsval);
+	}
+}
+
+/* Sequence space [*seq, *seq + *seq_len) taken by a sent_list packet */
+static int sent_pkt_seq(struct net_pkt *pkt, u32_t *seq, u32_t *seq_len)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			 net_pkt_ipv6_ext_len(pkt))) {
+		return -EMSGSIZE;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data_new(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	*seq = sys_get_be32(tcp_hdr->seq);
+	*seq_len = net_pkt_appdatalen(pkt);
+
+	if (tcp_hdr->flags & NET_TCP_SYN) {
+		*seq_len += 1;
+	}
+
+	if (tcp_hdr->flags & NET_TCP_FIN) {
+		*seq_len += 1;
+	}
+
+	return 0;
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+static void sack_remove(struct net_tcp *tcp, int i)
+{
+	tcp->sacked[i] = tcp->sacked[--tcp->sacked_count];
+}
+
+/* Add [left, right) to the scoreboard, merging it with any range it
+ * overlaps or touches. When the scoreboard is full the last range is
+ * overwritten; forgetting a block only costs a needless retransmit.
+ */
+static void sack_insert(struct net_tcp *tcp, u32_t left, u32_t right)
+{
+	int i = 0;
+
+	while (i < tcp->sacked_count) {
+		struct net_tcp_sack_block *blk = &tcp->sacked[i];
+
+		if (net_tcp_seq_cmp(left, blk->right) > 0 ||
+		    net_tcp_seq_cmp(blk->left, right) > 0) {
+			i++;
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(blk->left, left) < 0) {
+			left = blk->left;
+		}
+
+		if (net_tcp_seq_cmp(blk->right, right) > 0) {
+			right = blk->right;
+		}
+
+		sack_remove(tcp, i);
+	}
+
+	if (tcp->sacked_count == NET_TCP_SACK_MAX_BLOCKS) {
+		tcp->sacked_count--;
+	}
+
+	tcp->sacked[tcp->sacked_count].left = left;
+	tcp->sacked[tcp->sacked_count].right = right;
+	tcp->sacked_count++;
+}
+
+/* Record the SACK blocks of an incoming ACK. Blocks at or below the
+ * cumulative ACK (D-SACK) or beyond what we sent are ignored.
+ */
+static void tcp_sack_update(struct net_tcp *tcp, u32_t ack,
+			    const struct net_tcp_options *opts)
+{
+	int i;
+
+	if (!(tcp->flags & NET_TCP_SACK_OK) ||
+	    !(opts->found & NET_TCP_OPT_HAS_SACK)) {
+		return;
+	}
+
+	for (i = 0; i < opts->sack_count; i++) {
+		u32_t left = opts->sack[i].left;
+		u32_t right = opts->sack[i].right;
+
+		if (!net_tcp_seq_greater(right, left) ||
+		    !net_tcp_seq_greater(left, ack) ||
+		    net_tcp_seq_greater(right, tcp->send_seq)) {
+			continue;
+		}
+
+		sack_insert(tcp, left, right);
+	}
+}
+
+/* Forget the part of the scoreboard covered by the cumulative ACK */
+static void tcp_sack_ack(struct net_tcp *tcp, u32_t ack)
+{
+	int i = 0;
+
+	while (i < tcp->sacked_count) {
+		if (!net_tcp_seq_greater(tcp->sacked[i].right, ack)) {
+			sack_remove(tcp, i);
+			continue;
+		}
+
+		if (net_tcp_seq_greater(ack, tcp->sacked[i].left)) {
+			tcp->sacked[i].left = ack;
+		}
+
+		i++;
+	}
+}
+
+static bool tcp_sack_holds(const struct net_tcp *tcp, u32_t seq, u32_t len)
+{
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (net_tcp_seq_cmp(tcp->sacked[i].left, seq) <= 0 &&
+		    net_tcp_seq_cmp(seq + len, tcp->sacked[i].right) <= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Highest sequence number the peer has SACKed, or false if none */
+static bool tcp_sack_high(const struct net_tcp *tcp, u32_t *high)
+{
+	int i;
+
+	if (!(tcp->flags & NET_TCP_SACK_OK) || !tcp->sacked_count) {
+		return false;
+	}
+
+	*high = tcp->sacked[0].right;
+
+	for (i = 1; i < tcp->sacked_count; i++) {
+		if (net_tcp_seq_greater(tcp->sacked[i].right, *high)) {
+			*high = tcp->sacked[i].right;
+		}
+	}
+
+	return true;
+}
+#else
+#define tcp_sack_update(...)
+#define tcp_sack_ack(...)
+
+static inline bool tcp_sack_holds(const struct net_tcp *tcp, u32_t seq,
+				  u32_t len)
+{
+	return false;
+}
+
+static inline bool tcp_sack_high(const struct net_tcp *tcp, u32_t *high)
+{
+	return false;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
 #define is_6lo_technology(pkt)						\
 	(IS_ENABLED(CONFIG_NET_IPV6) &&	net_pkt_family(pkt) == AF_INET6 &&  \
 	 ((IS_ENABLED(CONFIG_NET_L2_BT) &&				\
@@ -208,13 +451,63 @@ static void abort_connection(struct net_tcp *tcp)
 	net_context_unref(ctx);
 }
 
+static void tcp_retransmit_pkt(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+	if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		NET_DBG("retry %u: [%p] pkt %p send failed",
+			tcp->retry_timeout_shift, tcp, pkt);
+		net_pkt_unref(pkt);
+	} else {
+		NET_DBG("retry %u: [%p] sent pkt %p",
+			tcp->retry_timeout_shift, tcp, pkt);
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+		    !is_6lo_technology(pkt)) {
+			net_stats_update_tcp_seg_rexmit(net_pkt_iface(pkt));
+		}
+	}
+}
+
+/* Resend every packet below the highest SACKed sequence number that
+ * the scoreboard says the peer is missing.
+ */
+static void tcp_retransmit_holes(struct net_tcp *tcp, u32_t high)
+{
+	struct net_pkt *pkt;
+	u32_t seq, seq_len;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (sent_pkt_seq(pkt, &seq, &seq_len) < 0) {
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(seq, high) >= 0) {
+			break;
+		}
+
+		if (tcp_sack_holds(tcp, seq, seq_len)) {
+			continue;
+		}
+
+		tcp_retransmit_pkt(tcp, pkt);
+	}
+}
+
 static void tcp_retry_expired(struct k_work *work)
 {
 	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, retry_timer);
 	struct net_pkt *pkt;
+	u32_t high;
 
 	/* Double the retry period for exponential backoff and resend
-	 * the first (only the first!) unack'd packet.
+	 * the first unack'd packet, or with SACK every hole the peer
+	 * reported.
 	 */
 	if (!sys_slist_is_empty(&tcp->sent_list)) {
 		tcp->retry_timeout_shift++;
@@ -226,29 +519,15 @@ static void tcp_retry_expired(struct k_work *work)
 
 		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
 
-		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
-				   struct net_pkt, sent_list);
-
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
+		if (tcp_sack_high(tcp, &high)) {
+			tcp_retransmit_holes(tcp, high);
+			return;
 		}
 
-		net_pkt_set_queued(pkt, true);
+		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+				   struct net_pkt, sent_list);
 
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
-			NET_DBG("retry %u: [%p] pkt %p send failed",
-				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
-		} else {
-			NET_DBG("retry %u: [%p] sent pkt %p",
-				tcp->retry_timeout_shift, tcp, pkt);
-			if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
-			    !is_6lo_technology(pkt)) {
-				net_stats_update_tcp_seg_rexmit(
-							net_pkt_iface(pkt));
-			}
-		}
+		tcp_retransmit_pkt(tcp, pkt);
 	} else if (CONFIG_NET_TCP_TIME_WAIT_DELAY != 0) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			NET_DBG("[%p] Closing connection (context %p)",
@@ -282,9 +561,25 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 	tcp_context[i].context = context;
 
 	tcp_context[i].send_seq = tcp_init_isn();
-	tcp_context[i].recv_wnd = MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	tcp_context[i].recv_wnd = NET_TCP_RECV_WND_INIT;
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
 
+	/* Offer everything enabled on our SYN, the peer's answer in
+	 * tcp_apply_syn_opts() decides what is kept.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE)) {
+		tcp_context[i].flags |= NET_TCP_WSCALE_OK;
+		tcp_context[i].rcv_wscale = tcp_wscale_shift();
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK)) {
+		tcp_context[i].flags |= NET_TCP_SACK_OK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS)) {
+		tcp_context[i].flags |= NET_TCP_TS_OK;
+	}
+
 	tcp_context[i].accept_cb = NULL;
 
 	k_delayed_work_init(&tcp_context[i].retry_timer, tcp_retry_expired);
@@ -340,7 +635,7 @@ int net_tcp_release(struct net_tcp *tcp)
 	tcp->context = NULL;
 
 	key = irq_lock();
-	tcp->flags &= ~(NET_TCP_IN_USE | NET_TCP_RECV_MSS_SET);
+	tcp->flags &= ~NET_TCP_IN_USE;
 	irq_unlock(key);
 
 	NET_DBG("[%p] Disposed of TCP connection state", tcp);
@@ -507,7 +802,8 @@ fail:
 
 u32_t net_tcp_get_recv_wnd(const struct net_tcp *tcp)
 {
-	return tcp->recv_wnd;
+	/* Never more than what the window field can carry */
+	return MIN(tcp->recv_wnd, (u32_t)UINT16_MAX << tcp->rcv_wscale);
 }
 
 int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
@@ -517,8 +813,9 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 			    struct net_pkt **send_pkt)
 {
 	struct tcp_segment segment = { 0 };
+	u8_t ts_options[NET_TCP_NOP_SIZE * 2 + NET_TCP_TIMESTAMP_SIZE];
 	u32_t seq;
-	u16_t wnd;
+	u32_t wnd;
 	int status;
 
 	if (!local) {
@@ -563,14 +860,29 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 		}
 	}
 
+	/* RFC 7323 2.2: the window of a SYN is never scaled */
 	wnd = net_tcp_get_recv_wnd(tcp);
+	if (!(flags & NET_TCP_SYN)) {
+		wnd >>= tcp->rcv_wscale;
+	}
+
+	/* Once timestamps are agreed on, every segment but RST carries
+	 * one (RFC 7323 3.2).
+	 */
+	if (!options && (tcp->flags & NET_TCP_TS_OK) &&
+	    !(flags & NET_TCP_RST)) {
+		ts_options[0] = NET_TCP_NOP_OPT;
+		ts_options[1] = NET_TCP_NOP_OPT;
+		optlen = 2 + tcp_put_ts_opt(tcp, ts_options + 2);
+		options = ts_options;
+	}
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
 	segment.seq = tcp->send_seq;
 	segment.ack = tcp->send_ack;
 	segment.flags = flags;
-	segment.wnd = wnd;
+	segment.wnd = MIN(wnd, UINT16_MAX);
 	segment.options = options;
 	segment.optlen = optlen;
 
@@ -656,6 +968,9 @@ u16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 	return 0;
 }
 
+/* Options of a SYN or SYN-ACK, laid out in 32-bit words:
+ * MSS, [SACK-permitted], [timestamps], [window scale]
+ */
 static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 				u8_t *optionlen)
 {
@@ -663,18 +978,36 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 
 	*optionlen = 0U;
 
-	if (!(tcp->flags & NET_TCP_RECV_MSS_SET)) {
-		recv_mss = net_tcp_get_recv_mss(tcp);
-		tcp->flags |= NET_TCP_RECV_MSS_SET;
-	} else {
-		recv_mss = 0U;
-	}
-
+	recv_mss = net_tcp_get_recv_mss(tcp);
 	recv_mss |= (NET_TCP_MSS_OPT << 24) | (NET_TCP_MSS_SIZE << 16);
 	UNALIGNED_PUT(htonl(recv_mss),
 		      (u32_t *)(options + *optionlen));
 
 	*optionlen += NET_TCP_MSS_SIZE;
+
+	if (tcp->flags & NET_TCP_SACK_OK) {
+		if (!(tcp->flags & NET_TCP_TS_OK)) {
+			options[(*optionlen)++] = NET_TCP_NOP_OPT;
+			options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		}
+
+		options[(*optionlen)++] = NET_TCP_SACK_PERM_OPT;
+		options[(*optionlen)++] = NET_TCP_SACK_PERM_SIZE;
+	} else if (tcp->flags & NET_TCP_TS_OK) {
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	}
+
+	if (tcp->flags & NET_TCP_TS_OK) {
+		*optionlen += tcp_put_ts_opt(tcp, options + *optionlen);
+	}
+
+	if (tcp->flags & NET_TCP_WSCALE_OK) {
+		options[(*optionlen)++] = NET_TCP_NOP_OPT;
+		options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_OPT;
+		options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_SIZE;
+		options[(*optionlen)++] = tcp_wscale_shift();
+	}
 }
 
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
@@ -820,6 +1153,14 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 
 	net_pkt_set_appdatalen(pkt, net_pkt_get_len(pkt));
 
+	/* Data larger than what the peer accepts in one segment is split
+	 * by L2, see net_tcp_gso_send().
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP_GSO) &&
+	    data_len > context->tcp->send_mss) {
+		net_pkt_set_gso_size(pkt, context->tcp->send_mss);
+	}
+
 	/* Set PSH on all packets, our window is so small that there's
 	 * no point in the remote side trying to finesse things and
 	 * coalesce packets.
@@ -1126,6 +1467,8 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 		valid_ack = true;
 	}
 
+	tcp_sack_ack(tcp, ack);
+
 	/* Restart the timer (if needed) on a valid inbound ACK.  This isn't
 	 * quite the same behavior as per-packet retry timers, but is close in
 	 * practice (it starts retries one timer period after the connection
@@ -1284,6 +1627,7 @@ int net_tcp_finalize(struct net_pkt *pkt)
 int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 		       struct net_tcp_options *opts)
 {
+	struct net_tcp_sack_block *blk;
 	u8_t opt, optlen;
 
 	while (opt_totlen) {
@@ -1335,6 +1679,60 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 				goto error;
 			}
 
+			opts->found |= NET_TCP_OPT_HAS_MSS;
+			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1) {
+				goto error;
+			}
+
+			if (net_pkt_read_u8_new(pkt, &opts->wscale)) {
+				goto error;
+			}
+
+			/* RFC 7323 2.3: larger values are treated as 14 */
+			opts->wscale = MIN(opts->wscale, NET_TCP_MAX_WSCALE);
+			opts->found |= NET_TCP_OPT_HAS_WSCALE;
+			break;
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0) {
+				goto error;
+			}
+
+			opts->found |= NET_TCP_OPT_HAS_SACK_PERM;
+			break;
+		case NET_TCP_SACK_OPT:
+			/* The 40 bytes of option space hold 4 blocks at most */
+			if (!optlen || (optlen % NET_TCP_SACK_BLOCK_SIZE) ||
+			    (optlen / NET_TCP_SACK_BLOCK_SIZE) >
+			    NET_TCP_SACK_MAX_BLOCKS) {
+				goto error;
+			}
+
+			for (opts->sack_count = 0U;
+			     opts->sack_count < optlen / NET_TCP_SACK_BLOCK_SIZE;
+			     opts->sack_count++) {
+				blk = &opts->sack[opts->sack_count];
+
+				if (net_pkt_read_be32_new(pkt, &blk->left) ||
+				    net_pkt_read_be32_new(pkt, &blk->right)) {
+					goto error;
+				}
+			}
+
+			opts->found |= NET_TCP_OPT_HAS_SACK;
+			break;
+		case NET_TCP_TIMESTAMP_OPT:
+			if (optlen != 8) {
+				goto error;
+			}
+
+			if (net_pkt_read_be32_new(pkt, &opts->tsval) ||
+			    net_pkt_read_be32_new(pkt, &opts->tsecr)) {
+				goto error;
+			}
+
+			opts->found |= NET_TCP_OPT_HAS_TS;
 			break;
 		default:
 			if (net_pkt_skip(pkt, optlen)) {
@@ -1427,7 +1825,7 @@ int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 	}
 
 	new_win = context->tcp->recv_wnd + delta;
-	if (new_win < 0 || new_win > UINT16_MAX) {
+	if (new_win < 0 || new_win > NET_TCP_RECV_WND_MAX) {
 		return -EINVAL;
 	}
 
@@ -1574,6 +1972,9 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
 	tcp_backlog[empty_slot].send_mss = send_mss;
+	tcp_backlog[empty_slot].opt_flags = context->tcp->flags &
+					    NET_TCP_SYN_OPT_FLAGS;
+	tcp_backlog[empty_slot].ts_recent = tcp_ts_recent(context->tcp);
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
@@ -1605,6 +2006,13 @@ static int tcp_backlog_ack(struct net_pkt *pkt,
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
 
+	context->tcp->flags &= ~NET_TCP_SYN_OPT_FLAGS;
+	context->tcp->flags |= tcp_backlog[r].opt_flags;
+	context->tcp->rcv_wscale =
+		(tcp_backlog[r].opt_flags & NET_TCP_WSCALE_OK) ?
+		tcp_wscale_shift() : 0U;
+	tcp_set_ts_recent(context->tcp, tcp_backlog[r].ts_recent);
+
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
 
@@ -1793,9 +2201,7 @@ static inline int send_syn_segment(struct net_context *context,
 	u8_t options[NET_TCP_MAX_OPT_SIZE];
 	u8_t optionlen = 0U;
 
-	if (flags == NET_TCP_SYN) {
-		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
-	}
+	net_tcp_set_syn_opt(context->tcp, options, &optionlen);
 
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
 				      local, remote, &pkt);
@@ -1897,7 +2303,9 @@ NET_CONN_CB(tcp_established)
 {
 	struct net_context *context = (struct net_context *)user_data;
 	struct net_tcp_hdr *tcp_hdr = proto_hdr->tcp;
+	struct net_tcp_options tcp_opts = { 0 };
 	enum net_verdict ret = NET_OK;
+	int opt_totlen;
 	u8_t tcp_flags;
 	u16_t data_len;
 
@@ -1916,6 +2324,25 @@ NET_CONN_CB(tcp_established)
 
 	tcp_flags = NET_TCP_FLAGS(tcp_hdr);
 
+	/* This also moves the cursor past the options, to the data */
+	opt_totlen = NET_TCP_HDR_LEN(tcp_hdr) - sizeof(struct net_tcp_hdr);
+	if (opt_totlen > 0 &&
+	    net_tcp_parse_opts(pkt, opt_totlen, &tcp_opts) < 0) {
+		ret = NET_DROP;
+		goto unlock;
+	}
+
+	/* RFC 7323 5.3 (PAWS): a timestamp older than the latest one
+	 * seen marks an old duplicate, acknowledge and drop it.
+	 */
+	if ((context->tcp->flags & NET_TCP_TS_OK) &&
+	    (tcp_opts.found & NET_TCP_OPT_HAS_TS) &&
+	    !(tcp_flags & NET_TCP_RST) &&
+	    net_tcp_seq_cmp(tcp_opts.tsval,
+			    tcp_ts_recent(context->tcp)) < 0) {
+		goto resend_ack;
+	}
+
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) < 0) {
 		/* Peer sent us packet we've already seen. Apparently,
@@ -1941,6 +2368,14 @@ resend_ack:
 		goto unlock;
 	}
 
+	/* The segment is the next in sequence, so its timestamp is the
+	 * one to echo (RFC 7323 4.3).
+	 */
+	if ((context->tcp->flags & NET_TCP_TS_OK) &&
+	    (tcp_opts.found & NET_TCP_OPT_HAS_TS)) {
+		tcp_set_ts_recent(context->tcp, tcp_opts.tsval);
+	}
+
 	/*
 	 * If we receive RST here, we close the socket. See RFC 793 chapter
 	 * called "Reset Processing" for details.
@@ -1970,6 +2405,9 @@ resend_ack:
 
 	/* Handle TCP state transition */
 	if (tcp_flags & NET_TCP_ACK) {
+		tcp_sack_update(context->tcp, sys_get_be32(tcp_hdr->ack),
+				&tcp_opts);
+
 		if (!net_tcp_ack_received(context,
 					  sys_get_be32(tcp_hdr->ack))) {
 			ret = NET_DROP;
@@ -2134,6 +2572,20 @@ NET_CONN_CB(tcp_synack_received)
 	}
 
 	if (NET_TCP_FLAGS(tcp_hdr) & NET_TCP_SYN) {
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+		};
+		int opt_totlen;
+
+		opt_totlen = NET_TCP_HDR_LEN(tcp_hdr)
+			     - sizeof(struct net_tcp_hdr);
+		if (net_tcp_parse_opts(pkt, opt_totlen, &tcp_opts) < 0) {
+			return NET_DROP;
+		}
+
+		context->tcp->send_mss = tcp_opts.mss;
+		tcp_apply_syn_opts(context->tcp, &tcp_opts);
+
 		context->tcp->send_ack =
 			sys_get_be32(tcp_hdr->seq) + 1;
 	}
@@ -2290,6 +2742,11 @@ NET_CONN_CB(tcp_syn_rcvd)
 
 		net_tcp_change_state(tcp, NET_TCP_SYN_RCVD);
 
+		/* Negotiated options, like seq and ack below, are kept in
+		 * the listening context only until stored in the backlog.
+		 */
+		tcp_apply_syn_opts(tcp, &tcp_opts);
+
 		/* Set TCP seq and ack which are then stored in the backlog */
 		context->tcp->send_seq = tcp_init_isn();
 		context->tcp->send_ack =
@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** Peer sent SACK-permitted (RFC 2018), SACK blocks will be processed */
+#define NET_TCP_SACK_OK BIT(1)
+
+/** Timestamps (RFC 7323) are in use on this connection */
+#define NET_TCP_TS_OK BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -37,8 +41,14 @@ extern "C" {
 /** A retransmitted packet has been sent and not yet ack'd */
 #define NET_TCP_RETRYING BIT(4)
 
-/** MSS option has been set already */
-#define NET_TCP_RECV_MSS_SET BIT(5)
+/* BIT(5) is unused and available */
+
+/** Window scaling (RFC 7323) is in use on this connection */
+#define NET_TCP_WSCALE_OK BIT(6)
+
+/** Options negotiated on the SYN exchange */
+#define NET_TCP_SYN_OPT_FLAGS (NET_TCP_SACK_OK | NET_TCP_TS_OK | \
+			       NET_TCP_WSCALE_OK)
 
 /*
  * TCP connection states
@@ -83,28 +93,80 @@ enum net_tcp_state {
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
+/* Largest option block we put in a segment: MSS, SACK-permitted,
+ * timestamps and window scale on a SYN.
+ */
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE) || defined(CONFIG_NET_TCP_SACK) || \
+	defined(CONFIG_NET_TCP_TIMESTAMPS)
+#define NET_TCP_MAX_OPT_SIZE  20
+#else
 #define NET_TCP_MAX_OPT_SIZE  8
+#endif
 
 /* TCP Option codes */
 #define NET_TCP_END_OPT          0
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
+#define NET_TCP_TIMESTAMP_OPT    8
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+#define NET_TCP_SACK_BLOCK_SIZE   8
+#define NET_TCP_TIMESTAMP_SIZE    10
+
+/* RFC 7323 2.3: the shift count is limited to 14 */
+#define NET_TCP_MAX_WSCALE 14
+
+/* At most 4 SACK blocks fit in the 40 bytes of option space */
+#define NET_TCP_SACK_MAX_BLOCKS 4
+
+/* Options found by net_tcp_parse_opts() */
+#define NET_TCP_OPT_HAS_MSS       BIT(0)
+#define NET_TCP_OPT_HAS_WSCALE    BIT(1)
+#define NET_TCP_OPT_HAS_SACK_PERM BIT(2)
+#define NET_TCP_OPT_HAS_SACK      BIT(3)
+#define NET_TCP_OPT_HAS_TS        BIT(4)
+
+/** Range of sequence space [left, right) reported by a SACK block */
+struct net_tcp_sack_block {
+	u32_t left;
+	u32_t right;
+};
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	/** Window scale shift count sent by the peer */
+	u8_t wscale;
+	/** NET_TCP_OPT_HAS_* bits of the options present */
+	u8_t found;
+	/** Timestamp value and echo reply */
+	u32_t tsval;
+	u32_t tsecr;
+	/** Number of valid entries in sack */
+	u8_t sack_count;
+	struct net_tcp_sack_block sack[NET_TCP_SACK_MAX_BLOCKS];
 };
 
 /* Max received bytes to buffer internally */
 #define NET_TCP_BUF_MAX_LEN 1280
 
+/* Initial receive window and the largest one we can advertise */
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+#define NET_TCP_RECV_WND_INIT CONFIG_NET_TCP_RECV_WINDOW_SIZE
+#define NET_TCP_RECV_WND_MAX ((u32_t)UINT16_MAX << NET_TCP_MAX_WSCALE)
+#else
+#define NET_TCP_RECV_WND_INIT MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN)
+#define NET_TCP_RECV_WND_MAX UINT16_MAX
+#endif
+
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
@@ -151,10 +213,23 @@ struct net_tcp {
 	 */
 	struct k_sem connect_wait;
 
+#if defined(CONFIG_NET_TCP_TIMESTAMPS)
+	/** Latest timestamp received from the peer (TS.Recent) */
+	u32_t ts_recent;
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK)
+	/** SACK scoreboard: data the peer holds above the cumulative ACK */
+	struct net_tcp_sack_block sacked[NET_TCP_SACK_MAX_BLOCKS];
+
+	/** Number of valid entries in the scoreboard */
+	u8_t sacked_count;
+#endif
+
 	/**
 	 * Current TCP receive window for our side
 	 */
-	u16_t recv_wnd;
+	u32_t recv_wnd;
 
 	/**
 	 * Send MSS for the peer
@@ -171,8 +246,10 @@ struct net_tcp {
 	u32_t fin_sent : 1;
 	/* An inbound FIN packet has been received */
 	u32_t fin_rcvd : 1;
+	/** Shift applied to the receive window we advertise */
+	u32_t rcv_wscale : 4;
 	/** Remaining bits in this u32_t */
-	u32_t _padding : 13;
+	u32_t _padding : 9;
 };
 
 typedef void (*net_tcp_cb_t)(struct net_tcp *tcp, void *user_data);
@@ -561,8 +638,8 @@ static inline int net_tcp_finalize(struct net_pkt *pkt)
 /**
  * @brief Parse TCP options from network packet.
  *
- * Parse TCP options, returning MSS value (as that the only one we
- * handle so far).
+ * Parse TCP options: MSS, window scale, SACK-permitted, SACK blocks and
+ * timestamps. Other options are skipped.
  *
  * @param pkt Network packet
  * @param opt_totlen Total length of options to parse
@@ -793,6 +870,76 @@ void net_tcp_init(void);
 #define net_tcp_init(...)
 #endif
 
+/**
+ * @brief Send a TCP packet larger than the MTU as several segments.
+ *
+ * Used by L2 for packets that have a GSO size set when the driver cannot
+ * segment them itself. Each segment carries a copy of the IP and TCP
+ * headers with the lengths, sequence number and checksums adjusted.
+ *
+ * @param iface Network interface the packet is sent to
+ * @param pkt TCP packet to split, released on success only
+ * @param send L2 function that sends one segment. It returns the number
+ * of bytes sent and releases the segment, or a negative errno.
+ *
+ * @return Number of bytes sent, negative errno otherwise.
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt,
+		     int (*send)(struct net_if *iface, struct net_pkt *pkt));
+#else
+static inline int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt,
+				   int (*send)(struct net_if *iface,
+					       struct net_pkt *pkt))
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(send);
+
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Try to coalesce a received TCP segment with the previous ones
+ * of the same connection.
+ *
+ * Must be called from an RX traffic class thread, after the TCP header
+ * has been validated by net_tcp_input().
+ *
+ * @param pkt Network packet
+ * @param ip_hdr IP header of the packet
+ * @param proto_hdr TCP header of the packet
+ *
+ * @return NET_OK if the packet was merged or held, NET_CONTINUE if it
+ * must be passed to net_conn_input() by the caller.
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr);
+
+/**
+ * @brief Deliver the held segments of the calling RX thread if its
+ * queue is empty.
+ */
+void net_tcp_gro_flush_if_idle(void);
+#else
+static inline
+enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(ip_hdr);
+	ARG_UNUSED(proto_hdr);
+
+	return NET_CONTINUE;
+}
+
+#define net_tcp_gro_flush_if_idle(...)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,479 @@
+/** @file
+ * @brief TCP generic segmentation and receive offload
+ *
+ * GSO: TCP queues segments larger than the MTU, they are split just
+ * before being handed to the driver.
+ *
+ * GRO: in-order data segments of a connection that arrive back-to-back
+ * are merged before being passed to TCP.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <misc/byteorder.h>
+
+#include "connection.h"
+#include "net_private.h"
+#include "tcp_internal.h"
+#include "net_stats.h"
+
+#if defined(CONFIG_NET_TCP_GSO)
+
+#define GSO_ALLOC_TIMEOUT K_MSEC(100)
+
+static int gso_set_ip_hdr(struct net_if *iface, struct net_pkt *seg,
+			  u16_t id_inc)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(seg) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(
+							seg, &ipv4_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		sys_put_be16(sys_get_be16(hdr->id) + id_inc, hdr->id);
+		hdr->len = htons(net_pkt_get_len(seg));
+		hdr->chksum = 0U;
+
+		if (net_if_need_calc_tx_checksum(iface)) {
+			hdr->chksum = net_calc_chksum_ipv4(seg);
+		}
+
+		return net_pkt_set_data(seg, &ipv4_access);
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(seg) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *hdr;
+
+		hdr = (struct net_ipv6_hdr *)net_pkt_get_data_new(
+							seg, &ipv6_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		hdr->len = htons(net_pkt_get_len(seg) - NET_IPV6H_LEN);
+
+		if (net_pkt_set_data(seg, &ipv6_access)) {
+			return -ENOBUFS;
+		}
+
+		return net_pkt_skip(seg, net_pkt_ipv6_ext_len(seg));
+	}
+
+	return -EAFNOSUPPORT;
+}
+
+static int gso_set_tcp_hdr(struct net_if *iface, struct net_pkt *seg,
+			   u32_t seq, bool last)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_pkt_cursor backup;
+	struct net_tcp_hdr *tcp_hdr;
+
+	net_pkt_cursor_backup(seg, &backup);
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data_new(seg, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	sys_put_be32(seq, tcp_hdr->seq);
+
+	/* FIN and PSH belong to the end of the original segment */
+	if (!last) {
+		tcp_hdr->flags &= ~(NET_TCP_FIN | NET_TCP_PSH);
+	}
+
+	tcp_hdr->chksum = 0U;
+
+	if (net_pkt_set_data(seg, &tcp_access)) {
+		return -ENOBUFS;
+	}
+
+	if (!net_if_need_calc_tx_checksum(iface)) {
+		return 0;
+	}
+
+	/* No need to get tcp_hdr again */
+	tcp_hdr->chksum = net_calc_chksum_tcp(seg);
+
+	net_pkt_cursor_restore(seg, &backup);
+
+	return net_pkt_set_data(seg, &tcp_access);
+}
+
+static struct net_pkt *gso_segment(struct net_if *iface, struct net_pkt *pkt,
+				   size_t hdr_len, size_t offset, size_t len)
+{
+	struct net_pkt *seg;
+
+	seg = net_pkt_alloc_with_buffer(iface, hdr_len + len,
+					net_pkt_family(pkt), IPPROTO_TCP,
+					GSO_ALLOC_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(seg, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, offset) ||
+	    net_pkt_copy(seg, pkt, len)) {
+		net_pkt_unref(seg);
+		return NULL;
+	}
+
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tag(seg, net_pkt_vlan_tag(pkt));
+
+	memcpy(&seg->lladdr_src, &pkt->lladdr_src, sizeof(seg->lladdr_src));
+	memcpy(&seg->lladdr_dst, &pkt->lladdr_dst, sizeof(seg->lladdr_dst));
+
+	net_pkt_cursor_init(seg);
+	net_pkt_set_overwrite(seg, true);
+
+	return seg;
+}
+
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt,
+		     int (*send)(struct net_if *iface, struct net_pkt *pkt))
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	size_t ip_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	size_t total = net_pkt_get_len(pkt);
+	u16_t mtu = net_if_get_mtu(iface);
+	struct net_tcp_hdr *tcp_hdr;
+	size_t hdr_len, offset, mss;
+	int sent = 0;
+	u16_t i;
+	u32_t seq;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, ip_len)) {
+		return -EINVAL;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data_new(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	seq = sys_get_be32(tcp_hdr->seq);
+	hdr_len = ip_len + NET_TCP_HDR_LEN(tcp_hdr);
+
+	mss = net_pkt_gso_size(pkt);
+	if (mtu > hdr_len) {
+		mss = MIN(mss, mtu - hdr_len);
+	}
+
+	if (total <= hdr_len || !mss) {
+		return -EINVAL;
+	}
+
+	NET_DBG("Splitting pkt %p (%zd bytes) in %zd bytes segments",
+		pkt, total, mss);
+
+	for (offset = 0, i = 0; hdr_len + offset < total; offset += mss, i++) {
+		size_t len = MIN(mss, total - hdr_len - offset);
+		struct net_pkt *seg;
+		int ret;
+
+		seg = gso_segment(iface, pkt, hdr_len, offset, len);
+		if (!seg) {
+			return -ENOMEM;
+		}
+
+		ret = gso_set_ip_hdr(iface, seg, i);
+		if (!ret) {
+			ret = gso_set_tcp_hdr(iface, seg, seq + offset,
+					      hdr_len + offset + len == total);
+		}
+
+		if (!ret) {
+			net_pkt_cursor_init(seg);
+			ret = send(iface, seg);
+		}
+
+		if (ret < 0) {
+			NET_DBG("Cannot send segment %u of pkt %p (%d)",
+				i, pkt, ret);
+			net_pkt_unref(seg);
+			return ret;
+		}
+
+		sent += ret;
+	}
+
+	/* Like any packet sent by L2, the original is released on success */
+	net_pkt_unref(pkt);
+
+	return sent;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
+#if defined(CONFIG_NET_TCP_GRO)
+
+struct tcp_gro_flow {
+	/** Held packet, the other fields are only valid if it is set */
+	struct net_pkt *pkt;
+
+	/** Headers of the held packet, in its first buffer */
+	union net_ip_header ip;
+	union net_proto_header proto;
+
+	/** Sequence number expected from the next segment */
+	u32_t next_seq;
+
+	/** TCP payload held so far */
+	u16_t len;
+};
+
+/* The flows are only touched by the thread of their RX queue */
+static struct tcp_gro_flow gro_flows[NET_RX_QUEUE_COUNT]
+				    [CONFIG_NET_TCP_GRO_FLOWS];
+static u8_t gro_evict[NET_RX_QUEUE_COUNT];
+
+static bool gro_same_flow(struct tcp_gro_flow *flow, struct net_pkt *pkt,
+			  union net_ip_header *ip_hdr,
+			  struct net_tcp_hdr *tcp_hdr)
+{
+	if (net_pkt_family(flow->pkt) != net_pkt_family(pkt) ||
+	    net_pkt_iface(flow->pkt) != net_pkt_iface(pkt) ||
+	    flow->proto.tcp->src_port != tcp_hdr->src_port ||
+	    flow->proto.tcp->dst_port != tcp_hdr->dst_port) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		return net_ipv4_addr_cmp(&flow->ip.ipv4->src,
+					 &ip_hdr->ipv4->src) &&
+			net_ipv4_addr_cmp(&flow->ip.ipv4->dst,
+					  &ip_hdr->ipv4->dst);
+	}
+
+	return net_ipv6_addr_cmp(&flow->ip.ipv6->src, &ip_hdr->ipv6->src) &&
+		net_ipv6_addr_cmp(&flow->ip.ipv6->dst, &ip_hdr->ipv6->dst);
+}
+
+/* Only plain data segments are coalesced, and only if both headers are
+ * in the first buffer so that they can be referenced until the packet
+ * is delivered.
+ */
+static bool gro_can_hold(struct net_pkt *pkt, union net_ip_header *ip_hdr,
+			 struct net_tcp_hdr *tcp_hdr, int payload_len)
+{
+	u8_t *data = pkt->buffer->data;
+	size_t ip_len = net_pkt_ip_hdr_len(pkt);
+
+	if (payload_len <= 0 ||
+	    NET_TCP_FLAGS(tcp_hdr) & ~(NET_TCP_ACK | NET_TCP_PSH) ||
+	    !(NET_TCP_FLAGS(tcp_hdr) & NET_TCP_ACK) ||
+	    net_pkt_ipv6_ext_len(pkt)) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET &&
+	    ip_hdr->ipv4->vhl != 0x45) {
+		return false;
+	}
+
+	return (u8_t *)ip_hdr->ipv4 == data &&
+		(u8_t *)tcp_hdr == data + ip_len &&
+		ip_len + NET_TCP_HDR_LEN(tcp_hdr) <= pkt->buffer->len;
+}
+
+static bool gro_can_merge(struct tcp_gro_flow *flow,
+			  struct net_tcp_hdr *tcp_hdr, int payload_len)
+{
+	struct net_tcp_hdr *held = flow->proto.tcp;
+
+	return sys_get_be32(tcp_hdr->seq) == flow->next_seq &&
+		flow->len + payload_len <= CONFIG_NET_TCP_GRO_MAX_SIZE &&
+		held->offset == tcp_hdr->offset &&
+		!memcmp(held->ack, tcp_hdr->ack, sizeof(held->ack)) &&
+		!memcmp(held->wnd, tcp_hdr->wnd, sizeof(held->wnd)) &&
+		!memcmp(held->optdata, tcp_hdr->optdata,
+			NET_TCP_HDR_LEN(tcp_hdr) - NET_TCPH_LEN);
+}
+
+static void gro_hold(struct tcp_gro_flow *flow, struct net_pkt *pkt,
+		     union net_ip_header *ip_hdr, struct net_tcp_hdr *tcp_hdr,
+		     int payload_len)
+{
+	flow->pkt = pkt;
+	flow->ip = *ip_hdr;
+	flow->proto.tcp = tcp_hdr;
+	flow->next_seq = sys_get_be32(tcp_hdr->seq) + payload_len;
+	flow->len = payload_len;
+}
+
+static void gro_merge(struct tcp_gro_flow *flow, struct net_pkt *pkt,
+		      struct net_tcp_hdr *tcp_hdr, int payload_len)
+{
+	flow->proto.tcp->flags |= tcp_hdr->flags & NET_TCP_PSH;
+
+	/* Only the payload is kept, its buffers are appended to the held
+	 * packet without copying.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_pull(pkt, net_pkt_get_len(pkt) - payload_len);
+
+	net_pkt_frag_add(flow->pkt, pkt->buffer);
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+
+	flow->next_seq += payload_len;
+	flow->len += payload_len;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_pkt_family(flow->pkt) == AF_INET) {
+		flow->ip.ipv4->len = htons(ntohs(flow->ip.ipv4->len) +
+					   payload_len);
+	} else {
+		flow->ip.ipv6->len = htons(ntohs(flow->ip.ipv6->len) +
+					   payload_len);
+	}
+}
+
+static void gro_flush(struct tcp_gro_flow *flow)
+{
+	struct net_pkt *pkt = flow->pkt;
+
+	flow->pkt = NULL;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		flow->ip.ipv4->chksum = 0U;
+		flow->ip.ipv4->chksum = net_calc_chksum_ipv4(pkt);
+	}
+
+	/* Put the cursor back where net_tcp_input() left it */
+	net_pkt_cursor_init(pkt);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) + sizeof(struct net_tcp_hdr));
+
+	NET_DBG("Delivering pkt %p with %u bytes of data", pkt, flow->len);
+
+	if (net_conn_input(pkt, &flow->ip, IPPROTO_TCP,
+			   &flow->proto) == NET_DROP) {
+		if (net_pkt_family(pkt) == AF_INET) {
+			net_stats_update_ipv4_drop(net_pkt_iface(pkt));
+		} else {
+			net_stats_update_ipv6_drop(net_pkt_iface(pkt));
+		}
+
+		net_pkt_unref(pkt);
+	}
+}
+
+enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr)
+{
+	struct net_tcp_hdr *tcp_hdr = proto_hdr->tcp;
+	struct tcp_gro_flow *flows;
+	struct tcp_gro_flow *flow = NULL;
+	int payload_len;
+	int queue, i;
+
+	queue = net_tc_rx_current();
+	if (queue < 0) {
+		return NET_CONTINUE;
+	}
+
+	flows = gro_flows[queue];
+
+	payload_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ipv6_ext_len(pkt) - NET_TCP_HDR_LEN(tcp_hdr);
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_FLOWS; i++) {
+		if (flows[i].pkt &&
+		    gro_same_flow(&flows[i], pkt, ip_hdr, tcp_hdr)) {
+			flow = &flows[i];
+			break;
+		}
+	}
+
+	if (flow) {
+		if (gro_can_hold(pkt, ip_hdr, tcp_hdr, payload_len) &&
+		    gro_can_merge(flow, tcp_hdr, payload_len)) {
+			gro_merge(flow, pkt, tcp_hdr, payload_len);
+
+			/* The sender wants the data passed up now */
+			if (tcp_hdr->flags & NET_TCP_PSH) {
+				gro_flush(flow);
+			}
+
+			return NET_OK;
+		}
+
+		/* Keep the segments of the connection in order */
+		gro_flush(flow);
+	}
+
+	/* Nothing to merge with if no other packet is pending */
+	if (net_tc_rx_queue_is_empty(queue) ||
+	    (tcp_hdr->flags & NET_TCP_PSH) ||
+	    !gro_can_hold(pkt, ip_hdr, tcp_hdr, payload_len)) {
+		return NET_CONTINUE;
+	}
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_FLOWS; i++) {
+		if (!flows[i].pkt) {
+			flow = &flows[i];
+			break;
+		}
+	}
+
+	if (!flow || flow->pkt) {
+		flow = &flows[gro_evict[queue]];
+		gro_evict[queue] = (gro_evict[queue] + 1) %
+			CONFIG_NET_TCP_GRO_FLOWS;
+
+		gro_flush(flow);
+	}
+
+	gro_hold(flow, pkt, ip_hdr, tcp_hdr, payload_len);
+
+	return NET_OK;
+}
+
+void net_tcp_gro_flush_if_idle(void)
+{
+	int queue, i;
+
+	queue = net_tc_rx_current();
+	if (queue < 0 || !net_tc_rx_queue_is_empty(queue)) {
+		return;
+	}
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_FLOWS; i++) {
+		if (gro_flows[queue][i].pkt) {
+			gro_flush(&gro_flows[queue][i]);
+		}
+	}
+}
+#endif /* CONFIG_NET_TCP_GRO */
@@ -400,38 +400,127 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
-static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+/* The checksum engine sums the data as native endian words into a 64-bit
+ * accumulator and folds the carries only once at the end (RFC 1071).
+ * The result is then converted to the value the old 16 bits at a time
+ * loop produced, i.e. the sum of the big endian 16-bit words in host
+ * order, so callers can keep combining it with pseudo header values.
+ */
+typedef u16_t __may_alias chksum_u16_t;
+typedef u32_t __may_alias chksum_u32_t;
+
+#define CHKSUM_SWAP(x) ((u16_t)(((x) << 8) | ((x) >> 8)))
+
+/* Value of a lone byte sitting at the first or the second address of a
+ * native 16-bit word.
+ */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CHKSUM_BYTE_FIRST(b) ((u64_t)(b))
+#define CHKSUM_BYTE_SECOND(b) ((u64_t)(b) << 8)
+#else
+#define CHKSUM_BYTE_FIRST(b) ((u64_t)(b) << 8)
+#define CHKSUM_BYTE_SECOND(b) ((u64_t)(b))
+#endif
+
+static inline u16_t chksum_add(u16_t sum, u16_t val)
 {
-	const u8_t *end;
-	u16_t tmp;
+	sum += val;
+	if (sum < val) {
+		sum++;
+	}
 
-	end = data + len - 1;
+	return sum;
+}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+static inline u16_t chksum_fold(u64_t acc)
+{
+	u32_t sum;
 
-		data += 2;
+	acc = (acc & 0xffffffff) + (acc >> 32);
+	acc = (acc & 0xffffffff) + (acc >> 32);
+
+	sum = (u32_t)acc;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+/* Sum len bytes from src, loading aligned words after the leading odd
+ * byte and half word.
+ */
+static u16_t chksum_words(const u8_t *src, size_t len)
+{
+	bool odd = (uintptr_t)src & 1;
+	u64_t acc = 0U;
+
+	if (!len) {
+		return 0;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	/* A leading odd byte is the second half of a memory word, which
+	 * shifts the 16-bit word boundaries by one. This is undone by a
+	 * byte swap of the folded result.
+	 */
+	if (odd) {
+		acc = CHKSUM_BYTE_SECOND(*src);
+		src++;
+		len--;
 	}
 
-	return sum;
+	if (len >= 2 && ((uintptr_t)src & 2)) {
+		acc += *(const chksum_u16_t *)src;
+		src += 2;
+		len -= 2;
+	}
+
+	while (len >= 16) {
+		const chksum_u32_t *w = (const chksum_u32_t *)src;
+
+		acc += (u64_t)w[0] + w[1] + w[2] + w[3];
+		src += 16;
+		len -= 16;
+	}
+
+	while (len >= 4) {
+		acc += *(const chksum_u32_t *)src;
+		src += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
+		acc += *(const chksum_u16_t *)src;
+		src += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		acc += CHKSUM_BYTE_FIRST(*src);
+	}
+
+	if (odd) {
+		return ntohs(CHKSUM_SWAP(chksum_fold(acc)));
+	}
+
+	return ntohs(chksum_fold(acc));
+}
+
+static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	return chksum_add(sum, chksum_words(data, len));
+}
+
+u16_t net_calc_chksum_buf(u16_t sum, const u8_t *data, size_t len)
+{
+	return calc_chksum(sum, data, len);
 }
 
 static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
+	bool odd = false;
 	size_t len;
+	u16_t tmp;
 
 	if (!cur->buf || !cur->pos) {
 		return sum;
@@ -440,7 +529,17 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 	len = cur->buf->len - (cur->pos - cur->buf->data);
 
 	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		/* Each fragment is summed on its own. One that starts at an
+		 * odd offset of the packet has its words shifted by a byte,
+		 * which a byte swap of its sum compensates.
+		 */
+		tmp = calc_chksum(0, cur->pos, len);
+		if (odd) {
+			tmp = CHKSUM_SWAP(tmp);
+		}
+
+		sum = chksum_add(sum, tmp);
+		odd ^= len & 1;
 
 		cur->buf = cur->buf->frags;
 		if (!cur->buf || !cur->buf->len) {
@@ -448,18 +547,7 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 		}
 
 		cur->pos = cur->buf->data;
-
-		if (len % 2) {
-			sum += *cur->pos;
-			if (sum < *cur->pos) {
-				sum++;
-			}
-
-			cur->pos++;
-			len = cur->buf->len - 1;
-		} else {
-			len = cur->buf->len;
-		}
+		len = cur->buf->len;
 	}
 
 	return sum;
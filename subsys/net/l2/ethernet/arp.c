@@ -18,46 +18,78 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 #include <net/net_stats.h>
 
 #include "arp.h"
+#include "eth_stats.h"
 #include "net_private.h"
+#include "route.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT K_SECONDS(2)
 
+BUILD_ASSERT_MSG((CONFIG_NET_ARP_HASH_SIZE &
+		  (CONFIG_NET_ARP_HASH_SIZE - 1)) == 0,
+		 "CONFIG_NET_ARP_HASH_SIZE must be a power of two");
+
 static bool arp_cache_initialized;
 static struct arp_entry arp_entries[CONFIG_NET_ARP_TABLE_SIZE];
 
-static sys_slist_t arp_free_entries;
-static sys_slist_t arp_pending_entries;
-static sys_slist_t arp_table;
+/* Every entry is in exactly one of these lists. The table is kept in
+ * least recently used order, the pending list in request order.
+ */
+static sys_dlist_t arp_free_entries;
+static sys_dlist_t arp_pending_entries;
+static sys_dlist_t arp_table;
+
+/* Both resolved and pending entries are found through the hash */
+static sys_dlist_t arp_hash[CONFIG_NET_ARP_HASH_SIZE];
 
 struct k_delayed_work arp_request_timer;
 
+static inline sys_dlist_t *arp_hash_bucket(struct net_if *iface,
+					   struct in_addr *addr)
+{
+	u32_t hash;
+
+	hash = net_hash_mix(POINTER_TO_UINT(iface),
+			    UNALIGNED_GET(&addr->s_addr));
+
+	return &arp_hash[hash & (CONFIG_NET_ARP_HASH_SIZE - 1)];
+}
+
 static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 {
+	int i;
+
 	NET_DBG("%p", entry);
 
 	if (pending) {
-		NET_DBG("Releasing pending pkt %p (ref %d)",
-			entry->pending,
-			atomic_get(&entry->pending->atomic_ref) - 1);
-		net_pkt_unref(entry->pending);
-		entry->pending = NULL;
+		for (i = 0; i < entry->pending_count; i++) {
+			NET_DBG("Releasing pending pkt %p (ref %d)",
+				entry->pending[i],
+				atomic_get(&entry->pending[i]->atomic_ref) - 1);
+			net_pkt_unref(entry->pending[i]);
+			entry->pending[i] = NULL;
+		}
+	}
+
+	if (sys_dnode_is_linked(&entry->hash_node)) {
+		sys_dlist_remove(&entry->hash_node);
 	}
 
 	entry->iface = NULL;
+	entry->is_pending = false;
+	entry->pending_count = 0U;
 
 	(void)memset(&entry->ip, 0, sizeof(struct in_addr));
 	(void)memset(&entry->eth, 0, sizeof(struct net_eth_addr));
 }
 
-static struct arp_entry *arp_entry_find(sys_slist_t *list,
-					struct net_if *iface,
-					struct in_addr *dst,
-					sys_snode_t **previous)
+static struct arp_entry *arp_entry_find(struct net_if *iface,
+					struct in_addr *dst)
 {
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(list, entry, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER(arp_hash_bucket(iface, dst),
+				     entry, hash_node) {
 		NET_DBG("iface %p dst %s",
 			iface, log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
@@ -65,10 +97,6 @@ static struct arp_entry *arp_entry_find(sys_slist_t *list,
 		    net_ipv4_addr_cmp(&entry->ip, dst)) {
 			return entry;
 		}
-
-		if (previous) {
-			*previous = &entry->node;
-		}
 	}
 
 	return NULL;
@@ -77,24 +105,21 @@ static struct arp_entry *arp_entry_find(sys_slist_t *list,
 static inline struct arp_entry *arp_entry_find_move_first(struct net_if *iface,
 							  struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_table, iface, dst, &prev);
-	if (entry) {
-		/* Let's assume the target is going to be accessed
-		 * more than once here in a short time frame. So we
-		 * place the entry first in position into the table
-		 * in order to reduce subsequent find.
-		 */
-		if (&entry->node != sys_slist_peek_head(&arp_table)) {
-			sys_slist_remove(&arp_table, prev, &entry->node);
-			sys_slist_prepend(&arp_table, &entry->node);
-		}
+	entry = arp_entry_find(iface, dst);
+	if (!entry || entry->is_pending) {
+		return NULL;
 	}
 
+	/* Let's assume the target is going to be accessed more than once
+	 * here in a short time frame, so it is the last one to be evicted.
+	 */
+	sys_dlist_remove(&entry->node);
+	sys_dlist_prepend(&arp_table, &entry->node);
+
 	return entry;
 }
 
@@ -102,26 +127,33 @@ static inline
 struct arp_entry *arp_entry_find_pending(struct net_if *iface,
 					 struct in_addr *dst)
 {
+	struct arp_entry *entry;
+
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	return arp_entry_find(&arp_pending_entries, iface, dst, NULL);
+	entry = arp_entry_find(iface, dst);
+	if (!entry || !entry->is_pending) {
+		return NULL;
+	}
+
+	return entry;
 }
 
 static struct arp_entry *arp_entry_get_pending(struct net_if *iface,
 					       struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_pending_entries, iface, dst, &prev);
+	entry = arp_entry_find_pending(iface, dst);
 	if (entry) {
 		/* We remove the entry from the pending list */
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
+		sys_dlist_remove(&entry->node);
+		entry->is_pending = false;
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_delayed_work_cancel(&arp_request_timer);
 	}
 
@@ -130,44 +162,71 @@ static struct arp_entry *arp_entry_get_pending(struct net_if *iface,
 
 static struct arp_entry *arp_entry_get_free(void)
 {
-	sys_snode_t *node;
+	sys_dnode_t *node;
 
-	node = sys_slist_peek_head(&arp_free_entries);
+	node = sys_dlist_get(&arp_free_entries);
 	if (!node) {
 		return NULL;
 	}
 
-	/* We remove the node from the free list */
-	sys_slist_remove(&arp_free_entries, NULL, node);
-
 	return CONTAINER_OF(node, struct arp_entry, node);
 }
 
 static struct arp_entry *arp_entry_get_last_from_table(void)
 {
-	sys_snode_t *node;
+	struct arp_entry *entry;
+	sys_dnode_t *node;
 
-	/* We assume last entry is the oldest one,
-	 * so is the preferred one to be taken out.
+	/* The last entry is the least recently used one, so it is the
+	 * preferred one to be taken out.
 	 */
-
-	node = sys_slist_peek_tail(&arp_table);
+	node = sys_dlist_peek_tail(&arp_table);
 	if (!node) {
 		return NULL;
 	}
 
-	sys_slist_find_and_remove(&arp_table, node);
+	sys_dlist_remove(node);
 
-	return CONTAINER_OF(node, struct arp_entry, node);
+	entry = CONTAINER_OF(node, struct arp_entry, node);
+
+	arp_entry_cleanup(entry, false);
+
+	return entry;
 }
 
+static bool arp_entry_queue_pending(struct arp_entry *entry,
+				    struct net_pkt *pkt)
+{
+	int i;
+
+	/* A packet that is sent again while waiting is only sent once */
+	for (i = 0; i < entry->pending_count; i++) {
+		if (entry->pending[i] == pkt) {
+			return true;
+		}
+	}
+
+	if (entry->pending_count >= CONFIG_NET_ARP_PENDING_QUEUE_DEPTH) {
+		NET_DBG("Pending queue of %s full, dropping pkt %p",
+			log_strdup(net_sprint_ipv4_addr(&entry->ip)), pkt);
+		eth_stats_update_arp_pending_dropped(entry->iface);
+		return false;
+	}
+
+	entry->pending[entry->pending_count++] = net_pkt_ref(pkt);
+
+	return true;
+}
 
 static void arp_entry_register_pending(struct arp_entry *entry)
 {
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
-	sys_slist_append(&arp_pending_entries, &entry->node);
+	sys_dlist_append(&arp_pending_entries, &entry->node);
+	sys_dlist_append(arp_hash_bucket(entry->iface, &entry->ip),
+			 &entry->hash_node);
 
+	entry->is_pending = true;
 	entry->req_start = k_uptime_get();
 
 	/* Let's start the timer if necessary */
@@ -184,7 +243,7 @@ static void arp_request_timeout(struct k_work *work)
 
 	ARG_UNUSED(work);
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
 					  entry, next, node) {
 		if ((entry->req_start + ARP_REQUEST_TIMEOUT - current) > 0) {
 			break;
@@ -192,8 +251,8 @@ static void arp_request_timeout(struct k_work *work)
 
 		arp_entry_cleanup(entry, true);
 
-		sys_slist_remove(&arp_pending_entries, NULL, &entry->node);
-		sys_slist_append(&arp_free_entries, &entry->node);
+		sys_dlist_remove(&entry->node);
+		sys_dlist_append(&arp_free_entries, &entry->node);
 
 		entry = NULL;
 	}
@@ -265,11 +324,12 @@ static inline struct net_pkt *arp_prepare(struct net_if *iface,
 	 * request and we want to send it again.
 	 */
 	if (entry) {
-		entry->pending = net_pkt_ref(pending);
 		entry->iface = net_pkt_iface(pkt);
 
 		net_ipaddr_copy(&entry->ip, next_addr);
 
+		arp_entry_queue_pending(entry, pending);
+
 		net_pkt_lladdr_src(pkt)->addr =
 			(u8_t *)net_if_get_link_addr(entry->iface)->addr;
 
@@ -329,8 +389,16 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	if (!current_ip &&
 	    !net_if_ipv4_addr_mask_cmp(net_pkt_iface(pkt), request_ip)) {
 		struct net_if_ipv4 *ipv4 = net_pkt_iface(pkt)->config.ip.ipv4;
+		struct net_route_entry_ipv4 *route = NULL;
 
-		if (ipv4) {
+#if defined(CONFIG_NET_ROUTE_IPV4)
+		/* A more specific route wins over the default gateway */
+		route = net_route_ipv4_lookup(net_pkt_iface(pkt), request_ip);
+#endif
+
+		if (route) {
+			addr = &route->nexthop;
+		} else if (ipv4) {
 			addr = &ipv4->gw;
 			if (net_ipv4_is_addr_unspecified(addr)) {
 				NET_ERR("Gateway not set for iface %p",
@@ -352,6 +420,8 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	if (!entry) {
 		struct net_pkt *req;
 
+		eth_stats_update_arp_miss(net_pkt_iface(pkt));
+
 		entry = arp_entry_find_pending(net_pkt_iface(pkt), addr);
 		if (!entry) {
 			/* No pending, let's try to get a new entry */
@@ -361,7 +431,10 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 				entry = arp_entry_get_last_from_table();
 			}
 		} else {
-			/* There is a pending already */
+			/* There is a pending already, the packet waits
+			 * for the same reply if there is room for it.
+			 */
+			arp_entry_queue_pending(entry, pkt);
 			entry = NULL;
 		}
 
@@ -369,9 +442,9 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 				  current_ip);
 
 		if (!entry) {
-			/* We cannot send the packet, the ARP cache is full
-			 * or there is already a pending query to this IP
-			 * address, so this packet must be discarded.
+			/* The ARP cache is full or there is already a
+			 * pending query to this IP address, so the request
+			 * is sent again.
 			 */
 			NET_DBG("Resending ARP %p", req);
 		}
@@ -379,6 +452,8 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 		return req;
 	}
 
+	eth_stats_update_arp_hit(net_pkt_iface(pkt));
+
 	net_pkt_lladdr_src(pkt)->addr =
 		(u8_t *)net_if_get_link_addr(entry->iface)->addr;
 	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
@@ -398,11 +473,10 @@ static void arp_gratuitous(struct net_if *iface,
 			   struct in_addr *src,
 			   struct net_eth_addr *hwaddr)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	entry = arp_entry_find(&arp_table, iface, src, &prev);
-	if (entry) {
+	entry = arp_entry_find(iface, src);
+	if (entry && !entry->is_pending) {
 		NET_DBG("Gratuitous ARP hwaddr %s -> %s",
 			log_strdup(net_sprint_ll_addr(
 					   (const u8_t *)&entry->eth,
@@ -423,6 +497,7 @@ static void arp_update(struct net_if *iface,
 {
 	struct arp_entry *entry;
 	struct net_pkt *pkt;
+	u8_t count, i;
 
 	NET_DBG("src %s", log_strdup(net_sprint_ipv4_addr(src)));
 
@@ -433,11 +508,10 @@ static void arp_update(struct net_if *iface,
 		}
 
 		if (force) {
-			sys_snode_t *prev = NULL;
 			struct arp_entry *entry;
 
-			entry = arp_entry_find(&arp_table, iface, src, &prev);
-			if (entry) {
+			entry = arp_entry_find(iface, src);
+			if (entry && !entry->is_pending) {
 				memcpy(&entry->eth, hwaddr,
 				       sizeof(struct net_eth_addr));
 			}
@@ -446,24 +520,32 @@ static void arp_update(struct net_if *iface,
 		return;
 	}
 
-	/* Set the dst in the pending packet */
-	net_pkt_lladdr_dst(entry->pending)->len = sizeof(struct net_eth_addr);
-	net_pkt_lladdr_dst(entry->pending)->addr =
-		(u8_t *) &NET_ETH_HDR(entry->pending)->dst.addr;
+	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
 
-	NET_DBG("dst %s pending %p frag %p",
-		log_strdup(net_sprint_ipv4_addr(&entry->ip)),
-		entry->pending, entry->pending->frags);
+	/* Inserting entry into the table */
+	sys_dlist_prepend(&arp_table, &entry->node);
 
-	pkt = entry->pending;
-	entry->pending = NULL;
+	count = entry->pending_count;
+	entry->pending_count = 0U;
 
-	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	/* Send the queued packets in the order they were sent by the
+	 * upper layers.
+	 */
+	for (i = 0U; i < count; i++) {
+		pkt = entry->pending[i];
+		entry->pending[i] = NULL;
 
-	/* Inserting entry into the table */
-	sys_slist_prepend(&arp_table, &entry->node);
+		/* Set the dst in the pending packet */
+		net_pkt_lladdr_dst(pkt)->len = sizeof(struct net_eth_addr);
+		net_pkt_lladdr_dst(pkt)->addr =
+			(u8_t *) &NET_ETH_HDR(pkt)->dst.addr;
 
-	net_if_queue_tx(iface, pkt);
+		NET_DBG("dst %s pending %p frag %p",
+			log_strdup(net_sprint_ipv4_addr(&entry->ip)),
+			pkt, pkt->frags);
+
+		net_if_queue_tx(iface, pkt);
+	}
 }
 
 static inline struct net_pkt *arp_prepare_reply(struct net_if *iface,
@@ -637,41 +719,36 @@ enum net_verdict net_arp_input(struct net_pkt *pkt,
 
 void net_arp_clear_cache(struct net_if *iface)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry, *next;
 
 	NET_DBG("Flushing ARP table");
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
 		if (iface && iface != entry->iface) {
-			prev = &entry->node;
 			continue;
 		}
 
 		arp_entry_cleanup(entry, false);
 
-		sys_slist_remove(&arp_table, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
+		sys_dlist_remove(&entry->node);
+		sys_dlist_prepend(&arp_free_entries, &entry->node);
 	}
 
-	prev = NULL;
-
 	NET_DBG("Flushing ARP pending requests");
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
 					  entry, next, node) {
 		if (iface && iface != entry->iface) {
-			prev = &entry->node;
 			continue;
 		}
 
 		arp_entry_cleanup(entry, true);
 
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
+		sys_dlist_remove(&entry->node);
+		sys_dlist_prepend(&arp_free_entries, &entry->node);
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_delayed_work_cancel(&arp_request_timer);
 	}
 }
@@ -681,7 +758,7 @@ int net_arp_foreach(net_arp_cb_t cb, void *user_data)
 	int ret = 0;
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
 		ret++;
 		cb(entry, user_data);
 	}
@@ -697,13 +774,17 @@ void net_arp_init(void)
 		return;
 	}
 
-	sys_slist_init(&arp_free_entries);
-	sys_slist_init(&arp_pending_entries);
-	sys_slist_init(&arp_table);
+	sys_dlist_init(&arp_free_entries);
+	sys_dlist_init(&arp_pending_entries);
+	sys_dlist_init(&arp_table);
+
+	for (i = 0; i < CONFIG_NET_ARP_HASH_SIZE; i++) {
+		sys_dlist_init(&arp_hash[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
 		/* Inserting entry as free */
-		sys_slist_prepend(&arp_free_entries, &arp_entries[i].node);
+		sys_dlist_prepend(&arp_free_entries, &arp_entries[i].node);
 	}
 
 	k_delayed_work_init(&arp_request_timer, arp_request_timeout);
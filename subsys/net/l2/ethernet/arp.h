@@ -13,7 +13,7 @@ extern "C" {
 
 #if defined(CONFIG_NET_ARP)
 
-#include <misc/slist.h>
+#include <misc/dlist.h>
 #include <net/ethernet.h>
 
 /**
@@ -50,14 +50,19 @@ enum net_verdict net_arp_input(struct net_pkt *pkt,
 			       struct net_eth_hdr *eth_hdr);
 
 struct arp_entry {
-	sys_snode_t node;
+	/** Node in the table (LRU ordered), pending or free list */
+	sys_dnode_t node;
+	/** Node in the lookup hash bucket, while the entry is in use */
+	sys_dnode_t hash_node;
 	s64_t req_start;
 	struct net_if *iface;
 	struct in_addr ip;
-	union {
-		struct net_pkt *pending;
-		struct net_eth_addr eth;
-	};
+	struct net_eth_addr eth;
+	/** Set while the address is being resolved */
+	bool is_pending;
+	/** Number of packets waiting for the address to be resolved */
+	u8_t pending_count;
+	struct net_pkt *pending[CONFIG_NET_ARP_PENDING_QUEUE_DEPTH];
 };
 
 typedef void (*net_arp_cb_t)(struct arp_entry *entry,
@@ -196,6 +196,60 @@ static inline void eth_stats_update_errors_tx(struct net_if *iface)
 	stats->errors.tx++;
 }
 
+static inline void eth_stats_update_arp_hit(struct net_if *iface)
+{
+	const struct ethernet_api *api = ((const struct ethernet_api *)
+		net_if_get_device(iface)->driver_api);
+	struct net_stats_eth *stats;
+
+	if (!api->get_stats) {
+		return;
+	}
+
+	stats = api->get_stats(net_if_get_device(iface));
+	if (!stats) {
+		return;
+	}
+
+	stats->arp.hit++;
+}
+
+static inline void eth_stats_update_arp_miss(struct net_if *iface)
+{
+	const struct ethernet_api *api = ((const struct ethernet_api *)
+		net_if_get_device(iface)->driver_api);
+	struct net_stats_eth *stats;
+
+	if (!api->get_stats) {
+		return;
+	}
+
+	stats = api->get_stats(net_if_get_device(iface));
+	if (!stats) {
+		return;
+	}
+
+	stats->arp.miss++;
+}
+
+static inline void eth_stats_update_arp_pending_dropped(struct net_if *iface)
+{
+	const struct ethernet_api *api = ((const struct ethernet_api *)
+		net_if_get_device(iface)->driver_api);
+	struct net_stats_eth *stats;
+
+	if (!api->get_stats) {
+		return;
+	}
+
+	stats = api->get_stats(net_if_get_device(iface));
+	if (!stats) {
+		return;
+	}
+
+	stats->arp.pending_dropped++;
+}
+
 #else /* CONFIG_NET_STATISTICS_ETHERNET */
 
 #define eth_stats_update_bytes_rx(iface, bytes)
@@ -208,6 +262,9 @@ static inline void eth_stats_update_errors_tx(struct net_if *iface)
 #define eth_stats_update_multicast_tx(iface)
 #define eth_stats_update_errors_rx(iface)
 #define eth_stats_update_errors_tx(iface)
+#define eth_stats_update_arp_hit(iface)
+#define eth_stats_update_arp_miss(iface)
+#define eth_stats_update_arp_pending_dropped(iface)
 
 #endif /* CONFIG_NET_STATISTICS_ETHERNET */
 
@@ -23,6 +23,7 @@ LOG_MODULE_REGISTER(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
 #include "eth_stats.h"
 #include "net_private.h"
 #include "ipv6.h"
+#include "tcp_internal.h"
 #include "ipv4_autoconf_internal.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
@@ -515,6 +516,15 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	u16_t ptype;
 	int ret;
 
+	/* Oversized TCP segments are split here unless the device can do it,
+	 * each resulting segment is sent through this function again.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP_GSO) && net_pkt_gso_size(pkt) &&
+	    !(net_eth_get_hw_capabilities(iface) &
+	      ETHERNET_HW_TCP_SEGMENTATION)) {
+		return net_tcp_gso_send(iface, pkt, ethernet_send);
+	}
+
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
 		struct net_pkt *tmp;
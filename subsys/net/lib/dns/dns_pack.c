@@ -316,6 +316,77 @@ int dns_unpack_response_query(struct dns_msg_t *dns_msg)
 	return 0;
 }
 
+/* Returns the length of the, possibly compressed, name at buf */
+static int dns_skip_name(const u8_t *buf, int size)
+{
+	int len = 0;
+
+	while (len < size) {
+		if (buf[len] == 0) {
+			return len + DNS_LABEL_LEN_SIZE;
+		}
+
+		/* A pointer ends the name */
+		if (buf[len] > DNS_LABEL_MAX_SIZE) {
+			len += DNS_COMMON_UINT_SIZE;
+			return len <= size ? len : -ENOMEM;
+		}
+
+		len += buf[len] + DNS_LABEL_LEN_SIZE;
+	}
+
+	return -ENOMEM;
+}
+
+int dns_unpack_negative_ttl(struct dns_msg_t *dns_msg, u32_t *ttl)
+{
+	int offset = dns_msg->answer_offset;
+	u16_t rdlength;
+	u32_t minimum;
+	int count;
+	u8_t *rr;
+	int len;
+
+	for (count = dns_header_nscount(dns_msg->msg); count > 0; count--) {
+		rr = dns_msg->msg + offset;
+
+		len = dns_skip_name(rr, dns_msg->msg_size - offset);
+		if (len < 0) {
+			return len;
+		}
+
+		if (offset + len + DNS_RR_FIXED_LEN > dns_msg->msg_size) {
+			return -ENOMEM;
+		}
+
+		rdlength = dns_answer_rdlength(len, rr);
+		if (offset + len + DNS_RR_FIXED_LEN + rdlength >
+		    dns_msg->msg_size) {
+			return -ENOMEM;
+		}
+
+		if (dns_answer_type(len, rr) == DNS_RR_TYPE_SOA &&
+		    dns_answer_class(len, rr) == DNS_CLASS_IN) {
+			if (rdlength < DNS_SOA_MIN_RDLENGTH) {
+				return -EINVAL;
+			}
+
+			/* MINIMUM is the last field of the SOA RDATA */
+			minimum = ntohl(UNALIGNED_GET((u32_t *)
+					(rr + len + DNS_RR_FIXED_LEN + rdlength -
+					 DNS_TTL_LEN)));
+
+			*ttl = MIN((u32_t)dns_answer_ttl(len, rr), minimum);
+
+			return 0;
+		}
+
+		offset += len + DNS_RR_FIXED_LEN + rdlength;
+	}
+
+	return -ENOENT;
+}
+
 int dns_copy_qname(u8_t *buf, u16_t *len, u16_t size,
 		   struct dns_msg_t *dns_msg, u16_t pos)
 {
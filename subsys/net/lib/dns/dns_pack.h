@@ -36,6 +36,15 @@
 #define DNS_TTL_LEN		4
 #define DNS_RDLENGTH_LEN	2
 
+/* Fixed part of a RR after its name: type, class, ttl and rdlength */
+#define DNS_RR_FIXED_LEN	(DNS_QTYPE_LEN + DNS_QCLASS_LEN + \
+				 DNS_TTL_LEN + DNS_RDLENGTH_LEN)
+
+/* SOA RDATA with two root names: MNAME, RNAME, SERIAL, REFRESH, RETRY,
+ * EXPIRE and MINIMUM. See RFC 1035, 3.3.13. SOA RDATA format.
+ */
+#define DNS_SOA_MIN_RDLENGTH	(2 + 5 * DNS_TTL_LEN)
+
 #define NS_CMPRSFLGS    0xc0   /* DNS name compression */
 
 /* RFC 1035 '4.1.1. Header section format' defines the following flags:
@@ -86,6 +95,7 @@ enum dns_rr_type {
 	DNS_RR_TYPE_INVALID = 0,
 	DNS_RR_TYPE_A	= 1,		/* IPv4  */
 	DNS_RR_TYPE_CNAME = 5,		/* CNAME */
+	DNS_RR_TYPE_SOA = 6,		/* SOA   */
 	DNS_RR_TYPE_AAAA = 28		/* IPv6  */
 };
 
@@ -340,6 +350,24 @@ int dns_msg_pack_query(u8_t *buf, u16_t *len, u16_t size,
  */
 int dns_unpack_response_query(struct dns_msg_t *dns_msg);
 
+/**
+ * @brief Finds the time a negative answer can be cached.
+ *
+ * @details RFC 2308 states that a negative answer (name error or no
+ *          data) is cached for the smaller of the TTL of the SOA record
+ *          found in the authority section and of its MINIMUM field.
+ *
+ * @param dns_msg Structure containing the message. The answer_offset field
+ *        must point past the answer section.
+ * @param ttl TTL of the negative answer.
+ * @retval 0 on success
+ * @retval -ENOENT if there is no SOA record in the authority section,
+ *         the answer must not be cached then.
+ * @retval -ENOMEM if a record does not fit in the message.
+ * @retval -EINVAL if the SOA record is malformed.
+ */
+int dns_unpack_negative_ttl(struct dns_msg_t *dns_msg, u32_t *ttl);
+
 /**
  * @brief Copies the qname from dns_msg to buf
  *
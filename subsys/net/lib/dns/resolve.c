@@ -17,6 +17,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #include <net/net_ip.h>
 #include <net/net_pkt.h>
@@ -320,6 +321,352 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -ENOENT;
 }
 
+/* RFC 2308, 2.2: a NOERROR response without answers is a NODATA one,
+ * dns_unpack_response_header() does not accept it.
+ */
+static bool dns_is_nodata(u8_t *header)
+{
+	return dns_header_qr(header) == DNS_RESPONSE &&
+	       dns_header_opcode(header) == DNS_QUERY &&
+	       dns_header_z(header) == 0 &&
+	       dns_header_rcode(header) == DNS_HEADER_NOERROR &&
+	       dns_unpack_header_qdcount(header) == 1 &&
+	       dns_unpack_header_ancount(header) == 0;
+}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/* Answers received by any of the contexts, looked up before a query is
+ * sent. Negative answers are cached without addresses.
+ */
+struct dns_cache_entry {
+	/** Name the answer is for */
+	char name[CONFIG_DNS_RESOLVER_CACHE_MAX_NAME_LEN + 1];
+
+	/** Cached addresses */
+	u8_t addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS][DNS_IPV6_LEN];
+
+	/** Uptime in ms when the answer expires */
+	s64_t expires;
+
+	/** Query type */
+	enum dns_query_type type;
+
+	/** DNS_EAI_ALLDONE, or DNS_EAI_NODATA for a negative answer */
+	enum dns_resolve_status status;
+
+	/** Number of cached addresses */
+	u8_t addr_count;
+
+	/** Is this entry in use */
+	bool is_used;
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_SIZE];
+static struct dns_resolve_cache_stats dns_cache_stats;
+static K_MUTEX_DEFINE(dns_cache_lock);
+
+/* Names are compared ignoring the case, RFC 4343 */
+static bool dns_name_equal(const char *a, const char *b)
+{
+	while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+		a++;
+		b++;
+	}
+
+	return *a == *b;
+}
+
+/* Must be called with dns_cache_lock held */
+static struct dns_cache_entry *cache_find(const char *name,
+					  enum dns_query_type type,
+					  s64_t now)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		struct dns_cache_entry *entry = &dns_cache[i];
+
+		if (!entry->is_used) {
+			continue;
+		}
+
+		if (entry->expires <= now) {
+			entry->is_used = false;
+			continue;
+		}
+
+		if (entry->type == type && dns_name_equal(entry->name, name)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void cache_add(struct dns_pending_query *query,
+		      enum dns_resolve_status status, u32_t ttl)
+{
+	struct dns_cache_entry *entry, *oldest = NULL;
+	s64_t now;
+	int i;
+
+	/* A zero TTL means the answer can only be used for this query */
+	if (!query->name[0] || ttl == 0) {
+		return;
+	}
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	entry = cache_find(query->name, query->query_type, now);
+	if (!entry) {
+		for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+			if (!dns_cache[i].is_used) {
+				entry = &dns_cache[i];
+				break;
+			}
+
+			if (!oldest || dns_cache[i].expires < oldest->expires) {
+				oldest = &dns_cache[i];
+			}
+		}
+
+		/* Replace the answer that would expire first */
+		if (!entry) {
+			entry = oldest;
+		}
+	}
+
+	strcpy(entry->name, query->name);
+	memcpy(entry->addr, query->addr, sizeof(entry->addr));
+	entry->addr_count = query->addr_count;
+	entry->type = query->query_type;
+	entry->status = status;
+	entry->expires = now + (s64_t)ttl * MSEC_PER_SEC;
+	entry->is_used = true;
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	NET_DBG("Cached %s type %d status %d for %u s",
+		log_strdup(query->name), query->query_type, status, ttl);
+}
+
+static void dns_set_addrinfo(struct dns_addrinfo *info,
+			     enum dns_query_type type, const u8_t *addr)
+{
+	if (type == DNS_QUERY_TYPE_A) {
+		memcpy(&net_sin(&info->ai_addr)->sin_addr, addr, DNS_IPV4_LEN);
+		info->ai_family = AF_INET;
+		info->ai_addr.sa_family = AF_INET;
+		info->ai_addrlen = sizeof(struct sockaddr_in);
+	}
+#if defined(CONFIG_NET_IPV6)
+	else if (type == DNS_QUERY_TYPE_AAAA) {
+		memcpy(&net_sin6(&info->ai_addr)->sin6_addr, addr,
+		       DNS_IPV6_LEN);
+		info->ai_family = AF_INET6;
+		info->ai_addr.sa_family = AF_INET6;
+		info->ai_addrlen = sizeof(struct sockaddr_in6);
+	}
+#endif
+}
+
+/* Returns true if the answer was found in the cache and given to cb */
+static bool cache_report(const char *name, enum dns_query_type type,
+			 dns_resolve_cb_t cb, void *user_data)
+{
+	u8_t addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS][DNS_IPV6_LEN];
+	enum dns_resolve_status status;
+	struct dns_cache_entry *entry;
+	int addr_count = 0;
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	entry = cache_find(name, type, k_uptime_get());
+	if (!entry) {
+		dns_cache_stats.misses++;
+		k_mutex_unlock(&dns_cache_lock);
+		return false;
+	}
+
+	dns_cache_stats.hits++;
+	if (entry->status != DNS_EAI_ALLDONE) {
+		dns_cache_stats.negative_hits++;
+	}
+
+	status = entry->status;
+	addr_count = entry->addr_count;
+	memcpy(addr, entry->addr, sizeof(addr));
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	/* The callback is free to start another query */
+	for (i = 0; i < addr_count; i++) {
+		struct dns_addrinfo info = { 0 };
+
+		dns_set_addrinfo(&info, type, addr[i]);
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+	}
+
+	cb(status, NULL, user_data);
+
+	return true;
+}
+
+/* Returns the index of a query sent for the same name, -1 if none */
+static int query_find_leader(struct dns_resolve_context *ctx, int query_idx)
+{
+	struct dns_pending_query *query = &ctx->queries[query_idx];
+	int i;
+
+	if (!query->name[0]) {
+		return -1;
+	}
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (i == query_idx || !ctx->queries[i].cb ||
+		    ctx->queries[i].leader >= 0 ||
+		    ctx->queries[i].query_type != query->query_type) {
+			continue;
+		}
+
+		if (dns_name_equal(ctx->queries[i].name, query->name)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void query_cache_init(struct dns_resolve_context *ctx, int query_idx,
+			     const char *name)
+{
+	struct dns_pending_query *query = &ctx->queries[query_idx];
+
+	if (strlen(name) < sizeof(query->name)) {
+		strcpy(query->name, name);
+	} else {
+		query->name[0] = '\0';
+	}
+
+	query->addr_count = 0U;
+	query->ttl = CONFIG_DNS_RESOLVER_CACHE_MAX_TTL;
+	query->leader = query_find_leader(ctx, query_idx);
+}
+
+/* Left to a query canceled by its caller while others wait for it */
+static void dns_canceled_cb(enum dns_resolve_status status,
+			    struct dns_addrinfo *info, void *user_data)
+{
+}
+
+static inline bool query_is_follower(struct dns_resolve_context *ctx,
+				     int query_idx, int leader)
+{
+	return ctx->queries[query_idx].cb &&
+		ctx->queries[query_idx].leader == leader;
+}
+
+void dns_resolve_cache_flush(void)
+{
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+	(void)memset(dns_cache, 0, sizeof(dns_cache));
+	k_mutex_unlock(&dns_cache_lock);
+}
+
+int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data)
+{
+	s64_t now;
+	int i, ret = 0;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		struct dns_cache_entry *entry = &dns_cache[i];
+
+		if (!entry->is_used || entry->expires <= now) {
+			continue;
+		}
+
+		cb(entry->name, entry->type, entry->status, entry->addr_count,
+		   (entry->expires - now + MSEC_PER_SEC - 1) / MSEC_PER_SEC,
+		   user_data);
+
+		ret++;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	return ret;
+}
+
+void dns_resolve_cache_get_stats(struct dns_resolve_cache_stats *stats)
+{
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+	memcpy(stats, &dns_cache_stats, sizeof(*stats));
+	k_mutex_unlock(&dns_cache_lock);
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+/* Gives one resolved address to the query and to the ones waiting for it */
+static void query_result(struct dns_resolve_context *ctx, int query_idx,
+			 struct dns_addrinfo *info, const u8_t *addr,
+			 int addr_len)
+{
+	struct dns_pending_query *query = &ctx->queries[query_idx];
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	int i;
+#endif
+
+	query->cb(DNS_EAI_INPROGRESS, info, query->user_data);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (query->addr_count < CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS) {
+		memcpy(query->addr[query->addr_count++], addr, addr_len);
+	}
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (query_is_follower(ctx, i, query_idx)) {
+			ctx->queries[i].cb(DNS_EAI_INPROGRESS, info,
+					   ctx->queries[i].user_data);
+		}
+	}
+#endif
+}
+
+/* Marks the end of the results of the query and of the ones waiting
+ * for it.
+ */
+static void query_finish(struct dns_resolve_context *ctx, int query_idx,
+			 enum dns_resolve_status status)
+{
+	struct dns_pending_query *query = &ctx->queries[query_idx];
+	dns_resolve_cb_t cb = query->cb;
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	int i;
+#endif
+
+	if (k_delayed_work_remaining_get(&query->timer) > 0) {
+		k_delayed_work_cancel(&query->timer);
+	}
+
+	/* The slot is free for the callback to start another query */
+	query->cb = NULL;
+	cb(status, NULL, query->user_data);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (query_is_follower(ctx, i, query_idx)) {
+			query_finish(ctx, i, status);
+		}
+	}
+#endif
+}
+
 static int dns_read(struct dns_resolve_context *ctx,
 		    struct net_pkt *pkt,
 		    struct net_buf *dns_data,
@@ -329,7 +676,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 	struct dns_addrinfo info = { 0 };
 	/* Helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
-	u32_t ttl; /* RR ttl, so far it is not passed to caller */
+	u32_t ttl; /* RR ttl, used by the cache */
 	u8_t *src, *addr;
 	int address_size;
 	/* index that points to the current answer being analyzed */
@@ -338,6 +685,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 	int items;
 	int ret;
 	int server_idx, query_idx;
+	int rcode;
 
 	data_len = MIN(net_pkt_remaining_data(pkt), DNS_RESOLVER_MAX_BUF_SIZE);
 
@@ -351,6 +699,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 	dns_msg.msg = dns_data->data;
 	dns_msg.msg_size = data_len;
+	dns_msg.response_type = DNS_RESPONSE_INVALID;
 
 	/* The dns_unpack_response_header() has design flaw as it expects
 	 * dns id to be given instead of returning the id to the caller.
@@ -366,13 +715,14 @@ static int dns_read(struct dns_resolve_context *ctx,
 		goto quit;
 	}
 
-	if (dns_header_rcode(dns_msg.msg) == DNS_HEADER_REFUSED) {
+	rcode = dns_header_rcode(dns_msg.msg);
+	if (rcode == DNS_HEADER_REFUSED) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
 
 	ret = dns_unpack_response_header(&dns_msg, *dns_id);
-	if (ret < 0) {
+	if (ret < 0 && !(ret == -EINVAL && dns_is_nodata(dns_msg.msg))) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
@@ -425,6 +775,19 @@ static int dns_read(struct dns_resolve_context *ctx,
 			goto quit;
 		}
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+		/* The answer is valid as long as all its records are, the
+		 * CNAMEs included. RFC 2181, 8: TTLs with the top bit set
+		 * are to be treated as zero.
+		 */
+		if (ttl > INT32_MAX) {
+			ttl = 0U;
+		}
+
+		ctx->queries[query_idx].ttl =
+			MIN(ctx->queries[query_idx].ttl, ttl);
+#endif
+
 		switch (dns_msg.response_type) {
 		case DNS_RESPONSE_IP:
 			if (dns_msg.response_length < address_size) {
@@ -437,8 +800,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 			memcpy(addr, src, address_size);
 
-			ctx->queries[query_idx].cb(DNS_EAI_INPROGRESS, &info,
-					ctx->queries[query_idx].user_data);
+			query_result(ctx, query_idx, &info, src, address_size);
 			items++;
 			break;
 
@@ -486,14 +848,24 @@ static int dns_read(struct dns_resolve_context *ctx,
 		ret = DNS_EAI_ALLDONE;
 	}
 
-	if (k_delayed_work_remaining_get(&ctx->queries[query_idx].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[query_idx].timer);
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (ret == DNS_EAI_ALLDONE) {
+		cache_add(&ctx->queries[query_idx], ret,
+			  ctx->queries[query_idx].ttl);
+	} else if (rcode == DNS_HEADER_NOERROR ||
+		   rcode == DNS_HEADER_NAMEERROR) {
+		/* Negative answers are only cached when the server tells
+		 * for how long, RFC 2308, 5.
+		 */
+		if (!dns_unpack_negative_ttl(&dns_msg, &ttl)) {
+			cache_add(&ctx->queries[query_idx], ret,
+				  MIN(ttl,
+				      CONFIG_DNS_RESOLVER_CACHE_MAX_NEGATIVE_TTL));
+		}
 	}
+#endif
 
-	/* Marks the end of the results */
-	ctx->queries[query_idx].cb(ret, NULL,
-				   ctx->queries[query_idx].user_data);
-	ctx->queries[query_idx].cb = NULL;
+	query_finish(ctx, query_idx, ret);
 
 	net_pkt_unref(pkt);
 
@@ -587,13 +959,7 @@ quit:
 		goto free_buf;
 	}
 
-	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[i].timer);
-	}
-
-	/* Marks the end of the results */
-	ctx->queries[i].cb(ret, NULL, ctx->queries[i].user_data);
-	ctx->queries[i].cb = NULL;
+	query_finish(ctx, i, ret);
 
 free_buf:
 	if (dns_data) {
@@ -681,6 +1047,9 @@ static int dns_write(struct dns_resolve_context *ctx,
 int dns_resolve_cancel(struct dns_resolve_context *ctx, u16_t dns_id)
 {
 	int i;
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	int j;
+#endif
 
 	i = get_slot_by_id(ctx, dns_id);
 	if (i < 0) {
@@ -689,12 +1058,23 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx, u16_t dns_id)
 
 	NET_DBG("Cancelling DNS req %u", dns_id);
 
-	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[i].timer);
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/* Other queries are waiting for the answer, so only this caller
+	 * is told that the query is canceled.
+	 */
+	for (j = 0; j < CONFIG_DNS_NUM_CONCUR_QUERIES; j++) {
+		if (query_is_follower(ctx, j, i)) {
+			dns_resolve_cb_t cb = ctx->queries[i].cb;
+
+			ctx->queries[i].cb = dns_canceled_cb;
+			cb(DNS_EAI_CANCELED, NULL, ctx->queries[i].user_data);
+
+			return 0;
+		}
 	}
+#endif
 
-	ctx->queries[i].cb(DNS_EAI_CANCELED, NULL, ctx->queries[i].user_data);
-	ctx->queries[i].cb = NULL;
+	query_finish(ctx, i, DNS_EAI_CANCELED);
 
 	return 0;
 }
@@ -703,10 +1083,17 @@ static void query_timeout(struct k_work *work)
 {
 	struct dns_pending_query *pending_query =
 		CONTAINER_OF(work, struct dns_pending_query, timer);
+	struct dns_resolve_context *ctx = pending_query->ctx;
+	int i = pending_query - ctx->queries;
 
 	NET_DBG("Query timeout DNS req %u", pending_query->id);
 
-	dns_resolve_cancel(pending_query->ctx, pending_query->id);
+	if (!pending_query->cb) {
+		return;
+	}
+
+	/* The queries waiting for this one time out too */
+	query_finish(ctx, i, DNS_EAI_CANCELED);
 }
 
 int dns_resolve_name(struct dns_resolve_context *ctx,
@@ -770,6 +1157,17 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	}
 
 try_resolve:
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (cache_report(query, type, cb, user_data)) {
+		/* Answered already, there is no query to cancel */
+		if (dns_id) {
+			*dns_id = 0U;
+		}
+
+		return 0;
+	}
+#endif
+
 	i = get_cb_slot(ctx);
 	if (i < 0) {
 		return -EAGAIN;
@@ -784,6 +1182,30 @@ try_resolve:
 
 	k_delayed_work_init(&ctx->queries[i].timer, query_timeout);
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	query_cache_init(ctx, i, query);
+
+	/* The same name is already being resolved, wait for its answer
+	 * instead of sending another query.
+	 */
+	if (ctx->queries[i].leader >= 0) {
+		ctx->queries[i].id = sys_rand32_get();
+		if (dns_id) {
+			*dns_id = ctx->queries[i].id;
+		}
+
+		k_mutex_lock(&dns_cache_lock, K_FOREVER);
+		dns_cache_stats.coalesced++;
+		k_mutex_unlock(&dns_cache_lock);
+
+		NET_DBG("DNS id %u waits for id %u", ctx->queries[i].id,
+			ctx->queries[ctx->queries[i].leader].id);
+
+		ret = k_delayed_work_submit(&ctx->queries[i].timer, timeout);
+		goto quit;
+	}
+#endif
+
 	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
 	if (!dns_data) {
 		ret = -ENOMEM;
@@ -157,6 +157,205 @@ static int client_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+static int client_write_msg(struct mqtt_client *client,
+			    const struct msghdr *message)
+{
+	int err_code;
+
+	MQTT_TRC("[%p]: Transport writing message.", client);
+
+	err_code = mqtt_transport_write_msg(client, message);
+	if (err_code < 0) {
+		MQTT_TRC("Transport write failed, err_code = %d, "
+			 "closing connection", err_code);
+		client_disconnect(client, err_code);
+		return err_code;
+	}
+
+	MQTT_TRC("[%p]: Transport write complete.", client);
+	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+	return 0;
+}
+
+/**@brief Prepares a message with the encoded packet followed by the payload,
+ *        if any.
+ */
+static void write_msg_prepare(struct msghdr *msg, struct iovec *io_vector,
+			      const struct buf_ctx *packet,
+			      const struct mqtt_binstr *payload)
+{
+	memset(msg, 0, sizeof(*msg));
+
+	io_vector[0].iov_base = packet->cur;
+	io_vector[0].iov_len = packet->end - packet->cur;
+
+	msg->msg_iov = io_vector;
+	msg->msg_iovlen = 1;
+
+	if (payload != NULL && payload->len > 0) {
+		io_vector[1].iov_base = payload->data;
+		io_vector[1].iov_len = payload->len;
+		msg->msg_iovlen++;
+	}
+}
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   u16_t message_id)
+{
+	struct mqtt_inflight *entry;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->ack_type != 0 &&
+		    entry->param.message_id == message_id) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static u16_t inflight_next_id(struct mqtt_client *client)
+{
+	u16_t message_id = client->internal.last_message_id;
+
+	/* Message id zero is not permitted by spec. */
+	do {
+		message_id++;
+	} while (message_id == 0 || inflight_find(client, message_id));
+
+	client->internal.last_message_id = message_id;
+
+	return message_id;
+}
+
+/**@brief Keeps a QoS 1 or QoS 2 message until it is acknowledged. */
+static int inflight_add(struct mqtt_client *client,
+			const struct mqtt_publish_param *param,
+			struct mqtt_inflight **entry)
+{
+	struct mqtt_inflight *free_entry = NULL;
+	int i;
+
+	if (param->message_id != 0 &&
+	    inflight_find(client, param->message_id) != NULL) {
+		return -EALREADY;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		if (client->internal.inflight[i].ack_type == 0) {
+			free_entry = &client->internal.inflight[i];
+			break;
+		}
+	}
+
+	if (free_entry == NULL) {
+		return -EBUSY;
+	}
+
+	free_entry->param = *param;
+
+	if (param->message_id == 0) {
+		free_entry->param.message_id = inflight_next_id(client);
+	}
+
+	if (param->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+		free_entry->ack_type = MQTT_PKT_TYPE_PUBACK;
+	} else {
+		free_entry->ack_type = MQTT_PKT_TYPE_PUBREC;
+	}
+
+	*entry = free_entry;
+
+	return 0;
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t pkt_type,
+		       u16_t message_id)
+{
+	struct mqtt_inflight *entry;
+
+	entry = inflight_find(client, message_id);
+	if (entry == NULL || entry->ack_type != pkt_type) {
+		MQTT_TRC("[CID %p]: Unexpected ack 0x%02x for message id "
+			 "0x%04x", client, pkt_type, message_id);
+		return;
+	}
+
+	if (pkt_type == MQTT_PKT_TYPE_PUBREC) {
+		entry->ack_type = MQTT_PKT_TYPE_PUBCOMP;
+	} else {
+		entry->ack_type = 0;
+	}
+}
+
+int mqtt_inflight_resume(struct mqtt_client *client)
+{
+	struct mqtt_pubrel_param release_param;
+	struct mqtt_inflight *entry;
+	struct iovec io_vector[2];
+	struct buf_ctx packet;
+	struct msghdr msg;
+	int err_code;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->ack_type == 0) {
+			continue;
+		}
+
+		if (client->clean_session) {
+			MQTT_TRC("[CID %p]: Dropped message id 0x%04x", client,
+				 entry->param.message_id);
+			entry->ack_type = 0;
+			continue;
+		}
+
+		tx_buf_init(client, &packet);
+
+		if (entry->ack_type == MQTT_PKT_TYPE_PUBCOMP) {
+			release_param.message_id = entry->param.message_id;
+
+			err_code = publish_release_encode(&release_param,
+							  &packet);
+			if (err_code < 0) {
+				client_disconnect(client, err_code);
+				return err_code;
+			}
+
+			write_msg_prepare(&msg, io_vector, &packet, NULL);
+		} else {
+			entry->param.dup_flag = 1U;
+
+			err_code = publish_encode(&entry->param, &packet);
+			if (err_code < 0) {
+				client_disconnect(client, err_code);
+				return err_code;
+			}
+
+			write_msg_prepare(&msg, io_vector, &packet,
+					  &entry->param.message.payload);
+		}
+
+		MQTT_TRC("[CID %p]: Resending message id 0x%04x", client,
+			 entry->param.message_id);
+
+		err_code = client_write_msg(client, &msg);
+		if (err_code < 0) {
+			return err_code;
+		}
+	}
+
+	return 0;
+}
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
+
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
@@ -205,11 +404,18 @@ static int verify_tx_state(const struct mqtt_client *client)
 	return 0;
 }
 
-int mqtt_publish(struct mqtt_client *client,
-		 const struct mqtt_publish_param *param)
+int mqtt_publish_and_get_id(struct mqtt_client *client,
+			    const struct mqtt_publish_param *param,
+			    u16_t *message_id)
 {
 	int err_code;
 	struct buf_ctx packet;
+	struct iovec io_vector[2];
+	struct msghdr msg;
+	const struct mqtt_publish_param *publish = param;
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+	struct mqtt_inflight *entry = NULL;
+#endif
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -228,18 +434,38 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = publish_encode(param, &packet);
-	if (err_code < 0) {
-		goto error;
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+	if (param->message.topic.qos > MQTT_QOS_0_AT_MOST_ONCE) {
+		err_code = inflight_add(client, param, &entry);
+		if (err_code < 0) {
+			goto error;
+		}
+
+		publish = &entry->param;
 	}
+#endif
 
-	err_code = client_write(client, packet.cur, packet.end - packet.cur);
+	err_code = publish_encode(publish, &packet);
 	if (err_code < 0) {
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+		if (entry != NULL) {
+			entry->ack_type = 0;
+		}
+#endif
 		goto error;
 	}
 
-	err_code = client_write(client, param->message.payload.data,
-				param->message.payload.len);
+	/* Let the application match the acknowledgments */
+	if (message_id != NULL) {
+		*message_id = publish->message_id;
+	}
+
+	/* A message that could not be written stays in flight, it is sent
+	 * again on reconnection.
+	 */
+	write_msg_prepare(&msg, io_vector, &packet, &publish->message.payload);
+
+	err_code = client_write_msg(client, &msg);
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -250,6 +476,12 @@ error:
 	return err_code;
 }
 
+int mqtt_publish(struct mqtt_client *client,
+		 const struct mqtt_publish_param *param)
+{
+	return mqtt_publish_and_get_id(client, param, NULL);
+}
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -161,6 +161,32 @@ void event_notify(struct mqtt_client *client, const struct mqtt_evt *evt);
  */
 int mqtt_handle_rx(struct mqtt_client *client);
 
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+/**@brief Releases or updates the message in flight acknowledged by the peer.
+ *
+ * @param[in] client Identifies the client for which the ack was received.
+ * @param[in] pkt_type Type of the acknowledgment, PUBACK, PUBREC or PUBCOMP.
+ * @param[in] message_id Message id of the acknowledgment.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t pkt_type,
+		       u16_t message_id);
+
+/**@brief Resumes the messages in flight once the connection is accepted.
+ *
+ * @details The messages are dropped for a clean session. Otherwise the
+ *          PUBLISH messages are sent again with the DUP flag and the PUBREL
+ *          messages sent again. This is done before the client is marked
+ *          as connected and the CONNACK event is notified, so the client
+ *          is disconnected with a refused CONNACK if one of them cannot
+ *          be sent.
+ *
+ * @param[in] client Identifies the client which was connected.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_resume(struct mqtt_client *client);
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
+
 /**@brief Constructs/encodes Connect packet.
  *
  * @param[in] client Identifies the client for which the procedure is requested.
@@ -40,6 +40,18 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 
 			if (evt.param.connack.return_code ==
 						MQTT_CONNECTION_ACCEPTED) {
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+				/* Before the event, so that the messages
+				 * published from it are neither resent nor
+				 * dropped, and follow the older ones. A
+				 * failed resend has closed the connection
+				 * and reported it as a refused CONNACK.
+				 */
+				if (mqtt_inflight_resume(client) < 0) {
+					notify_event = false;
+					break;
+				}
+#endif
 				/* Set state. */
 				MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
 			}
@@ -75,6 +87,13 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
 		evt.result = err_code;
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBACK,
+					  evt.param.puback.message_id);
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
@@ -83,6 +102,13 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
 		evt.result = err_code;
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBREC,
+					  evt.param.pubrec.message_id);
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -99,6 +125,13 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
 		evt.result = err_code;
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  evt.param.pubcomp.message_id);
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
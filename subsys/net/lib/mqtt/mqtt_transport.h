@@ -13,6 +13,7 @@
 #define MQTT_TRANSPORT_H_
 
 #include <net/mqtt.h>
+#include <net/net_ip.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +26,11 @@ typedef int (*transport_connect_handler_t)(struct mqtt_client *client);
 typedef int (*transport_write_handler_t)(struct mqtt_client *client,
 					 const u8_t *data, u32_t datalen);
 
+/**@brief Transport write message handler, similar to POSIX sendmsg function.
+ */
+typedef int (*transport_write_msg_handler_t)(struct mqtt_client *client,
+					     const struct msghdr *message);
+
 /**@brief Transport read handler. */
 typedef int (*transport_read_handler_t)(struct mqtt_client *client, u8_t *data,
 					u32_t buflen);
@@ -44,6 +50,11 @@ struct transport_procedure {
 	 */
 	transport_write_handler_t write;
 
+	/** Transport write message handler. Writes all the buffers of a
+	 *  message without copying them into one.
+	 */
+	transport_write_msg_handler_t write_msg;
+
 	/** Transport read handler. Handles transport read based on type of
 	 *  transport.
 	 */
@@ -74,6 +85,17 @@ int mqtt_transport_connect(struct mqtt_client *client);
 int mqtt_transport_write(struct mqtt_client *client, const u8_t *data,
 			 u32_t datalen);
 
+/**@brief Handles write message requests on configured transport.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[in] message Message to be written on the transport. Its buffers are
+ *                    updated as the data is written.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_transport_write_msg(struct mqtt_client *client,
+			     const struct msghdr *message);
+
 /**@brief Handles read requests on configured transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
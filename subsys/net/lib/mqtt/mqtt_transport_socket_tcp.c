@@ -81,6 +81,49 @@ int mqtt_client_tcp_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+/**@brief Handles write message requests on TCP socket transport.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[in] message Message to be written on the transport.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_client_tcp_write_msg(struct mqtt_client *client,
+			      const struct msghdr *message)
+{
+	size_t total_len = 0;
+	int ret, i;
+
+	for (i = 0; i < message->msg_iovlen; i++) {
+		total_len += message->msg_iov[i].iov_len;
+	}
+
+	while (total_len > 0) {
+		ret = sendmsg(client->transport.tcp.sock, message, 0);
+		if (ret < 0) {
+			return -errno;
+		}
+
+		total_len -= ret;
+
+		/* Skip the data already sent for the next iteration. */
+		for (i = 0; i < message->msg_iovlen && ret > 0; i++) {
+			struct iovec *vec = &message->msg_iov[i];
+
+			if ((size_t)ret < vec->iov_len) {
+				vec->iov_base = (u8_t *)vec->iov_base + ret;
+				vec->iov_len -= ret;
+				break;
+			}
+
+			ret -= vec->iov_len;
+			vec->iov_len = 0;
+		}
+	}
+
+	return 0;
+}
+
 /**@brief Handles read requests on TCP socket transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
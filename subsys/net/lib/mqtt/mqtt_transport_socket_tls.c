@@ -120,6 +120,32 @@ int mqtt_client_tls_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+/**@brief Handles write message requests on TLS socket transport.
+ *
+ * @details TLS sockets take one buffer at a time, each buffer is written
+ *          as is without being copied into a single one.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[in] message Message to be written on the transport.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_client_tls_write_msg(struct mqtt_client *client,
+			      const struct msghdr *message)
+{
+	int ret, i;
+
+	for (i = 0; i < message->msg_iovlen; i++) {
+		ret = mqtt_client_tls_write(client, message->msg_iov[i].iov_base,
+					    message->msg_iov[i].iov_len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
 /**@brief Handles read requests on TLS socket transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
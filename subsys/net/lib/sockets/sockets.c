@@ -166,6 +166,7 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	zsock_epoll_unregister(ctx);
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -231,6 +232,7 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 		k_fifo_init(&new_ctx->recv_q);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(parent);
 	}
 }
 
@@ -255,6 +257,7 @@ static void zsock_received_cb(struct net_context *ctx,
 			 */
 			sock_set_eof(ctx);
 			k_fifo_cancel_wait(&ctx->recv_q);
+			zsock_epoll_notify(ctx);
 			NET_DBG("Marked socket %p as peer-closed", ctx);
 		} else {
 			net_pkt_set_eof(last_pkt, true);
@@ -271,6 +274,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -592,15 +596,48 @@ error:
 	return ret;
 }
 
+static int sock_set_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			     struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	int rv;
+
+	if (!src_addr || !addrlen) {
+		return 0;
+	}
+
+	rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+				   src_addr, *addrlen);
+	if (rv < 0) {
+		errno = -rv;
+		return -1;
+	}
+
+	/* addrlen is a value-result argument, set to actual
+	 * size of source address
+	 */
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	return 0;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
-				       void *buf,
-				       size_t max_len,
+				       const struct iovec *iov,
+				       size_t iovlen,
 				       int flags,
 				       struct sockaddr *src_addr,
-				       socklen_t *addrlen)
+				       socklen_t *addrlen,
+				       int *msg_flags)
 {
 	s32_t timeout = K_FOREVER;
 	size_t recv_len = 0;
+	size_t data_len, len, i;
 	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
 
@@ -630,37 +667,25 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 
 	net_pkt_cursor_backup(pkt, &backup);
 
-	if (src_addr && addrlen) {
-		int rv;
+	if (sock_set_src_addr(ctx, pkt, src_addr, addrlen) < 0) {
+		return -1;
+	}
 
-		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-					   src_addr, *addrlen);
-		if (rv < 0) {
-			errno = -rv;
-			return -1;
-		}
+	data_len = net_pkt_remaining_data(pkt);
 
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
+	for (i = 0; i < iovlen && recv_len < data_len; i++) {
+		len = MIN(iov[i].iov_len, data_len - recv_len);
+
+		if (net_pkt_read_new(pkt, iov[i].iov_base, len)) {
+			errno = ENOBUFS;
 			return -1;
 		}
-	}
 
-	recv_len = net_pkt_remaining_data(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
+		recv_len += len;
 	}
 
-	if (net_pkt_read_new(pkt, buf, recv_len)) {
-		errno = ENOBUFS;
-		return -1;
+	if (msg_flags && recv_len < data_len) {
+		*msg_flags |= ZSOCK_MSG_TRUNC;
 	}
 
 	if (!(flags & ZSOCK_MSG_PEEK)) {
@@ -760,7 +785,10 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	enum net_sock_type sock_type = net_context_get_type(ctx);
 
 	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
+		struct iovec iov = { .iov_base = buf, .iov_len = max_len };
+
+		return zsock_recv_dgram(ctx, &iov, 1, flags, src_addr, addrlen,
+					NULL);
 	} else if (sock_type == SOCK_STREAM) {
 		return zsock_recv_stream(ctx, buf, max_len, flags);
 	} else {
@@ -809,6 +837,526 @@ Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
 }
 #endif /* CONFIG_USERSPACE */
 
+ssize_t zsock_sendmsg_ctx(struct net_context *ctx, const struct msghdr *msg,
+			  int flags)
+{
+	s32_t timeout = K_FOREVER;
+	int status;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	status = net_context_sendmsg(ctx, msg, NULL, timeout, NULL,
+				     ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return status;
+}
+
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	ssize_t len, total = 0;
+	size_t i;
+
+	msg->msg_flags = 0;
+	msg->msg_controllen = 0;
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, msg->msg_iov, msg->msg_iovlen,
+					flags, msg->msg_name,
+					msg->msg_name ? &msg->msg_namelen : NULL,
+					&msg->msg_flags);
+	} else if (sock_type != SOCK_STREAM) {
+		__ASSERT(0, "Unknown socket type");
+		return 0;
+	}
+
+	/* A stream socket has no per message peer address */
+	msg->msg_namelen = 0;
+
+	/* Only the first buffer waits for data, the others take whatever
+	 * is already queued.
+	 */
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (msg->msg_iov[i].iov_len == 0) {
+			continue;
+		}
+
+		len = zsock_recv_stream(ctx, msg->msg_iov[i].iov_base,
+					msg->msg_iov[i].iov_len, flags);
+		if (len < 0) {
+			return total ? total : -1;
+		}
+
+		total += len;
+		if ((size_t)len < msg->msg_iov[i].iov_len ||
+		    (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return total;
+}
+
+/* Sockets without their own sendmsg()/recvmsg() can still take a single
+ * buffer through sendto()/recvfrom().
+ */
+static ssize_t sock_sendmsg(void *ctx, const struct socket_op_vtable *vtable,
+			    const struct msghdr *msg, int flags)
+{
+	if (vtable->sendmsg) {
+		return vtable->sendmsg(ctx, msg, flags);
+	}
+
+	if (msg->msg_iovlen != 1) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	return vtable->sendto(ctx, msg->msg_iov[0].iov_base,
+			      msg->msg_iov[0].iov_len, flags,
+			      msg->msg_name, msg->msg_namelen);
+}
+
+static ssize_t sock_recvmsg(void *ctx, const struct socket_op_vtable *vtable,
+			    struct msghdr *msg, int flags)
+{
+	if (vtable->recvmsg) {
+		return vtable->recvmsg(ctx, msg, flags);
+	}
+
+	if (msg->msg_iovlen != 1) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	msg->msg_flags = 0;
+	msg->msg_controllen = 0;
+
+	return vtable->recvfrom(ctx, msg->msg_iov[0].iov_base,
+				msg->msg_iov[0].iov_len, flags,
+				msg->msg_name,
+				msg->msg_name ? &msg->msg_namelen : NULL);
+}
+
+ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return sock_sendmsg(ctx, vtable, msg, flags);
+}
+
+ssize_t z_impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return sock_recvmsg(ctx, vtable, msg, flags);
+}
+
+int z_impl_zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t len;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		len = sock_sendmsg(ctx, vtable, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	return (i || !vlen) ? i : -1;
+}
+
+int z_impl_zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t len;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		len = sock_recvmsg(ctx, vtable, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return (i || !vlen) ? i : -1;
+}
+
+#ifdef CONFIG_USERSPACE
+struct user_msghdr {
+	struct msghdr msg;
+	struct iovec iov[CONFIG_NET_SOCKETS_MSG_IOV_MAX];
+	struct sockaddr_storage addr;
+	socklen_t name_size;	/* size of the user name buffer */
+};
+
+/* Copy in a user message header along with its buffer array and peer
+ * address, checking that the caller may access every buffer. Faults go
+ * through Z_OOPS(), hence the system call frame argument.
+ */
+static int msghdr_from_user(struct user_msghdr *kmsg,
+			    const struct msghdr *umsg, bool for_recv,
+			    void *ssf)
+{
+	struct msghdr *msg = &kmsg->msg;
+	size_t i;
+
+	/* Never hand stack contents back as a peer address */
+	(void)memset(&kmsg->addr, 0, sizeof(kmsg->addr));
+	kmsg->name_size = 0;
+
+	Z_OOPS(z_user_from_copy(msg, (void *)umsg, sizeof(*msg)));
+
+	if (msg->msg_iovlen > ARRAY_SIZE(kmsg->iov)) {
+		return -EMSGSIZE;
+	}
+
+	Z_OOPS(z_user_from_copy(kmsg->iov, msg->msg_iov,
+				msg->msg_iovlen * sizeof(struct iovec)));
+	msg->msg_iov = kmsg->iov;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (for_recv) {
+			Z_OOPS(Z_SYSCALL_MEMORY_WRITE(kmsg->iov[i].iov_base,
+						      kmsg->iov[i].iov_len));
+		} else {
+			Z_OOPS(Z_SYSCALL_MEMORY_READ(kmsg->iov[i].iov_base,
+						     kmsg->iov[i].iov_len));
+		}
+	}
+
+	if (msg->msg_name) {
+		if (msg->msg_namelen > sizeof(kmsg->addr)) {
+			return -EINVAL;
+		}
+
+		if (for_recv) {
+			Z_OOPS(Z_SYSCALL_MEMORY_WRITE(msg->msg_name,
+						      msg->msg_namelen));
+		} else {
+			Z_OOPS(z_user_from_copy(&kmsg->addr, msg->msg_name,
+						msg->msg_namelen));
+		}
+
+		kmsg->name_size = msg->msg_namelen;
+		msg->msg_name = &kmsg->addr;
+	}
+
+	msg->msg_control = NULL;
+	msg->msg_controllen = 0;
+
+	return 0;
+}
+
+/* Copy the results of a receive back out to the user message header.
+ * The peer address is only copied when the receive filled it in, and
+ * never beyond the user buffer.
+ */
+static void msghdr_to_user(struct msghdr *umsg, struct user_msghdr *kmsg,
+			   void *ssf)
+{
+	socklen_t namelen = kmsg->msg.msg_namelen;
+	void *name;
+
+	Z_OOPS(z_user_from_copy(&name, &umsg->msg_name, sizeof(name)));
+	if (name) {
+		if (namelen > 0) {
+			Z_OOPS(z_user_to_copy(name, &kmsg->addr,
+					      MIN(namelen, kmsg->name_size)));
+		}
+
+		Z_OOPS(z_user_to_copy(&umsg->msg_namelen, &namelen,
+				      sizeof(socklen_t)));
+	}
+
+	Z_OOPS(z_user_to_copy(&umsg->msg_controllen, &kmsg->msg.msg_controllen,
+			      sizeof(size_t)));
+	Z_OOPS(z_user_to_copy(&umsg->msg_flags, &kmsg->msg.msg_flags,
+			      sizeof(int)));
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmsg, sock, msg, flags)
+{
+	struct user_msghdr kmsg;
+	int ret;
+
+	ret = msghdr_from_user(&kmsg, (const struct msghdr *)msg, false,
+			       ssf);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return z_impl_zsock_sendmsg(sock, &kmsg.msg, flags);
+}
+
+Z_SYSCALL_HANDLER(zsock_recvmsg, sock, msg, flags)
+{
+	struct user_msghdr kmsg;
+	ssize_t ret;
+
+	ret = msghdr_from_user(&kmsg, (const struct msghdr *)msg, true, ssf);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_recvmsg(sock, &kmsg.msg, flags);
+	if (ret >= 0) {
+		msghdr_to_user((struct msghdr *)msg, &kmsg, ssf);
+	}
+
+	return ret;
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmmsg, sock, msgvec_p, vlen, flags)
+{
+	struct zsock_mmsghdr *msgvec = (struct zsock_mmsghdr *)msgvec_p;
+	const struct socket_op_vtable *vtable;
+	struct user_msghdr kmsg;
+	unsigned int i, len;
+	ssize_t ret = 0;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ret = msghdr_from_user(&kmsg, &msgvec[i].msg_hdr, false,
+				       ssf);
+		if (ret < 0) {
+			errno = -ret;
+			break;
+		}
+
+		ret = sock_sendmsg(ctx, vtable, &kmsg.msg, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		len = ret;
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_len, &len, sizeof(len)));
+	}
+
+	return (i || !vlen) ? i : -1;
+}
+
+Z_SYSCALL_HANDLER(zsock_recvmmsg, sock, msgvec_p, vlen, flags)
+{
+	struct zsock_mmsghdr *msgvec = (struct zsock_mmsghdr *)msgvec_p;
+	const struct socket_op_vtable *vtable;
+	struct user_msghdr kmsg;
+	unsigned int i, len;
+	ssize_t ret = 0;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ret = msghdr_from_user(&kmsg, &msgvec[i].msg_hdr, true,
+				       ssf);
+		if (ret < 0) {
+			errno = -ret;
+			break;
+		}
+
+		ret = sock_recvmsg(ctx, vtable, &kmsg.msg, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msghdr_to_user(&msgvec[i].msg_hdr, &kmsg, ssf);
+		len = ret;
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_len, &len, sizeof(len)));
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return (i || !vlen) ? i : -1;
+}
+#endif /* CONFIG_USERSPACE */
+
+#if defined(CONFIG_NET_SOCKETS_RECV_ZC)
+static struct net_pkt *zsock_recv_zc_pkt(struct net_context *ctx,
+					 s32_t timeout)
+{
+	struct net_pkt *pkt;
+	int res;
+
+	if (net_context_get_type(ctx) == SOCK_DGRAM) {
+		pkt = k_fifo_get(&ctx->recv_q, timeout);
+		if (!pkt) {
+			errno = EAGAIN;
+		}
+
+		return pkt;
+	}
+
+	while (!sock_is_eof(ctx)) {
+		res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+		/* EAGAIN when timeout expired, EINTR when cancelled */
+		if (res && res != -EAGAIN && res != -EINTR) {
+			errno = -res;
+			return NULL;
+		}
+
+		/* The head packet may have been partially consumed by
+		 * recv(), its cursor then points to the remaining data.
+		 */
+		pkt = k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+		if (!pkt) {
+			break;
+		}
+
+		if (net_pkt_eof(pkt)) {
+			sock_set_eof(ctx);
+		}
+
+		if (net_pkt_remaining_data(pkt) > 0) {
+			return pkt;
+		}
+
+		net_pkt_unref(pkt);
+	}
+
+	errno = sock_is_eof(ctx) ? 0 : EAGAIN;
+
+	return NULL;
+}
+
+ssize_t zsock_recv_zc(int sock, struct zsock_zc_buf *zc, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	const struct fd_op_vtable *vtable;
+	struct net_context *ctx;
+	s32_t timeout = K_FOREVER;
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	u8_t *pos;
+
+	ctx = z_get_fd_obj_and_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	/* Only plain sockets hand out the received packets as they are */
+	if (vtable != &sock_fd_op_vtable.fd_vtable) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	if (flags & ZSOCK_MSG_PEEK) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	pkt = zsock_recv_zc_pkt(ctx, timeout);
+	if (!pkt) {
+		/* errno is left at 0 on end of stream */
+		return errno ? -1 : 0;
+	}
+
+	if (sock_set_src_addr(ctx, pkt, src_addr, addrlen) < 0) {
+		net_pkt_unref(pkt);
+		return -1;
+	}
+
+	/* Skip to the first fragment which still holds unread data */
+	frag = pkt->cursor.buf;
+	pos = pkt->cursor.pos;
+	while (frag && pos == frag->data + frag->len) {
+		frag = frag->frags;
+		pos = frag ? frag->data : NULL;
+	}
+
+	zc->pkt = pkt;
+	zc->frag = frag;
+	zc->data = pos;
+	zc->len = net_pkt_remaining_data(pkt);
+
+	return zc->len;
+}
+
+void zsock_recv_zc_release(int sock, struct zsock_zc_buf *zc)
+{
+	const struct fd_op_vtable *vtable;
+	struct net_context *ctx;
+
+	if (!zc->pkt) {
+		return;
+	}
+
+	/* Stream data only opens the receive window once the application
+	 * is done with it. The socket may be closed by now, in which case
+	 * there is no window left to update.
+	 */
+	ctx = z_get_fd_obj_and_vtable(sock, &vtable);
+	if (ctx != NULL && vtable == &sock_fd_op_vtable.fd_vtable &&
+	    net_context_get_type(ctx) == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, zc->len);
+	}
+
+	net_pkt_unref(zc->pkt);
+	zc->pkt = NULL;
+}
+#endif /* CONFIG_NET_SOCKETS_RECV_ZC */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1225,6 +1773,17 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_sendmsg_vmeth(void *obj, const struct msghdr *msg,
+				  int flags)
+{
+	return zsock_sendmsg_ctx(obj, msg, flags);
+}
+
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -1250,6 +1809,8 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.accept = sock_accept_vmeth,
 	.sendto = sock_sendto_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.sendmsg = sock_sendmsg_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 };
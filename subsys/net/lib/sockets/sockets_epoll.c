@@ -0,0 +1,528 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Persistent interest sets for sockets. Unlike poll(), which walks and
+ * re-arms every descriptor on each call, an epoll instance is told about
+ * readiness changes by the receive path and keeps the ready sockets on a
+ * list, so waiting costs depend on the number of ready sockets only.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <kernel_internal.h>
+#include <spinlock.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+#include <syscall_handler.h>
+#include <misc/dlist.h>
+#include <misc/fdtable.h>
+
+#include "sockets_internal.h"
+
+extern const struct socket_op_vtable sock_fd_op_vtable;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+struct zsock_epoll {
+	/* Registered sockets */
+	sys_dlist_t interest;
+	/* Registered sockets which may be ready */
+	sys_dlist_t ready;
+	/* Given when a socket is added to the ready list */
+	struct k_sem wait;
+	/* Threads in epoll_wait(), the last one out of a closed instance
+	 * releases it
+	 */
+	int waiters;
+	bool closing;
+	bool in_use;
+};
+
+static struct zsock_epoll epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+
+/* Protects all instances and the epoll fields of registered contexts */
+static struct k_spinlock epoll_lock;
+
+static u32_t epoll_revents(struct net_context *ctx)
+{
+	u32_t revents = 0U;
+
+	if ((ctx->epoll.events & ZSOCK_EPOLLIN) &&
+	    (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx))) {
+		revents |= ZSOCK_EPOLLIN;
+	}
+
+	/* As for poll(), assume that socket is always writable */
+	if (ctx->epoll.events & ZSOCK_EPOLLOUT) {
+		revents |= ZSOCK_EPOLLOUT;
+	}
+
+	return revents;
+}
+
+static void epoll_mark_ready(struct zsock_epoll *ep, struct net_context *ctx)
+{
+	if (!sys_dnode_is_linked(&ctx->epoll.ready_node)) {
+		sys_dlist_append(&ep->ready, &ctx->epoll.ready_node);
+		k_sem_give(&ep->wait);
+	}
+}
+
+static void epoll_detach(struct net_context *ctx)
+{
+	if (sys_dnode_is_linked(&ctx->epoll.ready_node)) {
+		sys_dlist_remove(&ctx->epoll.ready_node);
+	}
+
+	sys_dlist_remove(&ctx->epoll.node);
+	ctx->epoll.ep = NULL;
+}
+
+void zsock_epoll_notify(struct net_context *ctx)
+{
+	k_spinlock_key_t key;
+
+	/* Cheap check for the common case of an unregistered socket */
+	if (ctx->epoll.ep == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	if (ctx->epoll.ep != NULL && (ctx->epoll.events & ZSOCK_EPOLLIN)) {
+		epoll_mark_ready(ctx->epoll.ep, ctx);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+void zsock_epoll_unregister(struct net_context *ctx)
+{
+	k_spinlock_key_t key;
+
+	if (ctx->epoll.ep == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	if (ctx->epoll.ep != NULL) {
+		epoll_detach(ctx);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+int z_impl_zsock_epoll_create1(int flags)
+{
+	struct zsock_epoll *ep = NULL;
+	k_spinlock_key_t key;
+	int fd, i;
+
+	if (flags != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			ep->in_use = true;
+			break;
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ep == NULL) {
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->interest);
+	sys_dlist_init(&ep->ready);
+	k_sem_init(&ep->wait, 0, 1);
+	ep->waiters = 0;
+	ep->closing = false;
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	NET_DBG("epoll: ep=%p, fd=%d", ep, fd);
+
+	return fd;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_create1, flags)
+{
+	return z_impl_zsock_epoll_create1(flags);
+}
+#endif /* CONFIG_USERSPACE */
+
+static struct zsock_epoll *get_epoll(int epfd)
+{
+	const struct fd_op_vtable *vtable;
+	void *obj = z_get_fd_obj_and_vtable(epfd, &vtable);
+
+	if (obj == NULL) {
+		return NULL;
+	}
+
+	if (vtable != &epoll_fd_op_vtable) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return obj;
+}
+
+int z_impl_zsock_epoll_ctl(int epfd, int op, int fd,
+			   struct zsock_epoll_event *event)
+{
+	const struct fd_op_vtable *vtable;
+	struct net_context *ctx;
+	struct zsock_epoll *ep;
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	ep = get_epoll(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	ctx = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	/* Readiness of other socket types is not derived from recv_q */
+	if (vtable != &sock_fd_op_vtable.fd_vtable) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		if (ctx->epoll.ep != NULL) {
+			ret = -EEXIST;
+			break;
+		}
+
+		ctx->epoll.ep = ep;
+		sys_dlist_append(&ep->interest, &ctx->epoll.node);
+		/* fall through */
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (ctx->epoll.ep != ep) {
+			ret = -ENOENT;
+			break;
+		}
+
+		ctx->epoll.events = event->events;
+		ctx->epoll.data = event->data.u64;
+
+		/* Report the current state at the next wait */
+		if (epoll_revents(ctx)) {
+			epoll_mark_ready(ep, ctx);
+		}
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (ctx->epoll.ep != ep) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_detach(ctx);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_ctl, epfd, op, fd, event)
+{
+	struct zsock_epoll_event event_copy;
+
+	if (op == ZSOCK_EPOLL_CTL_DEL) {
+		return z_impl_zsock_epoll_ctl(epfd, op, fd, NULL);
+	}
+
+	Z_OOPS(z_user_from_copy(&event_copy, (void *)event,
+				sizeof(event_copy)));
+
+	return z_impl_zsock_epoll_ctl(epfd, op, fd, &event_copy);
+}
+#endif /* CONFIG_USERSPACE */
+
+/* Move up to maxevents ready sockets to the events array. Sockets which
+ * are no longer ready are dropped from the ready list; level-triggered
+ * ones which are reported stay on it, behind any not yet looked at.
+ */
+static int epoll_collect(struct zsock_epoll *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	sys_dlist_t requeue;
+	sys_dnode_t *node;
+	struct net_context *ctx;
+	k_spinlock_key_t key;
+	u32_t revents;
+	int n = 0;
+
+	sys_dlist_init(&requeue);
+
+	key = k_spin_lock(&epoll_lock);
+
+	while (n < maxevents && (node = sys_dlist_get(&ep->ready)) != NULL) {
+		ctx = CONTAINER_OF(node, struct net_context, epoll.ready_node);
+
+		revents = epoll_revents(ctx);
+		if (revents == 0U) {
+			continue;
+		}
+
+		events[n].events = revents;
+		events[n].data.u64 = ctx->epoll.data;
+		n++;
+
+		if (!(ctx->epoll.events & ZSOCK_EPOLLET)) {
+			sys_dlist_append(&requeue, node);
+		}
+	}
+
+	while ((node = sys_dlist_get(&requeue)) != NULL) {
+		sys_dlist_append(&ep->ready, node);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return n;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+/* Leave the instance; when it was closed meanwhile, pass the wakeup on to
+ * the next waiter or, for the last one, release the instance.
+ */
+static bool epoll_wait_exit(struct zsock_epoll *ep)
+{
+	k_spinlock_key_t key;
+	bool closing, wake;
+
+	key = k_spin_lock(&epoll_lock);
+
+	ep->waiters--;
+	closing = ep->closing;
+	wake = closing && ep->waiters > 0;
+
+	if (closing && ep->waiters == 0) {
+		ep->in_use = false;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (wake) {
+		k_sem_give(&ep->wait);
+	}
+
+	return closing;
+}
+
+int z_impl_zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			    int maxevents, int timeout)
+{
+	u32_t entry_time = k_uptime_get_32();
+	int remaining_time = timeout;
+	struct zsock_epoll *ep;
+	k_spinlock_key_t key;
+	bool closed;
+	int n;
+
+	ep = get_epoll(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+		remaining_time = K_FOREVER;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	closed = !ep->in_use || ep->closing;
+	if (!closed) {
+		ep->waiters++;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (closed) {
+		errno = EBADF;
+		return -1;
+	}
+
+	while (true) {
+		n = epoll_collect(ep, events, maxevents);
+		if (n > 0 || timeout == K_NO_WAIT || ep->closing) {
+			break;
+		}
+
+		if (timeout != K_FOREVER) {
+			remaining_time = time_left(entry_time, timeout);
+			if (remaining_time <= 0) {
+				break;
+			}
+		}
+
+		/* Wakeups may be stale, e.g. for data consumed meanwhile;
+		 * the ready list is re-checked in any case.
+		 */
+		(void)k_sem_take(&ep->wait, remaining_time);
+	}
+
+	if (epoll_wait_exit(ep)) {
+		errno = EBADF;
+		return -1;
+	}
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_wait, epfd, events, maxevents, timeout)
+{
+	struct zsock_epoll_event *events_copy;
+	unsigned int events_size;
+	int ret;
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (__builtin_umul_overflow(maxevents,
+				    sizeof(struct zsock_epoll_event),
+				    &events_size)) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(events, events_size));
+
+	events_copy = z_thread_malloc(events_size);
+	if (!events_copy) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	ret = z_impl_zsock_epoll_wait(epfd, events_copy, maxevents, timeout);
+
+	if (ret > 0) {
+		z_user_to_copy((void *)events, events_copy,
+			       ret * sizeof(struct zsock_epoll_event));
+	}
+	k_free(events_copy);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	struct zsock_epoll *ep = obj;
+	struct net_context *ctx, *next;
+	k_spinlock_key_t key;
+	bool wake;
+
+	switch (request) {
+	case ZFD_IOCTL_CLOSE:
+		key = k_spin_lock(&epoll_lock);
+
+		SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ep->interest, ctx, next,
+						  epoll.node) {
+			epoll_detach(ctx);
+		}
+
+		/* Threads still waiting on the instance fail with EBADF,
+		 * the last of them releases it
+		 */
+		ep->closing = true;
+		wake = ep->waiters > 0;
+		if (!wake) {
+			ep->in_use = false;
+		}
+
+		k_spin_unlock(&epoll_lock, key);
+
+		if (wake) {
+			k_sem_give(&ep->wait);
+		}
+
+		return 0;
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
@@ -41,12 +41,29 @@ struct socket_op_vtable {
 			  const struct sockaddr *dest_addr, socklen_t addrlen);
 	ssize_t (*recvfrom)(void *obj, void *buf, size_t max_len, int flags,
 			    struct sockaddr *src_addr, socklen_t *addrlen);
+	ssize_t (*sendmsg)(void *obj, const struct msghdr *msg, int flags);
+	ssize_t (*recvmsg)(void *obj, struct msghdr *msg, int flags);
 	int (*getsockopt)(void *obj, int level, int optname,
 			  void *optval, socklen_t *optlen);
 	int (*setsockopt)(void *obj, int level, int optname,
 			  const void *optval, socklen_t optlen);
 };
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+void zsock_epoll_notify(struct net_context *ctx);
+void zsock_epoll_unregister(struct net_context *ctx);
+#else
+static inline void zsock_epoll_notify(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_unregister(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
 int ztls_socket(int family, int type, int proto);
 
 int zpacket_socket(int family, int type, int proto);
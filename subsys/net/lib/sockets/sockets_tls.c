@@ -34,6 +34,16 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/ssl_cookie.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
+#include <mbedtls/platform.h>
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+#include <mbedtls/ssl_cache.h>
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+#include <mbedtls/ssl_ticket.h>
+#endif
+
 #endif /* CONFIG_MBEDTLS */
 
 #include "sockets_internal.h"
@@ -102,6 +112,11 @@ struct tls_context {
 
 		/** DTLS role, client by default. */
 		s8_t role;
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+		/** Information if TLS session resumption is enabled. */
+		bool cache_enabled;
+#endif
 	} options;
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -147,6 +162,51 @@ static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 /* A mutex for protecting TLS context allocation. */
 static struct k_mutex context_lock;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/* Longer hostnames are not used to look up a cached session. */
+#define TLS_SESSION_HOSTNAME_LEN 64
+
+#if defined(MBEDTLS_GCM_C)
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_256_GCM
+#else
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_256_CCM
+#endif
+
+/** TLS session saved by a client for its next connection to a host. */
+struct tls_session_entry {
+	/** mbedTLS session, with the session ID or ticket. */
+	mbedtls_ssl_session session;
+
+	/** Hostname the session was established with. */
+	char hostname[TLS_SESSION_HOSTNAME_LEN + 1];
+
+	/** Time the session was established, in milliseconds. */
+	u32_t timestamp;
+
+	/** Information whether the entry is used. */
+	bool is_used;
+};
+
+static struct tls_session_entry
+	client_sessions[CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE];
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+/* Sessions of the clients of TLS servers. */
+static mbedtls_ssl_cache_context server_cache;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+/* Keys protecting the session tickets given by TLS servers. */
+static mbedtls_ssl_ticket_context server_ticket;
+static bool server_ticket_ready;
+#endif
+
+/* A mutex for protecting the session caches, mbedTLS does not lock them
+ * without MBEDTLS_THREADING_C.
+ */
+static struct k_mutex session_lock;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #define IS_LISTENING(context) (net_context_get_state(context) == \
 			       NET_CONTEXT_LISTENING)
 
@@ -250,6 +310,207 @@ static int dtls_timing_get_delay(void *data)
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/* Hostname to save the session with, NULL if the session is not saved. */
+static const char *tls_session_hostname(struct tls_context *tls)
+{
+	if (!tls->options.cache_enabled || !tls->options.is_hostname_set) {
+		return NULL;
+	}
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (tls->ssl.hostname != NULL && tls->ssl.hostname[0] != '\0' &&
+	    strlen(tls->ssl.hostname) <= TLS_SESSION_HOSTNAME_LEN) {
+		return tls->ssl.hostname;
+	}
+#endif
+
+	return NULL;
+}
+
+static struct tls_session_entry *tls_session_find(const char *hostname)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client_sessions); i++) {
+		if (client_sessions[i].is_used &&
+		    strcmp(client_sessions[i].hostname, hostname) == 0) {
+			return &client_sessions[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void tls_session_clear(struct tls_session_entry *entry)
+{
+	mbedtls_ssl_session_free(&entry->session);
+	entry->is_used = false;
+}
+
+/* Offer the session saved by the last connection to the same host. */
+static void tls_session_restore(struct tls_context *tls)
+{
+	const char *hostname = tls_session_hostname(tls);
+	struct tls_session_entry *entry;
+	int ret;
+
+	if (hostname == NULL) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(hostname);
+	if (entry == NULL) {
+		goto out;
+	}
+
+	if (k_uptime_get_32() - entry->timestamp >
+	    K_SECONDS(CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME)) {
+		NET_DBG("TLS session for %s expired",
+			log_strdup(entry->hostname));
+		tls_session_clear(entry);
+		goto out;
+	}
+
+	ret = mbedtls_ssl_set_session(&tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Cannot resume TLS session: -%x", -ret);
+	}
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+/* Save the session of an established connection, replacing the session of
+ * the same host or else the oldest one.
+ */
+static void tls_session_save(struct tls_context *tls)
+{
+	const char *hostname = tls_session_hostname(tls);
+	struct tls_session_entry *entry;
+	u32_t now = k_uptime_get_32();
+	int i, ret;
+
+	if (hostname == NULL) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(hostname);
+
+	for (i = 0; entry == NULL && i < ARRAY_SIZE(client_sessions); i++) {
+		if (!client_sessions[i].is_used) {
+			entry = &client_sessions[i];
+		}
+	}
+
+	if (entry == NULL) {
+		entry = &client_sessions[0];
+
+		for (i = 1; i < ARRAY_SIZE(client_sessions); i++) {
+			if (now - client_sessions[i].timestamp >
+			    now - entry->timestamp) {
+				entry = &client_sessions[i];
+			}
+		}
+	}
+
+	ret = mbedtls_ssl_get_session(&tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Cannot save TLS session: -%x", -ret);
+		tls_session_clear(entry);
+		goto out;
+	}
+
+	strcpy(entry->hostname, hostname);
+	entry->timestamp = now;
+	entry->is_used = true;
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static int tls_server_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_get(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_server_cache_set(void *data,
+				const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+static int tls_server_ticket_write(void *data,
+				   const mbedtls_ssl_session *session,
+				   unsigned char *start,
+				   const unsigned char *end,
+				   size_t *tlen, uint32_t *lifetime)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_write(data, session, start, end, tlen,
+				       lifetime);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_server_ticket_parse(void *data, mbedtls_ssl_session *session,
+				   unsigned char *buf, size_t len)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_parse(data, session, buf, len);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_TICKET_C */
+
+static void tls_session_cache_init(void)
+{
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_init(&server_cache);
+	mbedtls_ssl_cache_set_max_entries(
+		&server_cache, CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE);
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_init(&server_ticket);
+
+	if (mbedtls_ssl_ticket_setup(&server_ticket, mbedtls_ctr_drbg_random,
+				     &tls_ctr_drbg, TLS_TICKET_CIPHER,
+				     CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME)
+	    == 0) {
+		server_ticket_ready = true;
+	} else {
+		NET_WARN("TLS session tickets are not available");
+	}
+#endif
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 /* Initialize TLS internals. */
 static int tls_init(struct device *unused)
 {
@@ -274,6 +535,9 @@ static int tls_init(struct device *unused)
 	(void)memset(tls_contexts, 0, sizeof(tls_contexts));
 
 	k_mutex_init(&context_lock);
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	k_mutex_init(&session_lock);
+#endif
 
 	mbedtls_ctr_drbg_init(&tls_ctr_drbg);
 
@@ -285,6 +549,10 @@ static int tls_init(struct device *unused)
 		return -EFAULT;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	tls_session_cache_init();
+#endif
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
@@ -313,6 +581,9 @@ static struct tls_context *tls_alloc(void)
 			(void)memset(tls, 0, sizeof(*tls));
 			tls->is_used = true;
 			tls->options.verify_level = -1;
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+			tls->options.cache_enabled = true;
+#endif
 
 			NET_DBG("Allocated TLS context, %p", tls);
 			break;
@@ -805,6 +1076,12 @@ static int tls_mbedtls_handshake(struct net_context *context, bool block)
 
 	if (ret == 0) {
 		k_sem_give(&context->tls->tls_established);
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+		if (context->tls->config.endpoint == MBEDTLS_SSL_IS_CLIENT) {
+			tls_session_save(context->tls);
+		}
+#endif
 	}
 
 	return ret;
@@ -893,6 +1170,34 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 			     mbedtls_ctr_drbg_random,
 			     &tls_ctr_drbg);
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	if (context->tls->options.cache_enabled && is_server) {
+#if defined(MBEDTLS_SSL_CACHE_C)
+		mbedtls_ssl_conf_session_cache(&context->tls->config,
+					       &server_cache,
+					       tls_server_cache_get,
+					       tls_server_cache_set);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+		if (server_ticket_ready) {
+			mbedtls_ssl_conf_session_tickets_cb(
+				&context->tls->config,
+				tls_server_ticket_write,
+				tls_server_ticket_parse,
+				&server_ticket);
+		}
+#endif
+	}
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	if (!context->tls->options.cache_enabled && !is_server) {
+		mbedtls_ssl_conf_session_tickets(
+			&context->tls->config,
+			MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+	}
+#endif
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	ret = tls_mbedtls_set_credentials(context->tls);
 	if (ret != 0) {
 		return ret;
@@ -907,6 +1212,12 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 		return -ENOMEM;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	if (!is_server) {
+		tls_session_restore(context->tls);
+	}
+#endif
+
 	context->tls->is_initialized = true;
 
 	return 0;
@@ -1100,6 +1411,47 @@ static int tls_opt_dtls_role_set(struct net_context *context,
 	return 0;
 }
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static int tls_opt_session_cache_set(struct net_context *context,
+				     const void *optval, socklen_t optlen)
+{
+	int *cache;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	cache = (int *)optval;
+	if (*cache != TLS_SESSION_CACHE_DISABLED &&
+	    *cache != TLS_SESSION_CACHE_ENABLED) {
+		return -EINVAL;
+	}
+
+	context->tls->options.cache_enabled =
+		(*cache == TLS_SESSION_CACHE_ENABLED);
+
+	return 0;
+}
+
+static int tls_opt_session_cache_get(struct net_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->tls->options.cache_enabled ?
+			 TLS_SESSION_CACHE_ENABLED :
+			 TLS_SESSION_CACHE_DISABLED;
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 int ztls_socket(int family, int type, int proto)
 {
 	enum net_ip_protocol_secure tls_proto = 0;
@@ -1834,6 +2186,12 @@ int ztls_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_ciphersuite_used_get(ctx, optval, optlen);
 		break;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+#endif
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -1884,6 +2242,12 @@ int ztls_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_dtls_role_set(ctx, optval, optlen);
 		break;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+#endif
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
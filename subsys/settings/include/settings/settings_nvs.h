@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SETTINGS_NVS_H_
+#define __SETTINGS_NVS_H_
+
+#include <nvs/nvs.h>
+#include "settings/settings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Each key has a number, given in the order the keys are first saved.
+ * Its name is stored at SETTINGS_NVS_NAME_ID + number and its value at
+ * SETTINGS_NVS_VALUE_ID + number, the NVS ids below SETTINGS_NVS_KEY_CNT_ID
+ * are left to the application.
+ */
+#define SETTINGS_NVS_KEY_CNT_ID		0x8000
+#define SETTINGS_NVS_NAME_ID		0x8001
+#define SETTINGS_NVS_VALUE_ID		0xc001
+
+#define SETTINGS_NVS_NO_KEY		0xffff
+
+/* Two slots of the hash index per key, so that the probes stay short */
+#define SETTINGS_NVS_INDEX_SIZE		(2 * CONFIG_SETTINGS_NVS_MAX_KEYS)
+
+struct settings_nvs_index {
+	u16_t hash;	/* hash of the name */
+	u16_t key;	/* key number, SETTINGS_NVS_NO_KEY if free */
+};
+
+struct settings_nvs {
+	struct settings_store cf_store;
+	struct nvs_fs cf_nvs;
+	const char *cf_dev_name;	/* flash device of cf_nvs */
+	u16_t cf_key_cnt;		/* private */
+	struct settings_nvs_index cf_index[SETTINGS_NVS_INDEX_SIZE];
+	size_t cf_val_len;		/* private */
+	u8_t cf_val[SETTINGS_MAX_VAL_LEN];
+};
+
+/* register NVS to be source of settings */
+int settings_nvs_src(struct settings_nvs *cf);
+
+/* settings saves go to NVS */
+int settings_nvs_dst(struct settings_nvs *cf);
+
+void settings_mount_nvs_backend(struct settings_nvs *cf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SETTINGS_NVS_H_ */
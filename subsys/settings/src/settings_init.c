@@ -97,6 +97,56 @@ static void settings_init_fcb(void)
 	settings_mount_fcb_backend(&config_init_settings_fcb);
 }
 
+#elif defined(CONFIG_SETTINGS_NVS)
+#include <flash.h>
+#include <flash_map.h>
+#include "settings/settings_nvs.h"
+
+static struct settings_nvs default_settings_nvs;
+
+static void settings_init_nvs(void)
+{
+	const struct flash_area *fap;
+	struct flash_pages_info info;
+	struct device *dev;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fap);
+	if (rc != 0) {
+		k_panic();
+	}
+
+	dev = device_get_binding(fap->fa_dev_name);
+	if (!dev) {
+		k_panic();
+	}
+
+	/* NVS takes the whole storage area, in sectors of a flash page */
+	rc = flash_get_page_info_by_offs(dev, fap->fa_off, &info);
+	if (rc != 0) {
+		k_panic();
+	}
+
+	default_settings_nvs.cf_dev_name = fap->fa_dev_name;
+	default_settings_nvs.cf_nvs.offset = fap->fa_off;
+	default_settings_nvs.cf_nvs.sector_size = info.size;
+	default_settings_nvs.cf_nvs.sector_count = fap->fa_size / info.size;
+
+	flash_area_close(fap);
+
+	rc = settings_nvs_src(&default_settings_nvs);
+	if (rc != 0) {
+		k_panic();
+	}
+
+	rc = settings_nvs_dst(&default_settings_nvs);
+	if (rc != 0) {
+		k_panic();
+	}
+
+	settings_mount_nvs_backend(&default_settings_nvs);
+}
+
 #endif
 
 int settings_subsys_init(void)
@@ -126,6 +176,9 @@ int settings_subsys_init(void)
 #elif defined(CONFIG_SETTINGS_FCB)
 	settings_init_fcb(); /* func rises kernel panic once error */
 	err = 0;
+#elif defined(CONFIG_SETTINGS_NVS)
+	settings_init_nvs(); /* func rises kernel panic once error */
+	err = 0;
 #endif
 
 	if (!err) {
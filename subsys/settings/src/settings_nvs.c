@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <crc.h>
+
+#include "settings/settings.h"
+#include "settings/settings_nvs.h"
+#include "settings_priv.h"
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
+
+#define SETTINGS_NVS_NAME_LEN (SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN)
+
+static int settings_nvs_load(struct settings_store *cs, load_cb cb,
+			     void *cb_arg);
+static int settings_nvs_load_one(struct settings_store *cs, const char *name,
+				 load_cb cb, void *cb_arg);
+static int settings_nvs_save(struct settings_store *cs, const char *name,
+			     const char *value, size_t val_len);
+
+static struct settings_store_itf settings_nvs_itf = {
+	.csi_load = settings_nvs_load,
+	.csi_load_one = settings_nvs_load_one,
+	.csi_save = settings_nvs_save,
+};
+
+static u16_t settings_nvs_hash(const char *name, size_t len)
+{
+	return crc16_ccitt(0xffff, (const u8_t *)name, len);
+}
+
+/*
+ * Look up a name in the hash index. Only the names with the same hash are
+ * read from NVS, which is once for most names.
+ *
+ * Returns 0 and the slot of the name if it has a key, 1 and the free slot
+ * to give it if it does not, with its hash already set, -ERCODE on storage
+ * errors.
+ */
+static int settings_nvs_index_find(struct settings_nvs *cf, const char *name,
+				   size_t len, int *slot)
+{
+	struct settings_nvs_index *entry;
+	char buf[SETTINGS_NVS_NAME_LEN];
+	u16_t hash;
+	ssize_t rc;
+	int i;
+
+	hash = settings_nvs_hash(name, len);
+
+	/* There are more slots than keys, a free one ends the probes */
+	for (i = hash % SETTINGS_NVS_INDEX_SIZE; ;
+	     i = (i + 1) % SETTINGS_NVS_INDEX_SIZE) {
+		entry = &cf->cf_index[i];
+
+		if (entry->key == SETTINGS_NVS_NO_KEY) {
+			entry->hash = hash;
+			break;
+		}
+
+		if (entry->hash != hash) {
+			continue;
+		}
+
+		rc = nvs_read(&cf->cf_nvs, SETTINGS_NVS_NAME_ID + entry->key,
+			      buf, sizeof(buf));
+		if (rc < 0) {
+			return rc;
+		}
+
+		if (rc == len && !memcmp(buf, name, len)) {
+			*slot = i;
+			return 0;
+		}
+	}
+
+	*slot = i;
+	return 1;
+}
+
+/* Read the value of a key, for the read_handler() */
+static int settings_nvs_val_read(struct settings_nvs *cf, u16_t key)
+{
+	ssize_t rc;
+
+	rc = nvs_read(&cf->cf_nvs, SETTINGS_NVS_VALUE_ID + key, cf->cf_val,
+		      sizeof(cf->cf_val));
+	if (rc < 0) {
+		return rc;
+	}
+
+	cf->cf_val_len = MIN(rc, sizeof(cf->cf_val));
+
+	return 0;
+}
+
+int settings_nvs_src(struct settings_nvs *cf)
+{
+	char name[SETTINGS_NVS_NAME_LEN];
+	u16_t key, key_cnt;
+	ssize_t rc;
+	int slot;
+
+	rc = nvs_init(&cf->cf_nvs, cf->cf_dev_name);
+	if (rc) {
+		return rc;
+	}
+
+	rc = nvs_read(&cf->cf_nvs, SETTINGS_NVS_KEY_CNT_ID, &cf->cf_key_cnt,
+		      sizeof(cf->cf_key_cnt));
+	if (rc == -ENOENT) {
+		cf->cf_key_cnt = 0U;
+	} else if (rc != sizeof(cf->cf_key_cnt)) {
+		return -EIO;
+	}
+
+	/*
+	 * Build the hash index from the names, reading each once. The keys
+	 * over the max are left out, and no key is given their numbers again.
+	 */
+	key_cnt = MIN(cf->cf_key_cnt, CONFIG_SETTINGS_NVS_MAX_KEYS);
+	if (key_cnt < cf->cf_key_cnt) {
+		LOG_WRN("%u keys over CONFIG_SETTINGS_NVS_MAX_KEYS not loaded",
+			cf->cf_key_cnt - key_cnt);
+	}
+
+	(void)memset(cf->cf_index, 0xff, sizeof(cf->cf_index));
+
+	for (key = 0U; key < key_cnt; key++) {
+		rc = nvs_read(&cf->cf_nvs, SETTINGS_NVS_NAME_ID + key, name,
+			      sizeof(name));
+		if (rc == -ENOENT) {
+			continue;
+		}
+
+		if (rc < 0) {
+			return rc;
+		}
+
+		if (rc > sizeof(name)) {
+			continue;
+		}
+
+		rc = settings_nvs_index_find(cf, name, rc, &slot);
+		if (rc < 0) {
+			return rc;
+		}
+
+		if (rc) {
+			cf->cf_index[slot].key = key;
+		}
+	}
+
+	cf->cf_store.cs_itf = &settings_nvs_itf;
+	settings_src_register(&cf->cf_store);
+
+	return 0;
+}
+
+int settings_nvs_dst(struct settings_nvs *cf)
+{
+	cf->cf_store.cs_itf = &settings_nvs_itf;
+	settings_dst_register(&cf->cf_store);
+
+	return 0;
+}
+
+/* Only the latest value of each key is read, deleted keys are skipped */
+static int settings_nvs_load(struct settings_store *cs, load_cb cb,
+			     void *cb_arg)
+{
+	struct settings_nvs *cf = (struct settings_nvs *)cs;
+	char name[SETTINGS_NVS_NAME_LEN + 1];
+	u16_t key, key_cnt;
+	ssize_t rc;
+
+	key_cnt = MIN(cf->cf_key_cnt, CONFIG_SETTINGS_NVS_MAX_KEYS);
+
+	for (key = 0U; key < key_cnt; key++) {
+		rc = nvs_read(&cf->cf_nvs, SETTINGS_NVS_NAME_ID + key, name,
+			      sizeof(name) - 1);
+		if (rc == -ENOENT) {
+			continue;
+		}
+
+		if (rc < 0) {
+			return -EINVAL;
+		}
+
+		if (rc > sizeof(name) - 1) {
+			continue;
+		}
+
+		name[rc] = '\0';
+
+		rc = settings_nvs_val_read(cf, key);
+		if (rc == -ENOENT) {
+			continue;
+		}
+
+		if (rc) {
+			return -EINVAL;
+		}
+
+		cb(name, (void *)cf, 0, cb_arg);
+	}
+
+	return 0;
+}
+
+/* ::csi_load_one implementation */
+static int settings_nvs_load_one(struct settings_store *cs, const char *name,
+				 load_cb cb, void *cb_arg)
+{
+	struct settings_nvs *cf = (struct settings_nvs *)cs;
+	int slot;
+	int rc;
+
+	rc = settings_nvs_index_find(cf, name, strlen(name), &slot);
+	if (rc) {
+		return rc < 0 ? -EINVAL : 0;
+	}
+
+	rc = settings_nvs_val_read(cf, cf->cf_index[slot].key);
+	if (rc == -ENOENT) {
+		return 0;
+	}
+
+	if (rc) {
+		return -EINVAL;
+	}
+
+	cb((char *)name, (void *)cf, 0, cb_arg);
+
+	return 0;
+}
+
+/* ::csi_save implementation */
+static int settings_nvs_save(struct settings_store *cs, const char *name,
+			     const char *value, size_t val_len)
+{
+	struct settings_nvs *cf = (struct settings_nvs *)cs;
+	bool delete;
+	size_t len;
+	u16_t key;
+	ssize_t rc;
+	int slot;
+
+	if (!name) {
+		return -EINVAL;
+	}
+
+	len = strlen(name);
+	if (len > SETTINGS_NVS_NAME_LEN || val_len > SETTINGS_MAX_VAL_LEN) {
+		return -EINVAL;
+	}
+
+	delete = !value || val_len == 0;
+
+	rc = settings_nvs_index_find(cf, name, len, &slot);
+	if (rc < 0) {
+		return rc;
+	}
+
+	if (rc == 0) {
+		key = cf->cf_index[slot].key;
+	} else if (delete) {
+		/* The name was never saved */
+		return 0;
+	} else {
+		if (cf->cf_key_cnt >= CONFIG_SETTINGS_NVS_MAX_KEYS) {
+			return -ENOMEM;
+		}
+
+		/*
+		 * The key count is written first, a key number is never
+		 * given twice even when writing its name fails.
+		 */
+		key = cf->cf_key_cnt++;
+
+		rc = nvs_write(&cf->cf_nvs, SETTINGS_NVS_KEY_CNT_ID,
+			       &cf->cf_key_cnt, sizeof(cf->cf_key_cnt));
+		if (rc < 0) {
+			return rc;
+		}
+
+		rc = nvs_write(&cf->cf_nvs, SETTINGS_NVS_NAME_ID + key, name,
+			       len);
+		if (rc < 0) {
+			return rc;
+		}
+
+		cf->cf_index[slot].key = key;
+	}
+
+	/* The name stays, so that the key is given again if saved again */
+	if (delete) {
+		rc = nvs_delete(&cf->cf_nvs, SETTINGS_NVS_VALUE_ID + key);
+	} else {
+		rc = nvs_write(&cf->cf_nvs, SETTINGS_NVS_VALUE_ID + key, value,
+			       val_len);
+	}
+
+	return rc < 0 ? rc : 0;
+}
+
+static int read_handler(void *ctx, off_t off, char *buf, size_t *len)
+{
+	struct settings_nvs *cf = ctx;
+
+	if (off >= cf->cf_val_len) {
+		*len = 0;
+		return 0;
+	}
+
+	if ((off + *len) > cf->cf_val_len) {
+		*len = cf->cf_val_len - off;
+	}
+
+	memcpy(buf, cf->cf_val + off, *len);
+
+	return 0;
+}
+
+static size_t get_len_cb(void *ctx)
+{
+	struct settings_nvs *cf = ctx;
+
+	return cf->cf_val_len;
+}
+
+/*
+ * The values are read from the copy settings_nvs_val_read() makes, and
+ * written by settings_nvs_save() itself.
+ */
+void settings_mount_nvs_backend(struct settings_nvs *cf)
+{
+	settings_line_io_init(read_handler, NULL, get_len_cb, 1);
+}
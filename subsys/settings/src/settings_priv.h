@@ -115,6 +115,8 @@ typedef void (*load_cb)(char *name, void *val_read_cb_ctx, off_t off,
 
 struct settings_store_itf {
 	int (*csi_load)(struct settings_store *cs, load_cb cb, void *cb_arg);
+	int (*csi_load_one)(struct settings_store *cs, const char *name,
+			    load_cb cb, void *cb_arg);
 	int (*csi_save_start)(struct settings_store *cs);
 	int (*csi_save)(struct settings_store *cs, const char *name,
 			const char *value, size_t val_len);
@@ -156,13 +156,19 @@ int settings_save_one(const char *name, void *value, size_t val_len)
 	}
 
 	/*
-	 * Check if we're writing the same value again.
+	 * Check if we're writing the same value again. Back-ends that can
+	 * look up a single name do not need to load everything for this.
 	 */
 	cdca.name = name;
 	cdca.val = (char *)value;
 	cdca.is_dup = 0;
 	cdca.val_len = val_len;
-	cs->cs_itf->csi_load(cs, settings_dup_check_cb, &cdca);
+	if (cs->cs_itf->csi_load_one) {
+		cs->cs_itf->csi_load_one(cs, name, settings_dup_check_cb,
+					 &cdca);
+	} else {
+		cs->cs_itf->csi_load(cs, settings_dup_check_cb, &cdca);
+	}
 	if (cdca.is_dup == 1) {
 		return 0;
 	}
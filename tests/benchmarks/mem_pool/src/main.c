@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+/* See README.rst */
+
+#define MIN_SZ 16
+#define MAX_SZ 1024
+#define N_MAX 16
+
+#define N_RUNS 5000
+#define MAX_LIVE 32
+
+K_MEM_POOL_DEFINE(bench_pool, MIN_SZ, MAX_SZ, N_MAX, 4);
+
+static struct k_mem_block live[MAX_LIVE];
+static bool in_use[MAX_LIVE];
+static struct k_mem_block pinned[N_RUNS / 4];
+
+static u32_t t_alloc, t_free, n_alloc, n_free;
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static bool timed_alloc(struct k_mem_block *block, size_t size)
+{
+	u32_t t0 = k_cycle_get_32();
+	int ret = k_mem_pool_alloc(&bench_pool, block, size, K_NO_WAIT);
+
+	t_alloc += k_cycle_get_32() - t0;
+	n_alloc++;
+
+	return ret == 0;
+}
+
+static void timed_free(struct k_mem_block *block)
+{
+	u32_t t0 = k_cycle_get_32();
+
+	k_mem_pool_free(block);
+	t_free += k_cycle_get_32() - t0;
+	n_free++;
+}
+
+static size_t random_size(void)
+{
+	/* Skewed towards small sizes, like real heap traffic */
+	return MIN_SZ << (next_rand() % 4) << (next_rand() % 3);
+}
+
+static void fixed_size(void)
+{
+	struct k_mem_block block;
+
+	for (int i = 0; i < N_RUNS; i++) {
+		if (timed_alloc(&block, 64)) {
+			timed_free(&block);
+		}
+	}
+}
+
+static void random_mix(bool pin)
+{
+	int npinned = 0;
+
+	for (int i = 0; i < N_RUNS; i++) {
+		int slot = next_rand() % MAX_LIVE;
+
+		if (in_use[slot]) {
+			timed_free(&live[slot]);
+			in_use[slot] = false;
+		}
+
+		if (pin && (i % 4) == 0 && npinned < ARRAY_SIZE(pinned)) {
+			if (timed_alloc(&pinned[npinned], random_size())) {
+				npinned++;
+			}
+		}
+
+		in_use[slot] = timed_alloc(&live[slot], random_size());
+	}
+
+	for (int i = 0; i < MAX_LIVE; i++) {
+		if (in_use[i]) {
+			k_mem_pool_free(&live[i]);
+			in_use[i] = false;
+		}
+	}
+
+	for (int i = 0; i < npinned; i++) {
+		k_mem_pool_free(&pinned[i]);
+	}
+}
+
+/* Counts how many maximum size blocks can be had once everything has
+ * been freed, i.e. whether the pool recombined all its fragments
+ */
+static int count_max_blocks(void)
+{
+	static struct k_mem_block big[N_MAX];
+	int n = 0;
+
+	while (n < N_MAX &&
+	       k_mem_pool_alloc(&bench_pool, &big[n], MAX_SZ, K_NO_WAIT) == 0) {
+		n++;
+	}
+
+	for (int i = 0; i < n; i++) {
+		k_mem_pool_free(&big[i]);
+	}
+
+	return n;
+}
+
+static void report(const char *name)
+{
+	printk("%-12s alloc %5u free %5u cycles (avg), %d/%d max blocks after\n",
+	       name, t_alloc / MAX(n_alloc, 1U), t_free / MAX(n_free, 1U),
+	       count_max_blocks(), N_MAX);
+
+#ifdef CONFIG_MEM_POOL_CACHE
+	struct k_mem_pool_cache_stats stats;
+
+	k_mem_pool_cache_stats_get(&bench_pool, &stats);
+	printk("%-12s cache hits %u misses %u cached %u\n", name,
+	       stats.hits, stats.misses, stats.cached);
+#endif
+
+	t_alloc = t_free = n_alloc = n_free = 0U;
+}
+
+void main(void)
+{
+	fixed_size();
+	report("fixed");
+
+	random_mix(false);
+	report("mixed");
+
+	random_mix(true);
+	report("fragmenting");
+
+	printk("fin\n");
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/net_pkt.h>
+#include <random/rand32.h>
+
+#include "net_private.h"
+
+/* See README.rst */
+
+#define MAX_LEN 1460
+#define ROUNDS 1000
+
+/* Extra room so that the buffer can be offset by an odd amount */
+static u8_t src_buf[MAX_LEN + 8] __aligned(4);
+
+/* The 16 bits at a time loop net_calc_chksum() used to run */
+static u16_t ref_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	const u8_t *end;
+	u16_t tmp;
+
+	end = data + len - 1;
+
+	while (data < end) {
+		tmp = (data[0] << 8) + data[1];
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+
+		data += 2;
+	}
+
+	if (data == end) {
+		tmp = data[0] << 8;
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+/* Keeps the compiler from dropping the calls being timed */
+static volatile u16_t sink;
+
+static u32_t time_ref(const u8_t *src, size_t len)
+{
+	u32_t start = k_cycle_get_32();
+	int i;
+
+	for (i = 0; i < ROUNDS; i++) {
+		sink = ref_chksum(0, src, len);
+	}
+
+	return (k_cycle_get_32() - start) / ROUNDS;
+}
+
+static u32_t time_buf(const u8_t *src, size_t len)
+{
+	u32_t start = k_cycle_get_32();
+	int i;
+
+	for (i = 0; i < ROUNDS; i++) {
+		sink = net_calc_chksum_buf(0, src, len);
+	}
+
+	return (k_cycle_get_32() - start) / ROUNDS;
+}
+
+/* One's complement sums can represent zero as 0x0000 or 0xffff */
+static bool chksum_equal(u16_t a, u16_t b)
+{
+	return a == b || (a == 0xffff && b == 0) || (a == 0 && b == 0xffff);
+}
+
+static void run(size_t len, size_t offset)
+{
+	const u8_t *src = src_buf + offset;
+	u16_t ref = ref_chksum(0, src, len);
+
+	if (!chksum_equal(net_calc_chksum_buf(0, src, len), ref)) {
+		printk("chksum: len %zu offset %zu mismatch\n", len, offset);
+		return;
+	}
+
+	printk("chksum: len %4zu offset %zu: ref %u buf %u cycles\n",
+	       len, offset, time_ref(src, len), time_buf(src, len));
+}
+
+void main(void)
+{
+	static const size_t lens[] = { 20, 64, 576, MAX_LEN };
+	int i;
+
+	for (i = 0; i < sizeof(src_buf); i++) {
+		src_buf[i] = sys_rand32_get();
+	}
+
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		run(lens[i], 0);
+		run(lens[i], 1);
+	}
+
+	printk("fin\n");
+}
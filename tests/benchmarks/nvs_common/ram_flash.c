@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+#include <device.h>
+#include <flash.h>
+#include <zephyr/types.h>
+
+#include "ram_flash.h"
+
+/*
+ * Flash device backed by RAM, shared by the NVS benchmarks. It can count
+ * the accesses and take the erase and write times of a flash, see Kconfig.
+ */
+
+static u8_t rambuf[RAM_FLASH_PAGE_SIZE * RAM_FLASH_PAGE_COUNT];
+
+#ifdef CONFIG_RAM_FLASH_COUNTERS
+u32_t ram_flash_reads;
+u32_t ram_flash_erases;
+#endif
+
+static bool ram_flash_in_bounds(off_t offset, size_t len)
+{
+	return offset >= 0 && offset + len <= sizeof(rambuf);
+}
+
+static int ram_flash_init(struct device *dev)
+{
+	(void)memset(rambuf, 0xff, sizeof(rambuf));
+
+	return 0;
+}
+
+static int ram_flash_write_protection(struct device *dev, bool enable)
+{
+	return 0;
+}
+
+static int ram_flash_erase(struct device *dev, off_t offset, size_t len)
+{
+	if (!ram_flash_in_bounds(offset, len)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_RAM_FLASH_COUNTERS
+	ram_flash_erases++;
+#endif
+	(void)memset(rambuf + offset, 0xff, len);
+
+	if (CONFIG_RAM_FLASH_ERASE_US > 0) {
+		k_busy_wait(CONFIG_RAM_FLASH_ERASE_US *
+			    (len / RAM_FLASH_PAGE_SIZE));
+	}
+
+	return 0;
+}
+
+static int ram_flash_write(struct device *dev, off_t offset,
+			   const void *data, size_t len)
+{
+	if (!ram_flash_in_bounds(offset, len)) {
+		return -EINVAL;
+	}
+
+	memcpy(rambuf + offset, data, len);
+
+	if (CONFIG_RAM_FLASH_WRITE_US > 0) {
+		k_busy_wait(CONFIG_RAM_FLASH_WRITE_US);
+	}
+
+	return 0;
+}
+
+static int ram_flash_read(struct device *dev, off_t offset, void *data,
+			  size_t len)
+{
+	if (!ram_flash_in_bounds(offset, len)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_RAM_FLASH_COUNTERS
+	ram_flash_reads++;
+#endif
+	memcpy(data, rambuf + offset, len);
+
+	return 0;
+}
+
+static void ram_flash_pages_layout(struct device *dev,
+				   const struct flash_pages_layout **layout,
+				   size_t *layout_size)
+{
+	static const struct flash_pages_layout dev_layout[] = {
+		{ RAM_FLASH_PAGE_COUNT, RAM_FLASH_PAGE_SIZE },
+	};
+
+	*layout = dev_layout;
+	*layout_size = ARRAY_SIZE(dev_layout);
+}
+
+static const struct flash_driver_api ram_flash_api = {
+	.write_protection = ram_flash_write_protection,
+	.erase = ram_flash_erase,
+	.write = ram_flash_write,
+	.read = ram_flash_read,
+	.page_layout = ram_flash_pages_layout,
+	.write_block_size = 4,
+};
+
+DEVICE_AND_API_INIT(ram_flash, RAM_FLASH_NAME, ram_flash_init,
+		    NULL, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &ram_flash_api);
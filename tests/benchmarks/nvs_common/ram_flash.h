@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __RAM_FLASH_H__
+#define __RAM_FLASH_H__
+
+#include <zephyr/types.h>
+
+#define RAM_FLASH_NAME "ram_flash"
+#define RAM_FLASH_PAGE_SIZE 4096
+#define RAM_FLASH_PAGE_COUNT 4
+
+#ifdef CONFIG_RAM_FLASH_COUNTERS
+/* Number of flash_read() and flash_erase() calls so far */
+extern u32_t ram_flash_reads;
+extern u32_t ram_flash_erases;
+#endif
+
+#endif /* __RAM_FLASH_H__ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <nvs/nvs.h>
+
+#include "ram_flash.h"
+
+/* See README.rst */
+
+#define N_IDS 64
+#define N_VERSIONS 5
+#define N_READS 1000
+#define HOT_IDS 8
+
+struct record {
+	u32_t id;
+	u32_t version;
+};
+
+static struct nvs_fs fs = {
+	.offset = 0,
+	.sector_size = RAM_FLASH_PAGE_SIZE,
+	.sector_count = RAM_FLASH_PAGE_COUNT,
+};
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static int fill(void)
+{
+	struct record rec;
+	ssize_t rc;
+
+	for (rec.version = 0; rec.version < N_VERSIONS; rec.version++) {
+		for (rec.id = 0; rec.id < N_IDS; rec.id++) {
+			rc = nvs_write(&fs, rec.id, &rec, sizeof(rec));
+			if (rc != sizeof(rec)) {
+				printk("Write of id %u failed (%d)\n", rec.id,
+				       (int)rc);
+				return -EIO;
+			}
+		}
+	}
+
+	return 0;
+}
+
+enum pick {
+	PICK_NEWEST,
+	PICK_OLDEST,
+	PICK_RANDOM,
+	PICK_HOT,
+};
+
+static u16_t pick_id(enum pick pick)
+{
+	switch (pick) {
+	case PICK_NEWEST:
+		return N_IDS - 1;
+	case PICK_OLDEST:
+		return 0;
+	case PICK_RANDOM:
+		return next_rand() % N_IDS;
+	default:
+		return next_rand() % HOT_IDS;
+	}
+}
+
+static void timed_reads(const char *name, enum pick pick)
+{
+	u32_t cycles = 0U, reads = ram_flash_reads;
+	struct record rec;
+	ssize_t rc;
+	u16_t id;
+	u32_t t0;
+
+	for (int i = 0; i < N_READS; i++) {
+		id = pick_id(pick);
+
+		t0 = k_cycle_get_32();
+		rc = nvs_read(&fs, id, &rec, sizeof(rec));
+		cycles += k_cycle_get_32() - t0;
+
+		if (rc != sizeof(rec) || rec.id != id ||
+		    rec.version != N_VERSIONS - 1) {
+			printk("Wrong read of id %u (%d)\n", id, (int)rc);
+			return;
+		}
+	}
+
+	printk("%-8s %7u cycles %4u flash reads per read (avg)\n", name,
+	       cycles / N_READS, (ram_flash_reads - reads) / N_READS);
+}
+
+static void read_all(void)
+{
+	timed_reads("newest", PICK_NEWEST);
+	timed_reads("oldest", PICK_OLDEST);
+	timed_reads("random", PICK_RANDOM);
+	timed_reads("hot", PICK_HOT);
+}
+
+void main(void)
+{
+	u32_t t0, reads;
+	int rc;
+
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	if (rc) {
+		printk("Init failed (%d)\n", rc);
+		return;
+	}
+
+	if (fill()) {
+		return;
+	}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	printk("lookup cache of %d entries, %d ids\n",
+	       CONFIG_NVS_LOOKUP_CACHE_SIZE, N_IDS);
+#else
+	printk("no lookup cache, %d ids\n", N_IDS);
+#endif
+
+	read_all();
+
+	reads = ram_flash_reads;
+	t0 = k_cycle_get_32();
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	t0 = k_cycle_get_32() - t0;
+	if (rc) {
+		printk("Remount failed (%d)\n", rc);
+		return;
+	}
+
+	printk("remount  %7u cycles %4u flash reads\n", t0,
+	       ram_flash_reads - reads);
+
+	timed_reads("random", PICK_RANDOM);
+
+	printk("fin\n");
+}
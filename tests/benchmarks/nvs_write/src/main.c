@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <nvs/nvs.h>
+
+#include "ram_flash.h"
+
+/* See README.rst */
+
+#define N_IDS 32
+#define N_WRITES 2048
+
+struct record {
+	u32_t version;
+	u32_t id;
+	u32_t pad[2];
+};
+
+static struct nvs_fs fs = {
+	.offset = 0,
+	.sector_size = RAM_FLASH_PAGE_SIZE,
+	.sector_count = RAM_FLASH_PAGE_COUNT,
+};
+
+static u32_t latency[N_WRITES];
+static u32_t version;
+
+static void sort(u32_t *values, int count)
+{
+	u32_t value;
+	int i, j;
+
+	for (i = 1; i < count; i++) {
+		value = values[i];
+
+		for (j = i; j > 0 && values[j - 1] > value; j--) {
+			values[j] = values[j - 1];
+		}
+
+		values[j] = value;
+	}
+}
+
+static void report(const char *name)
+{
+	static const u8_t percentiles[] = { 50, 90, 99, 100 };
+	u32_t cycles;
+
+	sort(latency, N_WRITES);
+
+	printk("%s:", name);
+
+	for (int i = 0; i < ARRAY_SIZE(percentiles); i++) {
+		cycles = latency[(N_WRITES - 1) * percentiles[i] / 100];
+		if (percentiles[i] == 100) {
+			printk(" max");
+		} else {
+			printk(" p%u", percentiles[i]);
+		}
+
+		printk(" %u us", SYS_CLOCK_HW_CYCLES_TO_NS(cycles) / 1000);
+	}
+
+	printk("\n");
+}
+
+static int check(void)
+{
+	struct record rec;
+	ssize_t rc;
+
+	for (u16_t id = 0; id < N_IDS; id++) {
+		rc = nvs_read(&fs, id, &rec, sizeof(rec));
+		if (rc != sizeof(rec) || rec.id != id ||
+		    rec.version != version - N_IDS + id) {
+			printk("Wrong read of id %u (%d)\n", id, (int)rc);
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/* Writes the ids in turn, with a garbage collection step in between when
+ * gc_steps is set, as an application calling nvs_gc_step() when it is idle.
+ */
+static int timed_writes(const char *name, bool gc_steps)
+{
+	u32_t erases = ram_flash_erases;
+	struct record rec = { 0 };
+	ssize_t rc;
+	u32_t t0;
+
+	for (int i = 0; i < N_WRITES; i++) {
+		rec.version = version++;
+		rec.id = rec.version % N_IDS;
+
+		t0 = k_cycle_get_32();
+		rc = nvs_write(&fs, rec.id, &rec, sizeof(rec));
+		latency[i] = k_cycle_get_32() - t0;
+
+		if (rc != sizeof(rec)) {
+			printk("Write of id %u failed (%d)\n", rec.id, (int)rc);
+			return -EIO;
+		}
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+		if (gc_steps) {
+			rc = nvs_gc_step(&fs);
+			if (rc < 0) {
+				printk("Garbage collection failed (%d)\n",
+				       (int)rc);
+				return -EIO;
+			}
+		}
+#endif
+	}
+
+	report(name);
+	printk("%u sector erases\n", ram_flash_erases - erases);
+
+	return check();
+}
+
+void main(void)
+{
+	int rc;
+
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	if (rc) {
+		printk("Init failed (%d)\n", rc);
+		return;
+	}
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	printk("incremental garbage collection, %d entries per step\n",
+	       CONFIG_NVS_GC_STEP_ATES);
+#else
+	printk("garbage collection in nvs_write()\n");
+#endif
+
+	if (timed_writes("back to back", false)) {
+		return;
+	}
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	if (timed_writes("gc steps", true)) {
+		return;
+	}
+#endif
+
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	if (rc) {
+		printk("Remount failed (%d)\n", rc);
+		return;
+	}
+
+	if (check() || timed_writes("remounted", false)) {
+		return;
+	}
+
+	printk("fin\n");
+}
@@ -41,6 +41,8 @@
 #define N_RUNS 1000
 #define N_SETTLE 10
 
+extern void timeout_bench(void);
+
 
 static K_THREAD_STACK_DEFINE(partner_stack, 1024);
 static struct k_thread partner_thread;
@@ -157,5 +159,8 @@ void main(void)
 		       stamps[4] - stamps[3],
 		       whole, avg);
 	}
+
+	timeout_bench();
+
 	printk("fin\n");
 }
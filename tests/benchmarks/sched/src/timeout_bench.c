@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <timeout_q.h>
+
+/* Timeout queue microbenchmark.  For each population size, fill the
+ * timeout queue with that many armed timeouts (spread pseudo-randomly
+ * over a long range so none of them fire during the run), then time
+ * N_PROBES z_add_timeout()/z_abort_timeout() pairs of one more
+ * timeout landing somewhere in the middle of them.  Compare
+ * CONFIG_TIMEOUT_DLIST against CONFIG_TIMEOUT_WHEEL.
+ */
+
+#define MAX_LIVE 10000
+#define N_PROBES 1000
+
+/* Far enough out that nothing expires while we measure */
+#define BASE_TICKS 1000000
+
+static struct _timeout live[MAX_LIVE];
+static struct _timeout probe;
+
+static const int sizes[] = { 10, 100, 1000, MAX_LIVE };
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static void dummy_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	printk("ERROR: benchmark timeout expired\n");
+}
+
+static void run_one(int nlive)
+{
+	u32_t t0, t_add = 0U, t_abort = 0U;
+
+	for (int i = 0; i < nlive; i++) {
+		z_init_timeout(&live[i], dummy_fn);
+		z_add_timeout(&live[i], dummy_fn,
+			      BASE_TICKS + (next_rand() % BASE_TICKS));
+	}
+
+	z_init_timeout(&probe, dummy_fn);
+	for (int i = 0; i < N_PROBES; i++) {
+		s32_t ticks = BASE_TICKS + (next_rand() % BASE_TICKS);
+
+		t0 = k_cycle_get_32();
+		z_add_timeout(&probe, dummy_fn, ticks);
+		t_add += k_cycle_get_32() - t0;
+
+		t0 = k_cycle_get_32();
+		z_abort_timeout(&probe);
+		t_abort += k_cycle_get_32() - t0;
+	}
+
+	for (int i = 0; i < nlive; i++) {
+		z_abort_timeout(&live[i]);
+	}
+
+	printk("timeouts %5d: add %6d cycles abort %6d cycles (avg)\n",
+	       nlive, t_add / N_PROBES, t_abort / N_PROBES);
+}
+
+void timeout_bench(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		run_one(sizes[i]);
+	}
+}
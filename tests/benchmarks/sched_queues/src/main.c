@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <sched_priq.h>
+
+/* See README.rst.  These are not real threads: the queues only look
+ * at the priority, deadline and queue node fields, so the structs
+ * never get passed to k_thread_create().
+ */
+
+#define MAX_THREADS 500
+#define N_RUNS 1000
+#define NUM_PRIOS (K_LOWEST_APPLICATION_THREAD_PRIO - K_HIGHEST_THREAD_PRIO + 1)
+
+static struct k_thread threads[MAX_THREADS];
+
+static const int sizes[] = { 10, 50, 100, 200, 500 };
+
+static sys_dlist_t dumb_q;
+static struct _priq_rb rb_q;
+static struct _priq_mq mq_q;
+
+/* Thin wrappers so the backends can share one function table */
+#define WRAP(name, type)						\
+	static void name##_add(void *pq, struct k_thread *t)		\
+	{								\
+		z_priq_##name##_add((type *)pq, t);			\
+	}								\
+	static void name##_remove(void *pq, struct k_thread *t)	\
+	{								\
+		z_priq_##name##_remove((type *)pq, t);			\
+	}								\
+	static struct k_thread *name##_best(void *pq)			\
+	{								\
+		return z_priq_##name##_best((type *)pq);		\
+	}
+
+WRAP(dumb, sys_dlist_t)
+WRAP(rb, struct _priq_rb)
+WRAP(mq, struct _priq_mq)
+
+struct backend {
+	const char *name;
+	void *pq;
+	void (*add)(void *pq, struct k_thread *t);
+	void (*remove)(void *pq, struct k_thread *t);
+	struct k_thread *(*best)(void *pq);
+};
+
+static const struct backend backends[] = {
+	{ "dumb", &dumb_q, dumb_add, dumb_remove, dumb_best },
+	{ "scalable", &rb_q, rb_add, rb_remove, rb_best },
+	{ "multiq", &mq_q, mq_add, mq_remove, mq_best },
+};
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static void init_queues(void)
+{
+	sys_dlist_init(&dumb_q);
+
+	rb_q = (struct _priq_rb) {
+		.tree = {
+			.lessthan_fn = z_priq_rb_lessthan,
+		}
+	};
+
+	mq_q.bitmask = 0U;
+	for (int i = 0; i < ARRAY_SIZE(mq_q.queues); i++) {
+		z_priq_mq_init_level(&mq_q, i);
+	}
+}
+
+static void set_deadline(struct k_thread *t)
+{
+	t->base.prio_deadline = k_cycle_get_32() + (next_rand() % 100000U);
+}
+
+static void run_one(const struct backend *b, int n)
+{
+	u32_t t0, t_best = 0U, t_remove = 0U, t_add = 0U;
+
+	for (int i = 0; i < n; i++) {
+		threads[i].base.prio = K_HIGHEST_THREAD_PRIO + (i % NUM_PRIOS);
+		set_deadline(&threads[i]);
+		b->add(b->pq, &threads[i]);
+	}
+
+	for (int i = 0; i < N_RUNS; i++) {
+		struct k_thread *t;
+
+		t0 = k_cycle_get_32();
+		t = b->best(b->pq);
+		t_best += k_cycle_get_32() - t0;
+
+		t0 = k_cycle_get_32();
+		b->remove(b->pq, t);
+		t_remove += k_cycle_get_32() - t0;
+
+		set_deadline(t);
+
+		t0 = k_cycle_get_32();
+		b->add(b->pq, t);
+		t_add += k_cycle_get_32() - t0;
+	}
+
+	for (int i = 0; i < n; i++) {
+		b->remove(b->pq, &threads[i]);
+	}
+
+	printk("%-8s threads %3d: best %5d remove %5d add %5d cycles (avg)\n",
+	       b->name, n, t_best / N_RUNS, t_remove / N_RUNS,
+	       t_add / N_RUNS);
+}
+
+void main(void)
+{
+	init_queues();
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		for (int j = 0; j < ARRAY_SIZE(backends); j++) {
+			run_one(&backends[j], sizes[i]);
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+/* See README.rst.  Each "yielder" thread spins in k_yield(), so every
+ * iteration is one full trip through the scheduler (and a context
+ * switch to its partner on the same CPU).
+ */
+
+#define THREADS_PER_CPU 2
+#define NUM_THREADS (CONFIG_MP_NUM_CPUS * THREADS_PER_CPU)
+#define STACK_SIZE 1024
+#define RUN_MS 1000
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, NUM_THREADS, STACK_SIZE);
+static struct k_thread threads[NUM_THREADS];
+
+static volatile u32_t counts[NUM_THREADS];
+static volatile bool stop;
+
+static void yielder(void *p1, void *p2, void *p3)
+{
+	volatile u32_t *count = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!stop) {
+		(*count)++;
+		k_yield();
+	}
+}
+
+static u64_t run(int ncpus)
+{
+	int nthreads = ncpus * THREADS_PER_CPU;
+	u64_t total = 0;
+
+	stop = false;
+
+	for (int i = 0; i < nthreads; i++) {
+		counts[i] = 0U;
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				yielder, (void *)&counts[i], NULL, NULL,
+				K_PRIO_PREEMPT(1), 0, K_FOREVER);
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i / THREADS_PER_CPU);
+		k_thread_start(&threads[i]);
+	}
+
+	k_sleep(RUN_MS);
+	stop = true;
+
+	for (int i = 0; i < nthreads; i++) {
+		k_thread_abort(&threads[i]);
+		total += counts[i];
+	}
+
+	return total;
+}
+
+void main(void)
+{
+	u64_t base = 0;
+
+	k_thread_priority_set(k_current_get(), K_PRIO_COOP(0));
+
+	for (int n = 1; n <= CONFIG_MP_NUM_CPUS; n++) {
+		u64_t yields = run(n);
+		u32_t per_sec = (u32_t)(yields * 1000 / RUN_MS);
+
+		if (n == 1) {
+			base = yields;
+		}
+
+		if (base == 0U) {
+			printk("cpus %d: %u yields/sec (n/a of 1 cpu)\n",
+			       n, per_sec);
+			continue;
+		}
+
+		printk("cpus %d: %u yields/sec (%u.%02ux of 1 cpu)\n",
+		       n, per_sec, (u32_t)(yields / base),
+		       (u32_t)((yields * 100 / base) % 100));
+	}
+
+	printk("fin\n");
+}
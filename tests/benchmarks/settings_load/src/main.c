@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <misc/reboot.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <settings/settings.h>
+
+/* See README.rst */
+
+#define N_KEYS 1000
+#define N_UPDATES 2000
+
+static u8_t seen[N_KEYS];
+static int loaded;
+static int bad;
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+/*
+ * The values have the key number in their low half. FCB calls this for
+ * every record of a key, only the keys are counted.
+ */
+static int bench_set(int argc, char **argv, void *value_ctx)
+{
+	u32_t value;
+	int key;
+	int rc;
+
+	if (argc != 1) {
+		return -ENOENT;
+	}
+
+	key = atoi(argv[0]);
+	if (key < 0 || key >= N_KEYS) {
+		return -ENOENT;
+	}
+
+	rc = settings_val_read_cb(value_ctx, &value, sizeof(value));
+	if (rc != sizeof(value) || (value & 0xffff) != key) {
+		bad++;
+	}
+
+	if (!seen[key]) {
+		seen[key] = 1U;
+		loaded++;
+	}
+
+	return 0;
+}
+
+static struct settings_handler bench_handler = {
+	.name = "bench",
+	.h_set = bench_set,
+};
+
+static int save_key(int key, u32_t version)
+{
+	char name[16];
+	u32_t value = version << 16 | key;
+
+	snprintf(name, sizeof(name), "bench/%d", key);
+
+	return settings_save_one(name, &value, sizeof(value));
+}
+
+/* Saves count keys, all of them in turn or random ones */
+static int timed_saves(const char *name, int count, bool random)
+{
+	u32_t t0, ms, worst = 0U, t;
+	int key, rc;
+
+	t0 = k_uptime_get_32();
+
+	for (int i = 0; i < count; i++) {
+		key = random ? next_rand() % N_KEYS : i;
+
+		t = k_uptime_get_32();
+		rc = save_key(key, i + 1);
+		t = k_uptime_get_32() - t;
+
+		if (rc) {
+			printk("Save of key %d failed (%d)\n", key, rc);
+			return rc;
+		}
+
+		worst = MAX(worst, t);
+	}
+
+	ms = k_uptime_get_32() - t0;
+
+	printk("%-8s %5u us per save (avg) %5u ms max\n", name,
+	       ms * 1000U / count, worst);
+
+	return 0;
+}
+
+void main(void)
+{
+	u32_t init_ms, load_ms;
+	int rc;
+
+	init_ms = k_uptime_get_32();
+	rc = settings_subsys_init();
+	init_ms = k_uptime_get_32() - init_ms;
+	if (rc) {
+		printk("Init failed (%d)\n", rc);
+		return;
+	}
+
+	settings_register(&bench_handler);
+
+	load_ms = k_uptime_get_32();
+	rc = settings_load();
+	load_ms = k_uptime_get_32() - load_ms;
+	if (rc) {
+		printk("Load failed (%d)\n", rc);
+		return;
+	}
+
+#ifdef CONFIG_SETTINGS_NVS
+	printk("NVS back-end, %d keys\n", N_KEYS);
+#else
+	printk("FCB back-end, %d keys\n", N_KEYS);
+#endif
+
+	if (loaded != N_KEYS) {
+		/* First boot, store the keys and boot again */
+		printk("%d keys loaded, saving %d keys\n", loaded, N_KEYS);
+
+		if (timed_saves("new", N_KEYS, false) ||
+		    timed_saves("update", N_UPDATES, true)) {
+			return;
+		}
+
+		k_sleep(K_MSEC(250));
+		sys_reboot(SYS_REBOOT_COLD);
+		return;
+	}
+
+	printk("init     %5u ms\n", init_ms);
+	printk("load     %5u ms\n", load_ms);
+
+	if (bad) {
+		printk("%d wrong values loaded\n", bad);
+		return;
+	}
+
+	if (timed_saves("update", N_UPDATES, true)) {
+		return;
+	}
+
+	printk("fin\n");
+}
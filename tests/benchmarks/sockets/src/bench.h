@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SOCKETS_BENCH_H_
+#define _SOCKETS_BENCH_H_
+
+#include <kernel.h>
+
+#define BENCH_ADDR "192.0.2.1"
+
+void recv_bench(void);
+void poll_bench(void);
+
+static inline u32_t kib_per_sec(u32_t bytes, u32_t cycles)
+{
+	if (cycles == 0U) {
+		return 0;
+	}
+
+	return (u64_t)bytes * sys_clock_hw_cycles_per_sec() / cycles / 1024U;
+}
+
+#endif /* _SOCKETS_BENCH_H_ */
@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+#include "bench.h"
+
+/* See README.rst */
+
+void main(void)
+{
+	recv_bench();
+	poll_bench();
+
+	printk("fin\n");
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+#include "bench.h"
+
+#define MAX_SOCKS 64
+#define ROUNDS 200
+
+#define BASE_PORT 5000
+
+#define WAIT_TIMEOUT_MS 1000
+
+static int socks[MAX_SOCKS];
+static struct zsock_pollfd pfds[MAX_SOCKS];
+
+static int bind_udp(u16_t port)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(port),
+	};
+	int sock;
+
+	zsock_inet_pton(AF_INET, BENCH_ADDR, &addr.sin_addr);
+
+	sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		return -1;
+	}
+
+	if (zsock_bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		zsock_close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+static int send_to(int sender, int idx)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(BASE_PORT + idx),
+	};
+	u8_t byte = idx;
+
+	zsock_inet_pton(AF_INET, BENCH_ADDR, &addr.sin_addr);
+
+	return zsock_sendto(sender, &byte, sizeof(byte), 0,
+			    (struct sockaddr *)&addr, sizeof(addr));
+}
+
+/* Each round wakes the waiter up for one socket out of nsocks, picked
+ * round-robin, and measures the cycles from the send to the return of
+ * the wait call.
+ */
+static int poll_rounds(int sender, int nsocks, u32_t *cycles)
+{
+	u8_t byte;
+	u32_t start;
+	int i, idx, ret;
+
+	for (i = 0; i < nsocks; i++) {
+		pfds[i].fd = socks[i];
+		pfds[i].events = ZSOCK_POLLIN;
+	}
+
+	*cycles = 0U;
+
+	for (i = 0; i < ROUNDS; i++) {
+		idx = i % nsocks;
+
+		start = k_cycle_get_32();
+		send_to(sender, idx);
+
+		ret = zsock_poll(pfds, nsocks, WAIT_TIMEOUT_MS);
+		*cycles += k_cycle_get_32() - start;
+
+		if (ret != 1 || !(pfds[idx].revents & ZSOCK_POLLIN)) {
+			return -1;
+		}
+
+		zsock_recv(socks[idx], &byte, sizeof(byte), 0);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_NET_SOCKETS_EPOLL
+static int epoll_rounds(int sender, int nsocks, u32_t *cycles)
+{
+	struct zsock_epoll_event ev;
+	u8_t byte;
+	u32_t start;
+	int epfd, i, idx, ret = 0;
+
+	epfd = zsock_epoll_create1(0);
+	if (epfd < 0) {
+		return -1;
+	}
+
+	/* Registration is paid once, not per wait */
+	for (i = 0; i < nsocks; i++) {
+		ev.events = ZSOCK_EPOLLIN;
+		ev.data.u32 = i;
+		if (zsock_epoll_ctl(epfd, ZSOCK_EPOLL_CTL_ADD, socks[i],
+				    &ev) < 0) {
+			ret = -1;
+			goto out;
+		}
+	}
+
+	*cycles = 0U;
+
+	for (i = 0; i < ROUNDS; i++) {
+		idx = i % nsocks;
+
+		start = k_cycle_get_32();
+		send_to(sender, idx);
+
+		ret = zsock_epoll_wait(epfd, &ev, 1, WAIT_TIMEOUT_MS);
+		*cycles += k_cycle_get_32() - start;
+
+		if (ret != 1 || ev.data.u32 != (u32_t)idx) {
+			ret = -1;
+			goto out;
+		}
+
+		zsock_recv(socks[idx], &byte, sizeof(byte), 0);
+	}
+
+	ret = 0;
+
+out:
+	zsock_close(epfd);
+
+	return ret;
+}
+#endif
+
+void poll_bench(void)
+{
+	static const int counts[] = { 8, 16, 32, 64 };
+	u32_t cycles;
+	int sender, nsocks, i;
+
+	printk("poll: cycles per wakeup, one of N UDP sockets ready\n");
+
+	sender = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sender < 0) {
+		printk("poll: cannot create sender socket\n");
+		return;
+	}
+
+	for (nsocks = 0; nsocks < MAX_SOCKS; nsocks++) {
+		socks[nsocks] = bind_udp(BASE_PORT + nsocks);
+		if (socks[nsocks] < 0) {
+			break;
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(counts); i++) {
+		if (counts[i] > nsocks ||
+		    counts[i] > CONFIG_NET_SOCKETS_POLL_MAX) {
+			printk("poll: N=%d skipped, raise CONFIG_POSIX_MAX_FDS,"
+			       " CONFIG_NET_MAX_CONTEXTS and "
+			       "CONFIG_NET_SOCKETS_POLL_MAX\n", counts[i]);
+			continue;
+		}
+
+		if (poll_rounds(sender, counts[i], &cycles) < 0) {
+			printk("poll: N=%d failed\n", counts[i]);
+		} else {
+			printk("poll: N=%d poll() %u cycles\n", counts[i],
+			       cycles / ROUNDS);
+		}
+
+#ifdef CONFIG_NET_SOCKETS_EPOLL
+		if (epoll_rounds(sender, counts[i], &cycles) < 0) {
+			printk("poll: N=%d epoll failed\n", counts[i]);
+		} else {
+			printk("poll: N=%d epoll_wait() %u cycles\n",
+			       counts[i], cycles / ROUNDS);
+		}
+#endif
+	}
+
+	for (i = 0; i < nsocks; i++) {
+		zsock_close(socks[i]);
+	}
+	zsock_close(sender);
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+#include <net/buf.h>
+
+#include "bench.h"
+
+#define MSG_LEN 1024
+#define BURST 4
+#define N_BURSTS 500
+
+#define UDP_PORT 4242
+#define TCP_PORT 4243
+
+/* A datagram lost on loopback would otherwise hang the benchmark */
+#define RX_TIMEOUT_MS 1000
+
+static u8_t tx_buf[MSG_LEN];
+static u8_t rx_buf[MSG_LEN];
+
+/* Stand-in for an application parser: it touches every byte once */
+static u32_t parse(const u8_t *data, size_t len, u32_t sum)
+{
+	while (len--) {
+		sum += *data++;
+	}
+
+	return sum;
+}
+
+#ifdef CONFIG_NET_SOCKETS_RECV_ZC
+static u32_t parse_zc(struct zsock_zc_buf *zc, u32_t sum)
+{
+	struct net_buf *frag = zc->frag;
+	u8_t *data = zc->data;
+	size_t left = zc->len;
+	size_t len;
+
+	while (frag && left) {
+		len = MIN(left, frag->len - (data - frag->data));
+		sum = parse(data, len, sum);
+		left -= len;
+
+		frag = frag->frags;
+		data = frag ? frag->data : NULL;
+	}
+
+	return sum;
+}
+#endif
+
+static ssize_t recv_one(int sock, bool zero_copy, u32_t *sum)
+{
+	struct zsock_pollfd pfd = { .fd = sock, .events = ZSOCK_POLLIN };
+	ssize_t len;
+
+	if (zsock_poll(&pfd, 1, RX_TIMEOUT_MS) <= 0) {
+		return -1;
+	}
+
+	if (!zero_copy) {
+		len = zsock_recv(sock, rx_buf, sizeof(rx_buf), 0);
+		if (len > 0) {
+			*sum = parse(rx_buf, len, *sum);
+		}
+
+		return len;
+	}
+
+#ifdef CONFIG_NET_SOCKETS_RECV_ZC
+	struct zsock_zc_buf zc;
+
+	len = zsock_recv_zc(sock, &zc, 0, NULL, NULL);
+	if (len > 0) {
+		*sum = parse_zc(&zc, *sum);
+		zsock_recv_zc_release(sock, &zc);
+	}
+
+	return len;
+#else
+	return -1;
+#endif
+}
+
+static void run(const char *name, int tx, int rx, bool zero_copy)
+{
+	u32_t expected = 0U, bytes = 0U, cycles = 0U, sum = 0U;
+	u32_t t0;
+	ssize_t len;
+	int i, j;
+
+	for (i = 0; i < N_BURSTS; i++) {
+		for (j = 0; j < BURST; j++) {
+			if (zsock_send(tx, tx_buf, MSG_LEN, 0) != MSG_LEN) {
+				printk("%s: send failed (%d)\n", name, errno);
+				return;
+			}
+			expected += MSG_LEN;
+		}
+
+		t0 = k_cycle_get_32();
+		while (bytes < expected) {
+			len = recv_one(rx, zero_copy, &sum);
+			if (len <= 0) {
+				printk("%s: recv failed after %u bytes (%d)\n",
+				       name, bytes, errno);
+				return;
+			}
+			bytes += len;
+		}
+		cycles += k_cycle_get_32() - t0;
+	}
+
+	if (sum != parse(tx_buf, MSG_LEN, 0) * N_BURSTS * BURST) {
+		printk("%s: data corrupted\n", name);
+	}
+
+	printk("%s %s: %u bytes in %u cycles, %u KiB/s\n", name,
+	       zero_copy ? "zero-copy" : "copy", bytes, cycles,
+	       kib_per_sec(bytes, cycles));
+}
+
+static void run_both(const char *name, int tx, int rx)
+{
+	run(name, tx, rx, false);
+	if (IS_ENABLED(CONFIG_NET_SOCKETS_RECV_ZC)) {
+		run(name, tx, rx, true);
+	}
+}
+
+static void bench_udp(struct sockaddr_in *addr)
+{
+	int tx, rx;
+
+	addr->sin_port = htons(UDP_PORT);
+
+	rx = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	tx = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (rx < 0 || tx < 0 ||
+	    zsock_bind(rx, (struct sockaddr *)addr, sizeof(*addr)) < 0 ||
+	    zsock_connect(tx, (struct sockaddr *)addr, sizeof(*addr)) < 0) {
+		printk("udp: setup failed (%d)\n", errno);
+	} else {
+		run_both("udp", tx, rx);
+	}
+
+	zsock_close(tx);
+	zsock_close(rx);
+}
+
+static void bench_tcp(struct sockaddr_in *addr)
+{
+	int listener, tx, rx = -1;
+
+	addr->sin_port = htons(TCP_PORT);
+
+	listener = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	tx = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener < 0 || tx < 0 ||
+	    zsock_bind(listener, (struct sockaddr *)addr, sizeof(*addr)) < 0 ||
+	    zsock_listen(listener, 1) < 0 ||
+	    zsock_connect(tx, (struct sockaddr *)addr, sizeof(*addr)) < 0 ||
+	    (rx = zsock_accept(listener, NULL, NULL)) < 0) {
+		printk("tcp: setup failed (%d)\n", errno);
+	} else {
+		run_both("tcp", tx, rx);
+	}
+
+	zsock_close(rx);
+	zsock_close(tx);
+	zsock_close(listener);
+}
+
+void recv_bench(void)
+{
+	struct sockaddr_in addr = { .sin_family = AF_INET };
+	int i;
+
+	for (i = 0; i < MSG_LEN; i++) {
+		tx_buf[i] = i * 7;
+	}
+
+	zsock_inet_pton(AF_INET, BENCH_ADDR, &addr.sin_addr);
+
+	printk("receive throughput, %d x %d bytes per burst\n",
+	       BURST, MSG_LEN);
+	bench_udp(&addr);
+	bench_tcp(&addr);
+}
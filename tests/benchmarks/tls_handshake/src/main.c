@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <errno.h>
+
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+/* See README.rst */
+
+#define BENCH_ADDR "192.0.2.1"
+#define BENCH_PORT 4243
+#define BENCH_HOSTNAME "localhost"
+
+#define CONNECTIONS 8
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+#define SERVER_CERTIFICATE_TAG 1
+
+static const unsigned char server_certificate[] = {
+#include "echo-apps-cert.der.inc"
+};
+
+/* This is the private key in pkcs#8 format. */
+static const unsigned char private_key[] = {
+#include "echo-apps-key.der.inc"
+};
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(server_ready, 0, 1);
+
+static void server_main(void *p1, void *p2, void *p3)
+{
+	static const sec_tag_t sec_tags[] = { SERVER_CERTIFICATE_TAG };
+	struct sockaddr_in addr = { 0 };
+	int sock, client;
+	char byte;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	if (sock < 0) {
+		printk("Cannot create server socket (%d)\n", errno);
+		return;
+	}
+
+	if (setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+		       sizeof(sec_tags)) < 0) {
+		printk("Cannot set server credentials (%d)\n", errno);
+		return;
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(BENCH_PORT);
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(sock, 1) < 0) {
+		printk("Cannot listen (%d)\n", errno);
+		return;
+	}
+
+	k_sem_give(&server_ready);
+
+	while (true) {
+		client = accept(sock, NULL, NULL);
+		if (client < 0) {
+			printk("Accept failed (%d)\n", errno);
+			continue;
+		}
+
+		if (recv(client, &byte, sizeof(byte), 0) == sizeof(byte)) {
+			send(client, &byte, sizeof(byte), 0);
+		}
+
+		close(client);
+	}
+}
+
+/* Returns the cycles spent in connect(), 0 on failure */
+static u32_t connect_once(bool resume)
+{
+	int cache = resume ? TLS_SESSION_CACHE_ENABLED :
+			     TLS_SESSION_CACHE_DISABLED;
+	int verify = 0;
+	struct sockaddr_in addr = { 0 };
+	u32_t start, cycles = 0U;
+	char byte = 'x';
+	int sock;
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(BENCH_PORT);
+	inet_pton(AF_INET, BENCH_ADDR, &addr.sin_addr);
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	if (sock < 0) {
+		printk("Cannot create client socket (%d)\n", errno);
+		return 0;
+	}
+
+	/* The benchmark measures the handshake, not the verification */
+	setsockopt(sock, SOL_TLS, TLS_PEER_VERIFY, &verify, sizeof(verify));
+	setsockopt(sock, SOL_TLS, TLS_HOSTNAME, BENCH_HOSTNAME,
+		   sizeof(BENCH_HOSTNAME));
+
+	if (setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+		       sizeof(cache)) < 0 && resume) {
+		printk("Session resumption not supported (%d)\n", errno);
+		goto out;
+	}
+
+	start = k_cycle_get_32();
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("Connect failed (%d)\n", errno);
+		goto out;
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	/* Let the server finish the connection before the next one */
+	if (send(sock, &byte, sizeof(byte), 0) != sizeof(byte) ||
+	    recv(sock, &byte, sizeof(byte), 0) != sizeof(byte)) {
+		printk("Echo failed (%d)\n", errno);
+	}
+
+out:
+	close(sock);
+
+	return cycles;
+}
+
+static void handshake_bench(const char *name, bool resume)
+{
+	u64_t total = 0U;
+	u32_t cycles;
+	int i;
+
+	for (i = 0; i < CONNECTIONS; i++) {
+		cycles = connect_once(resume);
+		if (cycles == 0U) {
+			return;
+		}
+
+		total += cycles;
+	}
+
+	printk("%s handshake: %u us on average over %d connections\n", name,
+	       (u32_t)SYS_CLOCK_HW_CYCLES_TO_NS64(total / CONNECTIONS) / 1000U,
+	       CONNECTIONS);
+}
+
+void main(void)
+{
+	int ret;
+
+	ret = tls_credential_add(SERVER_CERTIFICATE_TAG,
+				 TLS_CREDENTIAL_SERVER_CERTIFICATE,
+				 server_certificate,
+				 sizeof(server_certificate));
+	if (ret == 0) {
+		ret = tls_credential_add(SERVER_CERTIFICATE_TAG,
+					 TLS_CREDENTIAL_PRIVATE_KEY,
+					 private_key, sizeof(private_key));
+	}
+
+	if (ret < 0) {
+		printk("Cannot add server credentials (%d)\n", ret);
+		return;
+	}
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_main,
+			NULL, NULL, NULL, SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	if (k_sem_take(&server_ready, K_SECONDS(1)) < 0) {
+		return;
+	}
+
+	handshake_bench("Full", false);
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	/* Establish the session to resume */
+	if (connect_once(true) > 0U) {
+		handshake_bench("Resumed", true);
+	}
+#endif
+
+	printk("fin\n");
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <ring_buffer.h>
+
+/**
+ * @addtogroup t_ringbuffer
+ * @{
+ * @defgroup t_ringbuffer_concurrent test_ringbuffer_concurrent
+ * @brief TestPurpose: stress ring buffers shared between contexts without
+ *	  locking, and report throughput and put-to-get latency
+ * - API coverage
+ *   -# ring_buf_put
+ *   -# ring_buf_get
+ *   -# ring_buf_mp_put
+ * @}
+ */
+
+#define STRESS_RECORDS	6000
+#define STRESS_TIMEOUT	K_SECONDS(60)
+#define PRODUCER_STACK	(512 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+/* Producer id in the top byte, sequence number in the others. */
+#define REC_ID_SHIFT	24
+#define REC_SEQ_MASK	(BIT(REC_ID_SHIFT) - 1)
+
+struct record {
+	u32_t tag;
+	u32_t stamp;
+};
+
+struct latency {
+	u32_t count;
+	u32_t min;
+	u32_t max;
+	u64_t sum;
+};
+
+static u8_t stress_data[1024];
+static struct ring_buf stress_buf;
+
+static void latency_add(struct latency *lat, u32_t stamp)
+{
+	u32_t delta = k_cycle_get_32() - stamp;
+
+	if (lat->count == 0U || delta < lat->min) {
+		lat->min = delta;
+	}
+	if (delta > lat->max) {
+		lat->max = delta;
+	}
+	lat->sum += delta;
+	lat->count++;
+}
+
+static void latency_print(const char *name, struct latency *lat,
+			  u32_t start, u32_t bytes)
+{
+	u32_t ms = k_uptime_get_32() - start;
+
+	TC_PRINT("%s: %u records, %u bytes/s, latency min %u avg %u "
+		 "max %u cycles\n", name, lat->count,
+		 ms ? (u32_t)(((u64_t)bytes * MSEC_PER_SEC) / ms) : 0,
+		 lat->min, (u32_t)(lat->sum / lat->count), lat->max);
+}
+
+/* Single producer in ISR context, single consumer thread, no locks. */
+static u32_t spsc_next;
+
+static void spsc_expiry(struct k_timer *timer)
+{
+	struct record rec;
+
+	while (spsc_next < STRESS_RECORDS &&
+	       ring_buf_space_get(&stress_buf) >= sizeof(rec)) {
+		rec.tag = spsc_next++;
+		rec.stamp = k_cycle_get_32();
+		ring_buf_put(&stress_buf, (u8_t *)&rec, sizeof(rec));
+	}
+}
+
+K_TIMER_DEFINE(spsc_timer, spsc_expiry, NULL);
+
+void test_ringbuffer_spsc_stress(void)
+{
+	struct latency lat = {};
+	struct record rec;
+	u32_t start = k_uptime_get_32();
+	u32_t expected = 0U;
+	u32_t len;
+
+	ring_buf_init(&stress_buf, sizeof(stress_data), stress_data);
+	spsc_next = 0U;
+	k_timer_start(&spsc_timer, K_MSEC(1), K_MSEC(1));
+
+	while (expected < STRESS_RECORDS) {
+		zassert_true(k_uptime_get_32() - start < STRESS_TIMEOUT,
+			     "consumer stalled at record %u", expected);
+
+		len = ring_buf_get(&stress_buf, (u8_t *)&rec, sizeof(rec));
+		if (len == 0U) {
+			k_sleep(K_MSEC(1));
+			continue;
+		}
+
+		/**TESTPOINT: records arrive whole and in order*/
+		zassert_equal(len, sizeof(rec), "torn record");
+		zassert_equal(rec.tag, expected, "record lost or reordered");
+		latency_add(&lat, rec.stamp);
+		expected++;
+	}
+
+	k_timer_stop(&spsc_timer);
+	zassert_true(ring_buf_is_empty(&stress_buf), NULL);
+	latency_print("spsc", &lat, start, STRESS_RECORDS * sizeof(rec));
+}
+
+#ifdef CONFIG_RING_BUFFER_MP
+/*
+ * Two preemptible producer threads of different priorities and a timer
+ * ISR write to the same ring buffer; the consumer checks that every
+ * producer's records arrive intact and in order.
+ */
+#define MP_PRODUCERS	3
+#define MP_ISR_ID	(MP_PRODUCERS - 1)
+
+static K_THREAD_STACK_ARRAY_DEFINE(mp_stacks, MP_PRODUCERS - 1,
+				   PRODUCER_STACK);
+static struct k_thread mp_threads[MP_PRODUCERS - 1];
+static u32_t mp_isr_next;
+
+static bool mp_put_record(u32_t id, u32_t seq)
+{
+	struct record rec = {
+		.tag = (id << REC_ID_SHIFT) | seq,
+		.stamp = k_cycle_get_32(),
+	};
+
+	return ring_buf_mp_put(&stress_buf, (u8_t *)&rec, sizeof(rec)) != 0U;
+}
+
+static void mp_producer(void *p1, void *p2, void *p3)
+{
+	u32_t id = POINTER_TO_UINT(p1);
+	u32_t seq = 0U;
+
+	while (seq < STRESS_RECORDS / MP_PRODUCERS) {
+		if (mp_put_record(id, seq)) {
+			seq++;
+		} else {
+			k_sleep(K_MSEC(1));
+		}
+	}
+}
+
+static void mp_expiry(struct k_timer *timer)
+{
+	if (mp_isr_next < STRESS_RECORDS / MP_PRODUCERS &&
+	    mp_put_record(MP_ISR_ID, mp_isr_next)) {
+		mp_isr_next++;
+	}
+}
+
+K_TIMER_DEFINE(mp_timer, mp_expiry, NULL);
+
+void test_ringbuffer_mp_stress(void)
+{
+	u32_t expected[MP_PRODUCERS] = {};
+	struct latency lat = {};
+	struct record rec;
+	u32_t start = k_uptime_get_32();
+	u32_t total = 0U;
+	u32_t id, len;
+
+	ring_buf_init(&stress_buf, sizeof(stress_data), stress_data);
+	mp_isr_next = 0U;
+
+	for (id = 0U; id < MP_PRODUCERS - 1; id++) {
+		k_thread_create(&mp_threads[id], mp_stacks[id],
+				K_THREAD_STACK_SIZEOF(mp_stacks[id]),
+				mp_producer, UINT_TO_POINTER(id), NULL, NULL,
+				K_PRIO_PREEMPT(id + 1), 0, K_NO_WAIT);
+	}
+	k_timer_start(&mp_timer, K_MSEC(1), K_MSEC(1));
+
+	while (total < (STRESS_RECORDS / MP_PRODUCERS) * MP_PRODUCERS) {
+		zassert_true(k_uptime_get_32() - start < STRESS_TIMEOUT,
+			     "consumer stalled at record %u", total);
+
+		len = ring_buf_get(&stress_buf, (u8_t *)&rec, sizeof(rec));
+		if (len == 0U) {
+			k_sleep(K_MSEC(1));
+			continue;
+		}
+
+		/**TESTPOINT: records from each producer arrive whole and in
+		 * order
+		 */
+		zassert_equal(len, sizeof(rec), "torn record");
+		id = rec.tag >> REC_ID_SHIFT;
+		zassert_true(id < MP_PRODUCERS, "corrupted record");
+		zassert_equal(rec.tag & REC_SEQ_MASK, expected[id],
+			      "record of producer %u lost or reordered", id);
+		latency_add(&lat, rec.stamp);
+		expected[id]++;
+		total++;
+	}
+
+	k_timer_stop(&mp_timer);
+	for (id = 0U; id < MP_PRODUCERS - 1; id++) {
+		k_thread_abort(&mp_threads[id]);
+	}
+
+	zassert_true(ring_buf_is_empty(&stress_buf), NULL);
+	latency_print("mpsc", &lat, start, total * sizeof(rec));
+}
+#else
+void test_ringbuffer_mp_stress(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_RING_BUFFER_MP */
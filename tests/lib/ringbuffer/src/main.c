@@ -395,6 +395,9 @@ void test_byte_put_free(void)
 	}
 }
 
+extern void test_ringbuffer_spsc_stress(void);
+extern void test_ringbuffer_mp_stress(void);
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -410,7 +413,9 @@ void test_main(void)
 			 ztest_unit_test(test_ring_buffer_main),
 			 ztest_unit_test(test_ringbuffer_raw),
 			 ztest_unit_test(test_ringbuffer_alloc_put),
-			 ztest_unit_test(test_byte_put_free)
+			 ztest_unit_test(test_byte_put_free),
+			 ztest_unit_test(test_ringbuffer_spsc_stress),
+			 ztest_unit_test(test_ringbuffer_mp_stress)
 			 );
 	ztest_run_test_suite(test_ringbuffer_api);
 }
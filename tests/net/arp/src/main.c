@@ -44,6 +44,8 @@ static struct net_eth_addr hwaddr = { { 0x42, 0x11, 0x69, 0xde, 0xfa, 0xec } };
 
 static int send_status = -EINVAL;
 
+static int ipv4_sent;
+
 struct net_arp_context {
 	u8_t mac_addr[sizeof(struct net_eth_addr)];
 	struct net_linkaddr ll_addr;
@@ -143,6 +145,10 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 		}
 	}
 
+	if (ntohs(hdr->type) == NET_ETH_PTYPE_IP) {
+		ipv4_sent++;
+	}
+
 	send_status = 0;
 
 	return 0;
@@ -633,9 +639,102 @@ void test_arp(void)
 	}
 }
 
+static struct net_pkt *prepare_ipv4_pkt(struct net_if *iface,
+					struct in_addr *src,
+					struct in_addr *dst)
+{
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *pkt;
+	int len;
+
+	pkt = net_pkt_alloc_with_buffer(iface, 0, AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	len = strlen(app_data);
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	net_ipaddr_copy(&ipv4->src, src);
+	net_ipaddr_copy(&ipv4->dst, dst);
+
+	memcpy(net_buf_add(pkt->buffer, len), app_data, len);
+
+	return pkt;
+}
+
+void test_arp_pending_queue(void)
+{
+	struct net_pkt *pkts[CONFIG_NET_ARP_PENDING_QUEUE_DEPTH + 1];
+	struct in_addr dst = { { { 192, 168, 0, 3 } } };
+	struct in_addr src = { { { 192, 168, 0, 1 } } };
+	struct net_eth_hdr *eth_hdr = NULL;
+	struct net_arp_hdr *arp_hdr;
+	struct net_pkt *pkt, *pkt2;
+	struct net_if *iface;
+	int i;
+
+	iface = net_if_get_default();
+
+	net_arp_clear_cache(iface);
+
+	/* Every packet to the unresolved address triggers a request, but
+	 * only the first ones fit in the pending queue of the entry.
+	 */
+	for (i = 0; i < ARRAY_SIZE(pkts); i++) {
+		pkts[i] = prepare_ipv4_pkt(iface, &src, &dst);
+
+		pkt2 = net_arp_prepare(pkts[i], &dst, NULL);
+		zassert_not_null(pkt2, "ARP request not created");
+		zassert_not_equal((void *)pkt2, (void *)pkts[i],
+				  "Address should not be resolved");
+
+		net_pkt_unref(pkt2);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(pkts); i++) {
+		zassert_equal(atomic_get(&pkts[i]->atomic_ref),
+			      i < CONFIG_NET_ARP_PENDING_QUEUE_DEPTH ? 2 : 1,
+			      "Invalid pending state of pkt %d", i);
+	}
+
+	/* Resolving the address sends all the queued packets */
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem reply");
+
+	arp_hdr = NET_ARP_HDR(pkt);
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	net_ipaddr_copy(&arp_hdr->dst_ipaddr, &dst);
+	net_ipaddr_copy(&arp_hdr->src_ipaddr, &src);
+
+	pkt2 = prepare_arp_reply(iface, pkt, &hwaddr, &eth_hdr);
+	zassert_not_null(pkt2, "ARP reply generation failed.");
+
+	ipv4_sent = 0;
+
+	(void)net_arp_input(pkt2, eth_hdr);
+
+	/* Let the TX path send the queued packets */
+	k_sleep(K_MSEC(50));
+
+	zassert_equal(ipv4_sent, CONFIG_NET_ARP_PENDING_QUEUE_DEPTH,
+		      "Queued packets were not sent");
+
+	for (i = 0; i < ARRAY_SIZE(pkts); i++) {
+		zassert_equal(atomic_get(&pkts[i]->atomic_ref), 1,
+			      "ARP cache should no longer own pkt %d", i);
+		net_pkt_unref(pkts[i]);
+	}
+
+	net_pkt_unref(pkt);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_arp_fn,
-		ztest_unit_test(test_arp));
+		ztest_unit_test(test_arp),
+		ztest_unit_test(test_arp_pending_queue));
 	ztest_run_test_suite(test_arp_fn);
 }
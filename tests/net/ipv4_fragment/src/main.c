@@ -0,0 +1,403 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#if defined(CONFIG_NET_IPV4_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4242
+#define PEER_PORT 4343
+
+/* Payload that needs three fragments with the default 576 bytes MTU */
+#define DATA_LEN 1400
+#define PKT_LEN (NET_IPV4H_LEN + NET_UDPH_LEN + DATA_LEN)
+
+#define MAX_FRAGS 4
+
+#define WAIT_TIME K_SECONDS(1)
+#define ALLOC_TIMEOUT 500
+
+static struct net_if *iface;
+
+static struct net_pkt *frags[MAX_FRAGS];
+static int frag_count;
+static u32_t frag_bytes;
+
+static bool test_failed;
+static bool test_started;
+static struct k_sem wait_data;
+static struct k_sem wait_recv;
+
+static size_t recv_len;
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int verify_fragment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	u16_t frag = net_ipv4_get_frag_field(hdr);
+	u16_t len = ntohs(hdr->len);
+
+	if (len != net_pkt_get_len(pkt) || len > NET_IPV4_MTU) {
+		DBG("Invalid fragment length %u\n", len);
+		return -EINVAL;
+	}
+
+	if (net_calc_chksum_ipv4(pkt) != 0) {
+		DBG("Invalid IPv4 header checksum\n");
+		return -EINVAL;
+	}
+
+	if ((frag & NET_IPV4_FRAG_OFFSET_MASK) * 8U != frag_bytes) {
+		DBG("Fragment offset %u, expecting %u\n",
+		    (frag & NET_IPV4_FRAG_OFFSET_MASK) * 8U, frag_bytes);
+		return -EINVAL;
+	}
+
+	frag_bytes += len - NET_IPV4H_LEN;
+
+	/* Only the last fragment has the More Fragments flag unset */
+	if (!!(frag & NET_IPV4_MF) !=
+	    (frag_bytes < NET_UDPH_LEN + DATA_LEN)) {
+		DBG("Invalid MF flag\n");
+		return -EINVAL;
+	}
+
+	if (frag_count >= MAX_FRAGS) {
+		DBG("Too many fragments\n");
+		return -EINVAL;
+	}
+
+	frags[frag_count++] = net_pkt_clone(pkt, K_NO_WAIT);
+
+	return 0;
+}
+
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->buffer) {
+		DBG("No data to send!\n");
+		return -ENODATA;
+	}
+
+	if (test_started) {
+		if (verify_fragment(pkt) < 0) {
+			DBG("Fragments cannot be verified\n");
+			test_failed = true;
+		}
+
+		k_sem_give(&wait_data);
+	}
+
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+NET_DEVICE_INIT(net_ipv4_frag_test, "net_ipv4_frag_test",
+		net_iface_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV4_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	DBG("Data %p received\n", pkt);
+
+	recv_len = net_pkt_get_len(pkt);
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_recv);
+
+	return NET_OK;
+}
+
+static void frag_count_cb(struct net_ipv4_reassembly *reass,
+			  void *user_data)
+{
+	(*(int *)user_data)++;
+}
+
+static int pending_reassemblies(void)
+{
+	int count = 0;
+
+	net_ipv4_frag_foreach(frag_count_cb, &count);
+
+	return count;
+}
+
+/* Turn a sent fragment into one coming back from the peer. Swapping the
+ * addresses and the ports does not change the checksums.
+ */
+static struct net_pkt *reply_fragment(int idx)
+{
+	struct net_pkt *pkt = net_pkt_clone(frags[idx], K_NO_WAIT);
+	struct net_ipv4_hdr *hdr;
+	struct in_addr addr;
+
+	zassert_not_null(pkt, "Cannot clone fragment");
+
+	hdr = NET_IPV4_HDR(pkt);
+
+	net_ipaddr_copy(&addr, &hdr->src);
+	net_ipaddr_copy(&hdr->src, &hdr->dst);
+	net_ipaddr_copy(&hdr->dst, &addr);
+
+	if (idx == 0) {
+		struct net_udp_hdr *udp_hdr =
+			(struct net_udp_hdr *)(pkt->frags->data +
+					       NET_IPV4H_LEN);
+		u16_t port = udp_hdr->src_port;
+
+		udp_hdr->src_port = udp_hdr->dst_port;
+		udp_hdr->dst_port = port;
+	}
+
+	return pkt;
+}
+
+static void test_setup(void)
+{
+	struct net_conn_handle *handle;
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+	k_sem_init(&wait_recv, 0, UINT_MAX);
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, &my_addr);
+	local_addr.sa_family = AF_INET;
+
+	net_ipaddr_copy(&net_sin(&remote_addr)->sin_addr, &peer_addr);
+	remote_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, &remote_addr, &local_addr,
+			       PEER_PORT, MY_PORT, udp_data_received,
+			       NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+
+	test_started = true;
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	static const char data[] = "123456789.";
+	struct net_pkt *pkt;
+	int i, ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, NET_UDPH_LEN + DATA_LEN,
+					AF_INET, IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create_new(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(MY_PORT), htons(PEER_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	for (i = 0; i < DATA_LEN; i += sizeof(data) - 1) {
+		ret = net_pkt_write_new(pkt, data, sizeof(data) - 1);
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	zassert_equal(net_pkt_get_len(pkt), PKT_LEN, "Packet size invalid");
+
+	frag_count = 0;
+	frag_bytes = 0U;
+	test_failed = false;
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send");
+
+	while (frag_bytes < NET_UDPH_LEN + DATA_LEN) {
+		zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			      "Timeout while waiting interface data");
+		zassert_false(test_failed, "Fragment verify failed");
+	}
+
+	zassert_equal(frag_count, 3, "Invalid number of fragments");
+}
+
+static void test_send_ipv4_dont_fragment(void)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, NET_UDPH_LEN + DATA_LEN,
+					AF_INET, IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_ipv4_create_new(pkt, &my_addr, &peer_addr);
+	net_udp_create(pkt, htons(MY_PORT), htons(PEER_PORT));
+	net_pkt_memset(pkt, 0, DATA_LEN);
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	NET_IPV4_HDR(pkt)->offset[0] = NET_IPV4_DF >> 8;
+
+	ret = net_send_data(pkt);
+	zassert_true(ret < 0, "Oversized packet with DF set was sent");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	int i;
+
+	zassert_equal(frag_count, 3, "No fragments to receive");
+
+	recv_len = 0;
+
+	/* Out of order, last fragment first */
+	for (i = frag_count - 1; i >= 0; i--) {
+		zassert_equal(net_recv_data(iface, reply_fragment(i)), 0,
+			      "Cannot receive fragment");
+	}
+
+	zassert_equal(k_sem_take(&wait_recv, WAIT_TIME), 0,
+		      "Reassembled packet not received");
+
+	zassert_equal(recv_len, PKT_LEN, "Reassembled length invalid");
+	zassert_equal(pending_reassemblies(), 0, "Reassembly left pending");
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	/* A duplicate must not complete the packet */
+	zassert_equal(net_recv_data(iface, reply_fragment(1)), 0,
+		      "Cannot receive fragment");
+	zassert_equal(net_recv_data(iface, reply_fragment(1)), 0,
+		      "Cannot receive fragment");
+	zassert_equal(net_recv_data(iface, reply_fragment(0)), 0,
+		      "Cannot receive fragment");
+
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(pending_reassemblies(), 1, "Reassembly not pending");
+
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT) + K_MSEC(100));
+
+	zassert_equal(pending_reassemblies(), 0, "Reassembly not timed out");
+	zassert_not_equal(k_sem_take(&wait_recv, K_NO_WAIT), 0,
+			  "Incomplete packet received");
+}
+
+static void test_recv_ipv4_fragment_overlap(void)
+{
+	struct net_pkt *pkt = reply_fragment(1);
+	u16_t frag;
+
+	/* Move the 2nd fragment 8 bytes back so it overlaps the 1st one */
+	frag = net_ipv4_get_frag_field(NET_IPV4_HDR(pkt)) - 1;
+	NET_IPV4_HDR(pkt)->offset[0] = frag >> 8;
+	NET_IPV4_HDR(pkt)->offset[1] = frag;
+	NET_IPV4_HDR(pkt)->chksum = 0U;
+	NET_IPV4_HDR(pkt)->chksum = net_calc_chksum_ipv4(pkt);
+
+	zassert_equal(net_recv_data(iface, reply_fragment(0)), 0,
+		      "Cannot receive fragment");
+	zassert_equal(net_recv_data(iface, pkt), 0,
+		      "Cannot receive fragment");
+
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(pending_reassemblies(), 0,
+		      "Overlapping fragments accepted");
+}
+
+static void test_cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < frag_count; i++) {
+		net_pkt_unref(frags[i]);
+		frags[i] = NULL;
+	}
+
+	frag_count = 0;
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_send_ipv4_dont_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout),
+			 ztest_unit_test(test_recv_ipv4_fragment_overlap),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
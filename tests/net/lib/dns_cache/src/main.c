@@ -0,0 +1,388 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+
+#include <ztest.h>
+
+#include <net/net_ip.h>
+#include <net/socket.h>
+#include <net/dns_resolve.h>
+
+#if defined(CONFIG_DNS_RESOLVER_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define SERVER_PORT 15353
+#define SERVER_STACK_SIZE 1024
+#define SERVER_PRIORITY K_PRIO_COOP(8)
+
+#define QUERY_TIMEOUT K_SECONDS(2)
+#define WAIT_TIME K_SECONDS(3)
+
+/* Long enough for a second query to be started while the first one waits */
+#define SLOW_REPLY_DELAY K_MSEC(300)
+
+#define DNS_HEADER_LEN 12
+#define DNS_RCODE_NAMEERROR 3
+
+#define POSITIVE_TTL 60
+#define SHORT_TTL 1
+#define SOA_TTL 30
+#define SOA_MINIMUM 10
+
+static struct in_addr answer_addr = { { { 192, 0, 2, 10 } } };
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static atomic_t server_queries;
+
+struct result {
+	struct k_sem done;
+	struct in_addr addr;
+	int status;
+	int addr_count;
+};
+
+static u8_t *put_be16(u8_t *ptr, u16_t value)
+{
+	*ptr++ = value >> 8;
+	*ptr++ = value;
+
+	return ptr;
+}
+
+static u8_t *put_be32(u8_t *ptr, u32_t value)
+{
+	ptr = put_be16(ptr, value >> 16);
+
+	return put_be16(ptr, value);
+}
+
+/* RR header for the queried name, which follows the header */
+static u8_t *put_rr(u8_t *ptr, u16_t type, u32_t ttl, u16_t rdlength)
+{
+	ptr = put_be16(ptr, 0xc000 | DNS_HEADER_LEN);
+	ptr = put_be16(ptr, type);
+	ptr = put_be16(ptr, 1);
+	ptr = put_be32(ptr, ttl);
+
+	return put_be16(ptr, rdlength);
+}
+
+static u8_t *put_soa(u8_t *ptr)
+{
+	ptr = put_rr(ptr, 6, SOA_TTL, 2 + 5 * sizeof(u32_t));
+
+	/* Root MNAME and RNAME */
+	*ptr++ = 0U;
+	*ptr++ = 0U;
+
+	ptr = put_be32(ptr, 1);
+	ptr = put_be32(ptr, 3600);
+	ptr = put_be32(ptr, 600);
+	ptr = put_be32(ptr, 86400);
+
+	return put_be32(ptr, SOA_MINIMUM);
+}
+
+static bool label_is(const u8_t *query, const char *label)
+{
+	return query[DNS_HEADER_LEN] == strlen(label) &&
+		!memcmp(&query[DNS_HEADER_LEN + 1], label, strlen(label));
+}
+
+/* Answers the resolver like a server would, the first label of the name
+ * selects the answer.
+ */
+static int build_reply(u8_t *buf, int len)
+{
+	u16_t ancount = 0U, nscount = 0U;
+	u8_t rcode = 0U;
+	u8_t *ptr = buf + len;
+
+	if (label_is(buf, "host") || label_is(buf, "slow")) {
+		ancount = 1U;
+		ptr = put_rr(ptr, 1, POSITIVE_TTL, sizeof(struct in_addr));
+	} else if (label_is(buf, "short")) {
+		ancount = 1U;
+		ptr = put_rr(ptr, 1, SHORT_TTL, sizeof(struct in_addr));
+	} else if (label_is(buf, "missing")) {
+		rcode = DNS_RCODE_NAMEERROR;
+		nscount = 1U;
+		ptr = put_soa(ptr);
+	} else if (label_is(buf, "empty")) {
+		nscount = 1U;
+		ptr = put_soa(ptr);
+	} else {
+		/* Name error that cannot be cached */
+		rcode = DNS_RCODE_NAMEERROR;
+	}
+
+	if (ancount) {
+		memcpy(ptr, &answer_addr, sizeof(answer_addr));
+		ptr += sizeof(answer_addr);
+	}
+
+	/* QR, keep the opcode and RD, then RA and RCODE */
+	buf[2] = 0x80 | (buf[2] & 0x79);
+	buf[3] = 0x80 | rcode;
+
+	put_be16(&buf[6], ancount);
+	put_be16(&buf[8], nscount);
+	put_be16(&buf[10], 0);
+
+	return ptr - buf;
+}
+
+static void server_main(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr = { 0 };
+	struct sockaddr peer;
+	socklen_t peer_len;
+	static u8_t buf[512];
+	int sock, len;
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		printk("Cannot create server socket (%d)\n", errno);
+		return;
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(SERVER_PORT);
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("Cannot bind server socket (%d)\n", errno);
+		return;
+	}
+
+	while (true) {
+		peer_len = sizeof(peer);
+
+		/* Keep room for the answer and authority records */
+		len = recvfrom(sock, buf, sizeof(buf) / 2, 0, &peer,
+			       &peer_len);
+		if (len <= DNS_HEADER_LEN) {
+			continue;
+		}
+
+		atomic_inc(&server_queries);
+
+		DBG("Query %d for label of %d bytes\n",
+		    (int)atomic_get(&server_queries), buf[DNS_HEADER_LEN]);
+
+		if (label_is(buf, "slow")) {
+			k_sleep(SLOW_REPLY_DELAY);
+		}
+
+		len = build_reply(buf, len);
+
+		sendto(sock, buf, len, 0, &peer, peer_len);
+	}
+}
+
+static void result_cb(enum dns_resolve_status status,
+		      struct dns_addrinfo *info,
+		      void *user_data)
+{
+	struct result *res = user_data;
+
+	if (status == DNS_EAI_INPROGRESS) {
+		if (info && info->ai_family == AF_INET) {
+			net_ipaddr_copy(&res->addr,
+					&net_sin(&info->ai_addr)->sin_addr);
+			res->addr_count++;
+		}
+
+		return;
+	}
+
+	res->status = status;
+	k_sem_give(&res->done);
+}
+
+static void resolve_start(const char *name, struct result *res)
+{
+	int ret;
+
+	(void)memset(res, 0, sizeof(*res));
+	k_sem_init(&res->done, 0, 1);
+
+	ret = dns_get_addr_info(name, DNS_QUERY_TYPE_A, NULL, result_cb, res,
+				QUERY_TIMEOUT);
+	zassert_equal(ret, 0, "Cannot resolve %s (%d)", name, ret);
+}
+
+static void resolve_wait(const char *name, struct result *res, int status)
+{
+	zassert_equal(k_sem_take(&res->done, WAIT_TIME), 0,
+		      "No answer for %s", name);
+	zassert_equal(res->status, status, "Wrong status %d for %s",
+		      res->status, name);
+
+	if (status == DNS_EAI_ALLDONE) {
+		zassert_equal(res->addr_count, 1, "Wrong address count");
+		zassert_true(net_ipv4_addr_cmp(&res->addr, &answer_addr),
+			     "Wrong address for %s", name);
+	} else {
+		zassert_equal(res->addr_count, 0, "Unexpected address");
+	}
+}
+
+/* Resolves name and checks how many queries the server got for it */
+static void resolve(const char *name, int status, int queries)
+{
+	int start = atomic_get(&server_queries);
+	struct result res;
+
+	resolve_start(name, &res);
+	resolve_wait(name, &res, status);
+
+	zassert_equal(atomic_get(&server_queries) - start, queries,
+		      "Server got %d queries for %s, expecting %d",
+		      (int)atomic_get(&server_queries) - start, name, queries);
+}
+
+static void test_setup(void)
+{
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_main,
+			NULL, NULL, NULL, SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	/* Let the server bind its socket */
+	k_sleep(K_MSEC(100));
+
+	dns_resolve_cache_flush();
+}
+
+static void test_positive_answer(void)
+{
+	struct dns_resolve_cache_stats before, after;
+
+	dns_resolve_cache_get_stats(&before);
+
+	resolve("host.example.com", DNS_EAI_ALLDONE, 1);
+	resolve("host.example.com", DNS_EAI_ALLDONE, 0);
+
+	/* Names are not case sensitive */
+	resolve("HOST.Example.com", DNS_EAI_ALLDONE, 0);
+
+	dns_resolve_cache_get_stats(&after);
+
+	zassert_equal(after.hits - before.hits, 2, "Wrong hit count");
+	zassert_equal(after.misses - before.misses, 1, "Wrong miss count");
+}
+
+static void test_ttl_expiry(void)
+{
+	resolve("short.example.com", DNS_EAI_ALLDONE, 1);
+	resolve("short.example.com", DNS_EAI_ALLDONE, 0);
+
+	k_sleep(K_SECONDS(SHORT_TTL) + K_MSEC(100));
+
+	resolve("short.example.com", DNS_EAI_ALLDONE, 1);
+
+	/* The other answer has a longer TTL */
+	resolve("host.example.com", DNS_EAI_ALLDONE, 0);
+}
+
+static void test_negative_answer(void)
+{
+	struct dns_resolve_cache_stats before, after;
+
+	dns_resolve_cache_get_stats(&before);
+
+	/* Name error */
+	resolve("missing.example.com", DNS_EAI_NODATA, 1);
+	resolve("missing.example.com", DNS_EAI_NODATA, 0);
+
+	/* No data */
+	resolve("empty.example.com", DNS_EAI_NODATA, 1);
+	resolve("empty.example.com", DNS_EAI_NODATA, 0);
+
+	dns_resolve_cache_get_stats(&after);
+
+	zassert_equal(after.negative_hits - before.negative_hits, 2,
+		      "Wrong negative hit count");
+}
+
+static void test_negative_answer_without_soa(void)
+{
+	resolve("unknown.example.com", DNS_EAI_NODATA, 1);
+	resolve("unknown.example.com", DNS_EAI_NODATA, 1);
+}
+
+static void test_coalescing(void)
+{
+	struct dns_resolve_cache_stats before, after;
+	struct result res1, res2;
+	int start = atomic_get(&server_queries);
+
+	dns_resolve_cache_get_stats(&before);
+
+	resolve_start("slow.example.com", &res1);
+	resolve_start("slow.example.com", &res2);
+
+	resolve_wait("slow.example.com", &res1, DNS_EAI_ALLDONE);
+	resolve_wait("slow.example.com", &res2, DNS_EAI_ALLDONE);
+
+	zassert_equal(atomic_get(&server_queries) - start, 1,
+		      "Identical queries were not coalesced");
+
+	dns_resolve_cache_get_stats(&after);
+
+	zassert_equal(after.coalesced - before.coalesced, 1,
+		      "Wrong coalesced count");
+}
+
+static void count_cb(const char *name, enum dns_query_type type,
+		     enum dns_resolve_status status, int addr_count,
+		     u32_t ttl, void *user_data)
+{
+	DBG("%s type %d status %d addresses %d ttl %u\n", name, type, status,
+	    addr_count, ttl);
+}
+
+static void test_flush(void)
+{
+	zassert_true(dns_resolve_cache_foreach(count_cb, NULL) > 0,
+		     "Cache is empty");
+
+	dns_resolve_cache_flush();
+
+	zassert_equal(dns_resolve_cache_foreach(count_cb, NULL), 0,
+		      "Cache not flushed");
+
+	resolve("host.example.com", DNS_EAI_ALLDONE, 1);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_positive_answer),
+			 ztest_unit_test(test_ttl_expiry),
+			 ztest_unit_test(test_negative_answer),
+			 ztest_unit_test(test_negative_answer_without_soa),
+			 ztest_unit_test(test_coalescing),
+			 ztest_unit_test(test_flush)
+			 );
+
+	ztest_run_test_suite(dns_cache);
+}
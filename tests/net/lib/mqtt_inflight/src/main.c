@@ -0,0 +1,477 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_MQTT_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+
+#include <ztest.h>
+
+#include <net/net_ip.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+#if defined(CONFIG_MQTT_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define BROKER_ADDR "192.0.2.1"
+#define BROKER_PORT 11883
+#define BROKER_STACK_SIZE 1536
+#define BROKER_PRIORITY K_PRIO_COOP(8)
+
+#define WAIT_TIME K_SECONDS(2)
+#define POLL_TIME 100
+
+#define MQTT_PKT_CONNECT 0x10
+#define MQTT_PKT_PUBLISH 0x30
+#define MQTT_PKT_PUBREL 0x60
+#define MQTT_PKT_DISCONNECT 0xe0
+#define MQTT_DUP_FLAG 0x08
+
+static const char topic[] = "sensors/telemetry";
+static const char payload[] = "temperature=21.5;humidity=40";
+
+static u8_t rx_buffer[128];
+static u8_t tx_buffer[128];
+static struct mqtt_client client_ctx;
+static struct sockaddr_in broker;
+static bool connected;
+static int acked;
+static u16_t last_id;
+static bool publish_on_connack;
+
+static K_THREAD_STACK_DEFINE(broker_stack, BROKER_STACK_SIZE);
+static struct k_thread broker_thread;
+
+/* Counters of the stand-in broker */
+static atomic_t broker_ack;
+static atomic_t broker_publishes;
+static atomic_t broker_dups;
+static atomic_t broker_releases;
+static atomic_t broker_bad_payloads;
+
+static int recv_all(int sock, u8_t *buf, int len)
+{
+	int ret;
+
+	while (len > 0) {
+		ret = recv(sock, buf, len, 0);
+		if (ret <= 0) {
+			return -1;
+		}
+
+		buf += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static void broker_reply(int sock, u8_t type, const u8_t *message_id)
+{
+	u8_t reply[4] = { type, 2, message_id[0], message_id[1] };
+
+	send(sock, reply, sizeof(reply), 0);
+}
+
+static void broker_publish(int sock, u8_t type, u8_t *buf, u32_t len)
+{
+	u16_t topic_len = (buf[0] << 8) | buf[1];
+	u8_t qos = (type >> 1) & 0x03;
+	u8_t *message_id = &buf[2 + topic_len];
+	u8_t *data = message_id;
+
+	/* Only QoS 1 and QoS 2 messages have an id */
+	if (qos > 0) {
+		data += sizeof(u16_t);
+	}
+
+	atomic_inc(&broker_publishes);
+
+	if (type & MQTT_DUP_FLAG) {
+		atomic_inc(&broker_dups);
+	}
+
+	/* Header and payload must make up a single, complete packet */
+	if (len - (data - buf) != strlen(payload) ||
+	    memcmp(data, payload, strlen(payload))) {
+		atomic_inc(&broker_bad_payloads);
+	}
+
+	DBG("PUBLISH qos %u flags 0x%02x\n", qos, type & 0x0f);
+
+	if (qos == 0 || !atomic_get(&broker_ack)) {
+		return;
+	}
+
+	/* PUBACK for QoS 1, PUBREC for QoS 2 */
+	if (qos == 1) {
+		broker_reply(sock, 0x40, message_id);
+	} else {
+		broker_reply(sock, 0x50, message_id);
+	}
+}
+
+static int broker_packet(int sock)
+{
+	static const u8_t connack[] = { 0x20, 2, 0, 0 };
+	static u8_t buf[256];
+	u32_t len = 0U;
+	int shift = 0;
+	u8_t type, byte;
+
+	if (recv_all(sock, &type, 1) < 0) {
+		return -1;
+	}
+
+	do {
+		if (recv_all(sock, &byte, 1) < 0) {
+			return -1;
+		}
+
+		len |= (byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	if (len > sizeof(buf) || recv_all(sock, buf, len) < 0) {
+		return -1;
+	}
+
+	switch (type & 0xf0) {
+	case MQTT_PKT_CONNECT:
+		send(sock, connack, sizeof(connack), 0);
+		break;
+
+	case MQTT_PKT_PUBLISH:
+		broker_publish(sock, type, buf, len);
+		break;
+
+	case MQTT_PKT_PUBREL:
+		atomic_inc(&broker_releases);
+
+		if (atomic_get(&broker_ack)) {
+			broker_reply(sock, 0x70, buf);
+		}
+		break;
+
+	case MQTT_PKT_DISCONNECT:
+		return -1;
+	}
+
+	return 0;
+}
+
+static void broker_main(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr = { 0 };
+	int sock, conn;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		printk("Cannot create broker socket (%d)\n", errno);
+		return;
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(BROKER_PORT);
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(sock, 1) < 0) {
+		printk("Cannot bind broker socket (%d)\n", errno);
+		return;
+	}
+
+	while (true) {
+		conn = accept(sock, NULL, NULL);
+		if (conn < 0) {
+			continue;
+		}
+
+		while (broker_packet(conn) == 0) {
+		}
+
+		close(conn);
+	}
+}
+
+static int publish(enum mqtt_qos qos, u16_t message_id);
+
+static void evt_handler(struct mqtt_client *const client,
+			const struct mqtt_evt *evt)
+{
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+
+		if (connected && publish_on_connack) {
+			zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+				      "Publish from CONNACK failed");
+		}
+		break;
+
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+
+	case MQTT_EVT_PUBREC: {
+		const struct mqtt_pubrel_param param = {
+			.message_id = evt->param.pubrec.message_id
+		};
+
+		mqtt_publish_qos2_release(client, &param);
+		break;
+	}
+
+	case MQTT_EVT_PUBACK:
+	case MQTT_EVT_PUBCOMP:
+		acked++;
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* Processes what the broker sent until cond is met */
+#define INPUT_UNTIL(cond)						\
+	do {								\
+		s64_t end = k_uptime_get() + WAIT_TIME;		\
+		struct pollfd fds = {					\
+			.fd = client_ctx.transport.tcp.sock,		\
+			.events = ZSOCK_POLLIN,				\
+		};							\
+									\
+		while (!(cond) && k_uptime_get() < end) {		\
+			if (poll(&fds, 1, POLL_TIME) > 0) {		\
+				mqtt_input(&client_ctx);		\
+			}						\
+		}							\
+	} while (0)
+
+static void wait_publishes(int count)
+{
+	s64_t end = k_uptime_get() + WAIT_TIME;
+
+	while (atomic_get(&broker_publishes) < count &&
+	       k_uptime_get() < end) {
+		k_sleep(K_MSEC(10));
+	}
+}
+
+static void client_connect(void)
+{
+	zassert_equal(mqtt_connect(&client_ctx), 0, "Connect failed");
+
+	INPUT_UNTIL(connected);
+
+	zassert_true(connected, "No CONNACK");
+}
+
+static int publish(enum mqtt_qos qos, u16_t message_id)
+{
+	struct mqtt_publish_param param = { 0 };
+
+	param.message.topic.qos = qos;
+	param.message.topic.topic.utf8 = (u8_t *)topic;
+	param.message.topic.topic.size = strlen(topic);
+	param.message.payload.data = (u8_t *)payload;
+	param.message.payload.len = strlen(payload);
+	param.message_id = message_id;
+
+	return mqtt_publish_and_get_id(&client_ctx, &param, &last_id);
+}
+
+static void test_setup(void)
+{
+	k_thread_create(&broker_thread, broker_stack,
+			K_THREAD_STACK_SIZEOF(broker_stack), broker_main,
+			NULL, NULL, NULL, BROKER_PRIORITY, 0, K_NO_WAIT);
+
+	/* Let the broker bind its socket */
+	k_sleep(K_MSEC(100));
+
+	broker.sin_family = AF_INET;
+	broker.sin_port = htons(BROKER_PORT);
+	inet_pton(AF_INET, BROKER_ADDR, &broker.sin_addr);
+
+	mqtt_client_init(&client_ctx);
+
+	client_ctx.broker = &broker;
+	client_ctx.evt_cb = evt_handler;
+	client_ctx.client_id.utf8 = (u8_t *)"zephyr_inflight";
+	client_ctx.client_id.size = strlen("zephyr_inflight");
+	client_ctx.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client_ctx.rx_buf = rx_buffer;
+	client_ctx.rx_buf_size = sizeof(rx_buffer);
+	client_ctx.tx_buf = tx_buffer;
+	client_ctx.tx_buf_size = sizeof(tx_buffer);
+
+	/* Keep the session, so that the window survives a reconnection */
+	client_ctx.clean_session = 0U;
+
+	atomic_set(&broker_ack, 1);
+
+	client_connect();
+}
+
+static void test_qos0_single_packet(void)
+{
+	zassert_equal(publish(MQTT_QOS_0_AT_MOST_ONCE, 0), 0,
+		      "Publish failed");
+
+	wait_publishes(1);
+
+	zassert_equal(atomic_get(&broker_publishes), 1, "Publish not received");
+	zassert_equal(atomic_get(&broker_bad_payloads), 0, "Bad payload");
+}
+
+static void test_window_full(void)
+{
+	u16_t ids[CONFIG_MQTT_INFLIGHT_WINDOW];
+	int i, j;
+
+	atomic_set(&broker_ack, 0);
+	atomic_set(&broker_publishes, 0);
+
+	/* Ids are given to the messages published with id 0, and returned */
+	for (i = 0; i < CONFIG_MQTT_INFLIGHT_WINDOW - 1; i++) {
+		zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+			      "Publish %d failed", i);
+		zassert_not_equal(last_id, 0, "Message id not returned");
+
+		ids[i] = last_id;
+		for (j = 0; j < i; j++) {
+			zassert_not_equal(ids[j], ids[i], "Message id reused");
+		}
+	}
+
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 1), -EALREADY,
+		      "Message id in flight reused");
+
+	zassert_equal(publish(MQTT_QOS_2_EXACTLY_ONCE, 1000), 0,
+		      "QoS 2 publish failed");
+
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), -EBUSY,
+		      "Window not full");
+
+	/* QoS 0 messages are not tracked */
+	zassert_equal(publish(MQTT_QOS_0_AT_MOST_ONCE, 0), 0,
+		      "QoS 0 publish failed");
+
+	wait_publishes(CONFIG_MQTT_INFLIGHT_WINDOW + 1);
+
+	zassert_equal(atomic_get(&broker_publishes),
+		      CONFIG_MQTT_INFLIGHT_WINDOW + 1, "Publishes not received");
+	zassert_equal(atomic_get(&broker_dups), 0, "Unexpected DUP flag");
+	zassert_equal(atomic_get(&broker_bad_payloads), 0, "Bad payload");
+}
+
+static void test_resend_on_reconnect(void)
+{
+	int i;
+
+	mqtt_abort(&client_ctx);
+	zassert_false(connected, "Still connected");
+
+	atomic_set(&broker_publishes, 0);
+	atomic_set(&broker_ack, 1);
+	acked = 0;
+
+	client_connect();
+
+	/* All the messages in flight are acknowledged, the QoS 2 one after
+	 * its PUBREL.
+	 */
+	INPUT_UNTIL(acked == CONFIG_MQTT_INFLIGHT_WINDOW);
+
+	zassert_equal(acked, CONFIG_MQTT_INFLIGHT_WINDOW, "Acks missing");
+	zassert_equal(atomic_get(&broker_publishes),
+		      CONFIG_MQTT_INFLIGHT_WINDOW, "Messages not resent");
+	zassert_equal(atomic_get(&broker_dups), CONFIG_MQTT_INFLIGHT_WINDOW,
+		      "DUP flag not set");
+	zassert_equal(atomic_get(&broker_releases), 1, "PUBREL not sent");
+	zassert_equal(atomic_get(&broker_bad_payloads), 0, "Bad payload");
+
+	/* The window is free again */
+	for (i = 0; i < CONFIG_MQTT_INFLIGHT_WINDOW; i++) {
+		zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+			      "Publish %d failed", i);
+	}
+
+	INPUT_UNTIL(acked == 2 * CONFIG_MQTT_INFLIGHT_WINDOW);
+
+	zassert_equal(acked, 2 * CONFIG_MQTT_INFLIGHT_WINDOW, "Acks missing");
+}
+
+static void test_publish_on_connack(void)
+{
+	mqtt_abort(&client_ctx);
+
+	atomic_set(&broker_ack, 0);
+	atomic_set(&broker_publishes, 0);
+	atomic_set(&broker_dups, 0);
+
+	publish_on_connack = true;
+	client_connect();
+	publish_on_connack = false;
+
+	/* The new message is sent once, not taken for one to resend */
+	wait_publishes(1);
+	k_sleep(K_MSEC(200));
+
+	zassert_equal(atomic_get(&broker_publishes), 1,
+		      "Message published from CONNACK resent");
+	zassert_equal(atomic_get(&broker_dups), 0, "Unexpected DUP flag");
+}
+
+static void test_clean_session(void)
+{
+	atomic_set(&broker_ack, 0);
+	atomic_set(&broker_publishes, 0);
+
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+		      "Publish failed");
+
+	wait_publishes(1);
+
+	mqtt_abort(&client_ctx);
+
+	atomic_set(&broker_publishes, 0);
+	client_ctx.clean_session = 1U;
+
+	client_connect();
+
+	/* The message is dropped along with the session */
+	k_sleep(K_MSEC(200));
+	zassert_equal(atomic_get(&broker_publishes), 0, "Message resent");
+
+	zassert_equal(mqtt_disconnect(&client_ctx), 0, "Disconnect failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_inflight,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_qos0_single_packet),
+			 ztest_unit_test(test_window_full),
+			 ztest_unit_test(test_resend_on_reconnect),
+			 ztest_unit_test(test_publish_on_connack),
+			 ztest_unit_test(test_clean_session)
+			 );
+
+	ztest_run_test_suite(mqtt_inflight);
+}
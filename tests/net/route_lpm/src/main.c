@@ -0,0 +1,333 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <misc/byteorder.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+#include "route.h"
+#include "route_lpm.h"
+
+#if defined(CONFIG_NET_ROUTE_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define RANDOM_ROUTES 48
+#define RANDOM_LOOKUPS 1000
+
+static struct net_if *iface;
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+NET_DEVICE_INIT(net_route_lpm_test, "net_route_lpm_test",
+		net_iface_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV4_MTU);
+
+static struct in_addr ipv4(u8_t a, u8_t b, u8_t c, u8_t d)
+{
+	struct in_addr addr = { { { a, b, c, d } } };
+
+	return addr;
+}
+
+static void check_nexthop(struct in_addr dst, struct in_addr *nexthop)
+{
+	struct net_route_entry_ipv4 *route;
+
+	route = net_route_ipv4_lookup(iface, &dst);
+
+	if (!nexthop) {
+		zassert_is_null(route, "Unexpected route to %s",
+				net_sprint_ipv4_addr(&dst));
+		return;
+	}
+
+	zassert_not_null(route, "No route to %s",
+			 net_sprint_ipv4_addr(&dst));
+	zassert_true(net_ipv4_addr_cmp(&route->nexthop, nexthop),
+		     "Wrong nexthop for %s", net_sprint_ipv4_addr(&dst));
+}
+
+static void test_setup(void)
+{
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface");
+}
+
+static void test_ipv4_longest_match(void)
+{
+	struct in_addr gw[] = {
+		ipv4(192, 0, 2, 1), ipv4(192, 0, 2, 2), ipv4(192, 0, 2, 3),
+		ipv4(192, 0, 2, 4), ipv4(192, 0, 2, 5), ipv4(192, 0, 2, 6),
+	};
+	struct {
+		struct in_addr addr;
+		u8_t len;
+	} prefixes[] = {
+		{ ipv4(0, 0, 0, 0), 0 },
+		{ ipv4(10, 0, 0, 0), 8 },
+		{ ipv4(10, 1, 0, 0), 16 },
+		{ ipv4(10, 1, 2, 0), 24 },
+		{ ipv4(10, 1, 2, 3), 32 },
+		{ ipv4(192, 168, 0, 0), 16 },
+	};
+	struct net_route_entry_ipv4 *routes[ARRAY_SIZE(prefixes)];
+	int i;
+
+	/* Added from the least specific, so that every route splits an
+	 * existing branch of the tree.
+	 */
+	for (i = 0; i < ARRAY_SIZE(prefixes); i++) {
+		routes[i] = net_route_ipv4_add(iface, &prefixes[i].addr,
+					       prefixes[i].len, &gw[i]);
+		zassert_not_null(routes[i], "Route %d add failed", i);
+	}
+
+	check_nexthop(ipv4(10, 1, 2, 3), &gw[4]);
+	check_nexthop(ipv4(10, 1, 2, 4), &gw[3]);
+	check_nexthop(ipv4(10, 1, 3, 1), &gw[2]);
+	check_nexthop(ipv4(10, 2, 0, 1), &gw[1]);
+	check_nexthop(ipv4(11, 0, 0, 1), &gw[0]);
+	check_nexthop(ipv4(192, 168, 5, 5), &gw[5]);
+
+	/* The cached result must not survive the removal */
+	zassert_equal(net_route_ipv4_del(routes[2]), 0, "Route del failed");
+	check_nexthop(ipv4(10, 1, 3, 1), &gw[1]);
+	check_nexthop(ipv4(10, 1, 2, 4), &gw[3]);
+
+	zassert_equal(net_route_ipv4_del(routes[2]), -EINVAL,
+		      "Route del again succeeded");
+
+	/* Adding the same prefix again updates the nexthop */
+	zassert_equal_ptr(net_route_ipv4_add(iface, &prefixes[1].addr,
+					     prefixes[1].len, &gw[2]),
+			  routes[1], "Route update failed");
+	check_nexthop(ipv4(10, 2, 0, 1), &gw[2]);
+
+	for (i = 0; i < ARRAY_SIZE(prefixes); i++) {
+		if (i == 2) {
+			continue;
+		}
+
+		zassert_equal(net_route_ipv4_del(routes[i]), 0,
+			      "Route %d del failed", i);
+	}
+
+	check_nexthop(ipv4(10, 1, 2, 3), NULL);
+	check_nexthop(ipv4(11, 0, 0, 1), NULL);
+}
+
+static u32_t rand_state = 0x12345678;
+
+static u32_t next_rand(void)
+{
+	/* xorshift32, so that every run uses the same routes */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+
+	return rand_state;
+}
+
+struct best_match {
+	struct in_addr *dst;
+	struct net_route_entry_ipv4 *route;
+};
+
+static void best_match_cb(struct net_route_entry_ipv4 *entry, void *user_data)
+{
+	struct best_match *best = user_data;
+	u32_t mask;
+
+	mask = entry->prefix_len ? 0xffffffff << (32 - entry->prefix_len) : 0;
+
+	if ((ntohl(entry->addr.s_addr) & mask) !=
+	    (ntohl(best->dst->s_addr) & mask)) {
+		return;
+	}
+
+	if (!best->route || entry->prefix_len > best->route->prefix_len) {
+		best->route = entry;
+	}
+}
+
+static void count_cb(struct net_route_entry_ipv4 *entry, void *user_data)
+{
+}
+
+static void check_against_linear_scan(void)
+{
+	struct best_match best;
+	struct in_addr dst;
+	int i;
+
+	for (i = 0; i < RANDOM_LOOKUPS; i++) {
+		/* Keep the lookups in a narrow range for them to hit the
+		 * routes often.
+		 */
+		dst.s_addr = htonl(0x0a000000 | (next_rand() & 0x00ffffff));
+
+		best.dst = &dst;
+		best.route = NULL;
+
+		net_route_ipv4_foreach(best_match_cb, &best);
+
+		zassert_equal_ptr(net_route_ipv4_lookup(iface, &dst),
+				  best.route, "Wrong route to %s",
+				  net_sprint_ipv4_addr(&dst));
+	}
+}
+
+static void test_ipv4_random(void)
+{
+	struct net_route_entry_ipv4 *routes[RANDOM_ROUTES];
+	struct in_addr gw = ipv4(192, 0, 2, 1);
+	struct in_addr addr;
+	u32_t start, elapsed;
+	int i;
+
+	for (i = 0; i < RANDOM_ROUTES; i++) {
+		addr.s_addr = htonl(0x0a000000 | (next_rand() & 0x00ffffff));
+
+		routes[i] = net_route_ipv4_add(iface, &addr,
+					       8 + next_rand() % 25, &gw);
+		zassert_not_null(routes[i], "Route %d add failed", i);
+	}
+
+	check_against_linear_scan();
+
+	/* Removing routes must keep the tree consistent */
+	for (i = 0; i < RANDOM_ROUTES; i += 2) {
+		net_route_ipv4_del(routes[i]);
+	}
+
+	check_against_linear_scan();
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < RANDOM_LOOKUPS; i++) {
+		addr.s_addr = htonl(0x0a000000 | (next_rand() & 0x00ffffff));
+		net_route_ipv4_lookup(iface, &addr);
+	}
+
+	elapsed = k_uptime_get_32() - start;
+
+	printk("%d lookups with %d routes in %u ms\n", RANDOM_LOOKUPS,
+	       RANDOM_ROUTES / 2, elapsed);
+
+	for (i = 1; i < RANDOM_ROUTES; i += 2) {
+		net_route_ipv4_del(routes[i]);
+	}
+
+	zassert_equal(net_route_ipv4_foreach(count_cb, NULL), 0,
+		      "Routes left in the table");
+}
+
+static void test_ipv6_prefix_per_iface(void)
+{
+	static struct net_route_lpm lpm = NET_ROUTE_LPM_INIT(128);
+	struct in6_addr prefix = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0 } } };
+	struct in6_addr dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 0,
+				    0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+	struct net_route_lpm_entry entry48 = { .iface = iface };
+	struct net_route_lpm_entry entry64;
+	struct net_route_lpm_entry entry128 = { .iface = iface };
+	static struct net_if other_iface;
+
+	/* Only the pointer is compared, the interface is not used */
+	entry64.iface = &other_iface;
+
+	zassert_equal(net_route_lpm_add(&lpm, prefix.s6_addr, 48, &entry48),
+		      0, "/48 add failed");
+	zassert_equal(net_route_lpm_add(&lpm, prefix.s6_addr, 64, &entry64),
+		      0, "/64 add failed");
+
+	zassert_equal_ptr(net_route_lpm_lookup(&lpm, dst.s6_addr, iface),
+			  &entry48, "Interface not matched");
+	zassert_equal_ptr(net_route_lpm_lookup(&lpm, dst.s6_addr, NULL),
+			  &entry64, "Longest prefix not found");
+
+	zassert_equal(net_route_lpm_add(&lpm, dst.s6_addr, 128, &entry128),
+		      0, "/128 add failed");
+	zassert_equal_ptr(net_route_lpm_lookup(&lpm, dst.s6_addr, iface),
+			  &entry128, "Host route not found");
+
+	zassert_equal(net_route_lpm_del(&lpm, prefix.s6_addr, 48, &entry128),
+		      -ENOENT, "Entry removed with wrong prefix");
+
+	zassert_equal(net_route_lpm_del(&lpm, dst.s6_addr, 128, &entry128),
+		      0, "/128 del failed");
+	zassert_equal(net_route_lpm_del(&lpm, prefix.s6_addr, 48, &entry48),
+		      0, "/48 del failed");
+
+	zassert_is_null(net_route_lpm_lookup(&lpm, dst.s6_addr, iface),
+			"Route found after removal");
+	zassert_equal_ptr(net_route_lpm_lookup(&lpm, dst.s6_addr, NULL),
+			  &entry64, "Remaining route not found");
+
+	zassert_equal(net_route_lpm_del(&lpm, prefix.s6_addr, 64, &entry64),
+		      0, "/64 del failed");
+	zassert_is_null(lpm.root, "Tree not empty");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_route_lpm_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_ipv4_longest_match),
+			 ztest_unit_test(test_ipv4_random),
+			 ztest_unit_test(test_ipv6_prefix_per_iface)
+			 );
+
+	ztest_run_test_suite(net_route_lpm_test);
+}
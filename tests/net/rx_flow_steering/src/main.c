@@ -0,0 +1,268 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TC_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#if defined(CONFIG_NET_TC_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4242
+#define PEER_PORT 10000
+
+#define FLOWS 16
+#define PKTS_PER_FLOW 200
+#define DATA_LEN 64
+
+#define WAIT_TIME K_SECONDS(10)
+#define ALLOC_TIMEOUT K_SECONDS(1)
+
+static struct net_if *iface;
+static struct net_conn_handle *handle;
+static struct k_sem wait_recv;
+
+struct flow_stats {
+	u32_t next_seq;
+	int queue;
+	bool out_of_order;
+	bool moved;
+};
+
+static struct flow_stats flows[FLOWS];
+static atomic_t recv_count;
+static bool unexpected;
+static atomic_t queue_used[NET_RX_QUEUE_COUNT];
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+NET_DEVICE_INIT(net_rx_flow_test, "net_rx_flow_test",
+		net_iface_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV4_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	int idx = ntohs(proto_hdr->udp->src_port) - PEER_PORT;
+	int queue = net_tc_rx_current();
+	struct flow_stats *flow;
+	u32_t seq = 0U;
+
+	if (idx < 0 || idx >= FLOWS || queue < 0) {
+		DBG("Unexpected packet %p\n", pkt);
+		unexpected = true;
+		net_pkt_unref(pkt);
+		return NET_OK;
+	}
+
+	flow = &flows[idx];
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_skip(pkt, NET_IPV4H_LEN + NET_UDPH_LEN);
+	net_pkt_read_be32_new(pkt, &seq);
+
+	/* Only this flow's queue touches its statistics */
+	if (seq != flow->next_seq) {
+		DBG("Flow %d got seq %u, expecting %u\n", idx, seq,
+		    flow->next_seq);
+		flow->out_of_order = true;
+	}
+
+	flow->next_seq = seq + 1;
+
+	if (flow->queue < 0) {
+		flow->queue = queue;
+	} else if (flow->queue != queue) {
+		flow->moved = true;
+	}
+
+	atomic_inc(&queue_used[queue]);
+
+	net_pkt_unref(pkt);
+
+	if (atomic_inc(&recv_count) + 1 == FLOWS * PKTS_PER_FLOW) {
+		k_sem_give(&wait_recv);
+	}
+
+	return NET_OK;
+}
+
+static struct net_pkt *create_pkt(int flow, u32_t seq)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, NET_UDPH_LEN + DATA_LEN,
+					   AF_INET, IPPROTO_UDP,
+					   ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create_new(pkt, &peer_addr, &my_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(PEER_PORT + flow), htons(MY_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	ret = net_pkt_write_be32_new(pkt, seq);
+	zassert_equal(ret, 0, "Cannot write sequence number");
+
+	ret = net_pkt_memset(pkt, 0, DATA_LEN - sizeof(seq));
+	zassert_equal(ret, 0, "Cannot write data");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	return pkt;
+}
+
+static void test_setup(void)
+{
+	struct sockaddr local_addr = { 0 };
+	struct net_if_addr *ifaddr;
+	int ret, i;
+
+	k_sem_init(&wait_recv, 0, UINT_MAX);
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, &my_addr);
+	local_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, NULL, &local_addr, 0, MY_PORT,
+			       udp_data_received, NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+
+	for (i = 0; i < FLOWS; i++) {
+		flows[i].queue = -1;
+	}
+}
+
+static void test_multi_flow_throughput(void)
+{
+	u32_t start, elapsed;
+	int i, seq, used = 0;
+
+	start = k_uptime_get_32();
+
+	/* Interleave the flows like a busy link would */
+	for (seq = 0; seq < PKTS_PER_FLOW; seq++) {
+		for (i = 0; i < FLOWS; i++) {
+			zassert_equal(net_recv_data(iface, create_pkt(i, seq)),
+				      0, "Cannot receive packet");
+		}
+	}
+
+	zassert_equal(k_sem_take(&wait_recv, WAIT_TIME), 0,
+		      "Not all packets received (%d)",
+		      (int)atomic_get(&recv_count));
+
+	elapsed = MAX(k_uptime_get_32() - start, 1);
+
+	zassert_false(unexpected, "Unexpected packet received");
+
+	for (i = 0; i < FLOWS; i++) {
+		zassert_false(flows[i].out_of_order,
+			      "Flow %d received out of order", i);
+		zassert_false(flows[i].moved,
+			      "Flow %d handled by several queues", i);
+		zassert_equal(flows[i].next_seq, PKTS_PER_FLOW,
+			      "Flow %d lost packets", i);
+	}
+
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
+		if (atomic_get(&queue_used[i])) {
+			used++;
+		}
+
+		DBG("Queue %d: %d packets\n", i,
+		    (int)atomic_get(&queue_used[i]));
+	}
+
+	if (NET_RX_FLOW_QUEUES > 1) {
+		zassert_true(used > 1, "Flows were not spread over queues");
+	}
+
+	printk("%d flows, %d packets in %u ms (%u pkts/s) using %d queue(s)\n",
+	       FLOWS, FLOWS * PKTS_PER_FLOW, elapsed,
+	       FLOWS * PKTS_PER_FLOW * 1000U / elapsed, used);
+}
+
+static void test_cleanup(void)
+{
+	net_udp_unregister(handle);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_flow_steering_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_multi_flow_throughput),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_rx_flow_steering_test);
+}
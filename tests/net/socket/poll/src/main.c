@@ -122,10 +122,177 @@ void test_poll(void)
 	zassert_equal(res, 0, "close failed");
 }
 
+void test_epoll(void)
+{
+	int res;
+	int c_sock;
+	int s_sock;
+	int epfd;
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	struct epoll_event ev;
+	struct epoll_event events[2];
+	u32_t tstamp;
+	ssize_t len;
+	char buf[10];
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	ev.events = EPOLLIN;
+	ev.data.fd = c_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, c_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	ev.events = EPOLLIN;
+	ev.data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, -1, "double add succeeded");
+	zassert_equal(errno, EEXIST, "");
+
+
+	/* Wait on non-ready sockets with timeout of 0, then 30 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp >= 30 && tstamp <= 30 + FUZZ, "");
+	zassert_equal(res, 0, "");
+
+
+	/* Send pkt for s_sock, it is reported until read (level-triggered) */
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	len = recv(s_sock, BUF_AND_SIZE(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+
+	/* Edge-triggered: reported once per arrival */
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	len = recv(s_sock, BUF_AND_SIZE(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+
+
+	/* Removed and closed sockets are no longer reported */
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 0, "");
+
+	res = close(c_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(s_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+}
+
+#define STACK_SIZE 1024
+static K_THREAD_STACK_DEFINE(waiter_stack, STACK_SIZE);
+static struct k_thread waiter_thread;
+static K_SEM_DEFINE(waiter_done, 0, 1);
+static int waiter_res;
+static int waiter_errno;
+
+static void epoll_waiter(void *p1, void *p2, void *p3)
+{
+	struct epoll_event events[1];
+
+	waiter_res = epoll_wait(POINTER_TO_INT(p1), events,
+				ARRAY_SIZE(events), -1);
+	waiter_errno = errno;
+	k_sem_give(&waiter_done);
+}
+
+void test_epoll_close(void)
+{
+	int res;
+	int epfd;
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	k_thread_create(&waiter_thread, waiter_stack,
+			K_THREAD_STACK_SIZEOF(waiter_stack), epoll_waiter,
+			INT_TO_POINTER(epfd), NULL, NULL,
+			K_PRIO_PREEMPT(0), 0, 0);
+
+	/* Let it block in epoll_wait(), closing wakes it with EBADF */
+	k_sleep(K_MSEC(30));
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+
+	res = k_sem_take(&waiter_done, K_MSEC(100));
+	zassert_equal(res, 0, "waiter not woken up");
+	zassert_equal(waiter_res, -1, "");
+	zassert_equal(waiter_errno, EBADF, "");
+
+	/* The instance is released and can be created again */
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_poll,
-			 ztest_unit_test(test_poll));
+			 ztest_unit_test(test_poll),
+			 ztest_unit_test(test_epoll),
+			 ztest_unit_test(test_epoll_close));
 
 	ztest_run_test_suite(socket_poll);
 }
@@ -301,6 +301,164 @@ void test_send_recv_2_sock(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+void test_v4_sendmsg_recvmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in src_addr;
+	char rx_buf[STRLEN(TEST_STR2)];
+	struct iovec iov[3];
+	struct msghdr msg;
+	ssize_t len;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(client_sock,
+		  (struct sockaddr *)&client_addr, sizeof(client_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	/* Gather one datagram from three pieces */
+	iov[0].iov_base = TEST_STR2;
+	iov[0].iov_len = 10;
+	iov[1].iov_base = TEST_STR2 + 10;
+	iov[1].iov_len = 0;
+	iov[2].iov_base = TEST_STR2 + 10;
+	iov[2].iov_len = STRLEN(TEST_STR2) - 10;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &server_addr;
+	msg.msg_namelen = sizeof(server_addr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = ARRAY_SIZE(iov);
+
+	len = sendmsg(client_sock, &msg, 0);
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid sendmsg len");
+
+	/* Scatter it into two buffers, with the source address */
+	clear_buf(rx_buf);
+	iov[0].iov_base = rx_buf;
+	iov[0].iov_len = 100;
+	iov[1].iov_base = rx_buf + 100;
+	iov[1].iov_len = sizeof(rx_buf) - 100;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &src_addr;
+	msg.msg_namelen = sizeof(src_addr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	len = recvmsg(server_sock, &msg, 0);
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid recvmsg len");
+	zassert_mem_equal(rx_buf, BUF_AND_SIZE(TEST_STR2), "wrong data");
+	zassert_equal(msg.msg_namelen, sizeof(src_addr), "wrong addrlen");
+	zassert_equal(src_addr.sin_port, client_addr.sin_port,
+		      "wrong source port");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags");
+
+	/* A datagram that does not fit is truncated and flagged */
+	len = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		     (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid sendto len");
+
+	iov[0].iov_len = 10;
+	msg.msg_name = NULL;
+	msg.msg_iovlen = 1;
+
+	len = recvmsg(server_sock, &msg, 0);
+	zassert_equal(len, 10, "invalid recvmsg len");
+	zassert_equal(msg.msg_flags, MSG_TRUNC, "datagram not truncated");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define MMSG_COUNT 4
+
+void test_sendmmsg_recvmmsg(void)
+{
+	int rv, i;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec iov[MMSG_COUNT];
+	char rx_buf[MMSG_COUNT][8];
+	char tx_buf[MMSG_COUNT][8];
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = connect(client_sock,
+		     (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, 0, "connect failed");
+
+	(void)memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < MMSG_COUNT; i++) {
+		snprintf(tx_buf[i], sizeof(tx_buf[i]), "msg%d", i);
+		iov[i].iov_base = tx_buf[i];
+		iov[i].iov_len = strlen(tx_buf[i]);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "not all datagrams sent");
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, iov[i].iov_len,
+			      "invalid sent len");
+	}
+
+	/* Wait for the first datagram, then take what is queued; on
+	 * loopback that is all of them.
+	 */
+	(void)memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < MMSG_COUNT; i++) {
+		iov[i].iov_base = rx_buf[i];
+		iov[i].iov_len = sizeof(rx_buf[i]);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	k_sleep(K_MSEC(100));
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "not all datagrams received");
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, strlen(tx_buf[i]),
+			      "invalid received len");
+		zassert_mem_equal(rx_buf[i], tx_buf[i], msgs[i].msg_len,
+				  "wrong data");
+	}
+
+	/* Nothing left: a non-blocking batch receive fails */
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_DONTWAIT);
+	zassert_equal(rv, -1, "unexpected datagram");
+	zassert_equal(errno, EAGAIN, "unexpected errno");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_udp,
@@ -308,7 +466,9 @@ void test_main(void)
 			 ztest_unit_test(test_v4_sendto_recvfrom),
 			 ztest_unit_test(test_v6_sendto_recvfrom),
 			 ztest_unit_test(test_v4_bind_sendto),
-			 ztest_unit_test(test_v6_bind_sendto));
+			 ztest_unit_test(test_v6_bind_sendto),
+			 ztest_unit_test(test_v4_sendmsg_recvmsg),
+			 ztest_unit_test(test_sendmmsg_recvmmsg));
 
 	ztest_run_test_suite(socket_udp);
 }
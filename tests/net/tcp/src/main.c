@@ -235,6 +235,150 @@ static void v6_send_syn_ack(struct net_pkt *req)
 	k_sem_give(&wait_connect);
 }
 
+/* The SACK tests talk to a simulated peer that only exists in
+ * tester_send(): the peer address is not local, so segments reach the
+ * dummy L2 where they are recorded and possibly "lost", and the peer
+ * answers by injecting segments with net_recv_data().
+ */
+#define MY_SACK_PORT 5546
+#define SACK_PEER_ISN 1000U
+#define SACK_SEGMENTS 4
+/* 262140 >> 2 fits in 16 bits, see CONFIG_NET_TCP_RECV_WINDOW_SIZE */
+#define SACK_WSCALE 2
+
+static struct in_addr sack_peer_v4_inaddr = { { { 192, 0, 2, 251 } } };
+static struct net_context *sack_ctx;
+static struct k_sem sack_sem;
+static bool sack_test_active;
+static u32_t sack_peer_ts;
+
+static struct net_tcp_options sack_syn_opts;
+static struct net_tcp_options sack_data_opts;
+static u16_t sack_data_wnd;
+
+/* Sequence numbers of data segments as first sent, then retransmitted */
+static u32_t sack_sent[SACK_SEGMENTS];
+static int sack_sent_count;
+static u32_t sack_rexmit[2 * SACK_SEGMENTS];
+static int sack_rexmit_count;
+
+static struct net_pkt *sack_peer_segment(u32_t seq, u32_t ack, u8_t flags,
+					 const u8_t *opts, size_t optlen)
+{
+	struct net_tcp_hdr hdr;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(my_iface, sizeof(hdr) + optlen,
+					AF_INET, IPPROTO_TCP, K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_ipv4_create_new(pkt, &sack_peer_v4_inaddr, &my_v4_inaddr);
+
+	(void)memset(&hdr, 0, sizeof(hdr));
+	hdr.src_port = htons(PEER_TCP_PORT);
+	hdr.dst_port = htons(MY_SACK_PORT);
+	sys_put_be32(seq, hdr.seq);
+	sys_put_be32(ack, hdr.ack);
+	hdr.offset = ((sizeof(hdr) + optlen) / 4) << 4;
+	hdr.flags = flags;
+	sys_put_be16(4096, hdr.wnd);
+
+	net_pkt_write_new(pkt, &hdr, sizeof(hdr));
+	net_pkt_write_new(pkt, opts, optlen);
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_TCP);
+
+	return pkt;
+}
+
+static void sack_peer_inject(struct net_pkt *pkt)
+{
+	if (pkt && net_recv_data(my_iface, pkt) < 0) {
+		net_pkt_unref(pkt);
+	}
+}
+
+/* Peer timestamps option, padded to 12 bytes */
+static void sack_put_ts(u8_t *opts, u32_t tsecr)
+{
+	opts[0] = NET_TCP_NOP_OPT;
+	opts[1] = NET_TCP_NOP_OPT;
+	opts[2] = NET_TCP_TIMESTAMP_OPT;
+	opts[3] = NET_TCP_TIMESTAMP_SIZE;
+	sys_put_be32(++sack_peer_ts, opts + 4);
+	sys_put_be32(tsecr, opts + 8);
+}
+
+static void sack_peer_syn_ack(u32_t syn_seq)
+{
+	u8_t opts[24] = {
+		NET_TCP_MSS_OPT, NET_TCP_MSS_SIZE, 0x05, 0xb4,
+		NET_TCP_NOP_OPT, NET_TCP_WINDOW_SCALE_OPT,
+		NET_TCP_WINDOW_SCALE_SIZE, 7,
+		NET_TCP_NOP_OPT, NET_TCP_NOP_OPT,
+		NET_TCP_SACK_PERM_OPT, NET_TCP_SACK_PERM_SIZE,
+	};
+
+	sack_put_ts(opts + 12, sack_syn_opts.tsval);
+
+	sack_peer_inject(sack_peer_segment(SACK_PEER_ISN, syn_seq + 1,
+					   NET_TCP_SYN | NET_TCP_ACK,
+					   opts, sizeof(opts)));
+}
+
+static void sack_peer_recv(struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+	struct net_tcp_options opts = { 0 };
+	int opt_len, data_len;
+	u32_t seq;
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (!tcp_hdr || tcp_hdr->src_port != htons(MY_SACK_PORT)) {
+		return;
+	}
+
+	opt_len = NET_TCP_HDR_LEN(tcp_hdr) - sizeof(struct net_tcp_hdr);
+	data_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		NET_TCP_HDR_LEN(tcp_hdr);
+	seq = sys_get_be32(tcp_hdr->seq);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) + sizeof(struct net_tcp_hdr));
+
+	if (net_tcp_parse_opts(pkt, opt_len, &opts) < 0) {
+		test_failed = true;
+		return;
+	}
+
+	if (NET_TCP_FLAGS(tcp_hdr) == NET_TCP_SYN) {
+		sack_syn_opts = opts;
+		sack_peer_syn_ack(seq);
+		return;
+	}
+
+	if (data_len <= 0) {
+		return;
+	}
+
+	if (sack_sent_count < SACK_SEGMENTS) {
+		if (!sack_sent_count) {
+			sack_data_opts = opts;
+			sack_data_wnd = sys_get_be16(tcp_hdr->wnd);
+		}
+
+		sack_sent[sack_sent_count++] = seq;
+	} else if (sack_rexmit_count < ARRAY_SIZE(sack_rexmit)) {
+		sack_rexmit[sack_rexmit_count++] = seq;
+	}
+
+	k_sem_give(&sack_sem);
+}
+
 static int send_status = -EINVAL;
 
 static int tester_send(struct device *dev, struct net_pkt *pkt)
@@ -249,6 +393,10 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 		v6_send_syn_ack(pkt);
 	}
 
+	if (sack_test_active && net_pkt_family(pkt) == AF_INET) {
+		sack_peer_recv(pkt);
+	}
+
 	send_status = 0;
 
 	return 0;
@@ -1455,18 +1603,14 @@ static bool test_init_tcp_context(void)
 	return true;
 }
 
-/* Receive window helper function copied from tcp.c */
 static inline u32_t get_recv_wnd(struct net_tcp *tcp)
 {
-	ARG_UNUSED(tcp);
-
 	/* We don't queue received data inside the stack, we hand off
 	 * packets to synchronous callbacks (who can queue if they
 	 * want, but it's not our business).  So the available window
-	 * size is always the same.  There are two configurables to
-	 * check though.
+	 * size is always the same, as limited by window scaling.
 	 */
-	return MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	return net_tcp_get_recv_wnd(tcp);
 }
 
 static bool test_tcp_seq_validity(void)
@@ -1640,6 +1784,250 @@ static bool test_init_tcp_accept(void)
 	return true;
 }
 
+static bool test_tcp_parse_opts(void)
+{
+	static const u8_t opts[] = {
+		NET_TCP_MSS_OPT, NET_TCP_MSS_SIZE, 0x05, 0xb4,
+		/* Shift above 14 is clamped */
+		NET_TCP_NOP_OPT, NET_TCP_WINDOW_SCALE_OPT,
+		NET_TCP_WINDOW_SCALE_SIZE, 15,
+		NET_TCP_SACK_PERM_OPT, NET_TCP_SACK_PERM_SIZE,
+		NET_TCP_TIMESTAMP_OPT, NET_TCP_TIMESTAMP_SIZE,
+		0x01, 0x02, 0x03, 0x04, 0x0a, 0x0b, 0x0c, 0x0d,
+		NET_TCP_NOP_OPT, NET_TCP_NOP_OPT,
+		NET_TCP_SACK_OPT, 2 + 2 * NET_TCP_SACK_BLOCK_SIZE,
+		0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x20, 0x00,
+		0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x40, 0x00,
+	};
+	static const u8_t bad_sack[] = {
+		NET_TCP_SACK_OPT, 2 + NET_TCP_SACK_BLOCK_SIZE / 2,
+		0x00, 0x00, 0x10, 0x00,
+	};
+	struct net_tcp_options tcp_opts = { 0 };
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(my_iface, sizeof(opts), AF_UNSPEC, 0,
+					K_FOREVER);
+	net_pkt_write_new(pkt, opts, sizeof(opts));
+	net_pkt_cursor_init(pkt);
+
+	ret = net_tcp_parse_opts(pkt, sizeof(opts), &tcp_opts);
+	net_pkt_unref(pkt);
+
+	if (ret < 0) {
+		TC_ERROR("Parsing options failed (%d)\n", ret);
+		return false;
+	}
+
+	if (tcp_opts.found != (NET_TCP_OPT_HAS_MSS | NET_TCP_OPT_HAS_WSCALE |
+			       NET_TCP_OPT_HAS_SACK_PERM | NET_TCP_OPT_HAS_TS |
+			       NET_TCP_OPT_HAS_SACK)) {
+		TC_ERROR("Options found 0x%x\n", tcp_opts.found);
+		return false;
+	}
+
+	if (tcp_opts.mss != 1460 || tcp_opts.wscale != NET_TCP_MAX_WSCALE ||
+	    tcp_opts.tsval != 0x01020304 || tcp_opts.tsecr != 0x0a0b0c0d) {
+		TC_ERROR("Wrong option values\n");
+		return false;
+	}
+
+	if (tcp_opts.sack_count != 2 ||
+	    tcp_opts.sack[0].left != 0x1000 ||
+	    tcp_opts.sack[0].right != 0x2000 ||
+	    tcp_opts.sack[1].left != 0x3000 ||
+	    tcp_opts.sack[1].right != 0x4000) {
+		TC_ERROR("Wrong SACK blocks\n");
+		return false;
+	}
+
+	pkt = net_pkt_alloc_with_buffer(my_iface, sizeof(bad_sack), AF_UNSPEC,
+					0, K_FOREVER);
+	net_pkt_write_new(pkt, bad_sack, sizeof(bad_sack));
+	net_pkt_cursor_init(pkt);
+
+	ret = net_tcp_parse_opts(pkt, sizeof(bad_sack), &tcp_opts);
+	net_pkt_unref(pkt);
+
+	if (ret != -EINVAL) {
+		TC_ERROR("Truncated SACK block accepted\n");
+		return false;
+	}
+
+	return true;
+}
+
+static void sack_connect_cb(struct net_context *context, int status,
+			    void *user_data)
+{
+	if (status) {
+		test_failed = true;
+	}
+
+	k_sem_give(&wait_connect);
+}
+
+static bool test_tcp_sack_connect(void)
+{
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(MY_SACK_PORT),
+	};
+	struct sockaddr_in remote = {
+		.sin_family = AF_INET,
+		.sin_port = htons(PEER_TCP_PORT),
+	};
+	struct net_tcp *tcp;
+	u8_t expected;
+	int ret;
+
+	k_sem_init(&sack_sem, 0, UINT_MAX);
+
+	net_ipaddr_copy(&local.sin_addr, &my_v4_inaddr);
+	net_ipaddr_copy(&remote.sin_addr, &sack_peer_v4_inaddr);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &sack_ctx);
+	if (ret) {
+		TC_ERROR("Context get failed (%d)\n", ret);
+		return false;
+	}
+
+	ret = net_context_bind(sack_ctx, (struct sockaddr *)&local,
+			       sizeof(local));
+	if (ret) {
+		TC_ERROR("Context bind failed (%d)\n", ret);
+		return false;
+	}
+
+	sack_test_active = true;
+
+	ret = net_context_connect(sack_ctx, (struct sockaddr *)&remote,
+				  sizeof(remote), sack_connect_cb, K_NO_WAIT,
+				  NULL);
+	if (ret) {
+		TC_ERROR("Context connect failed (%d)\n", ret);
+		return false;
+	}
+
+	if (k_sem_take(&wait_connect, WAIT_TIME_LONG)) {
+		TC_ERROR("Timeout while waiting for connection\n");
+		return false;
+	}
+
+	/* Our SYN offered every option */
+	expected = NET_TCP_OPT_HAS_MSS | NET_TCP_OPT_HAS_WSCALE |
+		NET_TCP_OPT_HAS_SACK_PERM | NET_TCP_OPT_HAS_TS;
+	if (sack_syn_opts.found != expected ||
+	    sack_syn_opts.wscale != SACK_WSCALE) {
+		TC_ERROR("SYN options 0x%x shift %u\n", sack_syn_opts.found,
+			 sack_syn_opts.wscale);
+		return false;
+	}
+
+	/* And the peer accepted all of them */
+	tcp = sack_ctx->tcp;
+	if ((tcp->flags & NET_TCP_SYN_OPT_FLAGS) != NET_TCP_SYN_OPT_FLAGS ||
+	    tcp->rcv_wscale != SACK_WSCALE || tcp->send_mss != 1460) {
+		TC_ERROR("Options not negotiated (flags 0x%x)\n", tcp->flags);
+		return false;
+	}
+
+	return true;
+}
+
+/* Send SACK_SEGMENTS segments, lose the 1st and the 3rd in the dummy
+ * L2 and have the peer SACK the other two. The retransmit timer must
+ * then resend both holes, and nothing the peer already holds.
+ */
+static bool test_tcp_sack_retransmit(void)
+{
+	u8_t opts[12 + 4 + 2 * NET_TCP_SACK_BLOCK_SIZE];
+	u8_t *sack = opts + 12;
+	bool rexmit_1st = false, rexmit_3rd = false;
+	u32_t ack;
+	int i, ret;
+
+	for (i = 0; i < SACK_SEGMENTS; i++) {
+		ret = net_context_send_new(sack_ctx, data, sizeof(data), NULL,
+					   K_NO_WAIT, NULL, NULL);
+		if (ret < 0) {
+			TC_ERROR("Send failed (%d)\n", ret);
+			return false;
+		}
+	}
+
+	for (i = 0; i < SACK_SEGMENTS; i++) {
+		if (k_sem_take(&sack_sem, WAIT_TIME_LONG)) {
+			TC_ERROR("Segment %d was not sent\n", i);
+			return false;
+		}
+	}
+
+	/* Data segments carry a scaled window and echo the peer's clock */
+	if (sack_data_wnd != (get_recv_wnd(sack_ctx->tcp) >> SACK_WSCALE) ||
+	    !(sack_data_opts.found & NET_TCP_OPT_HAS_TS) ||
+	    sack_data_opts.tsecr != sack_peer_ts) {
+		TC_ERROR("Window %u tsecr %u\n", sack_data_wnd,
+			 sack_data_opts.tsecr);
+		return false;
+	}
+
+	sack_put_ts(opts, sack_data_opts.tsval);
+	sack[0] = NET_TCP_NOP_OPT;
+	sack[1] = NET_TCP_NOP_OPT;
+	sack[2] = NET_TCP_SACK_OPT;
+	sack[3] = 2 + 2 * NET_TCP_SACK_BLOCK_SIZE;
+	sys_put_be32(sack_sent[1], sack + 4);
+	sys_put_be32(sack_sent[1] + sizeof(data), sack + 8);
+	sys_put_be32(sack_sent[3], sack + 12);
+	sys_put_be32(sack_sent[3] + sizeof(data), sack + 16);
+
+	sack_peer_inject(sack_peer_segment(SACK_PEER_ISN + 1, sack_sent[0],
+					   NET_TCP_ACK, opts, sizeof(opts)));
+
+	/* The first timeout may fire before the SACK arrives and resend
+	 * only the head, the next one must fill both holes.
+	 */
+	while (!rexmit_1st || !rexmit_3rd) {
+		if (k_sem_take(&sack_sem, 4 * MSEC_PER_SEC)) {
+			TC_ERROR("Holes were not retransmitted\n");
+			return false;
+		}
+
+		for (i = 0; i < sack_rexmit_count; i++) {
+			if (sack_rexmit[i] == sack_sent[0]) {
+				rexmit_1st = true;
+			} else if (sack_rexmit[i] == sack_sent[2]) {
+				rexmit_3rd = true;
+			} else {
+				TC_ERROR("SACKed segment %u retransmitted\n",
+					 sack_rexmit[i]);
+				return false;
+			}
+		}
+	}
+
+	/* Acknowledge everything, the scoreboard must drain */
+	ack = sack_sent[SACK_SEGMENTS - 1] + sizeof(data);
+	sack_put_ts(opts, sack_data_opts.tsval);
+
+	sack_peer_inject(sack_peer_segment(SACK_PEER_ISN + 1, ack,
+					   NET_TCP_ACK, opts, 12));
+
+	k_sleep(WAIT_TIME);
+
+	if (!sys_slist_is_empty(&sack_ctx->tcp->sent_list) ||
+	    sack_ctx->tcp->sacked_count) {
+		TC_ERROR("Data not acknowledged\n");
+		return false;
+	}
+
+	sack_test_active = false;
+
+	return true;
+}
+
 #if 0
 static bool test_init_tcp_connect(void)
 {
@@ -1787,6 +2175,12 @@ static bool test_cleanup(void)
 		return false;
 	}
 
+	ret = net_context_put(sack_ctx);
+	if (ret != 0) {
+		TC_ERROR("Context free SACK failed.\n");
+		return false;
+	}
+
 	return true;
 }
 
@@ -1810,6 +2204,9 @@ static const struct {
 	{ "test TCP seq validity", test_tcp_seq_validity },
 	{ "test TCP reply context init", test_init_tcp_reply_context },
 	{ "test TCP accept init", test_init_tcp_accept },
+	{ "test TCP option parsing", test_tcp_parse_opts },
+	{ "test TCP SACK connection setup", test_tcp_sack_connect },
+	{ "test TCP SACK retransmit on loss", test_tcp_sack_retransmit },
 #if 0
 	/* TBD: more tests are needed */
 	{ "test TCP connect init", test_init_tcp_connect },
@@ -0,0 +1,478 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "tcp_internal.h"
+#include "connection.h"
+
+#if defined(CONFIG_NET_TCP_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4242
+#define PEER_PORT 4343
+
+#define SEQ 0x12345678
+#define MSS 536
+
+/* Payload that needs three segments with the default 576 bytes MTU */
+#define DATA_LEN 1400
+#define HDR_LEN (NET_IPV4H_LEN + NET_TCPH_LEN)
+
+#define ALLOC_TIMEOUT 500
+
+/* Size of the received segments that GRO coalesces */
+#define SEG_LEN 64
+#define MAX_RECV 4
+
+/* Time for the RX thread to process the queued segments */
+#define RECV_WAIT K_MSEC(100)
+
+static struct net_if *iface;
+
+static int seg_count;
+static u32_t seg_bytes;
+static bool test_failed;
+
+struct recv_seg {
+	u32_t seq;
+	u16_t ip_len;
+	u16_t len;
+	u8_t flags;
+};
+
+static struct recv_seg recv_segs[MAX_RECV];
+static int recv_count;
+static struct net_conn_handle *conn_handle;
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+NET_DEVICE_INIT(net_tcp_gso_test, "net_tcp_gso_test",
+		net_iface_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV4_MTU);
+
+static u8_t data_byte(u32_t offset)
+{
+	return offset % 251;
+}
+
+static int verify_segment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	struct net_tcp_hdr *tcp_hdr;
+	u32_t len = net_pkt_get_len(pkt);
+	bool last;
+	u8_t byte;
+	u32_t i;
+
+	if (ntohs(hdr->len) != len || len > NET_IPV4_MTU) {
+		DBG("Invalid segment length %u\n", len);
+		return -EINVAL;
+	}
+
+	if (net_calc_chksum_ipv4(pkt) != 0 || net_calc_chksum_tcp(pkt) != 0) {
+		DBG("Invalid checksum\n");
+		return -EINVAL;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)(pkt->buffer->data + NET_IPV4H_LEN);
+
+	if (sys_get_be32(tcp_hdr->seq) != SEQ + seg_bytes) {
+		DBG("Invalid sequence number\n");
+		return -EINVAL;
+	}
+
+	last = seg_bytes + len - HDR_LEN == DATA_LEN;
+
+	if (!!(tcp_hdr->flags & NET_TCP_PSH) != last) {
+		DBG("Invalid PSH flag\n");
+		return -EINVAL;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, HDR_LEN);
+
+	for (i = 0U; i < len - HDR_LEN; i++) {
+		if (net_pkt_read_u8_new(pkt, &byte) ||
+		    byte != data_byte(seg_bytes + i)) {
+			DBG("Invalid data at %u\n", seg_bytes + i);
+			return -EINVAL;
+		}
+	}
+
+	seg_bytes += len - HDR_LEN;
+
+	return 0;
+}
+
+static int gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	int len = net_pkt_get_len(pkt);
+
+	seg_count++;
+
+	if (verify_segment(pkt) < 0) {
+		test_failed = true;
+	}
+
+	net_pkt_unref(pkt);
+
+	return len;
+}
+
+static int gso_send_fail(struct net_if *iface, struct net_pkt *pkt)
+{
+	seg_count++;
+
+	return -EIO;
+}
+
+static struct net_pkt *create_tcp_pkt(void)
+{
+	struct net_tcp_hdr tcp_hdr = { 0 };
+	struct net_pkt *pkt;
+	u32_t i;
+	int ret;
+
+	/* Allocated without a family so that the buffer is not limited
+	 * by the MTU of the interface.
+	 */
+	pkt = net_pkt_alloc_with_buffer(iface, HDR_LEN + DATA_LEN,
+					AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET);
+
+	ret = net_ipv4_create_new(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	tcp_hdr.src_port = htons(MY_PORT);
+	tcp_hdr.dst_port = htons(PEER_PORT);
+	sys_put_be32(SEQ, tcp_hdr.seq);
+	tcp_hdr.offset = NET_TCPH_LEN << 2;
+	tcp_hdr.flags = NET_TCP_ACK | NET_TCP_PSH;
+	sys_put_be16(1024, tcp_hdr.wnd);
+
+	ret = net_pkt_write_new(pkt, &tcp_hdr, sizeof(tcp_hdr));
+	zassert_equal(ret, 0, "Cannot create TCP header");
+
+	for (i = 0U; i < DATA_LEN; i++) {
+		ret = net_pkt_write_u8_new(pkt, data_byte(i));
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_TCP);
+
+	zassert_equal(net_pkt_get_len(pkt), HDR_LEN + DATA_LEN,
+		      "Packet size invalid");
+
+	net_pkt_set_gso_size(pkt, MSS);
+
+	return pkt;
+}
+
+static int verify_recv(struct net_pkt *pkt, union net_ip_header *ip_hdr,
+		       struct net_tcp_hdr *tcp_hdr)
+{
+	struct recv_seg *seg = &recv_segs[recv_count];
+	u32_t offset;
+	u8_t byte;
+	u32_t i;
+
+	seg->seq = sys_get_be32(tcp_hdr->seq);
+	seg->ip_len = ntohs(ip_hdr->ipv4->len);
+	seg->len = net_pkt_get_len(pkt) - HDR_LEN;
+	seg->flags = NET_TCP_FLAGS(tcp_hdr);
+
+	if (seg->ip_len != net_pkt_get_len(pkt)) {
+		DBG("IP length %u does not match packet length %zu\n",
+		    seg->ip_len, net_pkt_get_len(pkt));
+		return -EINVAL;
+	}
+
+	if (net_calc_chksum_ipv4(pkt) != 0) {
+		DBG("Invalid IPv4 checksum\n");
+		return -EINVAL;
+	}
+
+	offset = seg->seq - SEQ;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, HDR_LEN);
+
+	for (i = 0U; i < seg->len; i++) {
+		if (net_pkt_read_u8_new(pkt, &byte) ||
+		    byte != data_byte(offset + i)) {
+			DBG("Invalid data at %u\n", offset + i);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static enum net_verdict gro_recv(struct net_conn *conn,
+				 struct net_pkt *pkt,
+				 union net_ip_header *ip_hdr,
+				 union net_proto_header *proto_hdr,
+				 void *user_data)
+{
+	if (recv_count >= MAX_RECV ||
+	    verify_recv(pkt, ip_hdr, proto_hdr->tcp) < 0) {
+		test_failed = true;
+	}
+
+	if (recv_count < MAX_RECV) {
+		recv_count++;
+	}
+
+	net_pkt_unref(pkt);
+
+	return NET_OK;
+}
+
+static void queue_seg(u32_t offset, u8_t flags)
+{
+	struct net_tcp_hdr tcp_hdr = { 0 };
+	struct net_pkt *pkt;
+	u32_t i;
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, HDR_LEN + SEG_LEN,
+					   AF_INET, IPPROTO_TCP,
+					   ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create_new(pkt, &peer_addr, &my_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	tcp_hdr.src_port = htons(PEER_PORT);
+	tcp_hdr.dst_port = htons(MY_PORT);
+	sys_put_be32(SEQ + offset, tcp_hdr.seq);
+	sys_put_be32(SEQ, tcp_hdr.ack);
+	tcp_hdr.offset = NET_TCPH_LEN << 2;
+	tcp_hdr.flags = flags;
+	sys_put_be16(1024, tcp_hdr.wnd);
+
+	ret = net_pkt_write_new(pkt, &tcp_hdr, sizeof(tcp_hdr));
+	zassert_equal(ret, 0, "Cannot create TCP header");
+
+	for (i = 0U; i < SEG_LEN; i++) {
+		ret = net_pkt_write_u8_new(pkt, data_byte(offset + i));
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_TCP);
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive packet");
+}
+
+static void recv_reset(void)
+{
+	recv_count = 0;
+	test_failed = false;
+	(void)memset(recv_segs, 0, sizeof(recv_segs));
+}
+
+static void check_recv(int idx, u32_t offset, u16_t len, u8_t flags)
+{
+	zassert_equal(recv_segs[idx].seq, SEQ + offset,
+		      "Invalid sequence number");
+	zassert_equal(recv_segs[idx].len, len, "Invalid data length");
+	zassert_equal(recv_segs[idx].ip_len, HDR_LEN + len,
+		      "Invalid IP total length");
+	zassert_equal(recv_segs[idx].flags, flags, "Invalid TCP flags");
+}
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ret = net_conn_register(IPPROTO_TCP, AF_INET, NULL, NULL,
+				PEER_PORT, MY_PORT, gro_recv, NULL,
+				&conn_handle);
+	zassert_equal(ret, 0, "Cannot register connection handler");
+}
+
+static void test_gso_split(void)
+{
+	struct net_pkt *pkt = create_tcp_pkt();
+	int ret;
+
+	seg_count = 0;
+	seg_bytes = 0U;
+	test_failed = false;
+
+	ret = net_tcp_gso_send(iface, pkt, gso_send);
+	zassert_equal(ret, 3 * HDR_LEN + DATA_LEN, "Invalid sent length");
+
+	zassert_false(test_failed, "Segment verify failed");
+	zassert_equal(seg_count, 3, "Invalid number of segments");
+	zassert_equal(seg_bytes, DATA_LEN, "Invalid amount of data");
+}
+
+static void test_gso_send_error(void)
+{
+	struct net_pkt *pkt = create_tcp_pkt();
+	int ret;
+
+	seg_count = 0;
+
+	/* The caller keeps the original packet on error */
+	ret = net_tcp_gso_send(iface, pkt, gso_send_fail);
+	zassert_equal(ret, -EIO, "Send error not returned");
+	zassert_equal(seg_count, 1, "Segments sent after an error");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_gro_merge(void)
+{
+	recv_reset();
+
+	/* The segments are queued before the RX thread runs, so all of
+	 * them are merged and the idle flush delivers the result.
+	 */
+	queue_seg(0, NET_TCP_ACK);
+	queue_seg(SEG_LEN, NET_TCP_ACK);
+	queue_seg(2 * SEG_LEN, NET_TCP_ACK);
+
+	k_sleep(RECV_WAIT);
+
+	zassert_false(test_failed, "Received packet verify failed");
+	zassert_equal(recv_count, 1, "Segments not merged");
+	check_recv(0, 0, 3 * SEG_LEN, NET_TCP_ACK);
+}
+
+static void test_gro_flush_psh(void)
+{
+	recv_reset();
+
+	queue_seg(0, NET_TCP_ACK);
+	queue_seg(SEG_LEN, NET_TCP_ACK | NET_TCP_PSH);
+	queue_seg(2 * SEG_LEN, NET_TCP_ACK);
+	queue_seg(3 * SEG_LEN, NET_TCP_ACK);
+
+	k_sleep(RECV_WAIT);
+
+	zassert_false(test_failed, "Received packet verify failed");
+	zassert_equal(recv_count, 2, "Not flushed on PSH");
+	check_recv(0, 0, 2 * SEG_LEN, NET_TCP_ACK | NET_TCP_PSH);
+	check_recv(1, 2 * SEG_LEN, 2 * SEG_LEN, NET_TCP_ACK);
+}
+
+static void test_gro_flush_out_of_order(void)
+{
+	recv_reset();
+
+	/* The segment at SEG_LEN is missing */
+	queue_seg(0, NET_TCP_ACK);
+	queue_seg(2 * SEG_LEN, NET_TCP_ACK);
+	queue_seg(3 * SEG_LEN, NET_TCP_ACK);
+
+	k_sleep(RECV_WAIT);
+
+	zassert_false(test_failed, "Received packet verify failed");
+	zassert_equal(recv_count, 2, "Not flushed on out of order segment");
+	check_recv(0, 0, SEG_LEN, NET_TCP_ACK);
+	check_recv(1, 2 * SEG_LEN, 2 * SEG_LEN, NET_TCP_ACK);
+}
+
+static void test_gro_flush_flags(void)
+{
+	recv_reset();
+
+	queue_seg(0, NET_TCP_ACK);
+	queue_seg(SEG_LEN, NET_TCP_ACK | NET_TCP_FIN);
+
+	k_sleep(RECV_WAIT);
+
+	zassert_false(test_failed, "Received packet verify failed");
+	zassert_equal(recv_count, 2, "Not flushed on flag mismatch");
+	check_recv(0, 0, SEG_LEN, NET_TCP_ACK);
+	check_recv(1, SEG_LEN, SEG_LEN, NET_TCP_ACK | NET_TCP_FIN);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tcp_gso_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_gso_split),
+			 ztest_unit_test(test_gso_send_error),
+			 ztest_unit_test(test_gro_merge),
+			 ztest_unit_test(test_gro_flush_psh),
+			 ztest_unit_test(test_gro_flush_out_of_order),
+			 ztest_unit_test(test_gro_flush_flags)
+			 );
+
+	ztest_run_test_suite(net_tcp_gso_test);
+}
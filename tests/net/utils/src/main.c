@@ -20,6 +20,8 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_UTILS_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_ip.h>
 #include <net/ethernet.h>
+#include <net/net_pkt.h>
+#include <random/rand32.h>
 #include <linker/sections.h>
 
 #include <tc_util.h>
@@ -830,11 +832,115 @@ void test_addr_parse(void)
 #endif
 }
 
+/* The plain 16 bits at a time checksum the stack used to have */
+static u16_t ref_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	u16_t tmp;
+
+	while (len > 1) {
+		tmp = (data[0] << 8) + data[1];
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		tmp = data[0] << 8;
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+static u8_t chksum_data[256 + 8];
+
+/* One's complement sums can represent zero as 0x0000 or 0xffff */
+static bool chksum_equal(u16_t a, u16_t b)
+{
+	return a == b || (a == 0xffff && b == 0) || (a == 0 && b == 0xffff);
+}
+
+void test_chksum(void)
+{
+	size_t src_off, len;
+	u16_t sum, ref;
+	int i;
+
+	for (i = 0; i < sizeof(chksum_data); i++) {
+		chksum_data[i] = sys_rand32_get();
+	}
+
+	for (src_off = 0; src_off < 4; src_off++) {
+		for (len = 0; len <= 256; len++) {
+			ref = ref_chksum(0x1234, chksum_data + src_off, len);
+			sum = net_calc_chksum_buf(0x1234,
+						  chksum_data + src_off, len);
+
+			zassert_true(chksum_equal(sum, ref),
+				     "chksum off %zu len %zu: 0x%04x != 0x%04x",
+				     src_off, len, sum, ref);
+		}
+	}
+}
+
+/* Fragment lengths, odd ones included, of the packet checksummed by
+ * test_chksum_pkt(). The first one holds the IPv4 header.
+ */
+static const size_t chksum_frags[] = {
+	NET_IPV4H_LEN + 3, 7, 1, 64, 5,
+};
+
+void test_chksum_pkt(void)
+{
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	size_t total = 0;
+	u16_t sum, ref;
+	int i;
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	for (i = 0; i < ARRAY_SIZE(chksum_frags); i++) {
+		frag = net_pkt_get_frag(pkt, K_NO_WAIT);
+		zassert_not_null(frag, "Cannot allocate frag");
+
+		net_buf_add_mem(frag, chksum_data + total, chksum_frags[i]);
+		net_pkt_frag_add(pkt, frag);
+
+		total += chksum_frags[i];
+	}
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV4H_LEN);
+
+	/* Pseudo header: length and protocol, then both addresses */
+	ref = ref_chksum(total - NET_IPV4H_LEN + IPPROTO_UDP,
+			 chksum_data + NET_IPV4H_LEN - 8, 8);
+	ref = ref_chksum(ref, chksum_data + NET_IPV4H_LEN,
+			 total - NET_IPV4H_LEN);
+	ref = ~((ref == 0) ? 0xffff : htons(ref));
+
+	sum = net_calc_chksum(pkt, IPPROTO_UDP);
+	zassert_equal(sum, ref, "pkt chksum 0x%04x != 0x%04x", sum, ref);
+
+	net_pkt_unref(pkt);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_pkt));
 
 	ztest_run_test_suite(test_utils_fn);
 }
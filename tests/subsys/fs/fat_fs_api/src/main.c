@@ -20,6 +20,7 @@ void test_main(void)
 			 ztest_unit_test(test_fat_file),
 			 ztest_unit_test(test_fat_dir),
 			 ztest_unit_test(test_fat_fs),
-			 ztest_unit_test(test_fat_rename));
+			 ztest_unit_test(test_fat_rename),
+			 ztest_unit_test(test_fat_async));
 	ztest_run_test_suite(fat_fs_basic_test);
 }
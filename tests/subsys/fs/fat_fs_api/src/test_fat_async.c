@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @filesystem
+ * @brief test_filesystem
+ * Tests the asynchronous and vectored file I/O
+ */
+
+#include "test_fat.h"
+#include <string.h>
+
+#define ASYNC_FILE	FATFS_MNTP"/async.txt"
+#define ASYNC_REQS	4
+
+static const char head[] = "record ";
+static char body[ASYNC_REQS][2];
+
+static struct fs_iovec write_iov[ASYNC_REQS][2];
+static struct fs_async_req reqs[ASYNC_REQS];
+static struct k_poll_signal signals[ASYNC_REQS];
+
+static ssize_t wait_req(struct fs_async_req *req)
+{
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, req->signal);
+	int rc;
+
+	rc = k_poll(&event, 1, K_SECONDS(5));
+	zassert_equal(rc, 0, "request not completed");
+	zassert_equal(event.signal->result, req->result,
+		      "signal and request results differ");
+
+	return req->result;
+}
+
+static void test_async_write(struct fs_file_t *fp)
+{
+	size_t len = strlen(head) + sizeof(body[0]);
+	int rc;
+
+	/* Queued back to back, the writes may be merged */
+	for (int i = 0; i < ASYNC_REQS; i++) {
+		body[i][0] = '0' + i;
+		body[i][1] = '\n';
+
+		write_iov[i][0].iov_base = (void *)head;
+		write_iov[i][0].iov_len = strlen(head);
+		write_iov[i][1].iov_base = body[i];
+		write_iov[i][1].iov_len = sizeof(body[i]);
+
+		k_poll_signal_init(&signals[i]);
+		reqs[i].zfp = fp;
+		reqs[i].op = FS_ASYNC_WRITE;
+		reqs[i].iov = write_iov[i];
+		reqs[i].iovcnt = 2;
+		reqs[i].signal = &signals[i];
+
+		rc = fs_async_submit(&reqs[i]);
+		zassert_equal(rc, 0, "submit failed");
+	}
+
+	for (int i = 0; i < ASYNC_REQS; i++) {
+		zassert_equal(wait_req(&reqs[i]), len, "short write");
+	}
+}
+
+static void test_async_read(struct fs_file_t *fp)
+{
+	size_t len = strlen(head) + sizeof(body[0]);
+	char buf[ASYNC_REQS][16];
+	struct fs_iovec iov[2];
+	struct k_poll_signal signal;
+	struct fs_async_req req = {
+		.zfp = fp,
+		.op = FS_ASYNC_READ,
+		.iov = iov,
+		.iovcnt = 2,
+		.signal = &signal,
+	};
+	int rc;
+
+	/* The first record in two buffers, the others in one each */
+	iov[0].iov_base = buf[0];
+	iov[0].iov_len = 3;
+	iov[1].iov_base = buf[0] + 3;
+	iov[1].iov_len = (ASYNC_REQS * len) - 3;
+
+	k_poll_signal_init(&signal);
+	rc = fs_async_submit(&req);
+	zassert_equal(rc, 0, "submit failed");
+	zassert_equal(wait_req(&req), ASYNC_REQS * len, "short read");
+
+	for (int i = 0; i < ASYNC_REQS; i++) {
+		char *rec = buf[0] + i * len;
+
+		zassert_true(memcmp(rec, head, strlen(head)) == 0,
+			     "wrong data read");
+		zassert_true(memcmp(rec + strlen(head), body[i],
+				    sizeof(body[i])) == 0, "wrong data read");
+	}
+}
+
+static void test_vectored_read(struct fs_file_t *fp)
+{
+	size_t len = strlen(head) + sizeof(body[0]);
+	char buf[2][16];
+	struct fs_iovec iov[2] = {
+		{ .iov_base = buf[0], .iov_len = len },
+		/* asks for more than what is left */
+		{ .iov_base = buf[1], .iov_len = sizeof(buf[1]) },
+	};
+	ssize_t brw;
+	int rc;
+
+	rc = fs_seek(fp, -2 * len, FS_SEEK_END);
+	zassert_equal(rc, 0, "fs_seek failed");
+
+	brw = fs_readv(fp, iov, 2);
+	zassert_equal(brw, 2 * len, "wrong read size at end of file");
+	zassert_true(memcmp(buf[1] + strlen(head), body[ASYNC_REQS - 1],
+			    sizeof(body[0])) == 0, "wrong data read");
+}
+
+void test_fat_async(void)
+{
+	struct fs_file_t fp;
+	int rc;
+
+	if (check_file_dir_exists(ASYNC_FILE)) {
+		zassert_equal(fs_unlink(ASYNC_FILE), 0, "fs_unlink failed");
+	}
+
+	rc = fs_open(&fp, ASYNC_FILE);
+	zassert_equal(rc, 0, "fs_open failed");
+
+	test_async_write(&fp);
+
+	rc = fs_seek(&fp, 0, FS_SEEK_SET);
+	zassert_equal(rc, 0, "fs_seek failed");
+
+	test_async_read(&fp);
+	test_vectored_read(&fp);
+
+	rc = fs_close(&fp);
+	zassert_equal(rc, 0, "fs_close failed");
+}
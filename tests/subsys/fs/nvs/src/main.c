@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <nvs/nvs.h>
+
+#include "ram_flash.h"
+
+#define DELETED_ID 1
+#define FILL_ID 100
+#define ABSENT_ID 3
+
+/* More ids than the lookup cache holds */
+#define EVICT_IDS 40
+
+static struct nvs_fs fs = {
+	.offset = 0,
+	.sector_size = RAM_FLASH_PAGE_SIZE,
+	.sector_count = RAM_FLASH_PAGE_COUNT,
+};
+
+static u8_t buf[256];
+
+static void mount(void)
+{
+	int rc;
+
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	zassert_equal(rc, 0, "nvs_init failed (%d)", rc);
+}
+
+static void mount_empty(void)
+{
+	int rc;
+
+	mount();
+
+	rc = nvs_clear(&fs);
+	zassert_equal(rc, 0, "nvs_clear failed (%d)", rc);
+
+	mount();
+}
+
+/* Overwrite FILL_ID until every sector written before has been
+ * collected and erased.
+ */
+static void fill(void)
+{
+	u32_t erases = ram_flash_erases;
+	ssize_t rc;
+	int i;
+
+	for (i = 0; i < 4 * RAM_FLASH_PAGE_COUNT * RAM_FLASH_PAGE_SIZE /
+		     sizeof(buf); i++) {
+		(void)memset(buf, i, sizeof(buf));
+		rc = nvs_write(&fs, FILL_ID, buf, sizeof(buf));
+		zassert_equal(rc, sizeof(buf), "nvs_write failed (%d)",
+			      (int)rc);
+	}
+
+#ifdef CONFIG_NVS_GC_INCREMENTAL
+	while (nvs_gc_step(&fs) > 0) {
+	}
+#endif
+
+	zassert_true(ram_flash_erases - erases >= RAM_FLASH_PAGE_COUNT,
+		     "Sectors not collected");
+}
+
+static void check_absent(u16_t id)
+{
+	ssize_t rc;
+
+	rc = nvs_read(&fs, id, buf, sizeof(buf));
+	zassert_equal(rc, -ENOENT, "id %d found (%d)", id, (int)rc);
+}
+
+/* With a complete lookup cache a miss is answered without a flash read */
+static void check_absent_cached(u16_t id)
+{
+	u32_t reads = ram_flash_reads;
+
+	check_absent(id);
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	zassert_true(fs.lookup_complete, "Lookup cache not complete");
+	zassert_equal(ram_flash_reads, reads, "id %d looked up in flash",
+		      id);
+#else
+	ARG_UNUSED(reads);
+#endif
+}
+
+static void check_ids(void)
+{
+	ssize_t rc;
+	u32_t val;
+	int i;
+
+	for (i = 0; i < EVICT_IDS; i++) {
+		if (!(i % 2)) {
+			check_absent(i);
+			continue;
+		}
+
+		rc = nvs_read(&fs, i, &val, sizeof(val));
+		zassert_equal(rc, sizeof(val), "id %d not read (%d)", i,
+			      (int)rc);
+		zassert_equal(val, i, "id %d has a wrong value", i);
+	}
+
+	check_absent(EVICT_IDS);
+}
+
+static void test_delete_gc(void)
+{
+	u32_t val = 0x1234;
+	ssize_t rc;
+
+	mount_empty();
+
+	check_absent_cached(ABSENT_ID);
+
+	rc = nvs_write(&fs, DELETED_ID, &val, sizeof(val));
+	zassert_equal(rc, sizeof(val), "nvs_write failed (%d)", (int)rc);
+
+	rc = nvs_delete(&fs, DELETED_ID);
+	zassert_equal(rc, 0, "nvs_delete failed (%d)", (int)rc);
+
+	check_absent(DELETED_ID);
+
+	/* The delete entry is not copied by the garbage collection, the id
+	 * has no entry at all once its sector is erased.
+	 */
+	fill();
+
+	check_absent_cached(DELETED_ID);
+	check_absent_cached(ABSENT_ID);
+
+	rc = nvs_read(&fs, FILL_ID, buf, sizeof(buf));
+	zassert_equal(rc, sizeof(buf), "Filled id not read (%d)", (int)rc);
+
+	mount();
+
+	check_absent_cached(DELETED_ID);
+	check_absent_cached(ABSENT_ID);
+
+	rc = nvs_write(&fs, DELETED_ID, &val, sizeof(val));
+	zassert_equal(rc, sizeof(val), "nvs_write failed (%d)", (int)rc);
+
+	rc = nvs_read(&fs, DELETED_ID, buf, sizeof(buf));
+	zassert_equal(rc, sizeof(val), "Rewritten id not read (%d)",
+		      (int)rc);
+}
+
+static void test_evict(void)
+{
+	ssize_t rc;
+	u32_t val;
+	int i;
+
+	mount_empty();
+
+	for (val = 0U; val < EVICT_IDS; val++) {
+		rc = nvs_write(&fs, val, &val, sizeof(val));
+		zassert_equal(rc, sizeof(val), "nvs_write failed (%d)",
+			      (int)rc);
+	}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	zassert_false(fs.lookup_complete, "No id evicted");
+#endif
+
+	for (i = 0; i < EVICT_IDS; i += 2) {
+		rc = nvs_delete(&fs, i);
+		zassert_equal(rc, 0, "nvs_delete failed (%d)", (int)rc);
+	}
+
+	/* Ids that are not cached any more are looked up in flash */
+	check_ids();
+
+	fill();
+	check_ids();
+
+	mount();
+	check_ids();
+}
+
+static void test_clear(void)
+{
+	u32_t val = 0x5678;
+	ssize_t rc;
+
+	mount();
+
+	rc = nvs_write(&fs, ABSENT_ID, &val, sizeof(val));
+	zassert_equal(rc, sizeof(val), "nvs_write failed (%d)", (int)rc);
+
+	rc = nvs_clear(&fs);
+	zassert_equal(rc, 0, "nvs_clear failed (%d)", rc);
+
+	check_absent(ABSENT_ID);
+	check_absent(FILL_ID);
+
+	mount();
+
+	check_absent_cached(ABSENT_ID);
+	check_absent_cached(FILL_ID);
+
+	rc = nvs_write(&fs, ABSENT_ID, &val, sizeof(val));
+	zassert_equal(rc, sizeof(val), "nvs_write failed (%d)", (int)rc);
+
+	rc = nvs_read(&fs, ABSENT_ID, buf, sizeof(buf));
+	zassert_equal(rc, sizeof(val), "id not read after clear (%d)",
+		      (int)rc);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nvs_test,
+			 ztest_unit_test(test_delete_gc),
+			 ztest_unit_test(test_evict),
+			 ztest_unit_test(test_clear)
+			 );
+
+	ztest_run_test_suite(nvs_test);
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ztest.h>
+#include <flash.h>
+#include <flash_map.h>
+
+#include "settings/settings.h"
+#include "settings/settings_nvs.h"
+#include "settings_priv.h"
+
+#define TEST_KEYS 10
+
+static u32_t val[TEST_KEYS];
+static size_t val_len[TEST_KEYS];
+static int set_called;
+
+static struct settings_nvs cf;
+
+static int nt_handle_set(int argc, char **argv, void *value_ctx)
+{
+	int idx;
+	int rc;
+
+	if (argc != 1) {
+		return -ENOENT;
+	}
+
+	idx = atoi(argv[0]);
+	zassert_true(idx >= 0 && idx < TEST_KEYS, "unexpected key %s",
+		     argv[0]);
+
+	val_len[idx] = settings_val_get_len_cb(value_ctx);
+	rc = settings_val_read_cb(value_ctx, &val[idx], sizeof(val[idx]));
+	zassert_true(rc >= 0, "SETTINGS_VALUE_SET callback");
+
+	set_called++;
+
+	return 0;
+}
+
+static struct settings_handler nt_handler = {
+	.name = "nt",
+	.h_set = nt_handle_set,
+};
+
+static void clear_values(void)
+{
+	(void)memset(val, 0, sizeof(val));
+	(void)memset(val_len, 0, sizeof(val_len));
+	set_called = 0;
+}
+
+static int save_key(int idx, u32_t value)
+{
+	char name[16];
+
+	snprintf(name, sizeof(name), "nt/%d", idx);
+
+	return settings_save_one(name, &value, sizeof(value));
+}
+
+/* Mounts the storage area again, as done at boot */
+static void nvs_mount(void)
+{
+	const struct flash_area *fap;
+	struct flash_pages_info info;
+	int rc;
+
+	sys_slist_init(&settings_load_srcs);
+	settings_save_dst = NULL;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fap);
+	zassert_true(rc == 0, "can't open the storage area");
+
+	rc = flash_get_page_info_by_offs(device_get_binding(fap->fa_dev_name),
+					 fap->fa_off, &info);
+	zassert_true(rc == 0, "can't get the page info");
+
+	(void)memset(&cf, 0, sizeof(cf));
+	cf.cf_dev_name = fap->fa_dev_name;
+	cf.cf_nvs.offset = fap->fa_off;
+	cf.cf_nvs.sector_size = info.size;
+	cf.cf_nvs.sector_count = fap->fa_size / info.size;
+
+	flash_area_close(fap);
+
+	rc = settings_nvs_src(&cf);
+	zassert_true(rc == 0, "can't register NVS as configuration source");
+
+	rc = settings_nvs_dst(&cf);
+	zassert_true(rc == 0,
+		     "can't register NVS as configuration destination");
+
+	settings_mount_nvs_backend(&cf);
+}
+
+void test_config_nvs_setup(void)
+{
+	const struct flash_area *fap;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fap);
+	zassert_true(rc == 0, "can't open the storage area");
+
+	rc = flash_area_erase(fap, 0, fap->fa_size);
+	zassert_true(rc == 0, "can't erase the storage area");
+
+	flash_area_close(fap);
+
+	rc = settings_register(&nt_handler);
+	zassert_true(rc == 0, "settings_register fail");
+
+	nvs_mount();
+}
+
+void test_config_nvs_save_load(void)
+{
+	int rc;
+
+	for (int i = 0; i < 4; i++) {
+		rc = save_key(i, 100 + i);
+		zassert_true(rc == 0, "NVS write error");
+	}
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, 4, "wrong number of keys loaded");
+
+	for (int i = 0; i < 4; i++) {
+		zassert_equal(val[i], 100 + i, "bad value read");
+		zassert_equal(val_len[i], sizeof(u32_t), "bad value length");
+	}
+
+	/* Only the latest value is loaded */
+	rc = save_key(2, 202);
+	zassert_true(rc == 0, "NVS write error");
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, 4, "wrong number of keys loaded");
+	zassert_equal(val[2], 202, "bad value read");
+}
+
+void test_config_nvs_save_dup(void)
+{
+	ssize_t free_space;
+	int rc;
+
+	free_space = nvs_calc_free_space(&cf.cf_nvs);
+
+	rc = save_key(0, 100);
+	zassert_true(rc == 0, "NVS write error");
+	zassert_equal(nvs_calc_free_space(&cf.cf_nvs), free_space,
+		      "same value written again");
+
+	rc = save_key(0, 300);
+	zassert_true(rc == 0, "NVS write error");
+	zassert_true(nvs_calc_free_space(&cf.cf_nvs) < free_space,
+		     "new value not written");
+}
+
+void test_config_nvs_delete(void)
+{
+	int rc;
+
+	rc = settings_delete("nt/1");
+	zassert_true(rc == 0, "NVS delete error");
+
+	/* A name that was never saved */
+	rc = settings_delete("nt/9");
+	zassert_true(rc == 0, "NVS delete error");
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, 3, "deleted key loaded");
+	zassert_equal(val_len[1], 0, "deleted key loaded");
+}
+
+void test_config_nvs_remount(void)
+{
+	u16_t key_cnt;
+	int rc;
+
+	nvs_mount();
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, 3, "wrong number of keys loaded");
+	zassert_equal(val[0], 300, "bad value read");
+	zassert_equal(val[2], 202, "bad value read");
+	zassert_equal(val[3], 103, "bad value read");
+
+	/* A deleted key gets its ids back */
+	key_cnt = cf.cf_key_cnt;
+	rc = save_key(1, 401);
+	zassert_true(rc == 0, "NVS write error");
+	zassert_equal(cf.cf_key_cnt, key_cnt, "deleted key got new ids");
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, 4, "wrong number of keys loaded");
+	zassert_equal(val[1], 401, "bad value read");
+}
+
+void test_config_nvs_limits(void)
+{
+	u8_t long_val[SETTINGS_MAX_VAL_LEN + 1] = { 0 };
+	int rc;
+
+	for (int i = 4; i < CONFIG_SETTINGS_NVS_MAX_KEYS; i++) {
+		rc = save_key(i, 100 + i);
+		zassert_true(rc == 0, "NVS write error");
+	}
+
+	rc = save_key(CONFIG_SETTINGS_NVS_MAX_KEYS, 0);
+	zassert_equal(rc, -ENOMEM, "key over the max saved");
+
+	rc = settings_save_one("nt/0", long_val, sizeof(long_val));
+	zassert_equal(rc, -EINVAL, "value over the max saved");
+
+	nvs_mount();
+
+	clear_values();
+	rc = settings_load();
+	zassert_true(rc == 0, "NVS read error");
+	zassert_equal(set_called, CONFIG_SETTINGS_NVS_MAX_KEYS,
+		      "wrong number of keys loaded");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_config_nvs,
+			 ztest_unit_test(test_config_nvs_setup),
+			 ztest_unit_test(test_config_nvs_save_load),
+			 ztest_unit_test(test_config_nvs_save_dup),
+			 ztest_unit_test(test_config_nvs_delete),
+			 ztest_unit_test(test_config_nvs_remount),
+			 ztest_unit_test(test_config_nvs_limits)
+			);
+
+	ztest_run_test_suite(test_config_nvs);
+}